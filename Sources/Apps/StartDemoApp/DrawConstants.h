@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Push constants of a draw with bindless descriptors, read by the vertex (world) and fragment
+// (material) stages. Shaders/bindless.vert and bindless.frag declare the same block.
+struct DrawConstants
+{
+	glm::mat4 world;
+	uint32_t material;	// Index into the bindless material buffer
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// A slot of the bindless material buffer, laid out like the std430 Material struct of Shaders/bindless.frag
+struct Material
+{
+	glm::vec4 baseColor;
+	uint32_t baseColorTexture;	// Index into the bindless texture array
+	uint32_t padding[3];
+};
@@ -1,22 +1,18 @@
 #pragma once
 
-#include <glm/glm.hpp>
-
 #include "Render/Vulkan/VulkanCommon.h"
+#include "Scene/Lod.h"
+#include "Scene/Occlusion.h"
 
+// Mesh component of the demo entities, drawn with their Scene::WorldTransform
 struct Renderable
 {
-	void Draw() const
-	{
-	}
-
-	void UploatToGPU()
-	{
-	}
-
-	glm::mat4 modelMatrix;
 	VkBuffer vertexBuffer;
 	VkBuffer indexBuffer;
+	uint32_t firstIndex;
 	uint32_t indexCount;
-	VkDescriptorSet descriptorSet;
+	uint32_t material; // From StartDemoApp::addMaterial(), a bindless slot or a per-material descriptor set
+	Eugenix::Scene::Aabb localBounds;
+	std::span<const Eugenix::Scene::LodLevel> lods; // Ranges of indexBuffer, empty when there is only the one above
+	const Eugenix::Scene::OccluderMesh* occluder{ nullptr }; // nullptr when it does not hide other objects
 };
\ No newline at end of file
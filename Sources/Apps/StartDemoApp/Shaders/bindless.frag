@@ -0,0 +1,35 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Fragment stage of the bindless StartDemoApp pipeline. The material index comes from the draw's
+// push constants and is the same for the whole draw, so the texture index needs no nonuniformEXT.
+
+struct Material
+{
+	vec4 baseColor;
+	uint baseColorTexture;	// Index into textures[]
+};
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(std430, set = 1, binding = 1) readonly buffer Materials
+{
+	Material materials[];
+};
+
+layout(push_constant) uniform DrawConstants
+{
+	mat4 world;
+	uint material;
+} draw;
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	Material material = materials[draw.material];
+	outColor = texture(textures[material.baseColorTexture], inTexCoord) * material.baseColor;
+}
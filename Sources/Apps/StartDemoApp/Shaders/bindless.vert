@@ -0,0 +1,30 @@
+#version 460
+
+// Vertex stage of the bindless StartDemoApp pipeline, the interface of DrawConstants.h and
+// VulkanBindlessDescriptors.h. The per-material pair in Shaders/Vulkan is the fallback.
+
+layout(set = 0, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 proj;
+} camera;
+
+layout(push_constant) uniform DrawConstants
+{
+	mat4 world;
+	uint material;
+} draw;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec2 outTexCoord;
+
+void main()
+{
+	gl_Position = camera.proj * camera.view * draw.world * vec4(inPosition, 1.0);
+	outNormal = mat3(draw.world) * inNormal;
+	outTexCoord = inTexCoord;
+}
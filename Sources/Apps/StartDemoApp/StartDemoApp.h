@@ -3,22 +3,42 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <unordered_map>
 
 #include <stb_image.h>
 #include <tiny_obj_loader.h>
 
 #include "Render/Vulkan/VulkanApp.h"
+#include "Render/Vulkan/VulkanBindlessDescriptors.h"
 #include "Render/Vulkan/VulkanBuffer.h"
+#include "Render/Vulkan/VulkanFrameUniformAllocator.h"
+#include "Render/Vulkan/VulkanGpuProfiler.h"
 #include "Render/Vulkan/VulkanInitializers.h"
 
 #include "Apps/StartDemoApp/Camera.h"
+#include "Apps/StartDemoApp/DrawConstants.h"
 #include "Apps/StartDemoApp/FrameData.h"
+#include "Apps/StartDemoApp/Material.h"
 #include "Apps/StartDemoApp/Renderable.h"
 #include "Apps/StartDemoApp/Vertex.h"
 #include "Apps/StartDemoApp/UBO.h"
 
+#include "Core/FrameStats.h"
+#include "Core/Jobs.h"
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+#include "Core/Simulation.h"
 #include "IO/IO.h"
+#include "IO/MemoryStream.h"
+#include "Scene/Components.h"
+#include "Scene/Ecs.h"
+#include "Scene/Lod.h"
+#include "Scene/Occlusion.h"
+#include "Scene/SceneGraph.h"
+#include "Scene/TransformSystems.h"
 
 class StartDemoApp final : public Eugenix::Render::Vulkan::VulkanApp
 {
@@ -27,6 +47,7 @@ protected:
 	{
 		createDescriptorSetLayouts();
 		initResources();
+		createMaterialTables();
 		createDepthResources();
 		createRenderPass();
 		createFramebuffers();
@@ -34,9 +55,16 @@ protected:
 		initRenderables();
 		createDescriptorPool();
 		createDescriptorSets();
-		createCommandBuffers();
 		createSyncObject();
 
+		// The first frames draw nothing until these copies are done
+		_uploadsReady = _uploads.Flush();
+
+		_gpuProfiler.Create(_adapter, _device, Eugenix::Render::Vulkan::Swapchain::MaxFramesInFlight);
+
+		// Whatever the last session used, once the names it refers to are registered
+		_pipelines.WarmUp();
+
 		return true;
 	}
 
@@ -69,14 +97,37 @@ protected:
 		if (KeyPress(GLFW_KEY_D))
 			_camera.processKeyboard('D', deltaTime);
 
-		updatePerFrameData(deltaTime);
+		// The camera stays with the render thread, the scene moves at the simulation's fixed rate
+		const auto frame = _simulation.Acquire();
+		_snapshotSync.Update(frame.previous, frame.latest, frame.alpha);
 	}
 
 	void onRender() override
 	{
 		auto& frame = _frames[_currentFrame];
 
-		vkWaitForFences(_device.Handle(), 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
+		{
+			EUGENIX_PROFILE_SCOPE("WaitForFence");
+
+			const auto waitStart = std::chrono::steady_clock::now();
+			vkWaitForFences(_device.Handle(), 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
+			Eugenix::FrameStats::AddFenceWait(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count());
+		}
+
+		_frameUniforms.BeginFrame(static_cast<uint32_t>(_currentFrame));
+
+		// The fence covers every command buffer of the frame, its pools are reset as a whole
+		_commandPools.BeginFrame(static_cast<uint32_t>(_currentFrame));
+		frame.commandBuffer = _commandPools.Primary();
+
+		// Compare a first launch with the next one to see what the on-disk cache saves
+		if (!_startupPipelinesLogged && _pipelines.Pending() == 0)
+		{
+			const auto pipelineStats = _device.Pipelines().Stats();
+			Eugenix::LogInfo("Startup pipelines: {} created in {:.2f} ms from a {} cache", pipelineStats.pipelines,
+				pipelineStats.milliseconds, pipelineStats.warm ? "warm" : "cold");
+			_startupPipelinesLogged = true;
+		}
 
 		uint32_t imageIndex{};
 		VkResult acquireResult = vkAcquireNextImageKHR(_device.Handle(), _swapchain.Handle(), UINT64_MAX, frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
@@ -93,10 +144,11 @@ protected:
 		}
 
 		updateUniformBuffer(imageIndex);
+		cullRenderables();
 
 		VERIFYVULKANRESULT(vkResetFences(_device.Handle(), 1, &frame.inFlight));
-		VERIFYVULKANRESULT(vkResetCommandBuffer(frame.commandBuffer, 0));
 		recordCommandBuffer(frame.commandBuffer, imageIndex);
+		_frameUniforms.EndFrame();
 
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -140,36 +192,26 @@ protected:
 
 	void onCleanup() override
 	{
-		cleanupSwapchain();
+		_simulation.Stop();
 
-		vkDestroySampler(_device.Handle(), _textureSampler, EUGENIX_VULKAN_ALLOCATOR);
+		_gpuProfiler.Destroy();
+
+		cleanupSwapchain();
 
-		vkDestroyImageView(_device.Handle(), _textureImageView, EUGENIX_VULKAN_ALLOCATOR);
-		vkDestroyImage(_device.Handle(), _textureImage, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), _textureImageMemory, EUGENIX_VULKAN_ALLOCATOR);
+		if (_useBindless)
+			_bindless.Destroy();
 
-		vkDestroyBuffer(_device.Handle(), _uniformBuffer.buffer, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), _uniformBuffer.memory, EUGENIX_VULKAN_ALLOCATOR);
+		vkDestroySampler(_device.Handle(), _textureSampler, EUGENIX_VULKAN_ALLOCATOR);
 
-		vkDestroyBuffer(_device.Handle(), _vertexBuffer.buffer, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), _vertexBuffer.memory, EUGENIX_VULKAN_ALLOCATOR);
+		_device.DestroyImage(_texture);
 
-		vkDestroyBuffer(_device.Handle(), _indexBuffer.buffer, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), _indexBuffer.memory, EUGENIX_VULKAN_ALLOCATOR);
+		_frameUniforms.Destroy();
+		_device.DestroyBuffer(_vertexBuffer);
+		_device.DestroyBuffer(_indexBuffer);
 
 		vkDestroyDescriptorSetLayout(_device.Handle(), _globalDescriptorSetLayout, EUGENIX_VULKAN_ALLOCATOR);
 		vkDestroyDescriptorSetLayout(_device.Handle(), _materialDescriptorSetLayout, EUGENIX_VULKAN_ALLOCATOR);
 
-		std::vector<VkCommandBuffer> commandBuffers;
-		for (const auto& frame : _frames)
-		{
-			commandBuffers.push_back(frame.commandBuffer);
-		}
-		vkFreeCommandBuffers(_device.Handle(), _commandPool,
-			static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-
-		vkDestroyCommandPool(_device.Handle(), _commandPool, EUGENIX_VULKAN_ALLOCATOR);
-
 		glfwDestroyWindow(_window);
 		glfwTerminate();
 	}
@@ -177,7 +219,8 @@ protected:
 private:
 	VkRenderPass _renderPass{ VK_NULL_HANDLE };
 	VkPipelineLayout _pipelineLayout{ VK_NULL_HANDLE };
-	VkPipeline _graphicsPipeline{ VK_NULL_HANDLE };
+	Eugenix::Render::Vulkan::PipelineCompiler::Key _mainPipeline{};
+	bool _startupPipelinesLogged{ false };
 
 	std::vector<VkFramebuffer> _swapchainFramebuffers;
 
@@ -186,26 +229,42 @@ private:
 
 	VkDescriptorPool _descriptorPool{ VK_NULL_HANDLE };
 	VkDescriptorSetLayout _globalDescriptorSetLayout;  // set = 0 (view/proj)
-	VkDescriptorSetLayout _materialDescriptorSetLayout;  // set = 1 (sampler)
 	VkDescriptorSet _globalDescriptorSet;
-	VkDescriptorSet _materialDescriptorSet;
+
+	// Compiled from Sources/Apps/StartDemoApp/Shaders, see the CMakeLists.txt there
+	static constexpr const char* BindlessVertexShader = "Shaders/Vulkan/bindless.vert.spv";
+	static constexpr const char* BindlessFragmentShader = "Shaders/Vulkan/bindless.frag.spv";
+
+	// set = 1, every texture and material, indexed through DrawConstants::material
+	bool _useBindless{ false };
+	Eugenix::Render::Vulkan::BindlessDescriptors _bindless;
+	uint32_t _textureIndex{ Eugenix::Render::Vulkan::BindlessDescriptors::InvalidIndex };
+
+	// set = 1 without descriptor indexing, a set per material holding its texture (binding 1)
+	VkDescriptorSetLayout _materialDescriptorSetLayout;
+	std::vector<VkDescriptorImageInfo> _textures;
+	std::vector<Material> _materials;
+	std::vector<VkDescriptorSet> _materialDescriptorSets;	// Per material, from _descriptorPool
 
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
+	Eugenix::Scene::Aabb _modelBounds;
+	std::vector<Eugenix::Scene::LodLevel> _modelLods;
+	std::vector<glm::vec3> _modelPositions;
+	Eugenix::Scene::OccluderMesh _modelOccluder;
 
 	Eugenix::Render::Vulkan::Buffer _vertexBuffer;
 	Eugenix::Render::Vulkan::Buffer _indexBuffer;
 
-	Eugenix::Render::Vulkan::Buffer _uniformBuffer;
+	Eugenix::Render::Vulkan::FrameUniformAllocator _frameUniforms;
+	uint32_t _cameraOffset{ Eugenix::Render::Vulkan::FrameUniformAllocator::InvalidOffset };	// Dynamic offset of this frame's UniformBufferObject
 
-	VkImage _textureImage;
-	VkDeviceMemory _textureImageMemory;
-	VkImageView _textureImageView;
+	Eugenix::Render::Vulkan::Image _texture;
 	VkSampler _textureSampler;
 
-	VkImage _depthImage;
-	VkDeviceMemory _depthImageMemory;
-	VkImageView _depthImageView;
+	Eugenix::Render::Vulkan::Image _depth;
+
+	Eugenix::Render::Vulkan::UploadManager::Ticket _uploadsReady{};
 
 	double _lastTime;
 	int _frameCount{ 0 };
@@ -215,7 +274,27 @@ private:
 	bool _firstMouse = true;
 	float _deltaTime = 0.0f, _lastFrame = 0.0f;
 
-	std::vector<Renderable> _renderables;
+	Eugenix::Scene::SceneGraph _scene;
+	Eugenix::Scene::Registry _registry;
+	Eugenix::Scene::SnapshotSyncSystem _snapshotSync{ _registry };
+
+	std::vector<Eugenix::Scene::NodeId> _spinNodes;
+
+	// Owns _scene and _spinNodes once started, declared after them so it stops first
+	Eugenix::Simulation::FixedStepThread<Eugenix::Scene::SceneSnapshot> _simulation;
+
+	Eugenix::Scene::Query<const Eugenix::Scene::WorldTransform, const Renderable, Eugenix::Scene::LodState> _drawQuery{ _registry };
+
+	// This frame's draw list in world space, recorded through the culler's visible indices
+	std::vector<glm::mat4> _drawWorlds;
+	std::vector<Renderable> _drawMeshes;
+	Eugenix::Scene::AabbBounds _drawBounds;
+	Eugenix::Scene::FrustumCuller _culler;
+	Eugenix::Scene::OcclusionCuller _occlusion;
+	std::vector<uint32_t> _drawVisible;
+	std::vector<VkCommandBuffer> _secondaries;	// recordDraws, executed in visible order
+
+	Eugenix::Render::Vulkan::GpuProfiler _gpuProfiler;
 
 	void createFramebuffers()
 	{
@@ -223,7 +302,7 @@ private:
 
 		for (size_t i = 0; i < _swapchain.Images().size(); ++i)
 		{
-			std::array<VkImageView, 2> attachments = { _swapchain.ImageViews()[i], _depthImageView };
+			std::array<VkImageView, 2> attachments = { _swapchain.ImageViews()[i], _depth.view };
 
 			VkFramebufferCreateInfo framebufferInfo = Eugenix::Render::Vulkan::FrameBufferInfo(_renderPass,
 				attachments, _swapchain.Extent(), 1);
@@ -254,7 +333,6 @@ private:
 		createDescriptorPool();
 		createDescriptorSets();
 
-		createCommandBuffers();
 		createSyncObject();
 
 		_currentFrame = 0;
@@ -322,7 +400,7 @@ private:
 		VkDescriptorSetLayoutBinding uboLayoutBinding{};
 		uboLayoutBinding.binding = 0;
 		uboLayoutBinding.descriptorCount = 1;
-		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
 		std::array<VkDescriptorSetLayoutBinding, 1> bindings = { uboLayoutBinding };
@@ -330,7 +408,7 @@ private:
 		VkDescriptorSetLayoutCreateInfo layoutInfo = Eugenix::Render::Vulkan::DescriptorSetLayoutInfo(bindings);
 		VERIFYVULKANRESULT(vkCreateDescriptorSetLayout(_device.Handle(), &layoutInfo, EUGENIX_VULKAN_ALLOCATOR, &_globalDescriptorSetLayout));
 
-		// Sampler
+		// Sampler, the material set when there are no bindless descriptors
 		VkDescriptorSetLayoutBinding samplerLayoutBinding{};
 		samplerLayoutBinding.binding = 1;
 		samplerLayoutBinding.descriptorCount = 1;
@@ -344,19 +422,75 @@ private:
 		VERIFYVULKANRESULT(vkCreateDescriptorSetLayout(_device.Handle(), &layoutInfo, EUGENIX_VULKAN_ALLOCATOR, &_materialDescriptorSetLayout));
 	}
 
+	// Outlives swapchain recreation, the pipeline layout refers to its set layout. Bindless needs
+	// descriptor indexing and the shaders built from Sources/Apps/StartDemoApp/Shaders, without
+	// either the demo binds a set per material with the Shaders/Vulkan/vertex.spv and fragment.spv pair.
+	void createMaterialTables()
+	{
+		constexpr uint32_t MaxTextures = 4096;
+		constexpr uint32_t MaxMaterials = 1024;
+
+		if (!_device.DescriptorIndexing())
+		{
+			Eugenix::LogWarn("StartDemoApp: no descriptor indexing, binding a descriptor set per material");
+		}
+		else if (!std::filesystem::exists(BindlessVertexShader) || !std::filesystem::exists(BindlessFragmentShader))
+		{
+			Eugenix::LogWarn("StartDemoApp: {} or {} is missing, binding a descriptor set per material", BindlessVertexShader, BindlessFragmentShader);
+		}
+		else
+		{
+			_useBindless = _bindless.Create(_adapter, _device, MaxTextures, MaxMaterials, sizeof(Material));
+			if (!_useBindless)
+			{
+				_bindless.Destroy();
+				Eugenix::LogWarn("StartDemoApp: bindless descriptors failed, binding a descriptor set per material");
+			}
+		}
+
+		_textureIndex = addTexture(_texture.view, _textureSampler);
+	}
+
+	// The two layouts differ in set 1 and the push constants. The manifest only records the name,
+	// a pipeline the last session built for one must not be warmed up against the other.
+	const char* pipelineLayoutName() const
+	{
+		return _useBindless ? "Main.Bindless" : "Main.PerMaterial";
+	}
+
+	// The index Material::baseColorTexture refers to
+	uint32_t addTexture(VkImageView view, VkSampler sampler)
+	{
+		if (_useBindless)
+			return _bindless.AddTexture(view, sampler);
+
+		_textures.push_back({ sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+		return static_cast<uint32_t>(_textures.size() - 1);
+	}
+
+	// The index Renderable::material refers to. Without bindless descriptors the sets are written
+	// in createDescriptorSets(), which comes after the renderables are set up.
+	uint32_t addMaterial(const Material& material)
+	{
+		if (_useBindless)
+			return _bindless.AddMaterial(material);
+
+		_materials.push_back(material);
+		return static_cast<uint32_t>(_materials.size() - 1);
+	}
+
 	void createDescriptorPool()
 	{
-		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		// The global set, plus a set per material unless they live in _bindless
+		const uint32_t materialSets = static_cast<uint32_t>(_materials.size());
 
-		// ubo pool size
-		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 		poolSizes[0].descriptorCount = 1;
-
-		// sampler pool size
 		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = 100;
+		poolSizes[1].descriptorCount = std::max(materialSets, 1u);
 
-		VkDescriptorPoolCreateInfo poolInfo = Eugenix::Render::Vulkan::DescriptorPoolInfo(poolSizes, static_cast<uint32_t>(100 + 1)); // FIXME: hardcoded size
+		VkDescriptorPoolCreateInfo poolInfo = Eugenix::Render::Vulkan::DescriptorPoolInfo(poolSizes, 1 + materialSets);
 
 		VERIFYVULKANRESULT(vkCreateDescriptorPool(_device.Handle(), &poolInfo, EUGENIX_VULKAN_ALLOCATOR, &_descriptorPool));
 	}
@@ -368,110 +502,57 @@ private:
 		VkDescriptorSetAllocateInfo allocInfo = Eugenix::Render::Vulkan::DescriptorSetAllocateInfo(_descriptorPool, 1, setLayouts);
 		VERIFYVULKANRESULT(vkAllocateDescriptorSets(_device.Handle(), &allocInfo, &_globalDescriptorSet));
 
-		setLayouts = { _materialDescriptorSetLayout };
+		// Written once, every frame binds its own range through the dynamic offset
+		VkDescriptorBufferInfo bufferInfo = _frameUniforms.DescriptorInfo(sizeof(UniformBufferObject));
 
-		VkDescriptorSetAllocateInfo samplerAllocInfo = Eugenix::Render::Vulkan::DescriptorSetAllocateInfo(_descriptorPool, 1, setLayouts);
-		VERIFYVULKANRESULT(vkAllocateDescriptorSets(_device.Handle(), &samplerAllocInfo, &_materialDescriptorSet));
+		// Filled in place, WriteDescriptorSet() keeps a pointer to its by-value buffer info
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = _globalDescriptorSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		descriptorWrite.pBufferInfo = &bufferInfo;
 
-		VkDescriptorBufferInfo bufferInfo{};
-		bufferInfo.buffer = _uniformBuffer.buffer;
-		bufferInfo.offset = 0;
-		bufferInfo.range = sizeof(UniformBufferObject);
+		vkUpdateDescriptorSets(_device.Handle(), 1, &descriptorWrite, 0, nullptr);
 
-		VkDescriptorImageInfo imageInfo{};
-		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imageInfo.imageView = _textureImageView;
-		imageInfo.sampler = _textureSampler;
+		// Reallocated with the pool on swapchain recreation
+		_materialDescriptorSets.resize(_materials.size());
+		if (_materials.empty())
+			return;
 
-		std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+		std::vector<VkDescriptorSetLayout> materialLayouts(_materials.size(), _materialDescriptorSetLayout);
+		VkDescriptorSetAllocateInfo materialAllocInfo = Eugenix::Render::Vulkan::DescriptorSetAllocateInfo(_descriptorPool,
+			static_cast<uint32_t>(materialLayouts.size()), materialLayouts);
+		VERIFYVULKANRESULT(vkAllocateDescriptorSets(_device.Handle(), &materialAllocInfo, _materialDescriptorSets.data()));
 
-		descriptorWrites[0] = Eugenix::Render::Vulkan::WriteDescriptorSet(_globalDescriptorSet, 0, 0, 1,
-			VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, bufferInfo);
-		descriptorWrites[1] = Eugenix::Render::Vulkan::WriteDescriptorSet(_materialDescriptorSet, 1, 0, 1,
-			VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, imageInfo);
+		std::vector<VkWriteDescriptorSet> materialWrites(_materials.size());
+		for (size_t i = 0; i < _materials.size(); ++i)
+		{
+			// The shaders of this path only sample the texture, the material's color is not applied
+			VkWriteDescriptorSet& write = materialWrites[i];
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = _materialDescriptorSets[i];
+			write.dstBinding = 1;
+			write.descriptorCount = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			write.pImageInfo = &_textures[_materials[i].baseColorTexture];
+		}
 
-		vkUpdateDescriptorSets(_device.Handle(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		vkUpdateDescriptorSets(_device.Handle(), static_cast<uint32_t>(materialWrites.size()), materialWrites.data(), 0, nullptr);
 	}
 
 	void createGraphicsPipeline()
 	{
-		auto vertShaderCode = Eugenix::IO::FileContent("Shaders/Vulkan/vertex.spv", std::ios::binary);
-		auto fragfShaderCode = Eugenix::IO::FileContent("Shaders/Vulkan/fragment.spv", std::ios::binary);
-
-		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-		VkShaderModule fragShaderModule = createShaderModule(fragfShaderCode);
-
-		VkPipelineShaderStageCreateInfo vertShaderStageInfo = Eugenix::Render::Vulkan::ShaderStageInfo(
-			VK_SHADER_STAGE_VERTEX_BIT, vertShaderModule, "main");
-
-		VkPipelineShaderStageCreateInfo fragShaderStageInfo = Eugenix::Render::Vulkan::ShaderStageInfo(
-			VK_SHADER_STAGE_FRAGMENT_BIT, fragShaderModule, "main");
-
-		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = { vertShaderStageInfo, fragShaderStageInfo };
-
-		std::array<VkVertexInputBindingDescription, 1> bindigsDescs = { Vertex::getBindingDescription() };
-		auto attributeDescs = Vertex::getAttributeDescriptions();
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo = Eugenix::Render::Vulkan::VertexInputStateInfo(
-			bindigsDescs, attributeDescs);
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssembly = Eugenix::Render::Vulkan::InputAssemplyInfo(
-			VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FALSE);
-
-		VkViewport viewport{};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = static_cast<float>(_swapchain.Extent().width);
-		viewport.height = static_cast<float>(_swapchain.Extent().height);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-		std::array<VkViewport, 1> viewports = { viewport };
-
-		VkRect2D scissor{};
-		scissor.offset = { 0, 0 };
-		scissor.extent = _swapchain.Extent();
-
-		std::array<VkRect2D, 1> scissors = { scissor };
-
-		VkPipelineViewportStateCreateInfo viewportState = Eugenix::Render::Vulkan::ViewportStateInfo(viewports, scissors);
-
-		VkPipelineRasterizationStateCreateInfo rasterizer = Eugenix::Render::Vulkan::RasterizationStateInfo(
-			VK_FALSE, VK_POLYGON_MODE_FILL, VK_FALSE, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-			VK_FALSE, 0.0f, 0.0f, 0.0f);
-
-		VkPipelineMultisampleStateCreateInfo multisampling = Eugenix::Render::Vulkan::MultisampleStateInfo(
-			VK_FALSE, VK_SAMPLE_COUNT_1_BIT, 1.0f, nullptr, VK_FALSE, VK_FALSE);
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-			VK_COLOR_COMPONENT_G_BIT |
-			VK_COLOR_COMPONENT_B_BIT |
-			VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachment.blendEnable = VK_FALSE;
-		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-
-		VkPipelineDepthStencilStateCreateInfo depthStencilAttachment = Eugenix::Render::Vulkan::DepthStencilStateInfo(
-			VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS, VK_FALSE, VK_FALSE);
-
-		std::array<VkPipelineColorBlendAttachmentState, 1> colorAttachments = { colorBlendAttachment };
-		VkPipelineColorBlendStateCreateInfo colorBlending = Eugenix::Render::Vulkan::ColorBlendStateInfo(
-			VK_FALSE, VK_LOGIC_OP_COPY, colorAttachments, { 0.0f, 0.0f, 0.0f, 0.0f });
-
 		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.stageFlags = _useBindless ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
 		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(glm::mat4);
+		pushConstantRange.size = _useBindless ? sizeof(DrawConstants) : sizeof(glm::mat4);
 
 		std::array<VkDescriptorSetLayout, 2> setLayouts =
 		{
 			_globalDescriptorSetLayout,
-			_materialDescriptorSetLayout
+			_useBindless ? _bindless.Layout() : _materialDescriptorSetLayout
 		};
 		std::array<VkPushConstantRange, 1> pushConstantRanges = { pushConstantRange };
 
@@ -479,23 +560,26 @@ private:
 			pushConstantRanges);
 		VERIFYVULKANRESULT(vkCreatePipelineLayout(_device.Handle(), &pipelineLayoutInfo, EUGENIX_VULKAN_ALLOCATOR, &_pipelineLayout));
 
-		VkGraphicsPipelineCreateInfo pipelineInfo = Eugenix::Render::Vulkan::PipelineInfo(shaderStages,
-			vertexInputInfo, inputAssembly, viewportState, rasterizer, multisampling, depthStencilAttachment,
-			colorBlending, nullptr, _pipelineLayout, _renderPass, 0, VK_NULL_HANDLE, -1);
-		VERIFYVULKANRESULT(vkCreateGraphicsPipelines(_device.Handle(), VK_NULL_HANDLE, 1, &pipelineInfo, EUGENIX_VULKAN_ALLOCATOR, &_graphicsPipeline));
-
-		vkDestroyShaderModule(_device.Handle(), vertShaderModule, EUGENIX_VULKAN_ALLOCATOR);
-		vkDestroyShaderModule(_device.Handle(), fragShaderModule, EUGENIX_VULKAN_ALLOCATOR);
-	}
-
-	VkShaderModule createShaderModule(const std::vector<char>& code)
-	{
-		VkShaderModule shaderModule;
-
-		VkShaderModuleCreateInfo createInfo = Eugenix::Render::Vulkan::ShaderModuleInfo(code);
-		VERIFYVULKANRESULT(vkCreateShaderModule(_device.Handle(), &createInfo, EUGENIX_VULKAN_ALLOCATOR, &shaderModule));
+		std::array<VkVertexInputBindingDescription, 1> bindigsDescs = { Vertex::getBindingDescription() };
+		auto attributeDescs = Vertex::getAttributeDescriptions();
 
-		return shaderModule;
+		_pipelines.SetVertexLayout("Vertex", bindigsDescs, attributeDescs);
+		_pipelines.SetLayout(pipelineLayoutName(), _pipelineLayout);
+		_pipelines.SetRenderPass("Main", _renderPass);
+
+		// The shaders read the camera from set 0. The bindless pair reads the world matrix and material
+		// index from DrawConstants and the material and its textures from the bindless set 1, the
+		// other one the world matrix alone and the texture from the material's set.
+		// Built on the compiler's threads, the main pass only clears until it is ready. After a
+		// swapchain recreation the request is known already and the pipeline is rebuilt on its own.
+		Eugenix::Render::Vulkan::GraphicsPipelineDesc desc;
+		desc.vertexShader = _useBindless ? BindlessVertexShader : "Shaders/Vulkan/vertex.spv";
+		desc.fragmentShader = _useBindless ? BindlessFragmentShader : "Shaders/Vulkan/fragment.spv";
+		desc.vertexLayout = "Vertex";
+		desc.layout = pipelineLayoutName();
+		desc.renderPass = "Main";
+
+		_mainPipeline = _pipelines.Request(desc);
 	}
 
 	void initRenderables()
@@ -505,31 +589,45 @@ private:
 		createVertexBuffer();
 		createIndexBuffer();
 
-		Renderable obj1;
-		obj1.modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
-		obj1.modelMatrix = glm::scale(obj1.modelMatrix, glm::vec3(0.5f));
-		obj1.modelMatrix = glm::rotate(obj1.modelMatrix, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-		obj1.modelMatrix = glm::rotate(obj1.modelMatrix, glm::radians(-90.0f), glm::vec3(0, 0, 1));
-		obj1.vertexBuffer = _vertexBuffer.buffer;
-		obj1.indexBuffer = _indexBuffer.buffer;
-		obj1.indexCount = static_cast<uint32_t>(indices.size());
-		obj1.descriptorSet = _globalDescriptorSet;
-
-		Renderable obj2;
-		obj2.modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		obj2.modelMatrix = glm::scale(obj2.modelMatrix, glm::vec3(0.5f));
-		obj2.modelMatrix = glm::rotate(obj2.modelMatrix, glm::radians(-90.0f), glm::vec3(1, 0, 0));
-		obj2.modelMatrix = glm::rotate(obj2.modelMatrix, glm::radians(-90.0f), glm::vec3(0, 0, 1));
-		obj2.vertexBuffer = _vertexBuffer.buffer;
-		obj2.indexBuffer = _indexBuffer.buffer;
-		obj2.indexCount = static_cast<uint32_t>(indices.size());
-		obj2.descriptorSet = _globalDescriptorSet;
-
-		_renderables = { obj1, obj2 };
+		// Both models hang off one root, moving it moves them together
+		const auto root = _scene.Create();
+		const glm::quat modelRotation = glm::angleAxis(glm::radians(-90.0f), glm::vec3(1, 0, 0)) * glm::angleAxis(glm::radians(-90.0f), glm::vec3(0, 0, 1));
+
+		Renderable mesh;
+		mesh.vertexBuffer = _vertexBuffer.buffer;
+		mesh.indexBuffer = _indexBuffer.buffer;
+		mesh.firstIndex = _modelLods[0].firstIndex;
+		mesh.indexCount = _modelLods[0].indexCount;
+		mesh.localBounds = _modelBounds;
+		mesh.lods = _modelLods;
+		mesh.occluder = &_modelOccluder;
+
+		for (float x : { -1.0f, 1.0f })
+		{
+			// A material each, with bindless descriptors they still draw with the same bound state
+			const glm::vec4 tint = x < 0.0f ? glm::vec4(1.0f) : glm::vec4(1.0f, 0.85f, 0.7f, 1.0f);
+			mesh.material = addMaterial(Material{ tint, _textureIndex });
+
+			const auto node = _scene.Create(root, glm::vec3(x, 0.0f, 0.0f), modelRotation, glm::vec3(0.5f));
+			_registry.Create(Eugenix::Scene::SceneNode{ node }, Eugenix::Scene::WorldTransform{}, mesh, Eugenix::Scene::LodState{});
+			_spinNodes.push_back(node);
+		}
+
+		_scene.Update();
+
+		// From here on only the simulation thread touches the scene graph, the entities get its
+		// snapshots blended to the frame's time
+		_simulation.Start([this](float stepSeconds) { simulate(stepSeconds); },
+			[this](Eugenix::Scene::SceneSnapshot& snapshot) { snapshot.Capture(_scene); });
+
+		const auto frame = _simulation.Acquire();
+		_snapshotSync.Update(frame.previous, frame.latest, frame.alpha);
 	}
 
 	void loadModel()
 	{
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::loadModel");
+
 		tinyobj::attrib_t attrib;
 		std::vector<tinyobj::shape_t> shapes;
 		std::vector<tinyobj::material_t> materials;
@@ -537,11 +635,17 @@ private:
 
 		std::unordered_map<Vertex, uint32_t> uniqueVertices{};
 
-		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, "models/viking_room.obj"))
+		const auto objFile = Eugenix::IO::File::Map("models/viking_room.obj");
+		Eugenix::IO::MemoryStream objStream{ objFile.Bytes() };
+		tinyobj::MaterialFileReader materialReader{ "models/" };
+
+		if (!objFile.IsOpen() || !tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, &objStream, &materialReader))
 		{
 			throw std::runtime_error(warning + error);
 		}
 
+		EUGENIX_PROFILE_COUNTERS_SCOPE("StartDemoApp::loadModel::Dedup");
+
 		for (const auto& shape : shapes)
 		{
 			for (const auto& index : shape.mesh.indices)
@@ -572,25 +676,22 @@ private:
 				{
 					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
 					vertices.push_back(vertex);
+					_modelPositions.push_back(vertex.pos);
+
+					_modelBounds.min = vertices.size() == 1 ? vertex.pos : glm::min(_modelBounds.min, vertex.pos);
+					_modelBounds.max = vertices.size() == 1 ? vertex.pos : glm::max(_modelBounds.max, vertex.pos);
 				}
 
 				indices.push_back(uniqueVertices[vertex]);
 			}
 		}
-	}
-
-	void createCommandBuffers()
-	{
-		std::vector<VkCommandBuffer> commandBuffers(Eugenix::Render::Vulkan::Swapchain::MaxFramesInFlight);
 
-		VkCommandBufferAllocateInfo allocInfo = Eugenix::Render::Vulkan::CommandBufferAllocateInfo(_commandPool,
-			VK_COMMAND_BUFFER_LEVEL_PRIMARY, Eugenix::Render::Vulkan::Swapchain::MaxFramesInFlight);
-		VERIFYVULKANRESULT(vkAllocateCommandBuffers(_device.Handle(), &allocInfo, commandBuffers.data()));
+		// The coarser levels go after the full mesh in the same index buffer
+		auto lods = Eugenix::Scene::BuildLods(_modelPositions, indices);
+		indices = std::move(lods.indices);
+		_modelLods = std::move(lods.levels);
 
-		for (size_t i = 0; i < Eugenix::Render::Vulkan::Swapchain::MaxFramesInFlight; ++i)
-		{
-			_frames[i].commandBuffer = commandBuffers[i];
-		}
+		_modelOccluder = { _modelPositions, std::span<const uint32_t>{ indices }.first(_modelLods[0].indexCount) };
 	}
 
 	void createSyncObject()
@@ -606,92 +707,39 @@ private:
 		}
 	}
 
-	VkCommandBuffer beginSingleTimeCommands()
-	{
-		VkCommandBuffer commandBuffer;
-
-		VkCommandBufferAllocateInfo allocInfo = Eugenix::Render::Vulkan::CommandBufferAllocateInfo(_commandPool,
-			VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
-		VERIFYVULKANRESULT(vkAllocateCommandBuffers(_device.Handle(), &allocInfo, &commandBuffer));
-
-		VkCommandBufferBeginInfo beginInfo = Eugenix::Render::Vulkan::CommandBufferBeginInfo(
-			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-		VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
-
-		return commandBuffer;
-	}
-
-	void endSingleTimeCommands(VkCommandBuffer commandBuffer)
-	{
-		VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
-
-		VkCommandBuffer commandBuffers[] = { commandBuffer };
-		VkSubmitInfo submitInfo = Eugenix::Render::Vulkan::SubmitInfo(commandBuffers);
-
-		VERIFYVULKANRESULT(vkQueueSubmit(_device.GraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
-		VERIFYVULKANRESULT(vkQueueWaitIdle(_device.GraphicsQueue()));
-
-		vkFreeCommandBuffers(_device.Handle(), _commandPool, 1, &commandBuffer);
-	}
-
 	void createVertexBuffer()
 	{
-		VkDeviceSize size = sizeof(Vertex) * vertices.size();
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::createVertexBuffer");
 
-		Eugenix::Render::Vulkan::Buffer stagingBuffer = _device.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-		void* data;
-		VERIFYVULKANRESULT(vkMapMemory(_device.Handle(), stagingBuffer.memory, 0, size, 0, &data));
-		memcpy(data, vertices.data(), static_cast<size_t>(size));
-		vkUnmapMemory(_device.Handle(), stagingBuffer.memory);
+		VkDeviceSize size = sizeof(Vertex) * vertices.size();
 
 		_vertexBuffer = _device.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		copyBuffer(stagingBuffer.buffer, _vertexBuffer.buffer, size);
-		vkDestroyBuffer(_device.Handle(), stagingBuffer.buffer, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), stagingBuffer.memory, EUGENIX_VULKAN_ALLOCATOR);
+		_uploads.UploadBuffer(_vertexBuffer, 0, vertices.data(), size,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
 	}
 
 	void createIndexBuffer()
 	{
-		VkDeviceSize size = sizeof(uint32_t) * indices.size();
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::createIndexBuffer");
 
-		Eugenix::Render::Vulkan::Buffer stagingBuffer = _device.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-		void* data;
-		VERIFYVULKANRESULT(vkMapMemory(_device.Handle(), stagingBuffer.memory, 0, size, 0, &data));
-		memcpy(data, indices.data(), static_cast<size_t>(size));
-		vkUnmapMemory(_device.Handle(), stagingBuffer.memory);
+		VkDeviceSize size = sizeof(uint32_t) * indices.size();
 
 		_indexBuffer = _device.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		copyBuffer(stagingBuffer.buffer, _indexBuffer.buffer, size);
-		vkDestroyBuffer(_device.Handle(), stagingBuffer.buffer, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), stagingBuffer.memory, EUGENIX_VULKAN_ALLOCATOR);
+		_uploads.UploadBuffer(_indexBuffer, 0, indices.data(), size,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
 	}
 
 	void createUniformBuffers()
 	{
-		// Camera UBO
-		VkDeviceSize size = sizeof(UniformBufferObject);
-		_uniformBuffer = _device.CreateBuffer(size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	}
-
-	void copyBuffer(VkBuffer& srcBuffer, VkBuffer& dstBuffer, VkDeviceSize size)
-	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-		VkBufferCopy copyRegion{};
-		copyRegion.srcOffset = 0;
-		copyRegion.dstOffset = 0;
-		copyRegion.size = size;
-		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-		endSingleTimeCommands(commandBuffer);
+		// Camera UBO, a region per frame in flight
+		if (!_frameUniforms.Create(_adapter, _device, Eugenix::Render::Vulkan::Swapchain::MaxFramesInFlight))
+		{
+			throw std::runtime_error("Failed to create the frame uniform buffer!\n");
+		}
 	}
 
 	void initResources()
@@ -704,6 +752,8 @@ private:
 
 	void createTextureImage()
 	{
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::createTextureImage");
+
 		int width, height, channels;
 		stbi_uc* pixels = stbi_load("models/viking_room.png", &width, &height, &channels, STBI_rgb_alpha);
 
@@ -714,100 +764,22 @@ private:
 
 		VkDeviceSize imageSize = width * height * 4;
 
-		Eugenix::Render::Vulkan::Buffer stagingBuffer;
-		stagingBuffer = _device.CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-		void* data;
-		VERIFYVULKANRESULT(vkMapMemory(_device.Handle(), stagingBuffer.memory, 0, imageSize, 0, &data));
-		memcpy(data, pixels, static_cast<uint32_t>(imageSize));
-		vkUnmapMemory(_device.Handle(), stagingBuffer.memory);
-		stbi_image_free(pixels);
-
-		createImage(width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _textureImage, _textureImageMemory);
-
-		transitionImageLayout(_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		copyBufferToImage(stagingBuffer.buffer, _textureImage, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-		transitionImageLayout(_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		_texture = createImage(width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		vkDestroyBuffer(_device.Handle(), stagingBuffer.buffer, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), stagingBuffer.memory, EUGENIX_VULKAN_ALLOCATOR);
-	}
-
-	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout/*, uint32_t mipLevels*/)
-	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-		VkImageMemoryBarrier barrier = Eugenix::Render::Vulkan::ImageMemoryBarrier(oldLayout, newLayout,
-			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1);
-
-		VkPipelineStageFlags sourceStage;
-		VkPipelineStageFlags destinationStage;
-
-		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-		{
-			barrier.srcAccessMask = 0;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		}
-		else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-		{
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		}
-		else
-		{
-			throw std::invalid_argument("unsupported layout transition!\n");
-		}
-
-		vkCmdPipelineBarrier(
-			commandBuffer,
-			sourceStage, destinationStage,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier
-		);
-
-		endSingleTimeCommands(commandBuffer);
-	}
-
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
-	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		_uploads.UploadImage(_texture, { static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 }, VK_IMAGE_ASPECT_COLOR_BIT,
+			pixels, imageSize, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
 
-		VkBufferImageCopy region{};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
-
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = { width, height, 1 };
-
-		vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-		endSingleTimeCommands(commandBuffer);
+		stbi_image_free(pixels);
 	}
 
 	void createTextureImageView()
 	{
-		_textureImageView = _device.CreateImageView(_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+		_texture.view = _device.CreateImageView(_texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
 	}
 
-	void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
-		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+	Eugenix::Render::Vulkan::Image createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
+		VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
 	{
 		VkImageCreateInfo imageInfo{};
 		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -823,17 +795,8 @@ private:
 		imageInfo.usage = usage;
 		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-		VERIFYVULKANRESULT(vkCreateImage(_device.Handle(), &imageInfo, nullptr, &image));
-
-		VkMemoryRequirements memRequirements;
-		vkGetImageMemoryRequirements(_device.Handle(), image, &memRequirements);
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = _adapter.FindMemoryType(memRequirements.memoryTypeBits, properties);
-		VERIFYVULKANRESULT(vkAllocateMemory(_device.Handle(), &allocInfo, EUGENIX_VULKAN_ALLOCATOR, &imageMemory));
 
-		VERIFYVULKANRESULT(vkBindImageMemory(_device.Handle(), image, imageMemory, 0));
+		return _device.CreateImage(imageInfo, properties);
 	}
 
 	void createTextureSampler()
@@ -863,8 +826,8 @@ private:
 	{
 		VkFormat depthFormat = findDepthFormat();
 
-		createImage(_swapchain.Extent().width, _swapchain.Extent().height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _depthImage, _depthImageMemory);
-		_depthImageView = _device.CreateImageView(_depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+		_depth = createImage(_swapchain.Extent().width, _swapchain.Extent().height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		_depth.view = _device.CreateImageView(_depth.image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
 	}
 
 	VkFormat findDepthFormat()
@@ -899,11 +862,18 @@ private:
 
 	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 	{
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::recordCommandBuffer");
+
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
 		VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
 
+		_uploads.RecordAcquires(commandBuffer);
+
+		_gpuProfiler.BeginFrame(commandBuffer, static_cast<uint32_t>(_currentFrame));
+		Eugenix::FrameStats::SetGpuTime(_gpuProfiler.LastFrameMilliseconds());
+
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		renderPassInfo.renderPass = _renderPass;
@@ -916,46 +886,203 @@ private:
 		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderPassInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipeline);
+		{
+			EUGENIX_GPU_PROFILE_SCOPE(_gpuProfiler, commandBuffer, "Main Pass");
+
+			vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+			// Until the initial uploads have been acquired and the pipeline is built the pass only clears,
+			// as it does when the camera constants did not fit this frame's uniform region
+			const VkPipeline pipeline = _pipelines.Get(_mainPipeline);
+			const bool cameraReady = _cameraOffset != Eugenix::Render::Vulkan::FrameUniformAllocator::InvalidOffset;
+			if (pipeline && cameraReady && _uploads.Ready(_uploadsReady) && !_drawVisible.empty())
+			{
+				recordDraws(pipeline, _swapchainFramebuffers[imageIndex]);
+				vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(_secondaries.size()), _secondaries.data());
+			}
+
+			vkCmdEndRenderPass(commandBuffer);
+		}
+
+		VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
+	}
+
+	// The visible draws split into contiguous ranges, each recorded into a secondary command buffer
+	// of its own on a job thread. Few draws stay on fewer threads, a secondary has a fixed cost.
+	void recordDraws(VkPipeline pipeline, VkFramebuffer framebuffer)
+	{
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::recordDraws");
+
+		constexpr uint32_t MinDrawsPerSecondary = 64;
+
+		const uint32_t drawCount = static_cast<uint32_t>(_drawVisible.size());
+		const uint32_t secondaryCount = std::clamp((drawCount + MinDrawsPerSecondary - 1) / MinDrawsPerSecondary, 1u, Eugenix::Jobs::ThreadCount());
+		const uint32_t drawsPerSecondary = (drawCount + secondaryCount - 1) / secondaryCount;
+
+		_secondaries.resize(secondaryCount);
+
+		VkCommandBufferInheritanceInfo inheritance{};
+		inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritance.renderPass = _renderPass;
+		inheritance.subpass = 0;
+		inheritance.framebuffer = framebuffer;
+
+		VkViewport viewport{};
+		viewport.width = static_cast<float>(_swapchain.Extent().width);
+		viewport.height = static_cast<float>(_swapchain.Extent().height);
+		viewport.maxDepth = 1.0f;
+
+		VkRect2D scissor{ { 0, 0 }, _swapchain.Extent() };
 
-		VkDeviceSize offsets[] = { 0 };
+		// Bindless materials are indexed per draw, so one bind covers every draw. Otherwise set 1
+		// changes with the material.
+		const std::array<VkDescriptorSet, 2> descriptorSets = { _globalDescriptorSet, _bindless.Set() };
+		const uint32_t boundSets = _useBindless ? 2 : 1;
 
-		for (const auto& renderable : _renderables)
+		Eugenix::Jobs::ParallelFor(0, secondaryCount, 1, [&](uint32_t first, uint32_t last)
 		{
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &renderable.vertexBuffer, offsets);
-			vkCmdBindIndexBuffer(commandBuffer, renderable.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			for (uint32_t secondary = first; secondary < last; ++secondary)
+			{
+				// Nothing is inherited but the pass, so the state is bound once per buffer
+				const VkCommandBuffer commandBuffer = _commandPools.BeginSecondary(inheritance);
 
-			vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &renderable.modelMatrix);
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+				vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_globalDescriptorSet, 0, nullptr);
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 1, 1, &_materialDescriptorSet, 0, nullptr);
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0,
+					boundSets, descriptorSets.data(), 1, &_cameraOffset);
 
-			vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(renderable.indexCount), 1, 0, 0, 0);
+				VkDeviceSize offsets[] = { 0 };
+				uint32_t boundMaterial = Eugenix::Render::Vulkan::BindlessDescriptors::InvalidIndex;
+
+				const uint32_t begin = secondary * drawsPerSecondary;
+				const uint32_t end = std::min(begin + drawsPerSecondary, drawCount);
+				for (uint32_t draw = begin; draw < end; ++draw)
+				{
+					const uint32_t i = _drawVisible[draw];
+					const Renderable& mesh = _drawMeshes[i];
+
+					vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.vertexBuffer, offsets);
+					vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+					if (_useBindless)
+					{
+						const DrawConstants constants{ _drawWorlds[i], mesh.material };
+						vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(DrawConstants), &constants);
+					}
+					else
+					{
+						if (mesh.material != boundMaterial)
+						{
+							vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 1, 1,
+								&_materialDescriptorSets[mesh.material], 0, nullptr);
+							boundMaterial = mesh.material;
+						}
+
+						vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &_drawWorlds[i]);
+					}
+
+					vkCmdDrawIndexed(commandBuffer, mesh.indexCount, 1, mesh.firstIndex, 0, 0);
+				}
+
+				VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
+				_secondaries[secondary] = commandBuffer;
+			}
+		});
+	}
+
+	// Simulation thread, once per fixed step
+	void simulate(float stepSeconds)
+	{
+		const glm::quat spin = glm::angleAxis(stepSeconds, glm::vec3(0, 0, 1));
+		for (const auto node : _spinNodes)
+		{
+			_scene.Rotate(node, spin);
 		}
 
-		vkCmdEndRenderPass(commandBuffer);
+		// Only the spinning nodes are recomposed
+		_scene.Update();
+	}
 
-		VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
+	glm::mat4 projectionMatrix() const
+	{
+		glm::mat4 proj = glm::perspective(glm::radians(45.0f), float(_swapchain.Extent().width) / float(_swapchain.Extent().height), 0.1f, 100.0f);
+		proj[1][1] *= -1;
+		return proj;
 	}
 
-	void updatePerFrameData(float deltaTime)
+	// Linear walk over the packed world matrices and meshes of each chunk into the draw list at
+	// the LOD their screen-space error allows, then the frustum test, the in-view occluders are
+	// rasterized and the occlusion test over the frustum survivors leaves the indices
+	// recordCommandBuffer draws
+	void cullRenderables()
 	{
-		_renderables[0].modelMatrix = glm::rotate(_renderables[0].modelMatrix, deltaTime, glm::vec3(0, 0, 1));
-		_renderables[1].modelMatrix = glm::rotate(_renderables[1].modelMatrix, deltaTime, glm::vec3(0, 0, 1));
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::cullRenderables");
+
+		_drawWorlds.clear();
+		_drawMeshes.clear();
+		_drawBounds.Clear();
+
+		const auto lodView = Eugenix::Scene::LodView::FromPerspective(_camera.position, glm::radians(45.0f),
+			static_cast<float>(_swapchain.Extent().height));
+
+		_drawQuery.ForEachChunk([this, &lodView](uint32_t count, const Eugenix::Scene::Entity*, const Eugenix::Scene::WorldTransform* worlds,
+			const Renderable* meshes, Eugenix::Scene::LodState* lods)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const auto bounds = Eugenix::Scene::TransformAabb(meshes[i].localBounds, worlds[i].matrix);
+
+					Renderable& mesh = _drawMeshes.emplace_back(meshes[i]);
+					if (!mesh.lods.empty())
+					{
+						lods[i].level = Eugenix::Scene::SelectLod(mesh.lods, lodView, bounds, Eugenix::Scene::MaxScale(worlds[i].matrix), lods[i].level);
+						mesh.firstIndex = mesh.lods[lods[i].level].firstIndex;
+						mesh.indexCount = mesh.lods[lods[i].level].indexCount;
+					}
+
+					_drawWorlds.push_back(worlds[i].matrix);
+					_drawBounds.Add(bounds);
+				}
+			});
+
+		const glm::mat4 viewProjection = projectionMatrix() * _camera.getViewMatrix();
+		const auto frustum = Eugenix::Scene::Frustum::FromViewProjection(viewProjection, true);
+		_culler.Cull(frustum, _drawBounds);
+
+		Eugenix::FrameStats::AddCulling(_culler.TestedCount(), _culler.VisibleCount());
+
+		_occlusion.BeginFrame(viewProjection, true);
+		for (uint32_t i : _culler.Visible())
+		{
+			if (_drawMeshes[i].occluder)
+				_occlusion.AddOccluder(*_drawMeshes[i].occluder, _drawWorlds[i]);
+		}
+		_occlusion.Rasterize();
+
+		_drawVisible.clear();
+		const uint32_t visible = _occlusion.Cull(_drawBounds, _culler.Visible(), _drawVisible);
+
+		Eugenix::FrameStats::AddOccluded(_culler.VisibleCount() - visible);
+
+		uint64_t triangles = 0;
+		for (uint32_t i : _drawVisible)
+		{
+			triangles += _drawMeshes[i].indexCount / 3;
+		}
+		Eugenix::FrameStats::AddTriangles(triangles);
 	}
 
 	void updateUniformBuffer(uint32_t currentImage)
 	{
+		EUGENIX_PROFILE_SCOPE("StartDemoApp::updateUniformBuffer");
+
 		UniformBufferObject ubo{};
 		ubo.view = _camera.getViewMatrix();
-		ubo.proj = glm::perspective(glm::radians(45.0f), float(_swapchain.Extent().width) / float(_swapchain.Extent().height), 0.1f, 100.0f);
-		ubo.proj[1][1] *= -1;
+		ubo.proj = projectionMatrix();
 
-		void* data;
-		VERIFYVULKANRESULT(vkMapMemory(_device.Handle(), _uniformBuffer.memory, 0, sizeof(ubo), 0, &data));
-		memcpy(data, &ubo, sizeof(ubo));
-		vkUnmapMemory(_device.Handle(), _uniformBuffer.memory);
+		_cameraOffset = _frameUniforms.Push(ubo);
 	}
 
 	void cleanupSwapchain()
@@ -967,9 +1094,7 @@ private:
 			vkDestroyFence(_device.Handle(), frame.inFlight, EUGENIX_VULKAN_ALLOCATOR);
 		}
 
-		vkDestroyImageView(_device.Handle(), _depthImageView, EUGENIX_VULKAN_ALLOCATOR);
-		vkDestroyImage(_device.Handle(), _depthImage, EUGENIX_VULKAN_ALLOCATOR);
-		vkFreeMemory(_device.Handle(), _depthImageMemory, EUGENIX_VULKAN_ALLOCATOR);
+		_device.DestroyImage(_depth);
 
 		vkDestroyDescriptorPool(_device.Handle(), _descriptorPool, EUGENIX_VULKAN_ALLOCATOR);
 
@@ -978,7 +1103,10 @@ private:
 			vkDestroyFramebuffer(_device.Handle(), framebuffer, EUGENIX_VULKAN_ALLOCATOR);
 		}
 
-		vkDestroyPipeline(_device.Handle(), _graphicsPipeline, EUGENIX_VULKAN_ALLOCATOR);
+		// The compiler drops the pipelines built with them, they are rebuilt once the new ones are set
+		_pipelines.SetRenderPass("Main", VK_NULL_HANDLE);
+		_pipelines.SetLayout(pipelineLayoutName(), VK_NULL_HANDLE);
+
 		vkDestroyPipelineLayout(_device.Handle(), _pipelineLayout, EUGENIX_VULKAN_ALLOCATOR);
 		vkDestroyRenderPass(_device.Handle(), _renderPass, EUGENIX_VULKAN_ALLOCATOR);
 
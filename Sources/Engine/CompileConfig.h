@@ -1,8 +1,20 @@
 #pragma once
 
-#include "Core/Log.h"
+#include "Core/Platform.h"
 
 #define EUGENIX_LOG_LEVEL LogLevel::All
+// Record raw arguments and format them on the log sink thread instead of the caller
+#define EUGENIX_LOG_DEFERRED_FORMATTING 0
 
 #define EUGENIX_PROFILING_ENABLED 1
+// Linux only: perf_event_open hardware counters for EUGENIX_PROFILE_COUNTERS_SCOPE zones, on unless
+// the build defines it
+#ifndef EUGENIX_PERF_COUNTERS_ENABLED
+#	define EUGENIX_PERF_COUNTERS_ENABLED 1
+#endif
+// Count global heap allocations, reported per frame by Memory::LastFrameStats(). Replaces the global
+// operator new/delete, so it is on in debug builds only unless the build defines it.
+#ifndef EUGENIX_MEMORY_TRACKING
+#	define EUGENIX_MEMORY_TRACKING EUGENIX_DEBUG
+#endif
 #define EUGENIX_DEBUG_UI_ENABLED 1
\ No newline at end of file
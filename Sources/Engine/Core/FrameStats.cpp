@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <span>
+#include <vector>
+
+#include "FrameStats.h"
+#include "Log.h"
+
+namespace
+{
+	using namespace Eugenix;
+	using Clock = std::chrono::steady_clock;
+
+	// Weight of the newest frame in the running average hitches are measured against (~32 frames)
+	constexpr double AverageWeight = 1.0 / 32.0;
+
+	struct StatsState
+	{
+		bool started{ false };
+		Clock::time_point frameStart{};
+
+		FrameStats::Frame current{};
+		FrameStats::Frame last{};
+
+		std::array<FrameStats::Frame, FrameStats::WindowSize> window{};
+		std::array<float, FrameStats::WindowSize> cpuHistory{};
+		uint32_t windowCount{ 0 };
+		uint32_t windowHead{ 0 };
+
+		double averageMs{ 0.0 };
+		uint64_t frameCount{ 0 };
+		uint64_t hitchCount{ 0 };
+
+		// For the CSV dump and benchmark reports
+		std::array<FrameStats::Frame, FrameStats::HistorySize> history{};
+		static_assert(sizeof(history) <= (4u << 20), "Frame history is meant to stay within 4 MB");
+		uint32_t historyCount{ 0 };
+		uint32_t historyHead{ 0 };
+	};
+
+	StatsState& state()
+	{
+		static StatsState instance;
+		return instance;
+	}
+
+	void push(StatsState& stats, const FrameStats::Frame& frame)
+	{
+		stats.window[stats.windowHead] = frame;
+		stats.cpuHistory[stats.windowHead] = static_cast<float>(frame.cpuMs);
+		stats.windowHead = (stats.windowHead + 1) % FrameStats::WindowSize;
+		stats.windowCount = std::min(stats.windowCount + 1, FrameStats::WindowSize);
+
+		stats.history[stats.historyHead] = frame;
+		stats.historyHead = (stats.historyHead + 1) % FrameStats::HistorySize;
+		stats.historyCount = std::min(stats.historyCount + 1, FrameStats::HistorySize);
+		++stats.frameCount;
+
+		stats.last = frame;
+	}
+
+	// Nearest-rank percentiles, values is reordered
+	FrameStats::Percentiles percentiles(std::vector<double>& values)
+	{
+		if (values.empty())
+			return {};
+
+		auto rank = [&values](double p)
+			{
+				const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * static_cast<double>(values.size())));
+				std::nth_element(values.begin(), values.begin() + index, values.end());
+				return values[index];
+			};
+
+		FrameStats::Percentiles result{};
+		result.p50 = rank(0.50);
+		result.p95 = rank(0.95);
+		result.p99 = rank(0.99);
+		result.max = *std::max_element(values.begin(), values.end());
+		return result;
+	}
+
+	FrameStats::Summary summarize(const StatsState& stats, std::span<const FrameStats::Frame> frames)
+	{
+		FrameStats::Summary summary{};
+		summary.sampleCount = static_cast<uint32_t>(frames.size());
+		summary.frameCount = stats.frameCount;
+		summary.hitchCount = stats.hitchCount;
+
+		if (frames.empty())
+			return summary;
+
+		thread_local std::vector<double> values;
+		values.resize(frames.size());
+
+		double total = 0.0;
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			values[i] = frames[i].cpuMs;
+			total += values[i];
+		}
+		summary.averageMs = total / static_cast<double>(frames.size());
+		summary.cpu = percentiles(values);
+
+		for (size_t i = 0; i < frames.size(); ++i)
+			values[i] = frames[i].gpuMs;
+		summary.gpu = percentiles(values);
+
+		for (size_t i = 0; i < frames.size(); ++i)
+			values[i] = frames[i].fenceWaitMs;
+		summary.fenceWait = percentiles(values);
+
+		return summary;
+	}
+}
+
+namespace Eugenix::FrameStats
+{
+	void BeginFrame()
+	{
+		auto& stats = state();
+		const auto now = Clock::now();
+
+		if (stats.started)
+		{
+			Frame frame = stats.current;
+			frame.cpuMs = std::chrono::duration<double, std::milli>(now - stats.frameStart).count();
+
+			// The first frames set the average instead of counting as hitches against zero
+			if (stats.averageMs > 0.0)
+			{
+				frame.hitch = frame.cpuMs > stats.averageMs * HitchFactor;
+				stats.averageMs += (frame.cpuMs - stats.averageMs) * AverageWeight;
+			}
+			else
+			{
+				stats.averageMs = frame.cpuMs;
+			}
+
+			if (frame.hitch)
+				++stats.hitchCount;
+
+			push(stats, frame);
+		}
+
+		stats.started = true;
+		stats.frameStart = now;
+
+		// GPU time carries over until a newer frame resolves
+		const double gpuMs = stats.current.gpuMs;
+		stats.current = Frame{};
+		stats.current.index = stats.frameCount;
+		stats.current.gpuMs = gpuMs;
+	}
+
+	void AddFenceWait(double milliseconds)
+	{
+		state().current.fenceWaitMs += milliseconds;
+	}
+
+	void SetGpuTime(double milliseconds)
+	{
+		state().current.gpuMs = milliseconds;
+	}
+
+	void AddCulling(uint32_t tested, uint32_t visible)
+	{
+		auto& current = state().current;
+		current.objectsTested += tested;
+		current.objectsVisible += visible;
+	}
+
+	void AddOccluded(uint32_t occluded)
+	{
+		state().current.objectsOccluded += occluded;
+	}
+
+	void AddTriangles(uint64_t triangles)
+	{
+		state().current.triangles += triangles;
+	}
+
+	Summary Compute()
+	{
+		const auto& stats = state();
+		return summarize(stats, std::span{ stats.window.data(), stats.windowCount });
+	}
+
+	Summary ComputeHistory()
+	{
+		const auto& stats = state();
+		return summarize(stats, std::span{ stats.history.data(), stats.historyCount });
+	}
+
+	void Reset()
+	{
+		auto& stats = state();
+
+		// Keeps the running average and the frame in progress, only the samples go
+		stats.windowCount = 0;
+		stats.windowHead = 0;
+		stats.frameCount = 0;
+		stats.hitchCount = 0;
+		stats.historyCount = 0;
+		stats.historyHead = 0;
+		stats.current.index = 0;
+	}
+
+	const Frame& LastFrame()
+	{
+		return state().last;
+	}
+
+	History CpuHistory()
+	{
+		const auto& stats = state();
+
+		// Until the ring wraps the oldest frame is at 0
+		const int offset = stats.windowCount == WindowSize ? static_cast<int>(stats.windowHead) : 0;
+		return { stats.cpuHistory.data(), static_cast<int>(stats.windowCount), offset };
+	}
+
+	bool SaveCsv(const std::filesystem::path& path)
+	{
+		const auto& stats = state();
+
+		std::ofstream file(path);
+		if (!file)
+		{
+			LogError("FrameStats: failed to open {}", path.string());
+			return false;
+		}
+
+		file << "frame,cpu_ms,gpu_ms,fence_wait_ms,objects_tested,objects_visible,objects_occluded,triangles,hitch\n";
+		// Until the ring wraps the oldest frame is at 0
+		const uint32_t oldest = stats.historyCount == HistorySize ? stats.historyHead : 0;
+		for (uint32_t i = 0; i < stats.historyCount; ++i)
+		{
+			const Frame& frame = stats.history[(oldest + i) % HistorySize];
+			file << frame.index << ',' << frame.cpuMs << ',' << frame.gpuMs << ','
+				<< frame.fenceWaitMs << ',' << frame.objectsTested << ',' << frame.objectsVisible << ',' << frame.objectsOccluded << ',' << frame.triangles << ',' << (frame.hitch ? 1 : 0) << '\n';
+		}
+
+		const Summary summary = Compute();
+		LogInfo("FrameStats: {} of {} frames saved to {}. CPU p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms, {} hitches",
+			stats.historyCount, summary.frameCount, path.string(), summary.cpu.p50, summary.cpu.p99, summary.cpu.max, summary.hitchCount);
+		return true;
+	}
+} // namespace Eugenix::FrameStats
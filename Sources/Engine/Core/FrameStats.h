@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace Eugenix::FrameStats
+{
+	// Frames the percentiles are computed over
+	constexpr uint32_t WindowSize = 1024;
+
+	// Frames kept for ComputeHistory() and SaveCsv(), ~7.5 minutes at 144 Hz. Older ones are overwritten.
+	constexpr uint32_t HistorySize = 65536;
+
+	// A frame is a hitch when its CPU time exceeds this multiple of the recent average
+	constexpr double HitchFactor = 2.0;
+
+	struct Frame
+	{
+		uint64_t index;
+		double cpuMs;		// BeginFrame() to the next BeginFrame()
+		double gpuMs;		// Latest resolved GPU frame, a few frames behind
+		double fenceWaitMs;	// Time blocked on the GPU (fences, swap)
+		uint32_t objectsTested;	// Frustum culling, summed over the frame's cull passes
+		uint32_t objectsVisible;
+		uint32_t objectsOccluded;	// Frustum-visible objects the occlusion test removed
+		uint64_t triangles;		// Submitted for drawing, at the LOD each object was drawn with
+		bool hitch;
+	};
+
+	struct Percentiles
+	{
+		double p50;
+		double p95;
+		double p99;
+		double max;
+	};
+
+	struct Summary
+	{
+		Percentiles cpu;
+		Percentiles gpu;
+		Percentiles fenceWait;
+		double averageMs;
+		uint32_t sampleCount;	// Frames the percentiles cover
+		uint64_t frameCount;	// Frames since startup or Reset()
+		uint64_t hitchCount;	// Hitches since startup or Reset()
+	};
+
+	// Closes the previous frame and starts timing the next one. Main thread, once per frame.
+	void BeginFrame();
+
+	// Accumulate into the running frame
+	void AddFenceWait(double milliseconds);
+	void SetGpuTime(double milliseconds);
+	void AddCulling(uint32_t tested, uint32_t visible);
+	void AddOccluded(uint32_t occluded);
+	void AddTriangles(uint64_t triangles);
+
+	// Percentiles over the last WindowSize frames
+	Summary Compute();
+
+	// Percentiles over the last HistorySize frames since startup or Reset(), for benchmark reports
+	Summary ComputeHistory();
+
+	// Drops all frames, e.g. after a warm-up
+	void Reset();
+
+	const Frame& LastFrame();
+
+	// CPU times of the window in ring order, for plotting: values[(offset + i) % count] is oldest first
+	struct History
+	{
+		const float* values;
+		int count;
+		int offset;
+	};
+	History CpuHistory();
+
+	// The last HistorySize frames since startup or Reset(), oldest first, one line each
+	bool SaveCsv(const std::filesystem::path& path);
+} // namespace Eugenix::FrameStats
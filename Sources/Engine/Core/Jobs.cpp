@@ -0,0 +1,531 @@
+#include <array>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Log.h"
+#include "Profiler.h"
+#include "Jobs.h"
+
+namespace Eugenix::Jobs
+{
+	struct Job
+	{
+		std::function<void()> fn;
+		Counter* counter{ nullptr };
+		Job* next{ nullptr };
+		std::atomic<bool> busy{ false };
+		bool pooled{ true };
+	};
+
+	namespace
+	{
+		constexpr uint32_t QueueCapacity = 4096;
+		constexpr uint32_t JobPoolSize = 4096;
+		constexpr uint32_t SpinsBeforeSleep = 64;
+
+		// Chase-Lev deque: the owner pushes/pops at the bottom, thieves take from the top
+		class WorkStealingQueue final
+		{
+		public:
+			bool Push(Job* job)
+			{
+				const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+				const int64_t top = _top.load(std::memory_order_acquire);
+				if (bottom - top >= static_cast<int64_t>(QueueCapacity))
+					return false;
+
+				_jobs[bottom & (QueueCapacity - 1)].store(job, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return true;
+			}
+
+			Job* Pop()
+			{
+				const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+				_bottom.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t top = _top.load(std::memory_order_relaxed);
+
+				if (top > bottom)
+				{
+					_bottom.store(bottom + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				Job* job = _jobs[bottom & (QueueCapacity - 1)].load(std::memory_order_relaxed);
+				if (top == bottom)
+				{
+					// Last element, race against the thieves for it
+					if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						job = nullptr;
+					_bottom.store(bottom + 1, std::memory_order_relaxed);
+				}
+				return job;
+			}
+
+			Job* Steal()
+			{
+				int64_t top = _top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+				if (top >= bottom)
+					return nullptr;
+
+				Job* job = _jobs[top & (QueueCapacity - 1)].load(std::memory_order_relaxed);
+				if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+				return job;
+			}
+
+		private:
+			alignas(64) std::atomic<int64_t> _top{ 0 };
+			alignas(64) std::atomic<int64_t> _bottom{ 0 };
+			std::array<std::atomic<Job*>, QueueCapacity> _jobs{};
+		};
+
+		// Jobs are recycled round-robin per submitting thread, no allocation per Run()
+		struct JobPool
+		{
+			Job* Allocate()
+			{
+				Job* job = &jobs[next++ & (JobPoolSize - 1)];
+				if (job->busy.load(std::memory_order_acquire))
+					return nullptr;
+
+				job->busy.store(true, std::memory_order_relaxed);
+				return job;
+			}
+
+			std::unique_ptr<Job[]> jobs{ std::make_unique<Job[]>(JobPoolSize) };
+			uint32_t next{ 0 };
+		};
+
+		thread_local int32_t threadIndex = -1; // 0 - main thread, 1..N - workers
+		thread_local JobPool jobPool;
+	}
+
+	struct Scheduler
+	{
+		std::vector<std::unique_ptr<WorkStealingQueue>> queues; // one per thread, [0] is the main thread
+		std::vector<std::thread> workers;
+
+		// Submissions from threads that don't belong to the scheduler (e.g. IO completions)
+		std::mutex externalMutex;
+		std::deque<Job*> external;
+		std::atomic<uint32_t> externalCount{ 0 };
+
+		struct MainThreadJob
+		{
+			std::function<void()> fn;
+			Counter* counter;
+		};
+
+		std::mutex mainMutex;
+		std::deque<MainThreadJob> mainThreadJobs;
+
+		std::mutex sleepMutex;
+		std::condition_variable sleepCv;
+		std::atomic<uint32_t> sleeping{ 0 };
+
+		std::atomic<bool> stop{ false };
+
+		static void Execute(Job* job)
+		{
+			{
+				EUGENIX_PROFILE_SCOPE("Job");
+				job->fn();
+			}
+			job->fn = nullptr;
+
+			Counter* counter = job->counter;
+			if (job->pooled)
+			{
+				job->counter = nullptr;
+				job->next = nullptr;
+				job->busy.store(false, std::memory_order_release);
+			}
+			else
+			{
+				delete job;
+			}
+
+			if (counter)
+				counter->release();
+		}
+
+		static void Attach(Counter* counter)
+		{
+			if (counter)
+				counter->add(1);
+		}
+
+		// Used before Initialize() and when the job pool of the calling thread is exhausted
+		static void RunInline(std::function<void()>& job, Counter* counter)
+		{
+			job();
+			if (counter)
+				counter->release();
+		}
+
+		static Job* AllocateJob()
+		{
+			if (threadIndex >= 0)
+				return jobPool.Allocate();
+
+			// Foreign threads may exit before their jobs run, their thread_local pool can't be used
+			auto* job = new Job{};
+			job->pooled = false;
+			return job;
+		}
+
+		static bool Chain(Counter& dependency, Job* job)
+		{
+			return dependency.addContinuation(job);
+		}
+
+		void Wake()
+		{
+			if (sleeping.load(std::memory_order_acquire) > 0)
+				sleepCv.notify_one();
+		}
+
+		void Enqueue(Job* job)
+		{
+			if (threadIndex >= 0 && queues[threadIndex]->Push(job))
+			{
+				Wake();
+				return;
+			}
+
+			if (threadIndex < 0)
+			{
+				{
+					std::lock_guard lock(externalMutex);
+					external.push_back(job);
+				}
+				externalCount.fetch_add(1, std::memory_order_release);
+				Wake();
+				return;
+			}
+
+			// Own deque is full, don't block the producer
+			Execute(job);
+		}
+
+		Job* TryGetJob()
+		{
+			if (threadIndex >= 0)
+			{
+				if (Job* job = queues[threadIndex]->Pop())
+					return job;
+			}
+
+			if (externalCount.load(std::memory_order_acquire) > 0)
+			{
+				std::lock_guard lock(externalMutex);
+				if (!external.empty())
+				{
+					Job* job = external.front();
+					external.pop_front();
+					externalCount.fetch_sub(1, std::memory_order_relaxed);
+					return job;
+				}
+			}
+
+			thread_local std::minstd_rand random{ std::random_device{}() };
+
+			const auto count = static_cast<uint32_t>(queues.size());
+			const uint32_t start = random() % count;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const uint32_t victim = (start + i) % count;
+				if (static_cast<int32_t>(victim) == threadIndex)
+					continue;
+
+				if (Job* job = queues[victim]->Steal())
+					return job;
+			}
+
+			return nullptr;
+		}
+
+		bool PumpMainThreadJobs()
+		{
+			bool executed = false;
+			while (true)
+			{
+				MainThreadJob job;
+				{
+					std::lock_guard lock(mainMutex);
+					if (mainThreadJobs.empty())
+						break;
+
+					job = std::move(mainThreadJobs.front());
+					mainThreadJobs.pop_front();
+				}
+
+				job.fn();
+				if (job.counter)
+					job.counter->release();
+				executed = true;
+			}
+			return executed;
+		}
+
+		void WorkerLoop(int32_t index)
+		{
+			threadIndex = index;
+			EUGENIX_PROFILE_THREAD("Job Worker " + std::to_string(index));
+
+			uint32_t idleSpins = 0;
+			while (!stop.load(std::memory_order_acquire))
+			{
+				if (Job* job = TryGetJob())
+				{
+					Execute(job);
+					idleSpins = 0;
+					continue;
+				}
+
+				if (++idleSpins < SpinsBeforeSleep)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				// Bounded sleep: a missed wake-up costs at most a millisecond, never a deadlock
+				std::unique_lock lock(sleepMutex);
+				sleeping.fetch_add(1, std::memory_order_acq_rel);
+				sleepCv.wait_for(lock, std::chrono::milliseconds(1));
+				sleeping.fetch_sub(1, std::memory_order_acq_rel);
+				idleSpins = 0;
+			}
+
+			threadIndex = -1;
+		}
+	};
+
+	namespace
+	{
+		std::unique_ptr<Scheduler> scheduler;
+	}
+
+	Counter::~Counter()
+	{
+		assert(IsDone() && "Counter destroyed while jobs are still attached to it");
+	}
+
+	void Counter::add(int32_t count)
+	{
+		_value.fetch_add(count, std::memory_order_acq_rel);
+	}
+
+	void Counter::release()
+	{
+		// The decrement and the continuation swap happen under the lock and clearing it is the last
+		// access to the counter. IsDone() stays false until then, so a waiter cannot destroy the
+		// counter (ParallelFor keeps it on its stack) while this worker still touches it.
+		while (_lock.test_and_set(std::memory_order_acquire)) { }
+
+		Job* ready = nullptr;
+		if (_value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			ready = _continuations;
+			_continuations = nullptr;
+		}
+
+		_lock.clear(std::memory_order_release);
+
+		while (ready)
+		{
+			Job* next = ready->next;
+			ready->next = nullptr;
+			scheduler->Enqueue(ready);
+			ready = next;
+		}
+	}
+
+	bool Counter::addContinuation(Job* job)
+	{
+		while (_lock.test_and_set(std::memory_order_acquire)) { }
+
+		const bool pending = _value.load(std::memory_order_acquire) != 0;
+		if (pending)
+		{
+			job->next = _continuations;
+			_continuations = job;
+		}
+
+		_lock.clear(std::memory_order_release);
+		return pending;
+	}
+
+	void Initialize(uint32_t workerCount)
+	{
+		if (scheduler)
+			return;
+
+		if (workerCount == 0)
+			workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+		scheduler = std::make_unique<Scheduler>();
+
+		scheduler->queues.reserve(workerCount + 1);
+		for (uint32_t i = 0; i <= workerCount; ++i)
+		{
+			scheduler->queues.push_back(std::make_unique<WorkStealingQueue>());
+		}
+
+		threadIndex = 0;
+
+		scheduler->workers.reserve(workerCount);
+		for (uint32_t i = 1; i <= workerCount; ++i)
+		{
+			scheduler->workers.emplace_back([i] { scheduler->WorkerLoop(static_cast<int32_t>(i)); });
+		}
+
+		LogInfo("Job system started with {} worker threads", workerCount);
+	}
+
+	void Shutdown()
+	{
+		if (!scheduler)
+			return;
+
+		assert(IsMainThread());
+
+		// Let queued work drain so nothing holding counters is lost
+		while (Job* job = scheduler->TryGetJob())
+			Scheduler::Execute(job);
+		scheduler->PumpMainThreadJobs();
+
+		scheduler->stop.store(true, std::memory_order_release);
+		scheduler->sleepCv.notify_all();
+
+		for (auto& worker : scheduler->workers)
+		{
+			worker.join();
+		}
+
+		scheduler.reset();
+		threadIndex = -1;
+	}
+
+	bool IsInitialized()
+	{
+		return scheduler != nullptr;
+	}
+
+	uint32_t ThreadCount()
+	{
+		return scheduler ? static_cast<uint32_t>(scheduler->queues.size()) : 1;
+	}
+
+	bool IsMainThread()
+	{
+		return threadIndex == 0;
+	}
+
+	uint32_t ThreadIndex()
+	{
+		return threadIndex >= 0 ? static_cast<uint32_t>(threadIndex) : NoThreadIndex;
+	}
+
+	void Run(std::function<void()> job, Counter* counter)
+	{
+		Scheduler::Attach(counter);
+
+		Job* slot = scheduler ? Scheduler::AllocateJob() : nullptr;
+		if (!slot)
+		{
+			Scheduler::RunInline(job, counter);
+			return;
+		}
+
+		slot->fn = std::move(job);
+		slot->counter = counter;
+		scheduler->Enqueue(slot);
+	}
+
+	void Run(std::function<void()> job, Counter* counter, Counter& dependency)
+	{
+		if (!scheduler)
+		{
+			Wait(dependency);
+			Run(std::move(job), counter);
+			return;
+		}
+
+		Scheduler::Attach(counter);
+
+		Job* slot = Scheduler::AllocateJob();
+		if (!slot)
+		{
+			Wait(dependency);
+			Scheduler::RunInline(job, counter);
+			return;
+		}
+
+		slot->fn = std::move(job);
+		slot->counter = counter;
+
+		if (!Scheduler::Chain(dependency, slot))
+			scheduler->Enqueue(slot);
+	}
+
+	void RunOnMainThread(std::function<void()> job, Counter* counter)
+	{
+		Scheduler::Attach(counter);
+
+		if (!scheduler || IsMainThread())
+		{
+			Scheduler::RunInline(job, counter);
+			return;
+		}
+
+		std::lock_guard lock(scheduler->mainMutex);
+		scheduler->mainThreadJobs.push_back({ std::move(job), counter });
+	}
+
+	void PumpMainThread()
+	{
+		if (!scheduler)
+			return;
+
+		assert(IsMainThread());
+		scheduler->PumpMainThreadJobs();
+	}
+
+	void Wait(const Counter& counter)
+	{
+		if (!scheduler)
+		{
+			assert(counter.IsDone());
+			return;
+		}
+
+		const bool mainThread = IsMainThread();
+		while (!counter.IsDone())
+		{
+			if (mainThread && scheduler->PumpMainThreadJobs())
+				continue;
+
+			if (Job* job = scheduler->TryGetJob())
+			{
+				Scheduler::Execute(job);
+				continue;
+			}
+
+			std::this_thread::yield();
+		}
+	}
+} // namespace Eugenix::Jobs
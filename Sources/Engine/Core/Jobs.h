@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace Eugenix::Jobs
+{
+	struct Job;
+
+	// Number of unfinished jobs attached to it. Jobs can wait on a counter or be started once it reaches zero.
+	class Counter final
+	{
+	public:
+		Counter() = default;
+		~Counter();
+
+		Counter(const Counter&) = delete;
+		Counter& operator=(const Counter&) = delete;
+
+		// Not while a release holds the lock: the waiter may destroy the counter as soon as this is true
+		bool IsDone() const { return _value.load(std::memory_order_acquire) == 0 && !_lock.test(std::memory_order_acquire); }
+
+	private:
+		friend struct Scheduler;
+
+		void add(int32_t count);
+		void release();
+		bool addContinuation(Job* job);
+
+		std::atomic<int32_t> _value{ 0 };
+
+		// Guards the transition to zero against jobs being chained onto the counter
+		std::atomic_flag _lock{};
+		Job* _continuations{ nullptr };
+	};
+
+	// Starts the worker threads. The calling thread becomes the main thread (GLFW, GL, window).
+	// workerCount == 0 uses one worker per remaining hardware thread.
+	void Initialize(uint32_t workerCount = 0);
+	void Shutdown();
+
+	bool IsInitialized();
+
+	// Worker threads plus the main thread
+	uint32_t ThreadCount();
+
+	bool IsMainThread();
+
+	constexpr uint32_t NoThreadIndex = UINT32_MAX;
+
+	// 0 on the main thread, 1..ThreadCount() - 1 on workers, NoThreadIndex on threads the scheduler
+	// does not own. Stable while the scheduler runs, for per-thread resources indexed without a lock.
+	uint32_t ThreadIndex();
+
+	// Queues the job on the calling thread's deque, idle workers steal from there.
+	// Without a scheduler (or when the job pool of this thread is exhausted) the job runs inline.
+	void Run(std::function<void()> job, Counter* counter = nullptr);
+
+	// Same, but the job is only queued after `dependency` reaches zero
+	void Run(std::function<void()> job, Counter* counter, Counter& dependency);
+
+	// Jobs that must run on the main thread, e.g. GL uploads after a background decode.
+	// They are executed from PumpMainThread() or while the main thread waits on a counter.
+	void RunOnMainThread(std::function<void()> job, Counter* counter = nullptr);
+	void PumpMainThread();
+
+	// Executes other jobs until the counter reaches zero
+	void Wait(const Counter& counter);
+
+	// Splits [begin, end) into chunks of grainSize and calls fn(first, last) for each one in parallel.
+	// grainSize == 0 picks a size that gives every thread a few chunks to balance uneven work.
+	template<typename Fn>
+	void ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, Fn&& fn)
+	{
+		if (end <= begin)
+			return;
+
+		const uint32_t count = end - begin;
+		if (grainSize == 0)
+			grainSize = std::max(1u, count / (ThreadCount() * 4));
+
+		if (count <= grainSize || ThreadCount() == 1)
+		{
+			fn(begin, end);
+			return;
+		}
+
+		Counter counter;
+		for (uint32_t first = begin + grainSize; first < end;)
+		{
+			const uint32_t last = end - first > grainSize ? first + grainSize : end;
+			Run([&fn, first, last] { fn(first, last); }, &counter);
+			first = last;
+		}
+
+		// The caller takes the first chunk itself instead of idling
+		fn(begin, begin + grainSize);
+		Wait(counter);
+	}
+} // namespace Eugenix::Jobs
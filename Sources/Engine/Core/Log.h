@@ -1,21 +1,13 @@
 #pragma once
 
-#include <iostream>
+#include <format>
 
 #include "CompileConfig.h"
+#include "Logger.h"
 #include "Platform.h"
 
 namespace Eugenix
 {
-	enum struct LogSeverity
-	{
-		Info,
-		Warning,
-		Error,
-		Verbose,
-		Success
-	};
-
 	enum struct LogLevel
 	{
 		Silent,
@@ -30,6 +22,15 @@ namespace Eugenix
 	constexpr LogLevel CurrentLogLevel = static_cast<LogLevel>(EUGENIX_LOG_LEVEL);
 #endif
 
+#ifndef EUGENIX_LOG_DEFERRED_FORMATTING
+#	define EUGENIX_LOG_DEFERRED_FORMATTING 0
+#endif
+
+	// Log calls never touch the console on the calling thread: the message is pushed into a per-thread
+	// lock-free ring and written out by the sink thread (see Logger.h). If the ring is full the message is
+	// dropped and counted. Errors are the exception: they are formatted eagerly and spill to an overflow
+	// list of the thread's ring that the sink drains, they are never dropped and never wait for the sink.
+	// What is still queued when the process terminates is written out by the terminate handler.
 	template<LogSeverity Severity, class... Args>
 	void LogFmt(std::format_string<Args...> fmt, Args&&... args)
 	{
@@ -40,34 +41,10 @@ namespace Eugenix
 			(Severity == LogSeverity::Verbose && CurrentLogLevel == LogLevel::All) ||
 			(Severity == LogSeverity::Success && CurrentLogLevel >= LogLevel::All))
 		{
-#if defined(EUGENIX_PLATFORM_WINDOWS)
-			HANDLE hConsole = GetStdHandle(STD_ERROR_HANDLE);
-			CONSOLE_SCREEN_BUFFER_INFO info;
-			GetConsoleScreenBufferInfo(hConsole, &info);
-
-			WORD original = info.wAttributes;
-			if constexpr (Severity == LogSeverity::Error) SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_INTENSITY);
-			else if constexpr (Severity == LogSeverity::Warning) SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-			else if constexpr (Severity == LogSeverity::Success) SetConsoleTextAttribute(hConsole, FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-#else 
-			if constexpr (Severity == LogSeverity::Error)   std::cerr << "\033[31m";
-			else if constexpr (Severity == LogSeverity::Warning) std::cerr << "\033[33m";
-			else if constexpr (Severity == LogSeverity::Success) std::cerr << "\033[32m";
-#endif
-
-			if constexpr (Severity == LogSeverity::Error)   std::cerr << "[Error] ";
-			if constexpr (Severity == LogSeverity::Warning) std::cerr << "[Warn] ";
-			if constexpr (Severity == LogSeverity::Info)    std::cerr << "[Info] ";
-			if constexpr (Severity == LogSeverity::Verbose) std::cerr << "[Verbose] ";
-
-			std::cerr << std::format(fmt, std::forward<Args>(args)...) << '\n';
-
-// reset color
-#if defined(EUGENIX_PLATFORM_WINDOWS)
-			SetConsoleTextAttribute(hConsole, original);
-#else
-			std::cerr << "\033[0m";
-#endif
+			if constexpr (EUGENIX_LOG_DEFERRED_FORMATTING && Severity != LogSeverity::Error && (Log::IsDeferrable<std::decay_t<Args>> && ...))
+				Log::PushDeferred<Severity>(fmt, std::forward<Args>(args)...);
+			else
+				Log::PushText<Severity>(fmt, std::forward<Args>(args)...);
 		}
 	}
 
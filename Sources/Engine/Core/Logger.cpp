@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "Platform.h"
+#include "Logger.h"
+
+namespace
+{
+	using namespace Eugenix;
+	using namespace Eugenix::Log;
+
+	constexpr size_t ThreadBufferCapacity = 256 * 1024;
+	constexpr auto SinkInterval = std::chrono::milliseconds(2);
+
+	struct Entry
+	{
+		int64_t timestamp;
+		LogSeverity severity;
+		uint32_t threadIndex;
+		size_t begin;
+		size_t end;
+	};
+
+	const char* severityTag(LogSeverity severity)
+	{
+		switch (severity)
+		{
+		case LogSeverity::Error: return "[Error] ";
+		case LogSeverity::Warning: return "[Warn] ";
+		case LogSeverity::Info: return "[Info] ";
+		case LogSeverity::Verbose: return "[Verbose] ";
+		default: return "";
+		}
+	}
+
+	std::terminate_handler previousTerminate = nullptr;
+
+	void onTerminate();
+
+	class Sink final
+	{
+	public:
+		Sink()
+		{
+			_thread = std::thread([this] { run(); });
+
+			// Exit is covered by the destructor, which drains every ring once more
+			previousTerminate = std::set_terminate(onTerminate);
+		}
+
+		~Sink()
+		{
+			{
+				std::lock_guard lock(_mutex);
+				_stop = true;
+			}
+			_wakeCv.notify_one();
+			_thread.join();
+
+			if (const uint64_t dropped = _totalDropped.load(std::memory_order_relaxed))
+				WriteDirect(LogSeverity::Warning, std::format("{} log messages were dropped in total", dropped));
+
+			CloseFile();
+		}
+
+		std::shared_ptr<RingBuffer> Register()
+		{
+			std::lock_guard lock(_mutex);
+			auto buffer = std::make_shared<RingBuffer>(ThreadBufferCapacity, _nextThreadIndex++);
+			_buffers.push_back(buffer);
+			return buffer;
+		}
+
+		void Flush()
+		{
+			// The sink cannot wait for itself, e.g. when it is the thread that terminates
+			if (std::this_thread::get_id() == _thread.get_id())
+				return;
+
+			std::unique_lock lock(_mutex);
+			const uint64_t ticket = ++_flushRequested;
+			_wakeCv.notify_one();
+			_flushedCv.wait(lock, [this, ticket] { return _flushed >= ticket || _stop; });
+		}
+
+		bool OpenFile(const std::filesystem::path& path)
+		{
+			std::lock_guard lock(_outputMutex);
+			if (_file)
+				std::fclose(_file);
+
+#if EUGENIX_PLATFORM_WINDOWS
+			_file = _wfopen(path.c_str(), L"w");
+#else
+			_file = std::fopen(path.c_str(), "w");
+#endif
+			return _file != nullptr;
+		}
+
+		void CloseFile()
+		{
+			std::lock_guard lock(_outputMutex);
+			if (_file)
+				std::fclose(_file);
+			_file = nullptr;
+		}
+
+		void SetConsoleOutput(bool enabled)
+		{
+			std::lock_guard lock(_outputMutex);
+			_console = enabled;
+		}
+
+		void WriteDirect(LogSeverity severity, std::string_view message)
+		{
+			std::lock_guard lock(_outputMutex);
+
+			_directLine.clear();
+			appendLine(_directLine, Timestamp(), UINT32_MAX, severity, message);
+			output(_directLine, severity);
+		}
+
+		uint64_t DroppedCount() const { return _totalDropped.load(std::memory_order_relaxed); }
+
+	private:
+		void run()
+		{
+			while (true)
+			{
+				uint64_t flushTicket = 0;
+				bool stop = false;
+				{
+					std::unique_lock lock(_mutex);
+					_wakeCv.wait_for(lock, SinkInterval, [this] { return _stop || _flushRequested != _flushed; });
+
+					stop = _stop;
+					flushTicket = _flushRequested;
+					_active.assign(_buffers.begin(), _buffers.end());
+				}
+
+				drain();
+
+				{
+					std::lock_guard lock(_mutex);
+					_flushed = flushTicket;
+
+					// Threads that exited and whose rings are empty can go now
+					std::erase_if(_buffers, [](const auto& buffer) { return buffer->Retired() && buffer->Empty(); });
+				}
+				_flushedCv.notify_all();
+				_active.clear();
+
+				if (stop)
+					return;
+			}
+		}
+
+		void drain()
+		{
+			_text.clear();
+			_entries.clear();
+
+			for (const auto& buffer : _active)
+			{
+				if (const uint64_t dropped = buffer->TakeDropped())
+				{
+					_totalDropped.fetch_add(dropped, std::memory_order_relaxed);
+
+					const size_t begin = _text.size();
+					std::format_to(std::back_inserter(_text), "{} log messages dropped, ring buffer is full", dropped);
+					_entries.push_back({ Timestamp(), LogSeverity::Warning, buffer->ThreadIndex(), begin, _text.size() });
+				}
+
+				buffer->TakeSpilled(_spilled);
+				for (const auto& spilled : _spilled)
+				{
+					const size_t begin = _text.size();
+					_text.append(spilled.message);
+					_entries.push_back({ spilled.timestamp, spilled.severity, buffer->ThreadIndex(), begin, _text.size() });
+				}
+
+				buffer->Drain([this, &buffer](const RecordHeader& header, const std::byte* payload)
+					{
+						const size_t begin = _text.size();
+
+						if (header.kind == RecordKind::Text)
+						{
+							uint32_t length = 0;
+							std::memcpy(&length, payload, sizeof(length));
+							_text.append(reinterpret_cast<const char*>(payload + sizeof(length)), length);
+						}
+						else
+						{
+							DeferredPayload deferred{};
+							std::memcpy(&deferred, payload, sizeof(deferred));
+							deferred.format(_text, { deferred.fmt, deferred.fmtSize }, payload + sizeof(deferred));
+						}
+
+						_entries.push_back({ header.timestamp, header.severity, buffer->ThreadIndex(), begin, _text.size() });
+					});
+			}
+
+			if (_entries.empty())
+				return;
+
+			// Rings are drained one after another, restore the global order
+			std::stable_sort(_entries.begin(), _entries.end(),
+				[](const Entry& a, const Entry& b) { return a.timestamp < b.timestamp; });
+
+			write();
+		}
+
+		void write()
+		{
+			std::lock_guard lock(_outputMutex);
+
+			_line.clear();
+			for (const auto& entry : _entries)
+			{
+				const std::string_view message{ _text.data() + entry.begin, entry.end - entry.begin };
+
+				const size_t begin = _line.size();
+				appendLine(_line, entry.timestamp, entry.threadIndex, entry.severity, message);
+
+				if (_console)
+					writeConsole(entry.severity, std::string_view{ _line }.substr(begin));
+			}
+
+			if (_console)
+				std::fflush(stderr);
+
+			writeFile(_line);
+		}
+
+		// Output mutex held
+		void output(std::string_view lines, LogSeverity severity)
+		{
+			if (_console)
+			{
+				writeConsole(severity, lines);
+				std::fflush(stderr);
+			}
+
+			writeFile(lines);
+		}
+
+		void writeFile(std::string_view lines)
+		{
+			if (_file)
+			{
+				std::fwrite(lines.data(), 1, lines.size(), _file);
+				std::fflush(_file);
+			}
+		}
+
+		// Direct writes have no ring and show up as thread "-"
+		static void appendLine(std::string& out, int64_t timestamp, uint32_t threadIndex, LogSeverity severity, std::string_view message)
+		{
+			const auto time = std::chrono::floor<std::chrono::microseconds>(
+				std::chrono::system_clock::time_point{ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ timestamp }) });
+
+			if (threadIndex == UINT32_MAX)
+				std::format_to(std::back_inserter(out), "[{:%H:%M:%S}] [T-] {}{}\n", time, severityTag(severity), message);
+			else
+				std::format_to(std::back_inserter(out), "[{:%H:%M:%S}] [T{}] {}{}\n", time, threadIndex, severityTag(severity), message);
+		}
+
+		void writeConsole(LogSeverity severity, std::string_view line)
+		{
+#if EUGENIX_PLATFORM_WINDOWS
+			HANDLE console = GetStdHandle(STD_ERROR_HANDLE);
+			CONSOLE_SCREEN_BUFFER_INFO info;
+			GetConsoleScreenBufferInfo(console, &info);
+
+			const WORD original = info.wAttributes;
+			if (severity == LogSeverity::Error) SetConsoleTextAttribute(console, FOREGROUND_RED | FOREGROUND_INTENSITY);
+			else if (severity == LogSeverity::Warning) SetConsoleTextAttribute(console, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+			else if (severity == LogSeverity::Success) SetConsoleTextAttribute(console, FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+
+			std::fwrite(line.data(), 1, line.size(), stderr);
+			std::fflush(stderr);
+
+			SetConsoleTextAttribute(console, original);
+#else
+			const char* color = nullptr;
+			if (severity == LogSeverity::Error) color = "\033[31m";
+			else if (severity == LogSeverity::Warning) color = "\033[33m";
+			else if (severity == LogSeverity::Success) color = "\033[32m";
+
+			if (color)
+				std::fputs(color, stderr);
+			std::fwrite(line.data(), 1, line.size(), stderr);
+			if (color)
+				std::fputs("\033[0m", stderr);
+#endif
+		}
+
+		std::thread _thread;
+
+		std::mutex _mutex;
+		std::condition_variable _wakeCv;
+		std::condition_variable _flushedCv;
+		std::vector<std::shared_ptr<RingBuffer>> _buffers;
+		uint32_t _nextThreadIndex{ 0 };
+		uint64_t _flushRequested{ 0 };
+		uint64_t _flushed{ 0 };
+		bool _stop{ false };
+
+		// Sink thread only
+		std::vector<std::shared_ptr<RingBuffer>> _active;
+		std::vector<Entry> _entries;
+		std::vector<RingBuffer::Spilled> _spilled;
+		std::string _text;
+		std::string _line;
+
+		std::atomic<uint64_t> _totalDropped{ 0 };
+
+		std::mutex _outputMutex;
+		std::FILE* _file{ nullptr };
+		bool _console{ true };
+		std::string _directLine;
+	};
+
+	Sink& sink()
+	{
+		static Sink instance;
+		return instance;
+	}
+
+	// std::terminate skips static destructors, write out what is still in the rings first
+	void onTerminate()
+	{
+		sink().Flush();
+
+		if (previousTerminate)
+			previousTerminate();
+
+		std::abort();
+	}
+
+	// Owned by the logging thread, the sink keeps the ring alive until it has been drained
+	struct ThreadBuffer
+	{
+		ThreadBuffer() : buffer(sink().Register()) { }
+		~ThreadBuffer() { buffer->Retire(); }
+
+		std::shared_ptr<RingBuffer> buffer;
+	};
+}
+
+namespace Eugenix::Log
+{
+	RingBuffer::RingBuffer(size_t capacity, uint32_t threadIndex)
+		: _capacity(std::bit_ceil(capacity))
+		, _mask(_capacity - 1)
+		, _threadIndex(threadIndex)
+	{
+		_data = static_cast<std::byte*>(::operator new(_capacity, std::align_val_t{ RecordAlignment }));
+	}
+
+	RingBuffer::~RingBuffer()
+	{
+		::operator delete(_data, std::align_val_t{ RecordAlignment });
+	}
+
+	std::byte* RingBuffer::Reserve(size_t size)
+	{
+		uint64_t write = _write.load(std::memory_order_relaxed);
+		const uint64_t read = _read.load(std::memory_order_acquire);
+
+		const size_t offset = static_cast<size_t>(write & _mask);
+		const size_t contiguous = _capacity - offset;
+		const size_t needed = size <= contiguous ? size : size + contiguous;
+
+		if (size > _capacity / 2 || _capacity - static_cast<size_t>(write - read) < needed)
+			return nullptr;
+
+		if (size > contiguous)
+		{
+			// Records never wrap, fill the tail and start over from the beginning
+			auto* padding = reinterpret_cast<RecordHeader*>(_data + offset);
+			padding->size = static_cast<uint32_t>(contiguous);
+			padding->kind = RecordKind::Padding;
+			write += contiguous;
+		}
+
+		_pending = write + size;
+		return _data + (write & _mask);
+	}
+
+	void RingBuffer::Commit()
+	{
+		_write.store(_pending, std::memory_order_release);
+	}
+
+	void RingBuffer::Spill(LogSeverity severity, int64_t timestamp, std::string_view message)
+	{
+		std::lock_guard lock(_spillMutex);
+		_spilled.push_back({ severity, timestamp, std::string(message) });
+		_hasSpilled.store(true, std::memory_order_release);
+	}
+
+	void RingBuffer::TakeSpilled(std::vector<Spilled>& out)
+	{
+		out.clear();
+		if (!_hasSpilled.load(std::memory_order_acquire))
+			return;
+
+		std::lock_guard lock(_spillMutex);
+		out.swap(_spilled);
+		_hasSpilled.store(false, std::memory_order_release);
+	}
+
+	RingBuffer& LocalBuffer()
+	{
+		thread_local ThreadBuffer local;
+		return *local.buffer;
+	}
+
+	int64_t Timestamp()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	void Flush()
+	{
+		sink().Flush();
+	}
+
+	void WriteDirect(LogSeverity severity, std::string_view message)
+	{
+		sink().WriteDirect(severity, message);
+	}
+
+	uint64_t DroppedCount()
+	{
+		return sink().DroppedCount();
+	}
+
+	bool OpenFile(const std::filesystem::path& path)
+	{
+		return sink().OpenFile(path);
+	}
+
+	void CloseFile()
+	{
+		sink().CloseFile();
+	}
+
+	void SetConsoleOutput(bool enabled)
+	{
+		sink().SetConsoleOutput(enabled);
+	}
+} // namespace Eugenix::Log
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace Eugenix
+{
+	enum struct LogSeverity : uint8_t
+	{
+		Info,
+		Warning,
+		Error,
+		Verbose,
+		Success
+	};
+
+	namespace Log
+	{
+		enum struct RecordKind : uint8_t
+		{
+			Padding,  // filler up to the end of the ring, skipped by the sink
+			Text,     // pre-formatted message
+			Deferred  // raw arguments, formatted by the sink
+		};
+
+		// 16 bytes and every record is a multiple of 16, so a header always fits in front of the wrap point
+		struct RecordHeader
+		{
+			uint32_t size;
+			LogSeverity severity;
+			RecordKind kind;
+			uint16_t reserved;
+			int64_t timestamp; // system_clock nanoseconds
+		};
+		static_assert(sizeof(RecordHeader) == 16);
+
+		constexpr size_t RecordAlignment = 16;
+
+		constexpr size_t AlignRecord(size_t size)
+		{
+			return (size + RecordAlignment - 1) & ~(RecordAlignment - 1);
+		}
+
+		using FormatThunk = void(*)(std::string& out, std::string_view fmt, const std::byte* args);
+
+		struct DeferredPayload
+		{
+			FormatThunk format;
+			const char* fmt;
+			size_t fmtSize;
+		};
+
+		// Single producer (owning thread) / single consumer (sink thread) byte ring
+		class RingBuffer final
+		{
+		public:
+			explicit RingBuffer(size_t capacity, uint32_t threadIndex);
+			~RingBuffer();
+
+			RingBuffer(const RingBuffer&) = delete;
+			RingBuffer& operator=(const RingBuffer&) = delete;
+
+			// Producer side. Returns nullptr when the ring is full, Drop() counts the record as lost
+			// if the caller gives up on it.
+			std::byte* Reserve(size_t size);
+			void Commit();
+			void Drop() { _dropped.fetch_add(1, std::memory_order_relaxed); }
+
+			// Producer side, for errors that did not fit. Takes a lock the sink only holds to swap the
+			// list out, never while writing.
+			void Spill(LogSeverity severity, int64_t timestamp, std::string_view message);
+
+			// Consumer side
+			template<typename Fn>
+			void Drain(Fn&& fn)
+			{
+				uint64_t read = _read.load(std::memory_order_relaxed);
+				const uint64_t write = _write.load(std::memory_order_acquire);
+
+				while (read < write)
+				{
+					const auto* header = reinterpret_cast<const RecordHeader*>(_data + (read & _mask));
+					if (header->kind != RecordKind::Padding)
+						fn(*header, reinterpret_cast<const std::byte*>(header + 1));
+					read += header->size;
+				}
+
+				_read.store(read, std::memory_order_release);
+			}
+
+			struct Spilled
+			{
+				LogSeverity severity;
+				int64_t timestamp;
+				std::string message;
+			};
+
+			// Consumer side, the spilled errors in the order they were logged. out is cleared first.
+			void TakeSpilled(std::vector<Spilled>& out);
+
+			bool Empty() const
+			{
+				return _read.load(std::memory_order_acquire) == _write.load(std::memory_order_acquire) &&
+					!_hasSpilled.load(std::memory_order_acquire);
+			}
+
+			uint32_t ThreadIndex() const { return _threadIndex; }
+
+			uint64_t TakeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+			void Retire() { _retired.store(true, std::memory_order_release); }
+			bool Retired() const { return _retired.load(std::memory_order_acquire); }
+
+		private:
+			std::byte* _data{ nullptr };
+			size_t _capacity{};
+			size_t _mask{};
+			uint32_t _threadIndex{};
+
+			uint64_t _pending{};
+
+			alignas(64) std::atomic<uint64_t> _write{ 0 };
+			alignas(64) std::atomic<uint64_t> _read{ 0 };
+			alignas(64) std::atomic<uint64_t> _dropped{ 0 };
+			std::atomic<bool> _retired{ false };
+
+			std::mutex _spillMutex;
+			std::vector<Spilled> _spilled;
+			std::atomic<bool> _hasSpilled{ false };
+		};
+
+		// Ring of the calling thread, created and registered with the sink on first use
+		RingBuffer& LocalBuffer();
+
+		int64_t Timestamp();
+
+		// Blocks until everything logged before the call has been written out
+		void Flush();
+
+		// Bypasses the rings and writes on the calling thread
+		void WriteDirect(LogSeverity severity, std::string_view message);
+
+		// Messages lost to full rings since startup
+		uint64_t DroppedCount();
+
+		// Mirrors the output to a file in addition to the console
+		bool OpenFile(const std::filesystem::path& path);
+		void CloseFile();
+
+		void SetConsoleOutput(bool enabled);
+
+		// Arguments that are safe to copy as raw bytes and format later on the sink thread.
+		// Anything that may point to caller-owned memory (C strings, string_view, std::string) is formatted eagerly.
+		template<typename T>
+		constexpr bool IsDeferrable =
+			std::is_trivially_copyable_v<T> &&
+			std::is_default_constructible_v<T> &&
+			!std::is_same_v<T, std::string_view> &&
+			!(std::is_pointer_v<T> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>);
+
+		template<typename... Args>
+		void FormatDeferred(std::string& out, std::string_view fmt, const std::byte* args)
+		{
+			std::tuple<Args...> values;
+
+			size_t offset = 0;
+			std::apply([&](auto&... value)
+				{
+					((std::memcpy(&value, args + offset, sizeof(value)), offset += sizeof(value)), ...);
+				}, values);
+
+			std::apply([&](auto&... value)
+				{
+					std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(value...));
+				}, values);
+		}
+
+		inline void WriteHeader(std::byte* record, size_t size, LogSeverity severity, RecordKind kind)
+		{
+			auto* header = reinterpret_cast<RecordHeader*>(record);
+			header->size = static_cast<uint32_t>(size);
+			header->severity = severity;
+			header->kind = kind;
+			header->reserved = 0;
+			header->timestamp = Timestamp();
+		}
+
+		template<LogSeverity Severity, class... Args>
+		void PushText(std::format_string<Args...> fmt, Args&&... args)
+		{
+			// Reused per thread, no allocations once it has grown to the typical message size
+			thread_local std::string scratch;
+			scratch.clear();
+			std::format_to(std::back_inserter(scratch), fmt, std::forward<Args>(args)...);
+
+			RingBuffer& ring = LocalBuffer();
+			const size_t size = AlignRecord(sizeof(RecordHeader) + sizeof(uint32_t) + scratch.size());
+
+			std::byte* record = ring.Reserve(size);
+			if (!record)
+			{
+				// Errors are never dropped, the sink picks them up from the overflow list
+				if constexpr (Severity == LogSeverity::Error)
+					ring.Spill(Severity, Timestamp(), scratch);
+				else
+					ring.Drop();
+				return;
+			}
+
+			WriteHeader(record, size, Severity, RecordKind::Text);
+
+			const auto length = static_cast<uint32_t>(scratch.size());
+			std::memcpy(record + sizeof(RecordHeader), &length, sizeof(length));
+			std::memcpy(record + sizeof(RecordHeader) + sizeof(length), scratch.data(), scratch.size());
+
+			ring.Commit();
+		}
+
+		template<LogSeverity Severity, class... Args>
+		void PushDeferred(std::format_string<Args...> fmt, Args&&... args)
+		{
+			constexpr size_t argsSize = (size_t{ 0 } + ... + sizeof(std::decay_t<Args>));
+
+			RingBuffer& ring = LocalBuffer();
+			const size_t size = AlignRecord(sizeof(RecordHeader) + sizeof(DeferredPayload) + argsSize);
+
+			std::byte* record = ring.Reserve(size);
+			if (!record)
+			{
+				ring.Drop();
+				return;
+			}
+
+			WriteHeader(record, size, Severity, RecordKind::Deferred);
+
+			const std::string_view fmtView = fmt.get();
+			const DeferredPayload payload{ &FormatDeferred<std::decay_t<Args>...>, fmtView.data(), fmtView.size() };
+
+			std::byte* cursor = record + sizeof(RecordHeader);
+			std::memcpy(cursor, &payload, sizeof(payload));
+			cursor += sizeof(payload);
+
+			([&](const auto& value)
+				{
+					std::memcpy(cursor, &value, sizeof(value));
+					cursor += sizeof(value);
+				}(static_cast<const std::decay_t<Args>&>(args)), ...);
+
+			ring.Commit();
+		}
+	} // namespace Log
+} // namespace Eugenix
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "Platform.h"
+#include "Memory.h"
+
+namespace
+{
+	constexpr size_t DefaultFrameArenaCapacity = 1024 * 1024;
+
+	std::atomic<uint64_t> heapAllocations{ 0 };
+
+	struct FrameState
+	{
+		Eugenix::Memory::FrameArena arena{ DefaultFrameArenaCapacity };
+		Eugenix::Memory::FrameMemoryStats lastFrame{};
+		uint64_t frameStartAllocations{ 0 };
+	};
+
+	FrameState& frameState()
+	{
+		static FrameState state;
+		return state;
+	}
+
+	std::byte* alignUp(std::byte* ptr, size_t alignment)
+	{
+		const auto address = reinterpret_cast<uintptr_t>(ptr);
+		return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(uintptr_t(alignment) - 1));
+	}
+}
+
+namespace Eugenix::Memory
+{
+	LinearArena::LinearArena(size_t capacity, std::pmr::memory_resource* upstream)
+		: _upstream(upstream)
+		, _capacity(capacity)
+	{
+		_block = static_cast<std::byte*>(_upstream->allocate(_capacity, alignof(std::max_align_t)));
+		_chunkBegin = _cursor = _block;
+		_end = _block + _capacity;
+	}
+
+	LinearArena::~LinearArena()
+	{
+		releaseOverflow();
+		_upstream->deallocate(_block, _capacity, alignof(std::max_align_t));
+	}
+
+	void LinearArena::Reset()
+	{
+		if (!_overflow.empty())
+		{
+			const size_t peak = Used();
+			releaseOverflow();
+
+			// Grow once to what the last round needed instead of spilling every time
+			_upstream->deallocate(_block, _capacity, alignof(std::max_align_t));
+			_capacity = std::bit_ceil(peak);
+			_block = static_cast<std::byte*>(_upstream->allocate(_capacity, alignof(std::max_align_t)));
+		}
+
+		_chunkBegin = _cursor = _block;
+		_end = _block + _capacity;
+		_used = 0;
+		_overflowBytes = 0;
+	}
+
+	void* LinearArena::do_allocate(size_t bytes, size_t alignment)
+	{
+		std::byte* ptr = alignUp(_cursor, alignment);
+		if (ptr + bytes <= _end)
+		{
+			_cursor = ptr + bytes;
+			return ptr;
+		}
+
+		return allocateOverflow(bytes, alignment);
+	}
+
+	void* LinearArena::allocateOverflow(size_t bytes, size_t alignment)
+	{
+		// Chunks double so a badly undersized arena still spills only a handful of times
+		const size_t lastSize = _overflow.empty() ? _capacity : _overflow.back().size;
+		const size_t size = std::max(bytes + alignment, lastSize * 2);
+
+		Chunk chunk{ static_cast<std::byte*>(_upstream->allocate(size, alignof(std::max_align_t))), size };
+		_overflow.push_back(chunk);
+
+		_used += static_cast<size_t>(_cursor - _chunkBegin);
+		_overflowBytes += bytes;
+
+		std::byte* ptr = alignUp(chunk.data, alignment);
+		_chunkBegin = chunk.data;
+		_cursor = ptr + bytes;
+		_end = chunk.data + chunk.size;
+		return ptr;
+	}
+
+	void LinearArena::releaseOverflow()
+	{
+		for (const auto& chunk : _overflow)
+		{
+			_upstream->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+		}
+		_overflow.clear();
+	}
+
+	FrameArena::FrameArena(size_t capacityPerFrame)
+		: _arenas{ { LinearArena(capacityPerFrame), LinearArena(capacityPerFrame) } }
+	{
+	}
+
+	void FrameArena::BeginFrame()
+	{
+		_index ^= 1;
+		_arenas[_index].Reset();
+	}
+
+	void BeginFrame()
+	{
+		auto& state = frameState();
+
+		const auto& finished = state.arena.Current();
+		const uint64_t allocations = HeapAllocationCount();
+
+		state.lastFrame.arenaUsed = finished.Used();
+		state.lastFrame.arenaCapacity = finished.Capacity();
+		state.lastFrame.arenaOverflow = finished.Overflow();
+		state.lastFrame.heapAllocations = allocations - state.frameStartAllocations;
+		state.frameStartAllocations = allocations;
+
+		state.arena.BeginFrame();
+	}
+
+	std::pmr::memory_resource* FrameResource()
+	{
+		return frameState().arena.Resource();
+	}
+
+	FrameMemoryStats LastFrameStats()
+	{
+		return frameState().lastFrame;
+	}
+
+	uint64_t HeapAllocationCount()
+	{
+		return heapAllocations.load(std::memory_order_relaxed);
+	}
+} // namespace Eugenix::Memory
+
+#if EUGENIX_MEMORY_TRACKING
+namespace
+{
+	void* trackedAlloc(size_t size)
+	{
+		heapAllocations.fetch_add(1, std::memory_order_relaxed);
+		return std::malloc(size ? size : 1);
+	}
+
+	void* trackedAlignedAlloc(size_t size, std::align_val_t alignment)
+	{
+		heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		const auto align = static_cast<size_t>(alignment);
+#if EUGENIX_PLATFORM_WINDOWS
+		return _aligned_malloc(size ? size : 1, align);
+#else
+		return std::aligned_alloc(align, ((size ? size : 1) + align - 1) & ~(align - 1));
+#endif
+	}
+
+	void trackedAlignedFree(void* ptr)
+	{
+#if EUGENIX_PLATFORM_WINDOWS
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+void* operator new(size_t size)
+{
+	if (void* ptr = trackedAlloc(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	if (void* ptr = trackedAlloc(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* ptr = trackedAlignedAlloc(size, alignment))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	if (void* ptr = trackedAlignedAlloc(size, alignment))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAlignedAlloc(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return trackedAlignedAlloc(size, alignment); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedAlignedFree(ptr); }
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CompileConfig.h"
+
+// Counts every global operator new, used to report heap allocations per frame
+#ifndef EUGENIX_MEMORY_TRACKING
+#	define EUGENIX_MEMORY_TRACKING 0
+#endif
+
+namespace Eugenix::Memory
+{
+	// Containers for transient data: pass FrameResource() (or any arena) to make their allocations a pointer bump
+	template<typename T>
+	using Vector = std::pmr::vector<T>;
+
+	using String = std::pmr::string;
+
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+	using UnorderedMap = std::pmr::unordered_map<Key, Value, Hash, Equal>;
+
+	using Allocator = std::pmr::polymorphic_allocator<>;
+
+	// Monotonic bump allocator. Deallocation is a no-op, everything is released at once by Reset().
+	// When the block runs out, allocations spill into extra chunks from upstream, Reset() then grows
+	// the block to the observed peak so the next round fits without spilling.
+	// Not thread-safe.
+	class LinearArena final : public std::pmr::memory_resource
+	{
+	public:
+		explicit LinearArena(size_t capacity, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+		~LinearArena() override;
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		void Reset();
+
+		size_t Used() const { return _used + static_cast<size_t>(_cursor - _chunkBegin); }
+		size_t Capacity() const { return _capacity; }
+		// Bytes that did not fit into the block since the last Reset()
+		size_t Overflow() const { return _overflowBytes; }
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override { }
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	private:
+		struct Chunk
+		{
+			std::byte* data;
+			size_t size;
+		};
+
+		void* allocateOverflow(size_t bytes, size_t alignment);
+		void releaseOverflow();
+
+		std::pmr::memory_resource* _upstream{ nullptr };
+
+		std::byte* _block{ nullptr };
+		size_t _capacity{};
+
+		std::byte* _chunkBegin{ nullptr };
+		std::byte* _cursor{ nullptr };
+		std::byte* _end{ nullptr };
+
+		std::vector<Chunk> _overflow;
+		size_t _overflowBytes{};
+		size_t _used{}; // bytes in chunks that are already full
+	};
+
+	// Two linear arenas used in turns. Memory allocated during frame N stays valid through frame N+1,
+	// which covers data handed over to the renderer / GPU upload of the next frame.
+	class FrameArena final
+	{
+	public:
+		explicit FrameArena(size_t capacityPerFrame);
+
+		// Switches to the other arena and resets it
+		void BeginFrame();
+
+		std::pmr::memory_resource* Resource() { return &_arenas[_index]; }
+
+		const LinearArena& Current() const { return _arenas[_index]; }
+		const LinearArena& Previous() const { return _arenas[_index ^ 1]; }
+
+	private:
+		std::array<LinearArena, 2> _arenas;
+		uint32_t _index{ 0 };
+	};
+
+	struct FrameMemoryStats
+	{
+		size_t arenaUsed{};
+		size_t arenaCapacity{};
+		size_t arenaOverflow{};
+		uint64_t heapAllocations{}; // 0 unless EUGENIX_MEMORY_TRACKING is on
+	};
+
+	// Frame boundary for the main loop thread: resets its frame arena and closes the stats of the previous frame
+	void BeginFrame();
+
+	// Allocations made through this resource live until the end of the next frame.
+	// Only the thread that drives the frame loop may use it.
+	std::pmr::memory_resource* FrameResource();
+
+	FrameMemoryStats LastFrameStats();
+
+	// Total number of global operator new calls so far
+	uint64_t HeapAllocationCount();
+} // namespace Eugenix::Memory
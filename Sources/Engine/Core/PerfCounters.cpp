@@ -0,0 +1,144 @@
+#include <array>
+
+#include "Platform.h"
+#include "Log.h"
+#include "PerfCounters.h"
+
+#if EUGENIX_PERF_COUNTERS_ENABLED && EUGENIX_PLATFORM_LINUX
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#	define EUGENIX_PERF_EVENT_OPEN 1
+#else
+#	define EUGENIX_PERF_EVENT_OPEN 0
+#endif
+
+namespace
+{
+	using namespace Eugenix;
+
+#if EUGENIX_PERF_EVENT_OPEN
+	constexpr std::array<uint64_t, 4> CounterConfigs =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+
+	// Layout of read() on the group leader with the read_format below
+	struct GroupRead
+	{
+		uint64_t count;
+		uint64_t timeEnabled;
+		uint64_t timeRunning;
+		std::array<uint64_t, CounterConfigs.size()> values;
+	};
+
+	int perfEventOpen(perf_event_attr& attr, int groupFd)
+	{
+		// This thread, any CPU
+		return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+	}
+
+	// One group per thread so all four counters are scheduled on the PMU together
+	struct ThreadCounters
+	{
+		ThreadCounters()
+		{
+			for (size_t i = 0; i < CounterConfigs.size(); ++i)
+			{
+				perf_event_attr attr{};
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.size = sizeof(attr);
+				attr.config = CounterConfigs[i];
+				attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+				attr.disabled = i == 0 ? 1 : 0;
+				// Counting user space only works with the default perf_event_paranoid of 2
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+
+				fds[i] = perfEventOpen(attr, i == 0 ? -1 : fds[0]);
+				if (fds[i] < 0)
+				{
+					close();
+					return;
+				}
+			}
+
+			ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+
+		~ThreadCounters()
+		{
+			close();
+		}
+
+		void close()
+		{
+			for (int& fd : fds)
+			{
+				if (fd >= 0)
+					::close(fd);
+				fd = -1;
+			}
+		}
+
+		bool valid() const { return fds[0] >= 0; }
+
+		std::array<int, CounterConfigs.size()> fds{ -1, -1, -1, -1 };
+	};
+
+	ThreadCounters& threadCounters()
+	{
+		thread_local ThreadCounters counters;
+
+		static const bool reported = [&]
+			{
+				if (!counters.valid())
+					LogWarn("PerfCounters: perf_event_open failed, hardware counters read as zero");
+				return true;
+			}();
+		(void)reported;
+
+		return counters;
+	}
+#endif
+}
+
+namespace Eugenix::PerfCounters
+{
+	bool IsAvailable()
+	{
+#if EUGENIX_PERF_EVENT_OPEN
+		return threadCounters().valid();
+#else
+		return false;
+#endif
+	}
+
+	Values Read()
+	{
+#if EUGENIX_PERF_EVENT_OPEN
+		auto& counters = threadCounters();
+		if (!counters.valid())
+			return {};
+
+		GroupRead group{};
+		if (::read(counters.fds[0], &group, sizeof(group)) != static_cast<ssize_t>(sizeof(group)))
+			return {};
+
+		// Other events competed for the PMU, extrapolate to the full enabled time
+		double scale = 1.0;
+		if (group.timeRunning > 0 && group.timeRunning < group.timeEnabled)
+			scale = static_cast<double>(group.timeEnabled) / static_cast<double>(group.timeRunning);
+
+		auto scaled = [scale](uint64_t value) { return static_cast<uint64_t>(static_cast<double>(value) * scale); };
+		return { scaled(group.values[0]), scaled(group.values[1]), scaled(group.values[2]), scaled(group.values[3]) };
+#else
+		return {};
+#endif
+	}
+} // namespace Eugenix::PerfCounters
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include "CompileConfig.h"
+
+// Hardware counters through perf_event_open. Linux only, elsewhere every read returns zeros.
+#ifndef EUGENIX_PERF_COUNTERS_ENABLED
+#	define EUGENIX_PERF_COUNTERS_ENABLED 0
+#endif
+
+namespace Eugenix::PerfCounters
+{
+	struct Values
+	{
+		uint64_t cycles;
+		uint64_t instructions;
+		uint64_t cacheMisses;
+		uint64_t branchMisses;
+
+		double Ipc() const { return cycles ? static_cast<double>(instructions) / static_cast<double>(cycles) : 0.0; }
+
+		Values operator-(const Values& other) const
+		{
+			return { cycles - other.cycles, instructions - other.instructions,
+				cacheMisses - other.cacheMisses, branchMisses - other.branchMisses };
+		}
+	};
+
+	// Opens the counters of the calling thread on first use. False when the kernel refuses
+	// (no PMU in a VM, kernel.perf_event_paranoid > 2) or the build has them disabled.
+	bool IsAvailable();
+
+	// Counts of the calling thread since its counters were opened, user space only.
+	// Scaled up when the kernel had to multiplex them with other events.
+	Values Read();
+
+	// Counter deltas of a region, e.g. a hot loop
+	class Sampler final
+	{
+	public:
+		Sampler()
+			: _start(Read())
+		{
+		}
+
+		Values Elapsed() const { return Read() - _start; }
+
+	private:
+		Values _start;
+	};
+} // namespace Eugenix::PerfCounters
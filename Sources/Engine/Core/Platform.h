@@ -3,6 +3,7 @@
 // Platform OS
 #define EUGENIX_PLATFORM_WINDOWS 0
 #define EUGENIX_PLATFORM_ANDROID 0
+#define EUGENIX_PLATFORM_LINUX 0
 #if defined(_WIN32) || defined(_WIN64) || defined(__WIN32__) || defined(WIN32) || defined(_WINDOWS)
 #	undef  EUGENIX_PLATFORM_WINDOWS
 #	define EUGENIX_PLATFORM_WINDOWS 1
@@ -13,10 +14,24 @@
 #elif defined(__ANDROID__) || defined(ANDROID) || defined(_ANDROID)
 #	undef  EUGENIX_PLATFORM_ANDROID
 #	define EUGENIX_PLATFORM_ANDROID __ANDROID_API__
+#elif defined(__linux__)
+#	undef  EUGENIX_PLATFORM_LINUX
+#	define EUGENIX_PLATFORM_LINUX 1
 #else
 #	error Unknown platform.
 #endif
 
+// Architecture
+#define EUGENIX_ARCH_X64 0
+#define EUGENIX_ARCH_ARM64 0
+#if defined(_M_X64) || defined(__x86_64__)
+#	undef  EUGENIX_ARCH_X64
+#	define EUGENIX_ARCH_X64 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#	undef  EUGENIX_ARCH_ARM64
+#	define EUGENIX_ARCH_ARM64 1
+#endif
+
 // Debug
 #define EUGENIX_DEBUG 0
 #if (defined(_DEBUG) || defined(DEBUG)) && !defined(NDEBUG)
@@ -26,9 +41,17 @@
 
 // Compiler
 #define EUGENIX_COMPILER_MSVC 0
+#define EUGENIX_COMPILER_CLANG 0
+#define EUGENIX_COMPILER_GCC 0
 #if defined(_MSC_VER) && (_MSC_VER >= 1900)
 #	undef  EUGENIX_COMPILER_MSVC
 #	define EUGENIX_COMPILER_MSVC _MSC_VER
+#elif defined(__clang__)
+#	undef  EUGENIX_COMPILER_CLANG
+#	define EUGENIX_COMPILER_CLANG (__clang_major__ * 100 + __clang_minor__)
+#elif defined(__GNUC__)
+#	undef  EUGENIX_COMPILER_GCC
+#	define EUGENIX_COMPILER_GCC (__GNUC__ * 100 + __GNUC_MINOR__)
 #else
 #	error "Unknown compiler."
 #endif
@@ -38,6 +61,11 @@
 #	define EUGENIX_PRAGMA_WARNING_LEVEL(level)     __pragma(warning(push, level))
 #	define EUGENIX_PRAGMA_WARNING_POP              __pragma(warning(pop))
 #	define EUGENIX_PRAGMA_WARNING_DISABLE_MSVC(id) __pragma(warning(disable: id))
+#elif EUGENIX_COMPILER_CLANG || EUGENIX_COMPILER_GCC
+#	define EUGENIX_PRAGMA_WARNING_PUSH             _Pragma("GCC diagnostic push")
+#	define EUGENIX_PRAGMA_WARNING_LEVEL(level)     _Pragma("GCC diagnostic push")
+#	define EUGENIX_PRAGMA_WARNING_POP              _Pragma("GCC diagnostic pop")
+#	define EUGENIX_PRAGMA_WARNING_DISABLE_MSVC(id)
 #else
 #	define EUGENIX_PRAGMA_WARNING_PUSH
 #	define EUGENIX_PRAGMA_WARNING_LEVEL(level)
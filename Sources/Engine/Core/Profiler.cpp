@@ -0,0 +1,378 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <json11.hpp>
+
+#include "Log.h"
+#include "Profiler.h"
+
+namespace
+{
+	using namespace Eugenix;
+
+	constexpr size_t EventsPerBlock = 4096;
+
+	struct Event
+	{
+		const char* name;
+		int64_t start;
+		int64_t end;
+	};
+
+	struct CounterEvent
+	{
+		const char* name;
+		int64_t start;
+		int64_t end;
+		PerfCounters::Values counters;
+	};
+
+	template<typename T>
+	struct Block
+	{
+		std::array<T, EventsPerBlock> events;
+		std::atomic<size_t> count{ 0 };
+		std::atomic<Block*> next{ nullptr };
+	};
+
+	// Blocks are allocated on first use and kept for later captures
+	template<typename T>
+	struct BlockList
+	{
+		~BlockList()
+		{
+			Block<T>* block = head.load(std::memory_order_relaxed);
+			while (block)
+			{
+				Block<T>* next = block->next.load(std::memory_order_relaxed);
+				delete block;
+				block = next;
+			}
+		}
+
+		void Reset()
+		{
+			for (Block<T>* block = head.load(std::memory_order_relaxed); block; block = block->next.load(std::memory_order_relaxed))
+				block->count.store(0, std::memory_order_relaxed);
+
+			tail = head.load(std::memory_order_relaxed);
+		}
+
+		void Push(const T& event)
+		{
+			if (!tail)
+			{
+				tail = new Block<T>{};
+				head.store(tail, std::memory_order_release);
+			}
+
+			size_t count = tail->count.load(std::memory_order_relaxed);
+			if (count == EventsPerBlock)
+			{
+				Block<T>* next = tail->next.load(std::memory_order_relaxed);
+				if (!next)
+				{
+					next = new Block<T>{};
+					tail->next.store(next, std::memory_order_release);
+				}
+				tail = next;
+				count = 0;
+			}
+
+			tail->events[count] = event;
+			tail->count.store(count + 1, std::memory_order_release);
+		}
+
+		template<typename Fn>
+		void ForEach(Fn&& fn) const
+		{
+			for (const Block<T>* block = head.load(std::memory_order_acquire); block; block = block->next.load(std::memory_order_acquire))
+			{
+				const size_t count = block->count.load(std::memory_order_acquire);
+				for (size_t i = 0; i < count; ++i)
+					fn(block->events[i]);
+			}
+		}
+
+		std::atomic<Block<T>*> head{ nullptr };
+		Block<T>* tail{ nullptr };
+	};
+
+	// Written only by its thread, read by the exporter after the capture has ended
+	struct ThreadEvents
+	{
+		void BeginWrite(uint64_t captureGeneration)
+		{
+			if (generation != captureGeneration)
+			{
+				// First zone of a new capture, reuse the blocks of the previous one
+				zones.Reset();
+				counterZones.Reset();
+				generation.store(captureGeneration, std::memory_order_release);
+			}
+		}
+
+		void Push(const Event& event, uint64_t captureGeneration)
+		{
+			BeginWrite(captureGeneration);
+			zones.Push(event);
+		}
+
+		void Push(const CounterEvent& event, uint64_t captureGeneration)
+		{
+			BeginWrite(captureGeneration);
+			counterZones.Push(event);
+		}
+
+		uint32_t index{};
+		std::string name;
+		bool retired{ false };	// Its thread has exited, guarded by threadsMutex
+		std::atomic<uint64_t> generation{ 0 };
+		BlockList<Event> zones;
+		BlockList<CounterEvent> counterZones;
+	};
+
+	struct ProfilerState
+	{
+		const std::chrono::steady_clock::time_point epoch{ std::chrono::steady_clock::now() };
+
+		std::atomic<bool> capturing{ false };
+		std::atomic<uint64_t> generation{ 0 };
+
+		std::mutex threadsMutex;
+		std::vector<std::shared_ptr<ThreadEvents>> threads;	// Null where a retired thread was dropped
+		std::vector<uint32_t> freeIndices;
+	};
+
+	ProfilerState& state()
+	{
+		static ProfilerState instance;
+		return instance;
+	}
+
+	std::shared_ptr<ThreadEvents> registerEvents(std::string name)
+	{
+		auto& profiler = state();
+		auto result = std::make_shared<ThreadEvents>();
+
+		std::lock_guard lock(profiler.threadsMutex);
+		if (!profiler.freeIndices.empty())
+		{
+			result->index = profiler.freeIndices.back();
+			profiler.freeIndices.pop_back();
+			profiler.threads[result->index] = result;
+		}
+		else
+		{
+			result->index = static_cast<uint32_t>(profiler.threads.size());
+			profiler.threads.push_back(result);
+		}
+		result->name = name.empty() ? "Thread " + std::to_string(result->index) : std::move(name);
+		return result;
+	}
+
+	// With threadsMutex held. Frees the events of exited threads, their slots go to new threads.
+	void dropRetired(ProfilerState& profiler)
+	{
+		for (auto& thread : profiler.threads)
+		{
+			if (thread && thread->retired)
+			{
+				profiler.freeIndices.push_back(thread->index);
+				thread.reset();
+			}
+		}
+	}
+
+	// Owns the calling thread's events, retires them when the thread exits
+	struct LocalEvents
+	{
+		LocalEvents() : events(registerEvents({})) {}
+
+		~LocalEvents()
+		{
+			auto& profiler = state();
+
+			std::lock_guard lock(profiler.threadsMutex);
+			events->retired = true;
+
+			// Zones of the current capture stay until they are saved or the next capture begins
+			if (events->generation.load(std::memory_order_acquire) != profiler.generation.load(std::memory_order_acquire))
+			{
+				profiler.freeIndices.push_back(events->index);
+				profiler.threads[events->index].reset();
+			}
+		}
+
+		std::shared_ptr<ThreadEvents> events;
+	};
+
+	ThreadEvents& localEvents()
+	{
+		thread_local LocalEvents local;
+		return *local.events;
+	}
+}
+
+namespace Eugenix::Profiler
+{
+	int64_t Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state().epoch).count();
+	}
+
+	int64_t FromSteadyClock(std::chrono::steady_clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time - state().epoch).count();
+	}
+
+	void BeginCapture()
+	{
+		auto& profiler = state();
+		{
+			// The zones of exited threads belong to the previous capture, nothing exports them anymore
+			std::lock_guard lock(profiler.threadsMutex);
+			dropRetired(profiler);
+		}
+
+		profiler.generation.fetch_add(1, std::memory_order_acq_rel);
+		profiler.capturing.store(true, std::memory_order_release);
+	}
+
+	void EndCapture()
+	{
+		state().capturing.store(false, std::memory_order_release);
+	}
+
+	bool IsCapturing()
+	{
+		return state().capturing.load(std::memory_order_relaxed);
+	}
+
+	void SetThreadName(std::string_view name)
+	{
+		auto& events = localEvents();
+
+		std::lock_guard lock(state().threadsMutex);
+		events.name = name;
+	}
+
+	void RecordZone(const char* name, int64_t start, int64_t end)
+	{
+		localEvents().Push(Event{ name, start, end }, state().generation.load(std::memory_order_acquire));
+	}
+
+	void RecordCounterZone(const char* name, int64_t start, int64_t end, const PerfCounters::Values& counters)
+	{
+		localEvents().Push(CounterEvent{ name, start, end, counters }, state().generation.load(std::memory_order_acquire));
+	}
+
+	uint32_t CreateTrack(std::string_view name)
+	{
+		return registerEvents(std::string(name))->index;
+	}
+
+	void RecordZone(uint32_t track, const char* name, int64_t start, int64_t end)
+	{
+		auto& profiler = state();
+
+		ThreadEvents* events = nullptr;
+		{
+			std::lock_guard lock(profiler.threadsMutex);
+			events = profiler.threads[track].get();
+		}
+
+		events->Push(Event{ name, start, end }, profiler.generation.load(std::memory_order_acquire));
+	}
+
+	void ToggleCapture(const std::filesystem::path& path)
+	{
+		if (!IsCapturing())
+		{
+			LogInfo("Profiler: capture started");
+			BeginCapture();
+			return;
+		}
+
+		EndCapture();
+		SaveChromeTrace(path);
+	}
+
+	bool SaveChromeTrace(const std::filesystem::path& path)
+	{
+		auto& profiler = state();
+		const uint64_t generation = profiler.generation.load(std::memory_order_acquire);
+
+		json11::Json::array traceEvents;
+
+		std::lock_guard lock(profiler.threadsMutex);
+		for (const auto& thread : profiler.threads)
+		{
+			if (!thread)
+				continue;
+
+			traceEvents.push_back(json11::Json::object{
+				{ "name", "thread_name" },
+				{ "ph", "M" },
+				{ "pid", 0 },
+				{ "tid", static_cast<int>(thread->index) },
+				{ "args", json11::Json::object{ { "name", thread->name } } } });
+
+			if (thread->generation.load(std::memory_order_acquire) != generation)
+				continue;
+
+			thread->zones.ForEach([&](const Event& event)
+				{
+					// Chrome expects microseconds, the fraction keeps the nanosecond resolution
+					traceEvents.push_back(json11::Json::object{
+						{ "name", event.name },
+						{ "ph", "X" },
+						{ "pid", 0 },
+						{ "tid", static_cast<int>(thread->index) },
+						{ "ts", static_cast<double>(event.start) / 1000.0 },
+						{ "dur", static_cast<double>(event.end - event.start) / 1000.0 } });
+				});
+
+			thread->counterZones.ForEach([&](const CounterEvent& event)
+				{
+					traceEvents.push_back(json11::Json::object{
+						{ "name", event.name },
+						{ "ph", "X" },
+						{ "pid", 0 },
+						{ "tid", static_cast<int>(thread->index) },
+						{ "ts", static_cast<double>(event.start) / 1000.0 },
+						{ "dur", static_cast<double>(event.end - event.start) / 1000.0 },
+						{ "args", json11::Json::object{
+							{ "cycles", static_cast<double>(event.counters.cycles) },
+							{ "instructions", static_cast<double>(event.counters.instructions) },
+							{ "ipc", event.counters.Ipc() },
+							{ "cacheMisses", static_cast<double>(event.counters.cacheMisses) },
+							{ "branchMisses", static_cast<double>(event.counters.branchMisses) } } } });
+				});
+		}
+
+		// Exited threads are written, nothing else reads their events
+		dropRetired(profiler);
+
+		const json11::Json trace = json11::Json::object{
+			{ "traceEvents", traceEvents },
+			{ "displayTimeUnit", "ns" } };
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+		{
+			LogError("Profiler: failed to open {}", path.string());
+			return false;
+		}
+
+		file << trace.dump();
+		LogInfo("Profiler: capture saved to {}", path.string());
+		return true;
+	}
+} // namespace Eugenix::Profiler
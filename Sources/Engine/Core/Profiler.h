@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "CompileConfig.h"
+#include "PerfCounters.h"
+
+#ifndef EUGENIX_PROFILING_ENABLED
+#	define EUGENIX_PROFILING_ENABLED 0
+#endif
+
+namespace Eugenix::Profiler
+{
+	// Nanoseconds since the profiler clock started, monotonic
+	int64_t Now();
+
+	// Maps a steady_clock reading (CLOCK_MONOTONIC / QueryPerformanceCounter) onto the Now() timeline
+	int64_t FromSteadyClock(std::chrono::steady_clock::time_point time);
+
+	// Zones are recorded only between BeginCapture() and EndCapture().
+	// Export after EndCapture(), before the next BeginCapture().
+	void BeginCapture();
+	void EndCapture();
+	bool IsCapturing();
+
+	// Chrome trace event format, open in chrome://tracing or ui.perfetto.dev
+	bool SaveChromeTrace(const std::filesystem::path& path);
+
+	// Starts a capture, or ends the running one and saves it to path. Bound to F9 in the apps.
+	void ToggleCapture(const std::filesystem::path& path);
+
+	// Name shown for the calling thread's track
+	void SetThreadName(std::string_view name);
+
+	void RecordZone(const char* name, int64_t start, int64_t end);
+
+	// Zone carrying the hardware counter deltas of its thread, shown as args in the trace
+	void RecordCounterZone(const char* name, int64_t start, int64_t end, const PerfCounters::Values& counters);
+
+	// Timeline that is not a CPU thread, e.g. a GPU queue. Zones on it are recorded with
+	// already converted timestamps, by one thread at a time.
+	uint32_t CreateTrack(std::string_view name);
+	void RecordZone(uint32_t track, const char* name, int64_t start, int64_t end);
+
+	class Zone final
+	{
+	public:
+		// The name must outlive the capture, string literals only
+		explicit Zone(const char* name)
+			: _name(name)
+			, _start(IsCapturing() ? Now() : -1)
+		{
+		}
+
+		~Zone()
+		{
+			if (_start >= 0)
+				RecordZone(_name, _start, Now());
+		}
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+	private:
+		const char* _name;
+		int64_t _start;
+	};
+
+	// Zone that also samples cycles, instructions, cache and branch misses. Reading the counters
+	// is a syscall each way, use it on hot loops as a whole rather than on their iterations.
+	class CounterZone final
+	{
+	public:
+		explicit CounterZone(const char* name)
+			: _name(name)
+			, _start(IsCapturing() ? Now() : -1)
+			, _counters(_start >= 0 ? PerfCounters::Read() : PerfCounters::Values{})
+		{
+		}
+
+		~CounterZone()
+		{
+			if (_start >= 0)
+			{
+				const PerfCounters::Values counters = PerfCounters::Read() - _counters;
+				RecordCounterZone(_name, _start, Now(), counters);
+			}
+		}
+
+		CounterZone(const CounterZone&) = delete;
+		CounterZone& operator=(const CounterZone&) = delete;
+
+	private:
+		const char* _name;
+		int64_t _start;
+		PerfCounters::Values _counters;
+	};
+} // namespace Eugenix::Profiler
+
+#define EUGENIX_PROFILE_CONCAT_IMPL(a, b) a##b
+#define EUGENIX_PROFILE_CONCAT(a, b) EUGENIX_PROFILE_CONCAT_IMPL(a, b)
+
+#if EUGENIX_PROFILING_ENABLED
+#	define EUGENIX_PROFILE_SCOPE(name) ::Eugenix::Profiler::Zone EUGENIX_PROFILE_CONCAT(_eugenixProfileZone, __LINE__){ name }
+#	define EUGENIX_PROFILE_FUNCTION() EUGENIX_PROFILE_SCOPE(__func__)
+#	define EUGENIX_PROFILE_THREAD(name) ::Eugenix::Profiler::SetThreadName(name)
+#	if EUGENIX_PERF_COUNTERS_ENABLED
+#		define EUGENIX_PROFILE_COUNTERS_SCOPE(name) ::Eugenix::Profiler::CounterZone EUGENIX_PROFILE_CONCAT(_eugenixProfileZone, __LINE__){ name }
+#	else
+#		define EUGENIX_PROFILE_COUNTERS_SCOPE(name) EUGENIX_PROFILE_SCOPE(name)
+#	endif
+#else
+#	define EUGENIX_PROFILE_SCOPE(name)
+#	define EUGENIX_PROFILE_FUNCTION()
+#	define EUGENIX_PROFILE_THREAD(name)
+#	define EUGENIX_PROFILE_COUNTERS_SCOPE(name)
+#endif
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Profiler.h"
+#include "Time.h"
+
+namespace Eugenix::Simulation
+{
+	// Snapshots handed from one producer thread to one consumer. The consumer reads the latest two
+	// as a pair and they stay untouched until its next Acquire(). Five slots: the latest two, the
+	// pair still being read and the one being written.
+	template<typename T>
+	class SnapshotBuffer final
+	{
+	public:
+		struct Pair
+		{
+			const T* previous;
+			const T* latest;
+			uint64_t step;					// Steps simulated up to latest
+			Time::Clock::time_point time;	// When latest was due
+		};
+
+		// Producer side, the slot to fill before the next Publish()
+		T& Back() { return _slots[_back]; }
+
+		// Step 0 is the initial state, it becomes both snapshots of the pair
+		void Publish(uint64_t step, Time::Clock::time_point time)
+		{
+			std::lock_guard lock(_mutex);
+			_previous = step == 0 ? _back : _latest;
+			_latest = _back;
+			_step = step;
+			_time = time;
+			_back = freeSlot();
+		}
+
+		Pair Acquire()
+		{
+			std::lock_guard lock(_mutex);
+			_readPrevious = _previous;
+			_readLatest = _latest;
+			return { &_slots[_previous], &_slots[_latest], _step, _time };
+		}
+
+	private:
+		static constexpr uint32_t SlotCount = 5;
+
+		uint32_t freeSlot() const
+		{
+			for (uint32_t slot = 0; slot < SlotCount; ++slot)
+			{
+				if (slot != _latest && slot != _previous && slot != _readPrevious && slot != _readLatest)
+					return slot;
+			}
+
+			assert(false && "SnapshotBuffer: no free slot");
+			return 0;
+		}
+
+		std::array<T, SlotCount> _slots{};
+		std::mutex _mutex;
+
+		uint32_t _back{ 0 };
+		uint32_t _latest{ 0 };
+		uint32_t _previous{ 0 };
+		uint32_t _readPrevious{ 0 };
+		uint32_t _readLatest{ 0 };
+		uint64_t _step{ 0 };
+		Time::Clock::time_point _time{};
+	};
+
+	struct Settings
+	{
+		float stepSeconds{ 1.0f / 60.0f };
+
+		// Further behind than this many steps the backlog is dropped, the simulation then runs
+		// slower than real time instead of spiralling
+		uint32_t maxCatchUpSteps{ 8 };
+	};
+
+	// Runs a simulation at a fixed rate on its own thread. Every step is followed by a capture into
+	// an immutable snapshot, the render thread interpolates between the latest two with Acquire().
+	// The simulation only ever sees stepSeconds, so its results do not depend on the frame rate,
+	// and its cost overlaps the render thread's frame instead of adding to it. The step and capture
+	// functions own the simulation state, nothing else may touch it while the thread runs.
+	template<typename T>
+	class FixedStepThread final
+	{
+	public:
+		using StepFn = std::function<void(float stepSeconds)>;
+		using CaptureFn = std::function<void(T& snapshot)>;
+
+		struct Frame
+		{
+			const T& previous;
+			const T& latest;
+			float alpha;	// Render time between previous (0) and latest (1)
+			uint64_t step;
+		};
+
+		FixedStepThread() = default;
+		~FixedStepThread() { Stop(); }
+
+		FixedStepThread(const FixedStepThread&) = delete;
+		FixedStepThread& operator=(const FixedStepThread&) = delete;
+
+		// The first capture runs here on the calling thread, the render thread can Acquire() right away
+		void Start(StepFn step, CaptureFn capture, const Settings& settings = {})
+		{
+			Stop();
+
+			_stepFn = std::move(step);
+			_captureFn = std::move(capture);
+			_settings = settings;
+			_stepDuration = std::chrono::duration_cast<Time::Clock::duration>(Time::Duration(settings.stepSeconds));
+
+			const auto start = Time::Clock::now();
+			_captureFn(_snapshots.Back());
+			_snapshots.Publish(0, start);
+
+			_running = true;
+			_thread = std::thread([this, start] { run(start); });
+		}
+
+		void Stop()
+		{
+			if (!_thread.joinable())
+				return;
+
+			{
+				std::lock_guard lock(_wakeMutex);
+				_running = false;
+			}
+			_wake.notify_one();
+			_thread.join();
+		}
+
+		bool IsRunning() const { return _thread.joinable(); }
+
+		// The render time trails the simulation by one step, so it always falls between the pair
+		Frame Acquire()
+		{
+			const auto pair = _snapshots.Acquire();
+			const float sinceLatest = Time::Duration(Time::Clock::now() - pair.time).count();
+			const float alpha = std::clamp(sinceLatest / _settings.stepSeconds, 0.0f, 1.0f);
+			return { *pair.previous, *pair.latest, alpha, pair.step };
+		}
+
+	private:
+		// Waiting on the condition variable can oversleep by a whole scheduler tick, the last
+		// stretch before a step yields instead
+		static constexpr auto SpinMargin = std::chrono::milliseconds(2);
+
+		void run(Time::Clock::time_point start)
+		{
+			EUGENIX_PROFILE_THREAD("Simulation");
+
+			uint64_t step = 0;
+			auto next = start + _stepDuration;
+
+			while (true)
+			{
+				{
+					std::unique_lock lock(_wakeMutex);
+					_wake.wait_until(lock, next - SpinMargin, [this] { return !_running; });
+					if (!_running)
+						break;
+				}
+
+				while (Time::Clock::now() < next)
+					std::this_thread::yield();
+
+				for (uint32_t catchUp = 0; catchUp < _settings.maxCatchUpSteps && Time::Clock::now() >= next; ++catchUp)
+				{
+					{
+						EUGENIX_PROFILE_SCOPE("Simulation::Step");
+						_stepFn(_settings.stepSeconds);
+					}
+					{
+						EUGENIX_PROFILE_SCOPE("Simulation::Capture");
+						_captureFn(_snapshots.Back());
+					}
+
+					_snapshots.Publish(++step, next);
+					next += _stepDuration;
+				}
+
+				const auto now = Time::Clock::now();
+				if (now >= next)
+					next = now + _stepDuration;
+			}
+		}
+
+		StepFn _stepFn;
+		CaptureFn _captureFn;
+		Settings _settings;
+		Time::Clock::duration _stepDuration{};
+
+		SnapshotBuffer<T> _snapshots;
+
+		std::thread _thread;
+		std::mutex _wakeMutex;
+		std::condition_variable _wake;
+		bool _running{ false };
+	};
+} // namespace Eugenix::Simulation
@@ -0,0 +1,329 @@
+#include <algorithm>
+
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+
+#include "AsyncReader.h"
+#include "MappedFile.h"
+
+#if EUGENIX_IO_URING
+#	include <fcntl.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	include <liburing.h>
+#endif
+
+namespace Eugenix::IO
+{
+#if EUGENIX_IO_URING
+    struct AsyncReader::Ring
+    {
+        struct InFlight
+        {
+            Request request;
+            std::vector<std::byte> buffer;
+            size_t offset{};
+            int fd{ -1 };
+        };
+
+        io_uring ring{};
+
+        std::mutex pendingMutex;
+        std::condition_variable pendingCv;
+        std::deque<Request> pending;
+
+        size_t inFlight{ 0 };
+        bool stop{ false };
+    };
+#endif
+
+    AsyncReader::AsyncReader(uint32_t workerCount, [[maybe_unused]] uint32_t queueDepth)
+    {
+        if (workerCount == 0)
+            workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+        _workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; ++i)
+        {
+            _workers.emplace_back([this]
+                {
+                    EUGENIX_PROFILE_THREAD("IO Worker");
+                    workerLoop();
+                });
+        }
+
+#if EUGENIX_IO_URING
+        if (initRing(queueDepth))
+        {
+            _backend = AsyncReaderBackend::IoUring;
+            _ringThread = std::thread([this]
+                {
+                    EUGENIX_PROFILE_THREAD("IO Ring");
+                    ringLoop();
+                });
+        }
+        else
+        {
+            LogWarn("io_uring is not available, AsyncReader falls back to the thread pool");
+        }
+#endif
+    }
+
+    AsyncReader::~AsyncReader()
+    {
+        WaitIdle();
+
+#if EUGENIX_IO_URING
+        shutdownRing();
+#endif
+
+        {
+            std::lock_guard lock(_tasksMutex);
+            _stop = true;
+        }
+        _tasksCv.notify_all();
+
+        for (auto& worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    void AsyncReader::Read(std::filesystem::path path, ReadCallback onComplete)
+    {
+        {
+            std::lock_guard lock(_idleMutex);
+            ++_inFlight;
+        }
+
+        Request request{ std::move(path), std::move(onComplete) };
+
+#if EUGENIX_IO_URING
+        if (_backend == AsyncReaderBackend::IoUring)
+        {
+            {
+                std::lock_guard lock(_ring->pendingMutex);
+                _ring->pending.push_back(std::move(request));
+            }
+            _ring->pendingCv.notify_one();
+            return;
+        }
+#endif
+
+        enqueueTask([this, request = std::move(request)]() mutable
+            {
+                readBlocking(request);
+                finishRequest();
+            });
+    }
+
+    void AsyncReader::WaitIdle()
+    {
+        std::unique_lock lock(_idleMutex);
+        _idleCv.wait(lock, [this] { return _inFlight == 0; });
+    }
+
+    AsyncReader& SharedReader()
+    {
+        static AsyncReader reader{};
+        return reader;
+    }
+
+    void AsyncReader::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(_tasksMutex);
+                _tasksCv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+
+                if (_tasks.empty())
+                    return;
+
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+
+    void AsyncReader::enqueueTask(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(_tasksMutex);
+            _tasks.push_back(std::move(task));
+        }
+        _tasksCv.notify_one();
+    }
+
+    void AsyncReader::finishRequest()
+    {
+        {
+            std::lock_guard lock(_idleMutex);
+            --_inFlight;
+        }
+        _idleCv.notify_all();
+    }
+
+    void AsyncReader::readBlocking(Request& request)
+    {
+        EUGENIX_PROFILE_SCOPE("AsyncReader::Read");
+
+        // Thread pool path: the mapping is faulted in by the worker itself, then decoded in place
+        MappedFile file;
+        const bool ok = file.Open(request.path, AccessHint::WillNeed);
+
+        request.onComplete(ReadCompletion{ request.path, file.Bytes(), ok });
+    }
+
+#if EUGENIX_IO_URING
+    bool AsyncReader::initRing(uint32_t queueDepth)
+    {
+        _ring = std::make_unique<Ring>();
+        if (io_uring_queue_init(queueDepth, &_ring->ring, 0) < 0)
+        {
+            _ring.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void AsyncReader::shutdownRing()
+    {
+        if (!_ring)
+            return;
+
+        {
+            std::lock_guard lock(_ring->pendingMutex);
+            _ring->stop = true;
+        }
+        _ring->pendingCv.notify_one();
+        _ringThread.join();
+
+        io_uring_queue_exit(&_ring->ring);
+        _ring.reset();
+    }
+
+    void AsyncReader::ringLoop()
+    {
+        using InFlight = Ring::InFlight;
+
+        auto complete = [this](InFlight* op, bool ok)
+            {
+                if (op->fd >= 0)
+                    ::close(op->fd);
+
+                enqueueTask([this, op, ok]
+                    {
+                        std::unique_ptr<InFlight> owned{ op };
+                        owned->request.onComplete(ReadCompletion{ owned->request.path,
+                            std::span<const std::byte>{ owned->buffer.data(), owned->offset }, ok });
+                        finishRequest();
+                    });
+            };
+
+        auto queueRead = [this](InFlight* op)
+            {
+                io_uring_sqe* sqe = io_uring_get_sqe(&_ring->ring);
+                if (!sqe)
+                {
+                    // SQ is full: flush what we have and retry
+                    io_uring_submit(&_ring->ring);
+                    sqe = io_uring_get_sqe(&_ring->ring);
+                }
+
+                const size_t remaining = op->buffer.size() - op->offset;
+                io_uring_prep_read(sqe, op->fd, op->buffer.data() + op->offset,
+                    static_cast<unsigned>(std::min<size_t>(remaining, 1u << 30)), op->offset);
+                io_uring_sqe_set_data(sqe, op);
+                ++_ring->inFlight;
+            };
+
+        std::deque<Request> batch;
+
+        while (true)
+        {
+            {
+                std::unique_lock lock(_ring->pendingMutex);
+                if (_ring->inFlight == 0)
+                {
+                    _ring->pendingCv.wait(lock, [this] { return _ring->stop || !_ring->pending.empty(); });
+                    if (_ring->stop && _ring->pending.empty())
+                        return;
+                }
+                batch.swap(_ring->pending);
+            }
+
+            // Everything queued since the last iteration goes to the kernel in a single submit
+            for (auto& request : batch)
+            {
+                auto* op = new InFlight{ std::move(request) };
+
+                op->fd = ::open(op->request.path.c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat st{};
+                if (op->fd < 0 || ::fstat(op->fd, &st) != 0)
+                {
+                    LogError("AsyncReader: failed to open {}", op->request.path.string());
+                    complete(op, false);
+                    continue;
+                }
+
+                op->buffer.resize(static_cast<size_t>(st.st_size));
+                if (op->buffer.empty())
+                {
+                    complete(op, true);
+                    continue;
+                }
+
+                queueRead(op);
+            }
+            batch.clear();
+
+            if (_ring->inFlight == 0)
+                continue;
+
+            io_uring_submit(&_ring->ring);
+
+            // Reap whatever is ready, block briefly so new requests still get picked up promptly
+            __kernel_timespec timeout{ 0, 1'000'000 };
+            io_uring_cqe* cqe = nullptr;
+            if (io_uring_wait_cqe_timeout(&_ring->ring, &cqe, &timeout) != 0)
+                continue;
+
+            unsigned head;
+            unsigned reaped = 0;
+            bool resubmit = false;
+            io_uring_for_each_cqe(&_ring->ring, head, cqe)
+            {
+                ++reaped;
+                --_ring->inFlight;
+
+                auto* op = static_cast<InFlight*>(io_uring_cqe_get_data(cqe));
+                if (cqe->res < 0)
+                {
+                    LogError("AsyncReader: read failed for {}", op->request.path.string());
+                    complete(op, false);
+                    continue;
+                }
+
+                op->offset += static_cast<size_t>(cqe->res);
+                if (cqe->res > 0 && op->offset < op->buffer.size())
+                {
+                    // Short read, continue from where the kernel stopped
+                    queueRead(op);
+                    resubmit = true;
+                    continue;
+                }
+
+                complete(op, op->offset == op->buffer.size());
+            }
+            io_uring_cq_advance(&_ring->ring, reaped);
+
+            if (resubmit)
+                io_uring_submit(&_ring->ring);
+        }
+    }
+#endif
+} // namespace Eugenix::IO
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// io_uring backend needs liburing (headers + -luring). Define EUGENIX_IO_URING 0 to force the thread pool.
+#ifndef EUGENIX_IO_URING
+#	if defined(__linux__) && !defined(__ANDROID__) && __has_include(<liburing.h>)
+#		define EUGENIX_IO_URING 1
+#	else
+#		define EUGENIX_IO_URING 0
+#	endif
+#endif
+
+namespace Eugenix::IO
+{
+    struct ReadCompletion
+    {
+        const std::filesystem::path& path;
+        std::span<const std::byte> data;
+        bool ok{ false };
+    };
+
+    // Called on a worker thread once the whole file is in memory. The span is only valid inside the call.
+    using ReadCallback = std::function<void(const ReadCompletion&)>;
+
+    enum struct AsyncReaderBackend
+    {
+        ThreadPool,
+        IoUring
+    };
+
+    // Batched asynchronous file reader.
+    // Requests queued with Read()/Load() are handed to the backend in one go (one io_uring submission
+    // per batch on Linux), completions run on a small worker pool so decoding overlaps the remaining I/O.
+    class AsyncReader final
+    {
+    public:
+        // workerCount == 0 picks hardware_concurrency - 1
+        explicit AsyncReader(uint32_t workerCount = 0, uint32_t queueDepth = 64);
+        ~AsyncReader();
+
+        AsyncReader(const AsyncReader&) = delete;
+        AsyncReader& operator=(const AsyncReader&) = delete;
+
+        void Read(std::filesystem::path path, ReadCallback onComplete);
+
+        // Reads the file and runs decode(std::span<const std::byte>) on a worker, the result lands in the future
+        template<typename Decode>
+        auto Load(std::filesystem::path path, Decode&& decode)
+            -> std::future<std::invoke_result_t<Decode&, std::span<const std::byte>>>
+        {
+            using Result = std::invoke_result_t<Decode&, std::span<const std::byte>>;
+
+            auto promise = std::make_shared<std::promise<Result>>();
+            auto future = promise->get_future();
+
+            Read(std::move(path), [promise, decode = std::forward<Decode>(decode)](const ReadCompletion& completion) mutable
+                {
+                    try
+                    {
+                        if (!completion.ok)
+                            throw std::runtime_error("AsyncReader: failed to read " + completion.path.string());
+
+                        if constexpr (std::is_void_v<Result>)
+                        {
+                            decode(completion.data);
+                            promise->set_value();
+                        }
+                        else
+                        {
+                            promise->set_value(decode(completion.data));
+                        }
+                    }
+                    catch (...)
+                    {
+                        promise->set_exception(std::current_exception());
+                    }
+                });
+
+            return future;
+        }
+
+        // Blocks until every queued request has completed
+        void WaitIdle();
+
+        AsyncReaderBackend Backend() const { return _backend; }
+
+    private:
+        struct Request
+        {
+            std::filesystem::path path;
+            ReadCallback onComplete;
+        };
+
+        void workerLoop();
+        void enqueueTask(std::function<void()> task);
+        void finishRequest();
+
+        void readBlocking(Request& request);
+
+#if EUGENIX_IO_URING
+        bool initRing(uint32_t queueDepth);
+        void ringLoop();
+        void shutdownRing();
+
+        struct Ring;
+        std::unique_ptr<Ring> _ring;
+        std::thread _ringThread;
+#endif
+
+        AsyncReaderBackend _backend{ AsyncReaderBackend::ThreadPool };
+
+        std::vector<std::thread> _workers;
+        std::deque<std::function<void()>> _tasks;
+        std::mutex _tasksMutex;
+        std::condition_variable _tasksCv;
+
+        std::mutex _idleMutex;
+        std::condition_variable _idleCv;
+        size_t _inFlight{ 0 };
+
+        bool _stop{ false };
+    };
+
+    // Process-wide reader for asset loads, created on first use so loads do not each set up and
+    // tear down a ring and a worker pool. Read()/Load() are safe to call from any thread.
+    AsyncReader& SharedReader();
+} // namespace Eugenix::IO
@@ -8,6 +8,8 @@
 #include <string_view>
 #include <vector>
 
+#include "MappedFile.h"
+
 // TODO : move to .cpp
 namespace
 {
@@ -55,5 +57,13 @@ namespace Eugenix::IO
         {
             return ReadFile(path, std::ios::binary, /*addNullTerminator=*/false);
         }
+
+        // Zero-copy alternative to ReadText/ReadBinary. Note: mapped text is not null-terminated.
+        static MappedFile Map(const std::filesystem::path& path, AccessHint hint = AccessHint::Sequential)
+        {
+            MappedFile file;
+            file.Open(path, hint);
+            return file;
+        }
     };
 } // namespace Eugenix::IO
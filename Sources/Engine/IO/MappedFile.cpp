@@ -0,0 +1,168 @@
+#include "Core/Log.h"
+#include "Core/Platform.h"
+
+#include "MappedFile.h"
+
+#if !EUGENIX_PLATFORM_WINDOWS
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace
+{
+#if !EUGENIX_PLATFORM_WINDOWS
+    int toMAdvice(Eugenix::IO::AccessHint hint)
+    {
+        switch (hint)
+        {
+        case Eugenix::IO::AccessHint::Sequential: return MADV_SEQUENTIAL;
+        case Eugenix::IO::AccessHint::Random: return MADV_RANDOM;
+        case Eugenix::IO::AccessHint::WillNeed: return MADV_WILLNEED;
+        default: return MADV_NORMAL;
+        }
+    }
+#endif
+}
+
+namespace Eugenix::IO
+{
+#if EUGENIX_PLATFORM_WINDOWS
+    bool MappedFile::Open(const std::filesystem::path& path, AccessHint hint)
+    {
+        Close();
+
+        const DWORD flags = hint == AccessHint::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN;
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            LogError("Failed to open file for mapping: {}", path.string());
+            return false;
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size))
+        {
+            LogError("Failed to query file size: {}", path.string());
+            CloseHandle(file);
+            return false;
+        }
+
+        _file = file;
+        _size = static_cast<size_t>(size.QuadPart);
+        _opened = true;
+
+        // Zero-sized files can't be mapped, an empty span is a valid result for them
+        if (_size == 0)
+            return true;
+
+        _mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!_mapping)
+        {
+            LogError("CreateFileMapping failed: {}", path.string());
+            Close();
+            return false;
+        }
+
+        _data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!_data)
+        {
+            LogError("MapViewOfFile failed: {}", path.string());
+            Close();
+            return false;
+        }
+
+        Advise(hint);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (_data)
+            UnmapViewOfFile(_data);
+        if (_mapping)
+            CloseHandle(_mapping);
+        if (_file)
+            CloseHandle(_file);
+
+        _data = nullptr;
+        _mapping = nullptr;
+        _file = nullptr;
+        _size = 0;
+        _opened = false;
+    }
+
+    void MappedFile::Advise(AccessHint hint) const
+    {
+        if (!_data || hint != AccessHint::WillNeed)
+            return;
+
+        WIN32_MEMORY_RANGE_ENTRY range{ const_cast<void*>(_data), _size };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    bool MappedFile::Open(const std::filesystem::path& path, AccessHint hint)
+    {
+        Close();
+
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            LogError("Failed to open file for mapping: {}", path.string());
+            return false;
+        }
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            LogError("Failed to query file size: {}", path.string());
+            ::close(fd);
+            return false;
+        }
+
+        _size = static_cast<size_t>(st.st_size);
+        _opened = true;
+
+        if (_size == 0)
+        {
+            ::close(fd);
+            return true;
+        }
+
+        void* data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            LogError("mmap failed: {}", path.string());
+            Close();
+            return false;
+        }
+
+        _data = data;
+
+        Advise(hint);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (_data)
+            ::munmap(const_cast<void*>(_data), _size);
+
+        _data = nullptr;
+        _size = 0;
+        _opened = false;
+    }
+
+    void MappedFile::Advise(AccessHint hint) const
+    {
+        if (!_data)
+            return;
+
+        ::madvise(const_cast<void*>(_data), _size, toMAdvice(hint));
+    }
+#endif
+} // namespace Eugenix::IO
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "Core/Platform.h"
+
+namespace Eugenix::IO
+{
+    // How the mapped range is going to be touched. Forwarded to the OS as a read-ahead hint.
+    enum struct AccessHint
+    {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed
+    };
+
+    // Read-only view of a whole file mapped into the address space.
+    // Pages are faulted in lazily by the OS, so nothing is copied until the data is actually read.
+    class MappedFile final
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept { swap(other); }
+        MappedFile& operator=(MappedFile&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Close();
+                swap(other);
+            }
+            return *this;
+        }
+
+        bool Open(const std::filesystem::path& path, AccessHint hint = AccessHint::Sequential);
+        void Close();
+
+        // Re-applies an access hint to an already opened mapping (e.g. WillNeed right before parsing)
+        void Advise(AccessHint hint) const;
+
+        bool IsOpen() const { return _opened; }
+        size_t Size() const { return _size; }
+
+        std::span<const std::byte> Bytes() const { return { static_cast<const std::byte*>(_data), _size }; }
+        std::string_view Text() const { return { static_cast<const char*>(_data), _size }; }
+
+    private:
+        void swap(MappedFile& other) noexcept
+        {
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+            std::swap(_opened, other._opened);
+#if EUGENIX_PLATFORM_WINDOWS
+            std::swap(_file, other._file);
+            std::swap(_mapping, other._mapping);
+#endif
+        }
+
+        const void* _data{ nullptr };
+        size_t _size{};
+        bool _opened{ false };
+
+#if EUGENIX_PLATFORM_WINDOWS
+        void* _file{ nullptr };
+        void* _mapping{ nullptr };
+#endif
+    };
+} // namespace Eugenix::IO
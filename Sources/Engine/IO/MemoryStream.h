@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <span>
+#include <streambuf>
+
+namespace Eugenix::IO
+{
+    // std::istream over externally owned memory (e.g. a MappedFile) for parsers that only accept streams.
+    // Unlike std::istringstream the bytes are not copied.
+    class MemoryStreamBuf final : public std::streambuf
+    {
+    public:
+        explicit MemoryStreamBuf(std::span<const std::byte> data)
+        {
+            char* begin = const_cast<char*>(reinterpret_cast<const char*>(data.data()));
+            setg(begin, begin, begin + data.size());
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override
+        {
+            char* target = nullptr;
+            switch (dir)
+            {
+            case std::ios_base::beg: target = eback() + off; break;
+            case std::ios_base::cur: target = gptr() + off; break;
+            case std::ios_base::end: target = egptr() + off; break;
+            default: return pos_type(off_type(-1));
+            }
+
+            if (target < eback() || target > egptr())
+                return pos_type(off_type(-1));
+
+            setg(eback(), target, egptr());
+            return pos_type(target - eback());
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode mode) override
+        {
+            return seekoff(off_type(pos), std::ios_base::beg, mode);
+        }
+    };
+
+    class MemoryStream final : public std::istream
+    {
+    public:
+        explicit MemoryStream(std::span<const std::byte> data)
+            : std::istream(nullptr)
+            , _buffer(data)
+        {
+            rdbuf(&_buffer);
+        }
+
+    private:
+        MemoryStreamBuf _buffer;
+    };
+} // namespace Eugenix::IO
@@ -0,0 +1,55 @@
+#include "Simd.h"
+
+#if EUGENIX_ARCH_X64 && EUGENIX_COMPILER_MSVC
+#	include <intrin.h>
+#endif
+
+namespace
+{
+	using namespace Eugenix::Math;
+
+	SimdLevel detect()
+	{
+#if EUGENIX_ARCH_X64 && EUGENIX_COMPILER_MSVC
+		int info[4]{};
+		__cpuid(info, 1);
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+
+		// The OS has to save the YMM registers on context switches
+		const bool ymmState = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+		__cpuidex(info, 7, 0);
+		const bool avx2 = (info[1] & (1 << 5)) != 0;
+
+		return avx && avx2 && fma && ymmState ? SimdLevel::AVX2 : SimdLevel::SSE;
+#elif EUGENIX_ARCH_X64
+		// Also checks the OS support through XGETBV
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? SimdLevel::AVX2 : SimdLevel::SSE;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+}
+
+namespace Eugenix::Math
+{
+	SimdLevel DetectedSimdLevel()
+	{
+		static const SimdLevel level = detect();
+		return level;
+	}
+
+	const char* SimdLevelName(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::Scalar: return "Scalar";
+		case SimdLevel::SSE:    return "SSE";
+		case SimdLevel::AVX2:   return "AVX2";
+		}
+		return "Unknown";
+	}
+} // namespace Eugenix::Math
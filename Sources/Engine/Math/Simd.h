@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Core/Platform.h"
+
+// Kernels above the x64 baseline (SSE2) are compiled per function and picked at runtime,
+// so one binary runs everywhere. MSVC accepts the intrinsics without extra flags.
+#if EUGENIX_ARCH_X64 && (EUGENIX_COMPILER_GCC || EUGENIX_COMPILER_CLANG)
+#	define EUGENIX_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#	define EUGENIX_TARGET_AVX2
+#endif
+
+namespace Eugenix::Math
+{
+	enum class SimdLevel : uint8_t
+	{
+		Scalar,
+		SSE,	// SSE2, always there on x64
+		AVX2,	// AVX2 + FMA
+	};
+
+	// Best level supported by both the CPU and the OS, detected once
+	SimdLevel DetectedSimdLevel();
+
+	// Clamps a requested level to what this machine can run
+	inline SimdLevel SupportedSimdLevel(SimdLevel requested)
+	{
+		const SimdLevel detected = DetectedSimdLevel();
+		return requested < detected ? requested : detected;
+	}
+
+	const char* SimdLevelName(SimdLevel level);
+} // namespace Eugenix::Math
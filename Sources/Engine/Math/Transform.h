@@ -1,19 +1,45 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "TransformBatch.h"
 
 namespace Eugenix::Math
 {
+	// Owns its model matrix, or views a slot of a TransformBatch. A view edits the batch's
+	// position/rotation/scale and Matrix() returns the world matrix of the batch's last Update().
 	struct Transform
 	{
+		Transform() = default;
+
+		Transform(TransformBatch& batch, uint32_t index)
+			: _batch(&batch)
+			, _index(index)
+		{
+		}
+
 		void Translate(const glm::vec3& translate)
 		{
+			if (_batch)
+			{
+				_batch->Translate(_index, translate);
+				return;
+			}
+
 			_modelMatrix = glm::translate(_modelMatrix, translate);
 		}
 
 		// in degrees
 		void Rotate(const glm::vec3& rotation)
 		{
+			if (_batch)
+			{
+				_batch->Rotate(_index, EulerToQuat(rotation));
+				return;
+			}
+
 			_modelMatrix = glm::rotate(_modelMatrix, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
 			_modelMatrix = glm::rotate(_modelMatrix, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
 			_modelMatrix = glm::rotate(_modelMatrix, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
@@ -21,19 +47,74 @@ namespace Eugenix::Math
 
 		void Scale(const glm::vec3& scale)
 		{
+			if (_batch)
+			{
+				_batch->Scale(_index, scale);
+				return;
+			}
+
 			_modelMatrix = glm::scale(_modelMatrix, scale);
 		}
 
 		void Reset()
 		{
+			if (_batch)
+			{
+				_batch->Reset(_index);
+				return;
+			}
+
 			_modelMatrix = glm::mat4{ 1.0f };
 		}
 
 		const glm::mat4& Matrix() const
 		{
-			return _modelMatrix;
+			return _batch ? _batch->World(_index) : _modelMatrix;
 		}
+
+		bool IsView() const { return _batch != nullptr; }
+
 	private:
 		glm::mat4 _modelMatrix{ 1.0f };
+
+		TransformBatch* _batch{ nullptr };
+		uint32_t _index{ 0 };
 	};
-} // Eugenix::Math
\ No newline at end of file
+
+	// Blends two world matrices by translation, rotation (shortest arc) and scale. Blending the
+	// elements would shrink a rotating object halfway between two steps. Shear and mirroring
+	// are not kept.
+	inline glm::mat4 Interpolate(const glm::mat4& from, const glm::mat4& to, float alpha)
+	{
+		if (from == to)
+			return to;
+
+		auto scaleOf = [](const glm::mat4& m)
+			{
+				return glm::vec3(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+			};
+		auto rotationOf = [](const glm::mat4& m, const glm::vec3& scale)
+			{
+				return glm::quat_cast(glm::mat3(glm::vec3(m[0]) / scale.x, glm::vec3(m[1]) / scale.y, glm::vec3(m[2]) / scale.z));
+			};
+
+		const glm::vec3 fromScale = scaleOf(from);
+		const glm::vec3 toScale = scaleOf(to);
+
+		// A collapsed axis (e.g. scaled to 0 to hide the node) has no rotation to recover, the
+		// element-wise blend shrinks or grows it without dividing by zero
+		constexpr float MinScale = 1e-6f;
+		if (glm::any(glm::lessThan(glm::min(fromScale, toScale), glm::vec3(MinScale))))
+			return from * (1.0f - alpha) + to * alpha;
+
+		const glm::vec3 position = glm::mix(glm::vec3(from[3]), glm::vec3(to[3]), alpha);
+		const glm::vec3 scale = glm::mix(fromScale, toScale, alpha);
+		const glm::mat3 rotation = glm::mat3_cast(glm::slerp(rotationOf(from, fromScale), rotationOf(to, toScale), alpha));
+
+		return glm::mat4(
+			glm::vec4(rotation[0] * scale.x, 0.0f),
+			glm::vec4(rotation[1] * scale.y, 0.0f),
+			glm::vec4(rotation[2] * scale.z, 0.0f),
+			glm::vec4(position, 1.0f));
+	}
+} // Eugenix::Math
@@ -0,0 +1,357 @@
+#include "TransformBatch.h"
+
+#include "Core/Profiler.h"
+
+#if EUGENIX_ARCH_X64
+#	include <immintrin.h>
+#endif
+
+namespace
+{
+	using namespace Eugenix::Math;
+
+	struct Streams
+	{
+		const float* px;
+		const float* py;
+		const float* pz;
+		const float* qx;
+		const float* qy;
+		const float* qz;
+		const float* qw;
+		const float* sx;
+		const float* sy;
+		const float* sz;
+		float* world; // 16 floats per transform, column-major like glm::mat4
+	};
+
+	// Rotation columns of a unit quaternion, scaled by the axis scales
+	void composeScalar(const Streams& s, uint32_t first, uint32_t last)
+	{
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const float x = s.qx[i], y = s.qy[i], z = s.qz[i], w = s.qw[i];
+			const float x2 = x + x, y2 = y + y, z2 = z + z;
+			const float xx = x * x2, yy = y * y2, zz = z * z2;
+			const float xy = x * y2, xz = x * z2, yz = y * z2;
+			const float wx = w * x2, wy = w * y2, wz = w * z2;
+
+			float* m = s.world + size_t(i) * 16;
+
+			m[0] = (1.0f - (yy + zz)) * s.sx[i];
+			m[1] = (xy + wz) * s.sx[i];
+			m[2] = (xz - wy) * s.sx[i];
+			m[3] = 0.0f;
+
+			m[4] = (xy - wz) * s.sy[i];
+			m[5] = (1.0f - (xx + zz)) * s.sy[i];
+			m[6] = (yz + wx) * s.sy[i];
+			m[7] = 0.0f;
+
+			m[8] = (xz + wy) * s.sz[i];
+			m[9] = (yz - wx) * s.sz[i];
+			m[10] = (1.0f - (xx + yy)) * s.sz[i];
+			m[11] = 0.0f;
+
+			m[12] = s.px[i];
+			m[13] = s.py[i];
+			m[14] = s.pz[i];
+			m[15] = 1.0f;
+		}
+	}
+
+#if EUGENIX_ARCH_X64
+	// Lanes hold 4 transforms, transposed back so each transform gets its column as one store
+	void storeColumnSSE(float* world, uint32_t column, __m128 x, __m128 y, __m128 z, __m128 w)
+	{
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(world + 0 * 16 + column * 4, x);
+		_mm_storeu_ps(world + 1 * 16 + column * 4, y);
+		_mm_storeu_ps(world + 2 * 16 + column * 4, z);
+		_mm_storeu_ps(world + 3 * 16 + column * 4, w);
+	}
+
+	uint32_t composeSSE(const Streams& s, uint32_t first, uint32_t last)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 zero = _mm_setzero_ps();
+
+		uint32_t i = first;
+		for (; i + 4 <= last; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(s.qx + i);
+			const __m128 y = _mm_loadu_ps(s.qy + i);
+			const __m128 z = _mm_loadu_ps(s.qz + i);
+			const __m128 w = _mm_loadu_ps(s.qw + i);
+
+			const __m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+			const __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+			const __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+			const __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+			const __m128 sx = _mm_loadu_ps(s.sx + i);
+			const __m128 sy = _mm_loadu_ps(s.sy + i);
+			const __m128 sz = _mm_loadu_ps(s.sz + i);
+
+			float* world = s.world + size_t(i) * 16;
+
+			storeColumnSSE(world, 0,
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx),
+				_mm_mul_ps(_mm_add_ps(xy, wz), sx),
+				_mm_mul_ps(_mm_sub_ps(xz, wy), sx),
+				zero);
+
+			storeColumnSSE(world, 1,
+				_mm_mul_ps(_mm_sub_ps(xy, wz), sy),
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+				_mm_mul_ps(_mm_add_ps(yz, wx), sy),
+				zero);
+
+			storeColumnSSE(world, 2,
+				_mm_mul_ps(_mm_add_ps(xz, wy), sz),
+				_mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz),
+				zero);
+
+			storeColumnSSE(world, 3, _mm_loadu_ps(s.px + i), _mm_loadu_ps(s.py + i), _mm_loadu_ps(s.pz + i), one);
+		}
+		return i;
+	}
+
+	// 4x8 transpose: lane k of the 128-bit halves gets transform k (low) and k + 4 (high)
+	EUGENIX_TARGET_AVX2 void transposeAVX(__m256& x, __m256& y, __m256& z, __m256& w)
+	{
+		const __m256 t0 = _mm256_unpacklo_ps(x, y);
+		const __m256 t1 = _mm256_unpackhi_ps(x, y);
+		const __m256 t2 = _mm256_unpacklo_ps(z, w);
+		const __m256 t3 = _mm256_unpackhi_ps(z, w);
+
+		x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		w = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	// Two adjacent columns of 8 transforms, written as one 32 byte store per transform
+	EUGENIX_TARGET_AVX2 void storeColumnPairAVX(float* world, uint32_t column,
+		__m256 ax, __m256 ay, __m256 az, __m256 aw,
+		__m256 bx, __m256 by, __m256 bz, __m256 bw)
+	{
+		transposeAVX(ax, ay, az, aw);
+		transposeAVX(bx, by, bz, bw);
+
+		const __m256 a[4] = { ax, ay, az, aw };
+		const __m256 b[4] = { bx, by, bz, bw };
+
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			_mm256_storeu_ps(world + k * 16 + column * 4, _mm256_permute2f128_ps(a[k], b[k], 0x20));
+			_mm256_storeu_ps(world + (k + 4) * 16 + column * 4, _mm256_permute2f128_ps(a[k], b[k], 0x31));
+		}
+	}
+
+	EUGENIX_TARGET_AVX2 uint32_t composeAVX2(const Streams& s, uint32_t first, uint32_t last)
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 zero = _mm256_setzero_ps();
+
+		uint32_t i = first;
+		for (; i + 8 <= last; i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(s.qx + i);
+			const __m256 y = _mm256_loadu_ps(s.qy + i);
+			const __m256 z = _mm256_loadu_ps(s.qz + i);
+			const __m256 w = _mm256_loadu_ps(s.qw + i);
+
+			const __m256 x2 = _mm256_add_ps(x, x), y2 = _mm256_add_ps(y, y), z2 = _mm256_add_ps(z, z);
+			const __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+			const __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+
+			// w * a +- b folded into one FMA
+			const __m256 xyPlusWz = _mm256_fmadd_ps(w, z2, xy);
+			const __m256 xyMinusWz = _mm256_fnmadd_ps(w, z2, xy);
+			const __m256 xzPlusWy = _mm256_fmadd_ps(w, y2, xz);
+			const __m256 xzMinusWy = _mm256_fnmadd_ps(w, y2, xz);
+			const __m256 yzPlusWx = _mm256_fmadd_ps(w, x2, yz);
+			const __m256 yzMinusWx = _mm256_fnmadd_ps(w, x2, yz);
+
+			const __m256 sx = _mm256_loadu_ps(s.sx + i);
+			const __m256 sy = _mm256_loadu_ps(s.sy + i);
+			const __m256 sz = _mm256_loadu_ps(s.sz + i);
+
+			float* world = s.world + size_t(i) * 16;
+
+			storeColumnPairAVX(world, 0,
+				_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+				_mm256_mul_ps(xyPlusWz, sx),
+				_mm256_mul_ps(xzMinusWy, sx),
+				zero,
+				_mm256_mul_ps(xyMinusWz, sy),
+				_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+				_mm256_mul_ps(yzPlusWx, sy),
+				zero);
+
+			storeColumnPairAVX(world, 2,
+				_mm256_mul_ps(xzPlusWy, sz),
+				_mm256_mul_ps(yzMinusWx, sz),
+				_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+				zero,
+				_mm256_loadu_ps(s.px + i),
+				_mm256_loadu_ps(s.py + i),
+				_mm256_loadu_ps(s.pz + i),
+				one);
+		}
+		return i;
+	}
+#endif
+}
+
+namespace Eugenix::Math
+{
+	uint32_t TransformBatch::Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		const uint32_t index = Size();
+
+		_positionX.push_back(position.x);
+		_positionY.push_back(position.y);
+		_positionZ.push_back(position.z);
+
+		_rotationX.push_back(rotation.x);
+		_rotationY.push_back(rotation.y);
+		_rotationZ.push_back(rotation.z);
+		_rotationW.push_back(rotation.w);
+
+		_scaleX.push_back(scale.x);
+		_scaleY.push_back(scale.y);
+		_scaleZ.push_back(scale.z);
+
+		_world.emplace_back(1.0f);
+
+		return index;
+	}
+
+	void TransformBatch::Reserve(uint32_t capacity)
+	{
+		for (auto* stream : { &_positionX, &_positionY, &_positionZ, &_rotationX, &_rotationY, &_rotationZ, &_rotationW, &_scaleX, &_scaleY, &_scaleZ })
+			stream->reserve(capacity);
+		_world.reserve(capacity);
+	}
+
+	void TransformBatch::Clear()
+	{
+		for (auto* stream : { &_positionX, &_positionY, &_positionZ, &_rotationX, &_rotationY, &_rotationZ, &_rotationW, &_scaleX, &_scaleY, &_scaleZ })
+			stream->clear();
+		_world.clear();
+	}
+
+	void TransformBatch::Remove(uint32_t index)
+	{
+		const uint32_t last = Size() - 1;
+		for (auto* stream : { &_positionX, &_positionY, &_positionZ, &_rotationX, &_rotationY, &_rotationZ, &_rotationW, &_scaleX, &_scaleY, &_scaleZ })
+		{
+			(*stream)[index] = (*stream)[last];
+			stream->pop_back();
+		}
+		_world[index] = _world[last];
+		_world.pop_back();
+	}
+
+	void TransformBatch::SetPosition(uint32_t index, const glm::vec3& position)
+	{
+		_positionX[index] = position.x;
+		_positionY[index] = position.y;
+		_positionZ[index] = position.z;
+	}
+
+	void TransformBatch::SetRotation(uint32_t index, const glm::quat& rotation)
+	{
+		_rotationX[index] = rotation.x;
+		_rotationY[index] = rotation.y;
+		_rotationZ[index] = rotation.z;
+		_rotationW[index] = rotation.w;
+	}
+
+	void TransformBatch::SetScale(uint32_t index, const glm::vec3& scale)
+	{
+		_scaleX[index] = scale.x;
+		_scaleY[index] = scale.y;
+		_scaleZ[index] = scale.z;
+	}
+
+	glm::vec3 TransformBatch::Position(uint32_t index) const
+	{
+		return { _positionX[index], _positionY[index], _positionZ[index] };
+	}
+
+	glm::quat TransformBatch::Rotation(uint32_t index) const
+	{
+		return { _rotationW[index], _rotationX[index], _rotationY[index], _rotationZ[index] };
+	}
+
+	glm::vec3 TransformBatch::Scale(uint32_t index) const
+	{
+		return { _scaleX[index], _scaleY[index], _scaleZ[index] };
+	}
+
+	void TransformBatch::Translate(uint32_t index, const glm::vec3& translate)
+	{
+		// M * T(t) = T(p + R * (S * t)) * R * S
+		SetPosition(index, Position(index) + Rotation(index) * (Scale(index) * translate));
+	}
+
+	void TransformBatch::Rotate(uint32_t index, const glm::quat& rotation)
+	{
+		SetRotation(index, glm::normalize(Rotation(index) * rotation));
+	}
+
+	void TransformBatch::Scale(uint32_t index, const glm::vec3& scale)
+	{
+		SetScale(index, Scale(index) * scale);
+	}
+
+	void TransformBatch::Reset(uint32_t index)
+	{
+		SetPosition(index, glm::vec3{ 0.0f });
+		SetRotation(index, glm::quat{ 1.0f, 0.0f, 0.0f, 0.0f });
+		SetScale(index, glm::vec3{ 1.0f });
+	}
+
+	void TransformBatch::Update(SimdLevel level)
+	{
+		EUGENIX_PROFILE_COUNTERS_SCOPE("TransformBatch::Update");
+
+		Update(0, Size(), level);
+	}
+
+	void TransformBatch::Update(uint32_t first, uint32_t last, SimdLevel level)
+	{
+		const Streams streams
+		{
+			_positionX.data(), _positionY.data(), _positionZ.data(),
+			_rotationX.data(), _rotationY.data(), _rotationZ.data(), _rotationW.data(),
+			_scaleX.data(), _scaleY.data(), _scaleZ.data(),
+			reinterpret_cast<float*>(_world.data())
+		};
+
+		uint32_t i = first;
+
+#if EUGENIX_ARCH_X64
+		switch (SupportedSimdLevel(level))
+		{
+		case SimdLevel::AVX2:
+			i = composeAVX2(streams, i, last);
+			// The remaining 0-7 go through SSE first
+			[[fallthrough]];
+		case SimdLevel::SSE:
+			i = composeSSE(streams, i, last);
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+#else
+		(void)level;
+#endif
+
+		composeScalar(streams, i, last);
+	}
+} // namespace Eugenix::Math
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Simd.h"
+
+namespace Eugenix::Math
+{
+	// Same order as Transform::Rotate: X, then Y, then Z, in degrees
+	inline glm::quat EulerToQuat(const glm::vec3& degrees)
+	{
+		return glm::angleAxis(glm::radians(degrees.x), glm::vec3(1.0f, 0.0f, 0.0f))
+			* glm::angleAxis(glm::radians(degrees.y), glm::vec3(0.0f, 1.0f, 0.0f))
+			* glm::angleAxis(glm::radians(degrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	}
+
+	// Positions, rotations and scales of many objects as separate float arrays (structure of arrays).
+	// Update() composes world = T * R * S for all of them with the widest kernel the CPU supports,
+	// 4 (SSE) or 8 (AVX2) transforms per iteration.
+	// Not thread-safe, but disjoint Update(first, last) ranges can run in parallel.
+	class TransformBatch final
+	{
+	public:
+		uint32_t Add(const glm::vec3& position = glm::vec3{ 0.0f },
+			const glm::quat& rotation = glm::quat{ 1.0f, 0.0f, 0.0f, 0.0f },
+			const glm::vec3& scale = glm::vec3{ 1.0f });
+
+		// Moves the last transform into the slot of the removed one
+		void Remove(uint32_t index);
+
+		void Reserve(uint32_t capacity);
+		void Clear();
+
+		uint32_t Size() const { return static_cast<uint32_t>(_world.size()); }
+
+		void SetPosition(uint32_t index, const glm::vec3& position);
+		void SetRotation(uint32_t index, const glm::quat& rotation);
+		void SetScale(uint32_t index, const glm::vec3& scale);
+
+		glm::vec3 Position(uint32_t index) const;
+		glm::quat Rotation(uint32_t index) const;
+		glm::vec3 Scale(uint32_t index) const;
+
+		// Local space edits with the semantics of Transform. Rotating after a non-uniform scale
+		// keeps the scale on the object's axes, a matrix would shear instead.
+		void Translate(uint32_t index, const glm::vec3& translate);
+		void Rotate(uint32_t index, const glm::quat& rotation);
+		void Scale(uint32_t index, const glm::vec3& scale);
+		void Reset(uint32_t index);
+
+		// Composes the world matrices, the level is clamped to what the CPU supports.
+		// The ranged version is not profiled, it is meant for callers splitting the batch into chunks.
+		void Update(SimdLevel level = DetectedSimdLevel());
+		void Update(uint32_t first, uint32_t last, SimdLevel level = DetectedSimdLevel());
+
+		// Valid until the next Add(), Remove() or Clear(), values as of the last Update()
+		const glm::mat4& World(uint32_t index) const { return _world[index]; }
+		std::span<const glm::mat4> Worlds() const { return _world; }
+
+	private:
+		std::vector<float> _positionX;
+		std::vector<float> _positionY;
+		std::vector<float> _positionZ;
+
+		std::vector<float> _rotationX;
+		std::vector<float> _rotationY;
+		std::vector<float> _rotationZ;
+		std::vector<float> _rotationW;
+
+		std::vector<float> _scaleX;
+		std::vector<float> _scaleY;
+		std::vector<float> _scaleZ;
+
+		std::vector<glm::mat4> _world;
+	};
+} // namespace Eugenix::Math
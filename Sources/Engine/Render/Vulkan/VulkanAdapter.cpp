@@ -1,3 +1,4 @@
+#include <cstring>
 #include <set>
 #include <vector>
 
@@ -10,6 +11,8 @@ namespace Eugenix::Render::Vulkan
 {
 	bool Adapter::Select(VkInstance instance, VkSurfaceKHR surface)
 	{
+		_instance = instance;
+
 		uint32_t deviceCount = 0;
 		VERIFYVULKANRESULT(vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr));
 		if (deviceCount == 0)
@@ -92,15 +95,25 @@ namespace Eugenix::Render::Vulkan
 				continue;
 			}
 
+			for (uint32_t family = 0; family < queueFamilyCount; ++family)
+			{
+				const VkQueueFlags flags = queueFamilies[family].queueFlags;
+				if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+				{
+					indices.transferFamily = family;
+					break;
+				}
+			}
+
 			_selectedPhysicalDevice = device;
 			_queueIndices = indices;
+			_timestampValidBits = queueFamilies[indices.graphicsFamily.value()].timestampValidBits;
+			_extensions = std::move(availableExtensions);
 
-			VkPhysicalDeviceProperties props;
-			vkGetPhysicalDeviceProperties(device, &props);
-
+			vkGetPhysicalDeviceProperties(device, &_properties);
 			vkGetPhysicalDeviceMemoryProperties(_selectedPhysicalDevice, &_memoryProperties);
 
-			LogSuccess("Selected adapter: ", props.deviceName);
+			LogSuccess("Selected adapter: ", _properties.deviceName);
 			return true;
 		}
 
@@ -108,6 +121,16 @@ namespace Eugenix::Render::Vulkan
 		return false;
 	}
 
+	bool Adapter::ExtensionSupported(const char* extensionName) const
+	{
+		for (const auto& extension : _extensions)
+		{
+			if (strcmp(extension.extensionName, extensionName) == 0)
+				return true;
+		}
+		return false;
+	}
+
 	uint32_t Adapter::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
 	{
 		for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; ++i)
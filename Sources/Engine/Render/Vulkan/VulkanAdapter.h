@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "VulkanCommon.h"
 
@@ -10,6 +11,7 @@ namespace Eugenix::Render::Vulkan
 	{
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
+		std::optional<uint32_t> transferFamily;	// Transfer only, the copy engines of discrete GPUs
 
 		bool isComplete()
 		{
@@ -22,14 +24,27 @@ namespace Eugenix::Render::Vulkan
 	public:
 		bool Select(VkInstance instance, VkSurfaceKHR surface);
 
+		VkInstance Instance() const { return _instance; }
 		VkPhysicalDevice Handle() const { return _selectedPhysicalDevice; }
 		QueueFamilyIndices Indices() const { return _queueIndices; }
 
+		const VkPhysicalDeviceProperties& Properties() const { return _properties; }
+		const VkPhysicalDeviceMemoryProperties& MemoryProperties() const { return _memoryProperties; }
+
+		// Bits of a timestamp query written on the graphics queue that hold data, 0 when unsupported
+		uint32_t TimestampValidBits() const { return _timestampValidBits; }
+
+		bool ExtensionSupported(const char* extensionName) const;
+
 		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
 
 	private:
+		VkInstance _instance{ VK_NULL_HANDLE };
 		VkPhysicalDevice _selectedPhysicalDevice{ VK_NULL_HANDLE };
+		VkPhysicalDeviceProperties _properties{};
 		VkPhysicalDeviceMemoryProperties _memoryProperties;
 		QueueFamilyIndices _queueIndices{};
+		uint32_t _timestampValidBits{};
+		std::vector<VkExtensionProperties> _extensions;
 	};
 } // namespace Eugenix::Render::Vulkan
\ No newline at end of file
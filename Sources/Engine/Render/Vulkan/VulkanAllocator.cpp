@@ -0,0 +1,630 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+
+#include "VulkanAllocator.h"
+#include "VulkanInitializers.h"
+
+namespace
+{
+	constexpr VkDeviceSize SmallHeapSize = 1ull << 30;
+
+	constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	constexpr VkDeviceSize alignDown(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return value / alignment * alignment;
+	}
+}
+
+namespace Eugenix::Render::Vulkan
+{
+	void Allocator::Tlsf::Init(VkDeviceSize size)
+	{
+		_nodes.clear();
+		_unusedNodes.clear();
+		_firstLevelMap = 0;
+		_secondLevelMap.fill(0);
+		for (auto& heads : _heads)
+			heads.fill(NoNode);
+
+		_used = 0;
+		_allocations = 0;
+		_freeRanges = 0;
+
+		_nodes.push_back({ .offset = 0, .size = alignDown(size, Granularity) });
+		insertFree(0);
+	}
+
+	uint32_t Allocator::Tlsf::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		size = alignUp(std::max(size, Granularity), Granularity);
+		alignment = std::max(alignment, Granularity);
+
+		// Every range in the class found is at least the size searched for, leave room for aligning
+		uint32_t node = findFree(size + (alignment > Granularity ? alignment - Granularity : 0));
+		if (node == NoNode)
+			return NoNode;
+
+		removeFree(node);
+
+		const VkDeviceSize padding = alignUp(_nodes[node].offset, alignment) - _nodes[node].offset;
+		if (padding > 0)
+		{
+			const uint32_t aligned = split(node, padding);
+			insertFree(node);
+			node = aligned;
+		}
+
+		if (_nodes[node].size > size)
+			insertFree(split(node, size));
+
+		_used += _nodes[node].size;
+		++_allocations;
+
+		return node;
+	}
+
+	void Allocator::Tlsf::Free(uint32_t node)
+	{
+		_used -= _nodes[node].size;
+		--_allocations;
+
+		// Free neighbours are always merged, so there is at most one on either side
+		const uint32_t next = _nodes[node].nextPhysical;
+		if (next != NoNode && _nodes[next].free)
+		{
+			removeFree(next);
+			merge(node, next);
+		}
+
+		const uint32_t prev = _nodes[node].prevPhysical;
+		if (prev != NoNode && _nodes[prev].free)
+		{
+			removeFree(prev);
+			merge(prev, node);
+			node = prev;
+		}
+
+		insertFree(node);
+	}
+
+	void Allocator::Tlsf::mapping(VkDeviceSize size, uint32_t& first, uint32_t& second)
+	{
+		if (size < SmallSize)
+		{
+			first = 0;
+			second = static_cast<uint32_t>(size / Granularity);
+			return;
+		}
+
+		const uint32_t log = static_cast<uint32_t>(std::bit_width(size)) - 1;
+		first = log - static_cast<uint32_t>(std::bit_width(SmallSize)) + 2;
+		second = static_cast<uint32_t>(size >> (log - SecondLevelBits)) - SecondLevelCount;
+	}
+
+	uint32_t Allocator::Tlsf::newNode()
+	{
+		if (_unusedNodes.empty())
+		{
+			_nodes.emplace_back();
+			return static_cast<uint32_t>(_nodes.size() - 1);
+		}
+
+		const uint32_t node = _unusedNodes.back();
+		_unusedNodes.pop_back();
+		return node;
+	}
+
+	void Allocator::Tlsf::insertFree(uint32_t node)
+	{
+		uint32_t first, second;
+		mapping(_nodes[node].size, first, second);
+
+		uint32_t& head = _heads[first][second];
+		_nodes[node].free = true;
+		_nodes[node].prevFree = NoNode;
+		_nodes[node].nextFree = head;
+		if (head != NoNode)
+			_nodes[head].prevFree = node;
+		head = node;
+
+		_firstLevelMap |= 1ull << first;
+		_secondLevelMap[first] |= 1u << second;
+		++_freeRanges;
+	}
+
+	void Allocator::Tlsf::removeFree(uint32_t node)
+	{
+		uint32_t first, second;
+		mapping(_nodes[node].size, first, second);
+
+		Node& entry = _nodes[node];
+		if (entry.prevFree != NoNode)
+			_nodes[entry.prevFree].nextFree = entry.nextFree;
+		else
+			_heads[first][second] = entry.nextFree;
+
+		if (entry.nextFree != NoNode)
+			_nodes[entry.nextFree].prevFree = entry.prevFree;
+
+		if (_heads[first][second] == NoNode)
+		{
+			_secondLevelMap[first] &= ~(1u << second);
+			if (_secondLevelMap[first] == 0)
+				_firstLevelMap &= ~(1ull << first);
+		}
+
+		entry.free = false;
+		entry.prevFree = NoNode;
+		entry.nextFree = NoNode;
+		--_freeRanges;
+	}
+
+	uint32_t Allocator::Tlsf::findFree(VkDeviceSize size) const
+	{
+		// Round up to the next class, any range in it fits without walking the list
+		if (size >= SmallSize)
+			size += (VkDeviceSize(1) << (std::bit_width(size) - 1 - SecondLevelBits)) - 1;
+
+		uint32_t first, second;
+		mapping(size, first, second);
+		if (first >= FirstLevelCount)
+			return NoNode;
+
+		uint32_t secondMap = _secondLevelMap[first] & (~0u << second);
+		if (secondMap == 0)
+		{
+			const uint64_t firstMap = first + 1 < FirstLevelCount ? _firstLevelMap & (~0ull << (first + 1)) : 0;
+			if (firstMap == 0)
+				return NoNode;
+
+			first = static_cast<uint32_t>(std::countr_zero(firstMap));
+			secondMap = _secondLevelMap[first];
+		}
+
+		return _heads[first][std::countr_zero(secondMap)];
+	}
+
+	uint32_t Allocator::Tlsf::split(uint32_t node, VkDeviceSize size)
+	{
+		const uint32_t rest = newNode();
+
+		Node& entry = _nodes[node];
+		Node& restEntry = _nodes[rest];
+		restEntry = {};
+		restEntry.offset = entry.offset + size;
+		restEntry.size = entry.size - size;
+		restEntry.prevPhysical = node;
+		restEntry.nextPhysical = entry.nextPhysical;
+
+		if (entry.nextPhysical != NoNode)
+			_nodes[entry.nextPhysical].prevPhysical = rest;
+
+		entry.size = size;
+		entry.nextPhysical = rest;
+
+		return rest;
+	}
+
+	void Allocator::Tlsf::merge(uint32_t node, uint32_t next)
+	{
+		Node& entry = _nodes[node];
+		entry.size += _nodes[next].size;
+		entry.nextPhysical = _nodes[next].nextPhysical;
+
+		if (entry.nextPhysical != NoNode)
+			_nodes[entry.nextPhysical].prevPhysical = node;
+
+		_nodes[next] = {};
+		_unusedNodes.push_back(next);
+	}
+
+	bool Allocator::Create(const Adapter& adapter, VkDevice device, const AllocatorSettings& settings)
+	{
+		_device = device;
+		_memoryProperties = adapter.MemoryProperties();
+		_nonCoherentAtomSize = std::max<VkDeviceSize>(adapter.Properties().limits.nonCoherentAtomSize, 1);
+		_maxAllocationCount = adapter.Properties().limits.maxMemoryAllocationCount;
+		_settings = settings;
+
+		_pools.clear();
+		_pools.resize(_memoryProperties.memoryTypeCount * 2);
+
+		for (uint32_t type = 0; type < _memoryProperties.memoryTypeCount; ++type)
+		{
+			const VkDeviceSize heapSize = _memoryProperties.memoryHeaps[_memoryProperties.memoryTypes[type].heapIndex].size;
+			_blockSizes[type] = alignUp(heapSize <= SmallHeapSize ? heapSize / 8 : settings.blockSize, 4096);
+		}
+
+		_deviceMemoryCount = 0;
+		_dedicatedCount.fill(0);
+		_dedicatedBytes.fill(0);
+
+		return true;
+	}
+
+	void Allocator::Destroy()
+	{
+		std::lock_guard lock(_mutex);
+
+		uint32_t leaked = 0;
+		for (auto& pool : _pools)
+		{
+			for (auto& block : pool.blocks)
+			{
+				if (!block)
+					continue;
+
+				leaked += block->ranges.Allocations();
+				freeMemory(block->memory);
+			}
+		}
+		_pools.clear();
+
+		for (uint32_t count : _dedicatedCount)
+			leaked += count;
+
+		if (leaked > 0)
+			LogWarn("Allocator: {} allocations were not freed", leaked);
+
+		_dedicatedCount.fill(0);
+		_dedicatedBytes.fill(0);
+		_deviceMemoryCount = 0;
+		_device = VK_NULL_HANDLE;
+	}
+
+	Allocation Allocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+		ResourceKind kind, bool dedicated)
+	{
+		EUGENIX_PROFILE_SCOPE("Allocator::Allocate");
+
+		std::lock_guard lock(_mutex);
+
+		Allocation allocation{};
+		for (uint32_t type = 0; type < _memoryProperties.memoryTypeCount; ++type)
+		{
+			if (!(requirements.memoryTypeBits & (1u << type)) ||
+				(_memoryProperties.memoryTypes[type].propertyFlags & properties) != properties)
+			{
+				continue;
+			}
+
+			// A block that cannot be allocated falls back to memory of the exact size
+			const bool alone = dedicated || requirements.size > VkDeviceSize(_blockSizes[type] * _settings.dedicatedFraction);
+			if (!alone && allocateFromPool(poolIndex(type, kind), requirements, allocation))
+				return allocation;
+
+			if (allocateDedicated(type, requirements, allocation))
+				return allocation;
+		}
+
+		LogError("Allocator: out of memory for {} bytes with properties {:#x}", requirements.size, properties);
+		return {};
+	}
+
+	void Allocator::Free(Allocation& allocation)
+	{
+		std::lock_guard lock(_mutex);
+		freeLocked(allocation);
+	}
+
+	void Allocator::Flush(const Allocation& allocation, VkDeviceSize offset, VkDeviceSize size) const
+	{
+		const uint32_t type = poolMemoryType(allocation.pool);
+		if (_memoryProperties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+			return;
+
+		VkDeviceSize memorySize = allocation.size;
+		if (allocation.block != Allocation::Dedicated)
+		{
+			std::lock_guard lock(_mutex);
+			memorySize = _pools[allocation.pool].blocks[allocation.block]->size;
+		}
+
+		if (size == VK_WHOLE_SIZE)
+			size = allocation.size - offset;
+
+		// The range has to cover whole atoms, neighbours in the block are flushed along
+		const VkDeviceSize begin = alignDown(allocation.offset + offset, _nonCoherentAtomSize);
+		const VkDeviceSize end = alignUp(allocation.offset + offset + size, _nonCoherentAtomSize);
+
+		VkMappedMemoryRange range{};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = allocation.memory;
+		range.offset = begin;
+		range.size = end < memorySize ? end - begin : VK_WHOLE_SIZE;
+
+		VERIFYVULKANRESULT(vkFlushMappedMemoryRanges(_device, 1, &range));
+	}
+
+	uint32_t Allocator::Defragment(std::span<Allocation* const> allocations, const MoveFn& move)
+	{
+		EUGENIX_PROFILE_SCOPE("Allocator::Defragment");
+
+		std::lock_guard lock(_mutex);
+
+		uint32_t moved = 0;
+		for (uint32_t pool = 0; pool < static_cast<uint32_t>(_pools.size()); ++pool)
+		{
+			auto& blocks = _pools[pool].blocks;
+
+			std::vector<uint32_t> order;
+			for (uint32_t block = 0; block < static_cast<uint32_t>(blocks.size()); ++block)
+			{
+				if (blocks[block])
+					order.push_back(block);
+			}
+
+			if (order.size() < 2)
+				continue;
+
+			// Emptiest blocks first, each gives its allocations to the ones used more than itself
+			std::ranges::sort(order, {}, [&](uint32_t block) { return blocks[block]->ranges.Used(); });
+
+			for (size_t source = 0; source + 1 < order.size(); ++source)
+			{
+				for (Allocation* allocation : allocations)
+				{
+					if (allocation->pool != pool || allocation->block != order[source])
+						continue;
+
+					for (size_t target = source + 1; target < order.size(); ++target)
+					{
+						// Releasing a block trims the null slots at the end
+						if (order[target] >= blocks.size() || !blocks[order[target]])
+							continue;
+
+						Block* block = blocks[order[target]].get();
+
+						const uint32_t node = block->ranges.Allocate(allocation->size, allocation->alignment);
+						if (node == Tlsf::NoNode)
+							continue;
+
+						Allocation to{};
+						fillAllocation(pool, order[target], node, allocation->size, allocation->alignment, to);
+
+						if (move(*allocation, to))
+						{
+							freeLocked(*allocation);
+							*allocation = to;
+							++moved;
+						}
+						else
+						{
+							block->ranges.Free(node);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		return moved;
+	}
+
+	AllocatorStats Allocator::Stats() const
+	{
+		std::lock_guard lock(_mutex);
+
+		AllocatorStats stats{};
+		for (uint32_t pool = 0; pool < static_cast<uint32_t>(_pools.size()); ++pool)
+			addStats(pool, stats);
+
+		for (uint32_t type = 0; type < _memoryProperties.memoryTypeCount; ++type)
+		{
+			stats.dedicated += _dedicatedCount[type];
+			stats.allocations += _dedicatedCount[type];
+			stats.dedicatedBytes += _dedicatedBytes[type];
+		}
+
+		return stats;
+	}
+
+	AllocatorStats Allocator::HeapStats(uint32_t heapIndex) const
+	{
+		std::lock_guard lock(_mutex);
+
+		AllocatorStats stats{};
+		for (uint32_t type = 0; type < _memoryProperties.memoryTypeCount; ++type)
+		{
+			if (_memoryProperties.memoryTypes[type].heapIndex != heapIndex)
+				continue;
+
+			addStats(poolIndex(type, ResourceKind::Linear), stats);
+			addStats(poolIndex(type, ResourceKind::Optimal), stats);
+
+			stats.dedicated += _dedicatedCount[type];
+			stats.allocations += _dedicatedCount[type];
+			stats.dedicatedBytes += _dedicatedBytes[type];
+		}
+
+		return stats;
+	}
+
+	bool Allocator::allocateFromPool(uint32_t pool, const VkMemoryRequirements& requirements, Allocation& allocation)
+	{
+		auto& blocks = _pools[pool].blocks;
+
+		for (uint32_t block = 0; block < static_cast<uint32_t>(blocks.size()); ++block)
+		{
+			if (!blocks[block])
+				continue;
+
+			const uint32_t node = blocks[block]->ranges.Allocate(requirements.size, requirements.alignment);
+			if (node != Tlsf::NoNode)
+			{
+				fillAllocation(pool, block, node, requirements.size, requirements.alignment, allocation);
+				return true;
+			}
+		}
+
+		const uint32_t type = poolMemoryType(pool);
+
+		auto block = std::make_unique<Block>();
+		block->size = _blockSizes[type];
+		block->memory = allocateMemory(type, block->size, &block->mapped);
+		if (!block->memory)
+			return false;
+
+		block->ranges.Init(block->size);
+
+		auto slot = std::ranges::find_if(blocks, [](const auto& slot) { return !slot; });
+		if (slot == blocks.end())
+			slot = blocks.insert(blocks.end(), nullptr);
+		*slot = std::move(block);
+
+		const uint32_t index = static_cast<uint32_t>(slot - blocks.begin());
+		const uint32_t node = blocks[index]->ranges.Allocate(requirements.size, requirements.alignment);
+		if (node == Tlsf::NoNode)
+		{
+			releaseEmptyBlocks(pool);
+			return false;
+		}
+
+		fillAllocation(pool, index, node, requirements.size, requirements.alignment, allocation);
+		return true;
+	}
+
+	void Allocator::fillAllocation(uint32_t pool, uint32_t block, uint32_t node, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation) const
+	{
+		const Block& source = *_pools[pool].blocks[block];
+
+		allocation.memory = source.memory;
+		allocation.offset = source.ranges.Offset(node);
+		allocation.size = size;
+		allocation.alignment = alignment;
+		allocation.mapped = source.mapped ? static_cast<std::byte*>(source.mapped) + allocation.offset : nullptr;
+		allocation.pool = pool;
+		allocation.block = block;
+		allocation.node = node;
+	}
+
+	bool Allocator::allocateDedicated(uint32_t memoryType, const VkMemoryRequirements& requirements, Allocation& allocation)
+	{
+		void* mapped = nullptr;
+		const VkDeviceMemory memory = allocateMemory(memoryType, requirements.size, &mapped);
+		if (!memory)
+			return false;
+
+		allocation = {};
+		allocation.memory = memory;
+		allocation.size = requirements.size;
+		allocation.alignment = requirements.alignment;
+		allocation.mapped = mapped;
+		allocation.pool = poolIndex(memoryType, ResourceKind::Linear);
+		allocation.block = Allocation::Dedicated;
+
+		++_dedicatedCount[memoryType];
+		_dedicatedBytes[memoryType] += requirements.size;
+
+		return true;
+	}
+
+	VkDeviceMemory Allocator::allocateMemory(uint32_t memoryType, VkDeviceSize size, void** mapped)
+	{
+		if (_deviceMemoryCount >= _maxAllocationCount)
+		{
+			LogError("Allocator: maxMemoryAllocationCount ({}) reached", _maxAllocationCount);
+			return VK_NULL_HANDLE;
+		}
+
+		EUGENIX_PROFILE_SCOPE("vkAllocateMemory");
+
+		// Running out of a heap is expected here, the caller tries the next memory type
+		VkMemoryAllocateInfo allocInfo = MemoryAllocateInfo(size, memoryType);
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		if (vkAllocateMemory(_device, &allocInfo, EUGENIX_VULKAN_ALLOCATOR, &memory) != VK_SUCCESS)
+			return VK_NULL_HANDLE;
+
+		++_deviceMemoryCount;
+
+		*mapped = nullptr;
+		if (hostVisible(memoryType))
+			VERIFYVULKANRESULT(vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, mapped));
+
+		return memory;
+	}
+
+	void Allocator::freeMemory(VkDeviceMemory memory)
+	{
+		// Freeing unmaps as well
+		vkFreeMemory(_device, memory, EUGENIX_VULKAN_ALLOCATOR);
+		--_deviceMemoryCount;
+	}
+
+	void Allocator::freeLocked(Allocation& allocation)
+	{
+		if (!allocation)
+			return;
+
+		if (allocation.block == Allocation::Dedicated)
+		{
+			const uint32_t type = poolMemoryType(allocation.pool);
+			freeMemory(allocation.memory);
+			--_dedicatedCount[type];
+			_dedicatedBytes[type] -= allocation.size;
+		}
+		else
+		{
+			Block& block = *_pools[allocation.pool].blocks[allocation.block];
+			block.ranges.Free(allocation.node);
+			if (block.ranges.Empty())
+				releaseEmptyBlocks(allocation.pool);
+		}
+
+		allocation = {};
+	}
+
+	void Allocator::releaseEmptyBlocks(uint32_t pool)
+	{
+		auto& blocks = _pools[pool].blocks;
+
+		uint32_t empty = 0;
+		for (const auto& block : blocks)
+		{
+			if (block && block->ranges.Empty())
+				++empty;
+		}
+
+		// The newest empty blocks go first
+		for (size_t i = blocks.size(); i-- > 0 && empty > _settings.emptyBlocksKept;)
+		{
+			if (blocks[i] && blocks[i]->ranges.Empty())
+			{
+				freeMemory(blocks[i]->memory);
+				blocks[i].reset();
+				--empty;
+			}
+		}
+
+		while (!blocks.empty() && !blocks.back())
+			blocks.pop_back();
+	}
+
+	bool Allocator::hostVisible(uint32_t memoryType) const
+	{
+		return _memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	}
+
+	void Allocator::addStats(uint32_t pool, AllocatorStats& stats) const
+	{
+		for (const auto& block : _pools[pool].blocks)
+		{
+			if (!block)
+				continue;
+
+			++stats.blocks;
+			stats.allocations += block->ranges.Allocations();
+			stats.blockBytes += block->size;
+			stats.usedBytes += block->ranges.Used();
+			stats.freeRanges += block->ranges.FreeRanges();
+		}
+	}
+} // namespace Eugenix::Render::Vulkan
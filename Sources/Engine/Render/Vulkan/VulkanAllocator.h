@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "VulkanAdapter.h"
+#include "VulkanCommon.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	// Buffers and linear images never share a block with optimal tiling images, so neighbours
+	// inside a block never need bufferImageGranularity padding
+	enum class ResourceKind : uint8_t
+	{
+		Linear,
+		Optimal
+	};
+
+	// A range of a VkDeviceMemory, either sub-allocated from a block or dedicated
+	struct Allocation
+	{
+		static constexpr uint32_t Dedicated = UINT32_MAX;
+
+		VkDeviceMemory memory{ VK_NULL_HANDLE };
+		VkDeviceSize offset{};
+		VkDeviceSize size{};
+		VkDeviceSize alignment{};
+		void* mapped{ nullptr };	// Host visible memory stays mapped for its block's lifetime
+
+		uint32_t pool{ UINT32_MAX };
+		uint32_t block{ Dedicated };
+		uint32_t node{ UINT32_MAX };
+
+		explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+	};
+
+	struct AllocatorSettings
+	{
+		VkDeviceSize blockSize{ 64ull << 20 };	// Heaps under 1 GiB use an eighth of the heap
+		float dedicatedFraction{ 0.5f };		// Larger resources, relative to the block size, get memory of their own
+		uint32_t emptyBlocksKept{ 1 };			// Per pool, so a free / allocate pattern does not thrash vkAllocateMemory
+	};
+
+	struct AllocatorStats
+	{
+		uint32_t blocks{};
+		uint32_t dedicated{};
+		uint32_t allocations{};		// Sub-allocations and dedicated ones
+		VkDeviceSize blockBytes{};
+		VkDeviceSize usedBytes{};	// In blocks, including alignment padding
+		VkDeviceSize dedicatedBytes{};
+		uint32_t freeRanges{};		// Free ranges over all blocks, grows as they fragment
+
+		uint32_t DeviceMemoryCount() const { return blocks + dedicated; }
+	};
+
+	// Sub-allocates device memory for buffers and images. Every memory type has a pool per
+	// ResourceKind, a pool is a list of large blocks with a two level segregated fit (TLSF) free
+	// list each, so finding a range and freeing it are O(1). Large resources and those the driver
+	// prefers to have alone get a dedicated VkDeviceMemory.
+	// Thread-safe.
+	class Allocator final
+	{
+	public:
+		// Moves the data of `from` into `to`: create the resource at `to`, copy and rebind everything
+		// that refers to it. `from` is released once this returns, the copy has to be complete.
+		// Returning false leaves the allocation where it is. Called with the allocator locked, it
+		// must not allocate or free.
+		using MoveFn = std::function<bool(const Allocation& from, const Allocation& to)>;
+
+		bool Create(const Adapter& adapter, VkDevice device, const AllocatorSettings& settings = {});
+		void Destroy();
+
+		// Tries every memory type the requirements allow that has all of properties, in order
+		Allocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+			ResourceKind kind, bool dedicated = false);
+		void Free(Allocation& allocation);
+
+		// Needed for host visible memory that is not host coherent, no-op otherwise
+		void Flush(const Allocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const;
+
+		// Compacts pools by moving allocations out of their least used blocks into fuller ones,
+		// blocks that end up empty are released. Only the given allocations are moved, they are
+		// updated in place. Returns how many were moved.
+		uint32_t Defragment(std::span<Allocation* const> allocations, const MoveFn& move);
+
+		AllocatorStats Stats() const;
+		AllocatorStats HeapStats(uint32_t heapIndex) const;
+
+	private:
+		// Two level segregated fit over the ranges of one block. The first level is the power of
+		// two of a size, the second splits it linearly into SecondLevelCount classes. Every class
+		// has a free list and both levels a bitmap of non-empty lists.
+		class Tlsf final
+		{
+		public:
+			static constexpr uint32_t NoNode = UINT32_MAX;
+
+			void Init(VkDeviceSize size);
+
+			// Returns the node, its offset is aligned
+			uint32_t Allocate(VkDeviceSize size, VkDeviceSize alignment);
+			void Free(uint32_t node);
+
+			VkDeviceSize Offset(uint32_t node) const { return _nodes[node].offset; }
+			VkDeviceSize Used() const { return _used; }
+			uint32_t Allocations() const { return _allocations; }
+			uint32_t FreeRanges() const { return _freeRanges; }
+			bool Empty() const { return _allocations == 0; }
+
+		private:
+			static constexpr uint32_t SecondLevelBits = 4;
+			static constexpr uint32_t SecondLevelCount = 1u << SecondLevelBits;
+			static constexpr uint32_t FirstLevelCount = 64;
+
+			// Offsets and sizes are kept in multiples of this, smaller ranges are not split off
+			static constexpr VkDeviceSize Granularity = 16;
+			static constexpr VkDeviceSize SmallSize = Granularity * SecondLevelCount;
+
+			struct Node
+			{
+				VkDeviceSize offset{};
+				VkDeviceSize size{};
+				uint32_t prevPhysical{ NoNode };
+				uint32_t nextPhysical{ NoNode };
+				uint32_t prevFree{ NoNode };
+				uint32_t nextFree{ NoNode };
+				bool free{ false };
+			};
+
+			static void mapping(VkDeviceSize size, uint32_t& first, uint32_t& second);
+
+			uint32_t newNode();
+			void insertFree(uint32_t node);
+			void removeFree(uint32_t node);
+			uint32_t findFree(VkDeviceSize size) const;
+			uint32_t split(uint32_t node, VkDeviceSize size);
+			void merge(uint32_t node, uint32_t next);
+
+			std::vector<Node> _nodes;
+			std::vector<uint32_t> _unusedNodes;
+
+			uint64_t _firstLevelMap{};
+			std::array<uint32_t, FirstLevelCount> _secondLevelMap{};
+			std::array<std::array<uint32_t, SecondLevelCount>, FirstLevelCount> _heads{};
+
+			VkDeviceSize _used{};
+			uint32_t _allocations{};
+			uint32_t _freeRanges{};
+		};
+
+		struct Block
+		{
+			VkDeviceMemory memory{ VK_NULL_HANDLE };
+			VkDeviceSize size{};
+			void* mapped{ nullptr };
+			Tlsf ranges;
+		};
+
+		// Blocks are never moved, an Allocation refers to one by index. Released blocks leave a
+		// null slot that the next new block of the pool takes.
+		struct Pool
+		{
+			std::vector<std::unique_ptr<Block>> blocks;
+		};
+
+		static uint32_t poolIndex(uint32_t memoryType, ResourceKind kind) { return memoryType * 2 + static_cast<uint32_t>(kind); }
+		static uint32_t poolMemoryType(uint32_t pool) { return pool / 2; }
+
+		bool allocateFromPool(uint32_t pool, const VkMemoryRequirements& requirements, Allocation& allocation);
+		void fillAllocation(uint32_t pool, uint32_t block, uint32_t node, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation) const;
+		bool allocateDedicated(uint32_t memoryType, const VkMemoryRequirements& requirements, Allocation& allocation);
+		VkDeviceMemory allocateMemory(uint32_t memoryType, VkDeviceSize size, void** mapped);
+		void freeMemory(VkDeviceMemory memory);
+		void freeLocked(Allocation& allocation);
+		void releaseEmptyBlocks(uint32_t pool);
+		bool hostVisible(uint32_t memoryType) const;
+
+		void addStats(uint32_t pool, AllocatorStats& stats) const;
+
+		VkDevice _device{ VK_NULL_HANDLE };
+		VkPhysicalDeviceMemoryProperties _memoryProperties{};
+		VkDeviceSize _nonCoherentAtomSize{ 1 };
+		uint32_t _maxAllocationCount{};
+		AllocatorSettings _settings;
+
+		mutable std::mutex _mutex;
+
+		std::vector<Pool> _pools;
+		std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> _blockSizes{};
+
+		// Every VkDeviceMemory counts against maxMemoryAllocationCount
+		uint32_t _deviceMemoryCount{};
+		std::array<uint32_t, VK_MAX_MEMORY_TYPES> _dedicatedCount{};
+		std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> _dedicatedBytes{};
+	};
+} // namespace Eugenix::Render::Vulkan
@@ -1,15 +1,23 @@
 #pragma once
 
-#include <sstream>
+#include <format>
+#include <iterator>
 
+#include "Core/FrameStats.h"
+#include "Core/Jobs.h"
 #include "Core/Log.h"
+#include "Core/Memory.h"
+#include "Core/Profiler.h"
 
 #include "VulkanAdapter.h"
 #include "VulkanDevice.h"
+#include "VulkanFrameCommandPools.h"
 #include "VulkanInitializers.h"
 #include "VulkanInstance.h"
 #include "VulkanSurface.h"
+#include "VulkanPipelineCompiler.h"
 #include "VulkanSwapchain.h"
+#include "VulkanUploadManager.h"
 
 constexpr auto DEFAULT_WIDTH = 1024;
 constexpr auto DEFAULT_HEIGHT = 768;
@@ -46,9 +54,22 @@ namespace Eugenix
 						return -1;
 					}
 
+					// The thread running the app loop owns GLFW and is the job system's main thread
+					Jobs::Initialize();
+					EUGENIX_PROFILE_THREAD("Main");
+
+					// A pool per job thread, so it needs the job system
+					if (!_commandPools.Create(_device, _device.GraphicsFamily(), Swapchain::MaxFramesInFlight, Jobs::ThreadCount()))
+					{
+						LogError("Failed to create frame command pools!");
+						Jobs::Shutdown();
+						return -1;
+					}
+
 					if (!onInit())
 					{
 						LogError("App onInit failed!");
+						Jobs::Shutdown();
 						return -1;
 					}
 
@@ -56,7 +77,16 @@ namespace Eugenix
 
 					while (!glfwWindowShouldClose(_window))
 					{
-						glfwPollEvents();
+						EUGENIX_PROFILE_SCOPE("Frame");
+
+						Memory::BeginFrame();
+						FrameStats::BeginFrame();
+
+						{
+							EUGENIX_PROFILE_SCOPE("PollEvents");
+							glfwPollEvents();
+							Jobs::PumpMainThread();
+						}
 
 						if (glfwGetKey(_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 						{
@@ -68,18 +98,30 @@ namespace Eugenix
 						_lastTime = currentTime;
 
 						// TODO : move stats into imgui
-						updateFPS();
+						updateStats();
 
-						onUpdate(deltaTime);
-						onRender();
-						onRenderUI();
+						{
+							EUGENIX_PROFILE_SCOPE("onUpdate");
+							onUpdate(deltaTime);
+						}
+						{
+							EUGENIX_PROFILE_SCOPE("onRender");
+							onRender();
+						}
+						{
+							EUGENIX_PROFILE_SCOPE("onRenderUI");
+							onRenderUI();
+						}
 					}
 
 					vkDeviceWaitIdle(_device.Handle());
 
 					onCleanup();
+					Jobs::Shutdown();
 					cleanupVulkan();
 
+					FrameStats::SaveCsv("FrameStats.csv");
+
 					return 0;
 				}
 
@@ -104,15 +146,16 @@ namespace Eugenix
 				Adapter _adapter;
 				Device _device;
 				Swapchain _swapchain;
+				UploadManager _uploads;
+				PipelineCompiler _pipelines;
 
-				VkCommandPool _commandPool{ VK_NULL_HANDLE };
+				FrameCommandPools _commandPools;
 
 				bool _resized{ false };
 
 			private:
 				double _lastTime{};
-				double _lastFPSTime{};
-				int _frameCounter{};
+				double _lastStatsTime{};
 
 				bool initWindow(const VulkanAppConfig& config)
 				{
@@ -133,6 +176,14 @@ namespace Eugenix
 								app->_resized = true;
 							}
 						});
+					glfwSetKeyCallback(_window,
+						[](GLFWwindow* window, int key, int scancode, int action, int mods)
+						{
+							if (key == GLFW_KEY_F9 && action == GLFW_PRESS)
+							{
+								Profiler::ToggleCapture("ProfilerCapture.json");
+							}
+						});
 					glfwSetCursorPosCallback(_window,
 						[](GLFWwindow* window, double xpos, double ypos) 
 						{
@@ -165,49 +216,46 @@ namespace Eugenix
 					if (!_swapchain.Create(_adapter, _surface, _device, window))
 						return false;
 
-					createCommandPool();
+					if (!_uploads.Create(_device))
+						return false;
+
+					if (!_pipelines.Create(_device, "PipelineManifest.txt"))
+						return false;
 
 					return true;
 				}
 
 				void cleanupVulkan()
 				{
-					vkDestroyCommandPool(_device.Handle(), _commandPool, nullptr);
-
+					_commandPools.Destroy();
+					_pipelines.Destroy();
+					_uploads.Destroy();
 					_swapchain.Destroy(_device.Handle());
 					_device.Destroy();
 					_surface.Destroy(_instance.Handle());
 					_instance.Destroy();
 				}
 
-				void createCommandPool()
-				{
-					QueueFamilyIndices queueFamilyIndices = _adapter.Indices();
-
-					VkCommandPoolCreateInfo poolInfo = CommandPoolInfo(queueFamilyIndices.graphicsFamily.value(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
-
-					VERIFYVULKANRESULT(vkCreateCommandPool(_device.Handle(), &poolInfo, nullptr, &_commandPool));
-				}
-
-				void updateFPS()
+				void updateStats()
 				{
 					double currentTime = glfwGetTime();
-					double delta = currentTime - _lastFPSTime;
-
-					_frameCounter++;
-					if (delta >= 1.0) // if last update was more than one second ago
-					{
-						double fps = double(_frameCounter) / delta;
+					if (currentTime - _lastStatsTime < 1.0)
+						return;
 
-						std::stringstream ss;
-						ss << "Eugenix. FPS: " << fps;
+					const FrameStats::Summary stats = FrameStats::Compute();
+					const FrameStats::Frame& frame = FrameStats::LastFrame();
+					const AllocatorStats gpuMemory = _device.MemoryAllocator().Stats();
 
-						glfwSetWindowTitle(_window, ss.str().c_str());
+					Memory::String title{ Memory::FrameResource() };
+					std::format_to(std::back_inserter(title),
+						"Eugenix. CPU p50/p99/max: {:.2f}/{:.2f}/{:.2f} ms | GPU p50: {:.2f} ms | Fence p99: {:.2f} ms | Hitches: {} | Visible: {}/{} | Heap allocs/frame: {} | GPU memory: {:.1f} MiB in {} VkDeviceMemory",
+						stats.cpu.p50, stats.cpu.p99, stats.cpu.max, stats.gpu.p50, stats.fenceWait.p99, stats.hitchCount,
+						frame.objectsVisible - frame.objectsOccluded, frame.objectsTested, Memory::LastFrameStats().heapAllocations,
+						(gpuMemory.usedBytes + gpuMemory.dedicatedBytes) / (1024.0 * 1024.0), gpuMemory.DeviceMemoryCount());
 
-						_frameCounter = 0;
+					glfwSetWindowTitle(_window, title.c_str());
 
-						_lastFPSTime = currentTime;
-					}
+					_lastStatsTime = currentTime;
 				}
 
 			};
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "Core/Log.h"
+
+#include "VulkanBindlessDescriptors.h"
+#include "VulkanInitializers.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	bool BindlessDescriptors::Create(const Adapter& adapter, Device& device, uint32_t maxTextures, uint32_t maxMaterials, uint32_t materialSize)
+	{
+		if (!device.DescriptorIndexing())
+		{
+			LogError("Bindless descriptors: the device has no descriptor indexing");
+			return false;
+		}
+
+		VkPhysicalDeviceVulkan12Properties properties12{};
+		properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &properties12;
+		vkGetPhysicalDeviceProperties2(adapter.Handle(), &properties);
+
+		const uint32_t textureLimit = std::min(properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+			properties12.maxPerStageDescriptorUpdateAfterBindSampledImages);
+		if (maxTextures > textureLimit)
+		{
+			LogWarn("Bindless descriptors: {} textures requested, the device allows {}", maxTextures, textureLimit);
+			maxTextures = textureLimit;
+		}
+
+		_device = &device;
+		_maxTextures = maxTextures;
+		_maxMaterials = maxMaterials;
+		_materialSize = materialSize;
+		_textureCount = 0;
+		_materialCount = 0;
+
+		std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+		bindings[TextureBinding].binding = TextureBinding;
+		bindings[TextureBinding].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[TextureBinding].descriptorCount = _maxTextures;
+		bindings[TextureBinding].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		bindings[MaterialBinding].binding = MaterialBinding;
+		bindings[MaterialBinding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[MaterialBinding].descriptorCount = 1;
+		bindings[MaterialBinding].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		// Slots are written while the set is bound and in use by frames that do not read them
+		const VkDescriptorBindingFlags bindingFlag = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+		std::array<VkDescriptorBindingFlags, 2> bindingFlags = { bindingFlag, bindingFlag };
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo = DescriptorSetLayoutInfo(bindings);
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		VERIFYVULKANRESULT(vkCreateDescriptorSetLayout(device.Handle(), &layoutInfo, EUGENIX_VULKAN_ALLOCATOR, &_layout));
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _maxTextures };
+		poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 };
+
+		VkDescriptorPoolCreateInfo poolInfo = DescriptorPoolInfo(poolSizes, 1);
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		VERIFYVULKANRESULT(vkCreateDescriptorPool(device.Handle(), &poolInfo, EUGENIX_VULKAN_ALLOCATOR, &_pool));
+
+		std::array<VkDescriptorSetLayout, 1> setLayouts = { _layout };
+		VkDescriptorSetAllocateInfo allocInfo = DescriptorSetAllocateInfo(_pool, 1, setLayouts);
+		VERIFYVULKANRESULT(vkAllocateDescriptorSets(device.Handle(), &allocInfo, &_set));
+
+		// Materials are written once into slots no frame reads yet, a mapped buffer is enough
+		_materials = device.CreateBuffer(static_cast<VkDeviceSize>(_materialSize) * _maxMaterials,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+		if (!_materials.allocation.mapped)
+		{
+			LogError("Bindless descriptors: no host visible memory for {} materials", _maxMaterials);
+			return false;
+		}
+
+		VkDescriptorBufferInfo bufferInfo{ _materials.buffer, 0, VK_WHOLE_SIZE };
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = _set;
+		write.dstBinding = MaterialBinding;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(device.Handle(), 1, &write, 0, nullptr);
+
+		LogInfo("Bindless descriptors: {} textures, {} materials of {} bytes", _maxTextures, _maxMaterials, _materialSize);
+
+		return true;
+	}
+
+	void BindlessDescriptors::Destroy()
+	{
+		if (!_device)
+			return;
+
+		// Frees the set as well
+		vkDestroyDescriptorPool(_device->Handle(), _pool, EUGENIX_VULKAN_ALLOCATOR);
+		vkDestroyDescriptorSetLayout(_device->Handle(), _layout, EUGENIX_VULKAN_ALLOCATOR);
+
+		if (_materials.buffer)
+			_device->DestroyBuffer(_materials);
+
+		_pool = VK_NULL_HANDLE;
+		_layout = VK_NULL_HANDLE;
+		_set = VK_NULL_HANDLE;
+		_device = nullptr;
+	}
+
+	uint32_t BindlessDescriptors::AddTexture(VkImageView view, VkSampler sampler, VkImageLayout layout)
+	{
+		if (_textureCount == _maxTextures)
+		{
+			LogError("Bindless descriptors: all {} texture slots are used", _maxTextures);
+			return InvalidIndex;
+		}
+
+		const uint32_t index = _textureCount++;
+
+		VkDescriptorImageInfo imageInfo{ sampler, view, layout };
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = _set;
+		write.dstBinding = TextureBinding;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(_device->Handle(), 1, &write, 0, nullptr);
+
+		return index;
+	}
+
+	uint32_t BindlessDescriptors::AddMaterial(const void* data)
+	{
+		if (_materialCount == _maxMaterials)
+		{
+			LogError("Bindless descriptors: all {} material slots are used", _maxMaterials);
+			return InvalidIndex;
+		}
+
+		const uint32_t index = _materialCount++;
+		const VkDeviceSize offset = static_cast<VkDeviceSize>(index) * _materialSize;
+
+		memcpy(static_cast<std::byte*>(_materials.allocation.mapped) + offset, data, _materialSize);
+		_device->MemoryAllocator().Flush(_materials.allocation, offset, _materialSize);
+
+		return index;
+	}
+} // namespace Eugenix::Render::Vulkan
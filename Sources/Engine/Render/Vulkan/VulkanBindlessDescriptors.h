@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+#include "VulkanAdapter.h"
+#include "VulkanBuffer.h"
+#include "VulkanCommon.h"
+#include "VulkanDevice.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	// One descriptor set holding every texture and material, bound once and indexed by the shaders:
+	//   binding 0: sampler2D textures[]                          (TextureBinding)
+	//   binding 1: readonly buffer { Material materials[]; }     (MaterialBinding, std430)
+	// Draws pass a material index as a push constant, the material holds its texture indices, so a
+	// new material or texture never changes what is bound. Both bindings are update-after-bind and
+	// partially bound: slots are written as they are added, while frames that do not read them yet
+	// are in flight, and slots nothing wrote stay empty.
+	class BindlessDescriptors final
+	{
+	public:
+		static constexpr uint32_t TextureBinding = 0;
+		static constexpr uint32_t MaterialBinding = 1;
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		// Needs Device::DescriptorIndexing(). maxTextures is clamped to the device's update-after-bind
+		// sampled image limits. materialSize is the std430 size of the shader's Material struct.
+		bool Create(const Adapter& adapter, Device& device, uint32_t maxTextures, uint32_t maxMaterials, uint32_t materialSize);
+		void Destroy();
+
+		// The slot's index for the shaders, InvalidIndex when the table is full. From the thread that
+		// records draws, not while command buffers using the set are being recorded.
+		uint32_t AddTexture(VkImageView view, VkSampler sampler, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		uint32_t AddMaterial(const void* data);
+
+		template<typename T>
+		uint32_t AddMaterial(const T& material)
+		{
+			static_assert(sizeof(T) % 4 == 0, "Material structs mirror std430 data");
+			return AddMaterial(static_cast<const void*>(&material));
+		}
+
+		VkDescriptorSetLayout Layout() const { return _layout; }
+		VkDescriptorSet Set() const { return _set; }
+
+		uint32_t TextureCount() const { return _textureCount; }
+		uint32_t MaterialCount() const { return _materialCount; }
+
+	private:
+		Device* _device{ nullptr };
+
+		VkDescriptorSetLayout _layout{ VK_NULL_HANDLE };
+		VkDescriptorPool _pool{ VK_NULL_HANDLE };
+		VkDescriptorSet _set{ VK_NULL_HANDLE };
+
+		Buffer _materials;
+		uint32_t _materialSize{};
+
+		uint32_t _maxTextures{};
+		uint32_t _maxMaterials{};
+		uint32_t _textureCount{};
+		uint32_t _materialCount{};
+	};
+} // namespace Eugenix::Render::Vulkan
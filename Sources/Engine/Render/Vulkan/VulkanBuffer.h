@@ -1,12 +1,13 @@
 #pragma once
 
+#include "VulkanAllocator.h"
 #include "VulkanCommon.h"
 
 namespace Eugenix::Render::Vulkan
 {
 	struct Buffer final
 	{
-		VkBuffer buffer;
-		VkDeviceMemory memory;
+		VkBuffer buffer{ VK_NULL_HANDLE };
+		Allocation allocation;
 	};
 } // Eugenix::Render::Vulkan
@@ -6,4 +6,4 @@
 
 #define EUGENIX_VULKAN_ALLOCATOR nullptr
 
-#define VERIFYVULKANRESULT(VkFunction) { const VkResult scopedResult = VkFunction; if (scopedResult != VK_SUCCESS) { Eugenix::LogError("VKResult=", scopedResult, ", Function=", #VkFunction, ", File=", __FILE__, ", Line=", __LINE__); }}
\ No newline at end of file
+#define VERIFYVULKANRESULT(VkFunction) { const VkResult scopedResult = VkFunction; if (scopedResult != VK_SUCCESS) { Eugenix::LogError("VkResult={}, Function={}, File={}, Line={}", static_cast<int>(scopedResult), #VkFunction, __FILE__, __LINE__); }}
\ No newline at end of file
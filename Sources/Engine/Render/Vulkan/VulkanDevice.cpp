@@ -2,6 +2,7 @@
 #include <vector>
 
 #include "Core/Log.h"
+#include "Core/Profiler.h"
 
 #include "VulkanDevice.h"
 #include "VulkanInitializers.h"
@@ -16,16 +17,20 @@ namespace
 
 namespace Eugenix::Render::Vulkan
 {
-	bool Device::Create(Adapter& adapter)
+	bool Device::Create(Adapter& adapter, const std::filesystem::path& pipelineCachePath)
 	{
 		_adapter = &adapter;
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos{};
 		const float queuePriority = 1.0f;
 
+		const QueueFamilyIndices indices = _adapter->Indices();
+		_graphicsFamily = indices.graphicsFamily.value();
+		_transferFamily = indices.transferFamily.value_or(_graphicsFamily);
+
 		std::set<uint32_t> uniqueQueueFamilies = 
 		{ 
-			_adapter->Indices().graphicsFamily.value(), _adapter->Indices().presentFamily.value()
+			_graphicsFamily, indices.presentFamily.value(), _transferFamily
 		};
 
 		for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -36,7 +41,47 @@ namespace Eugenix::Render::Vulkan
 		VkPhysicalDeviceFeatures deviceFeatures{};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
 
-		VkDeviceCreateInfo createInfo = DeviceInfo(queueCreateInfos, deviceFeatures, deviceExtensions);
+		std::vector<const char*> extensions(deviceExtensions.begin(), deviceExtensions.end());
+
+		_calibratedTimestamps = _adapter->ExtensionSupported(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+		if (_calibratedTimestamps)
+			extensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+
+		// Core since 1.2, the upload manager signals its batches on a timeline
+		VkPhysicalDeviceVulkan12Features features12{};
+		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		features12.timelineSemaphore = VK_TRUE;
+
+		VkPhysicalDeviceVulkan12Features supported12{};
+		supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		VkPhysicalDeviceFeatures2 supported{};
+		supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supported.pNext = &supported12;
+		vkGetPhysicalDeviceFeatures2(_adapter->Handle(), &supported);
+
+		// Bindless descriptors, all or nothing
+		_descriptorIndexing = supported12.descriptorIndexing && supported12.runtimeDescriptorArray &&
+			supported12.descriptorBindingPartiallyBound && supported12.descriptorBindingUpdateUnusedWhilePending &&
+			supported12.descriptorBindingSampledImageUpdateAfterBind && supported12.descriptorBindingStorageBufferUpdateAfterBind;
+
+		if (_descriptorIndexing)
+		{
+			features12.descriptorIndexing = VK_TRUE;
+			features12.runtimeDescriptorArray = VK_TRUE;
+			features12.descriptorBindingPartiallyBound = VK_TRUE;
+			features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+			features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			features12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		}
+		else
+		{
+			LogWarn("Vulkan device: descriptor indexing is not supported, bindless descriptors are unavailable");
+		}
+
+		VkDeviceCreateInfo createInfo = DeviceInfo(queueCreateInfos, deviceFeatures, extensions);
+		createInfo.pNext = &features12;
+		createInfo.pEnabledFeatures = &deviceFeatures;	// DeviceInfo pointed at its by-value copy
 
 		VERIFYVULKANRESULT(vkCreateDevice(_adapter->Handle(), &createInfo, EUGENIX_VULKAN_ALLOCATOR, &_device));
 
@@ -44,19 +89,29 @@ namespace Eugenix::Render::Vulkan
 
 		vkGetDeviceQueue(_device, _adapter->Indices().graphicsFamily.value(), 0, &_graphicsQueue);
 		vkGetDeviceQueue(_device, _adapter->Indices().presentFamily.value(), 0, &_presentQueue);
+		vkGetDeviceQueue(_device, _transferFamily, 0, &_transferQueue);
 
-		return true;
+		if (!_pipelineCache.Create(*_adapter, _device, pipelineCachePath))
+			return false;
+
+		return _allocator.Create(*_adapter, _device);
 	}
 
 	void Device::Destroy()
 	{
 		if (_device)
 		{
+			_pipelineCache.Destroy();
+			_allocator.Destroy();
+
 			LogSuccess("Logical device destroyed.");
 			vkDestroyDevice(_device, EUGENIX_VULKAN_ALLOCATOR);
 			_device = VK_NULL_HANDLE;
 			_graphicsQueue = VK_NULL_HANDLE;
 			_presentQueue = VK_NULL_HANDLE;
+			_transferQueue = VK_NULL_HANDLE;
+			_calibratedTimestamps = false;
+			_descriptorIndexing = false;
 		}
 	}
 
@@ -85,21 +140,80 @@ namespace Eugenix::Render::Vulkan
 		return imageView;
 	}
 
-	Buffer Device::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const
+	Buffer Device::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
 	{
+		EUGENIX_PROFILE_SCOPE("Device::CreateBuffer");
+
 		Buffer buffer{};
 
 		VkBufferCreateInfo bufferInfo = BufferCreateInfo(size, usage);
-		VERIFYVULKANRESULT(vkCreateBuffer(_device, &bufferInfo, nullptr, &buffer.buffer));
+		VERIFYVULKANRESULT(vkCreateBuffer(_device, &bufferInfo, EUGENIX_VULKAN_ALLOCATOR, &buffer.buffer));
+
+		VkBufferMemoryRequirementsInfo2 requirementsInfo{};
+		requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+		requirementsInfo.buffer = buffer.buffer;
 
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(_device, buffer.buffer, &memRequirements);
+		VkMemoryDedicatedRequirements dedicated{};
+		dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
 
-		VkMemoryAllocateInfo allocInfo = MemoryAllocateInfo(memRequirements.size, _adapter->FindMemoryType(memRequirements.memoryTypeBits, properties));
-		VERIFYVULKANRESULT(vkAllocateMemory(_device, &allocInfo, EUGENIX_VULKAN_ALLOCATOR, &buffer.memory));
+		VkMemoryRequirements2 requirements{};
+		requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		requirements.pNext = &dedicated;
+		vkGetBufferMemoryRequirements2(_device, &requirementsInfo, &requirements);
 
-		VERIFYVULKANRESULT(vkBindBufferMemory(_device, buffer.buffer, buffer.memory, 0));
+		buffer.allocation = _allocator.Allocate(requirements.memoryRequirements, properties, ResourceKind::Linear,
+			dedicated.prefersDedicatedAllocation);
+
+		VERIFYVULKANRESULT(vkBindBufferMemory(_device, buffer.buffer, buffer.allocation.memory, buffer.allocation.offset));
 
 		return buffer;
 	}
+
+	void Device::DestroyBuffer(Buffer& buffer)
+	{
+		vkDestroyBuffer(_device, buffer.buffer, EUGENIX_VULKAN_ALLOCATOR);
+		_allocator.Free(buffer.allocation);
+		buffer.buffer = VK_NULL_HANDLE;
+	}
+
+	Image Device::CreateImage(const VkImageCreateInfo& createInfo, VkMemoryPropertyFlags properties)
+	{
+		EUGENIX_PROFILE_SCOPE("Device::CreateImage");
+
+		Image image{};
+
+		VERIFYVULKANRESULT(vkCreateImage(_device, &createInfo, EUGENIX_VULKAN_ALLOCATOR, &image.image));
+
+		VkImageMemoryRequirementsInfo2 requirementsInfo{};
+		requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+		requirementsInfo.image = image.image;
+
+		VkMemoryDedicatedRequirements dedicated{};
+		dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+		VkMemoryRequirements2 requirements{};
+		requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		requirements.pNext = &dedicated;
+		vkGetImageMemoryRequirements2(_device, &requirementsInfo, &requirements);
+
+		const ResourceKind kind = createInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::Optimal : ResourceKind::Linear;
+		image.allocation = _allocator.Allocate(requirements.memoryRequirements, properties, kind,
+			dedicated.prefersDedicatedAllocation);
+
+		VERIFYVULKANRESULT(vkBindImageMemory(_device, image.image, image.allocation.memory, image.allocation.offset));
+
+		return image;
+	}
+
+	void Device::DestroyImage(Image& image)
+	{
+		if (image.view)
+			vkDestroyImageView(_device, image.view, EUGENIX_VULKAN_ALLOCATOR);
+
+		vkDestroyImage(_device, image.image, EUGENIX_VULKAN_ALLOCATOR);
+		_allocator.Free(image.allocation);
+
+		image.image = VK_NULL_HANDLE;
+		image.view = VK_NULL_HANDLE;
+	}
 } // namespace Eugenix::Render::Vulkan
\ No newline at end of file
@@ -1,15 +1,21 @@
 #pragma once
 
+#include <filesystem>
+
 #include "VulkanAdapter.h"
+#include "VulkanAllocator.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommon.h"
+#include "VulkanImage.h"
+#include "VulkanPipelineCache.h"
 
 namespace Eugenix::Render::Vulkan
 {
 	class Device
 	{
 	public:
-		bool Create(Adapter& adapter);
+		// The pipeline cache is loaded from and saved to pipelineCachePath
+		bool Create(Adapter& adapter, const std::filesystem::path& pipelineCachePath = "PipelineCache.bin");
 		void Destroy();
 
 		VkDevice Handle() const { return _device; }
@@ -17,8 +23,34 @@ namespace Eugenix::Render::Vulkan
 		VkQueue GraphicsQueue() const { return _graphicsQueue; }
 		VkQueue PresentQueue() const { return _presentQueue; }
 
+		// The graphics queue when the adapter has no transfer only family
+		VkQueue TransferQueue() const { return _transferQueue; }
+
+		uint32_t GraphicsFamily() const { return _graphicsFamily; }
+		uint32_t TransferFamily() const { return _transferFamily; }
+
+		// VK_EXT_calibrated_timestamps, enabled when the adapter exposes it
+		bool CalibratedTimestamps() const { return _calibratedTimestamps; }
+
+		// Core 1.2 descriptor indexing for bindless tables: runtime arrays, partially bound and
+		// update-after-bind sampled image and storage buffer bindings. Enabled when all are supported.
+		bool DescriptorIndexing() const { return _descriptorIndexing; }
+
+		Allocator& MemoryAllocator() { return _allocator; }
+		const Allocator& MemoryAllocator() const { return _allocator; }
+
+		// Every pipeline should be created through it
+		PipelineCache& Pipelines() { return _pipelineCache; }
+
 		VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspect) const;
-		Buffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const;
+
+		// Memory comes from the allocator, host visible buffers are mapped at allocation.mapped
+		Buffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+		void DestroyBuffer(Buffer& buffer);
+
+		// The view is left to the caller, DestroyImage releases it when set
+		Image CreateImage(const VkImageCreateInfo& createInfo, VkMemoryPropertyFlags properties);
+		void DestroyImage(Image& image);
 
 	private:
 		Adapter* _adapter{ nullptr };
@@ -26,5 +58,14 @@ namespace Eugenix::Render::Vulkan
 		VkDevice _device{ VK_NULL_HANDLE };
 		VkQueue _graphicsQueue{ VK_NULL_HANDLE };
 		VkQueue _presentQueue{ VK_NULL_HANDLE };
+		VkQueue _transferQueue{ VK_NULL_HANDLE };
+		uint32_t _graphicsFamily{};
+		uint32_t _transferFamily{};
+
+		Allocator _allocator;
+		PipelineCache _pipelineCache;
+
+		bool _calibratedTimestamps{ false };
+		bool _descriptorIndexing{ false };
 	};
 } // namespace Eugenix::Render::Vulkan
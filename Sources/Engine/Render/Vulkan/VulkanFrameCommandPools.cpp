@@ -0,0 +1,89 @@
+#include <cassert>
+
+#include "Core/Jobs.h"
+#include "Core/Profiler.h"
+
+#include "VulkanFrameCommandPools.h"
+#include "VulkanInitializers.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	bool FrameCommandPools::Create(const Device& device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t threadCount)
+	{
+		_device = device.Handle();
+		_threadCount = threadCount;
+		_frame = 0;
+
+		_pools.resize(static_cast<size_t>(framesInFlight) * threadCount);
+
+		// No RESET_COMMAND_BUFFER_BIT, the pools are only ever reset as a whole
+		VkCommandPoolCreateInfo poolInfo = CommandPoolInfo(queueFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+
+		for (auto& pool : _pools)
+			VERIFYVULKANRESULT(vkCreateCommandPool(_device, &poolInfo, EUGENIX_VULKAN_ALLOCATOR, &pool.pool));
+
+		return true;
+	}
+
+	void FrameCommandPools::Destroy()
+	{
+		// Destroying a pool frees its command buffers
+		for (auto& pool : _pools)
+			vkDestroyCommandPool(_device, pool.pool, EUGENIX_VULKAN_ALLOCATOR);
+
+		_pools.clear();
+		_device = VK_NULL_HANDLE;
+	}
+
+	void FrameCommandPools::BeginFrame(uint32_t frameIndex)
+	{
+		EUGENIX_PROFILE_SCOPE("FrameCommandPools::BeginFrame");
+
+		_frame = frameIndex % (static_cast<uint32_t>(_pools.size()) / _threadCount);
+
+		for (uint32_t thread = 0; thread < _threadCount; ++thread)
+		{
+			ThreadPool& pool = threadPool(thread);
+			VERIFYVULKANRESULT(vkResetCommandPool(_device, pool.pool, 0));
+			pool.usedSecondaries = 0;
+		}
+	}
+
+	VkCommandBuffer FrameCommandPools::Primary()
+	{
+		ThreadPool& pool = threadPool(0);
+
+		if (!pool.primary)
+		{
+			VkCommandBufferAllocateInfo allocInfo = CommandBufferAllocateInfo(pool.pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+			VERIFYVULKANRESULT(vkAllocateCommandBuffers(_device, &allocInfo, &pool.primary));
+		}
+
+		return pool.primary;
+	}
+
+	VkCommandBuffer FrameCommandPools::BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance)
+	{
+		const uint32_t thread = Jobs::ThreadIndex();
+		assert(thread < _threadCount && "FrameCommandPools: recording from a thread without a pool");
+
+		ThreadPool& pool = threadPool(thread);
+
+		if (pool.usedSecondaries == pool.secondaries.size())
+		{
+			VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+			VkCommandBufferAllocateInfo allocInfo = CommandBufferAllocateInfo(pool.pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY, 1);
+			VERIFYVULKANRESULT(vkAllocateCommandBuffers(_device, &allocInfo, &commandBuffer));
+			pool.secondaries.push_back(commandBuffer);
+		}
+
+		const VkCommandBuffer commandBuffer = pool.secondaries[pool.usedSecondaries++];
+
+		VkCommandBufferBeginInfo beginInfo = CommandBufferBeginInfo(
+			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT);
+		beginInfo.pInheritanceInfo = &inheritance;
+		VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+		return commandBuffer;
+	}
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "VulkanCommon.h"
+#include "VulkanDevice.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	// A transient command pool per frame in flight and job thread (Jobs::ThreadIndex()). Threads
+	// record secondary command buffers from their own pool without locking, the frame's primary
+	// comes from the main thread's pool. BeginFrame() resets every pool of the frame with one
+	// vkResetCommandPool each, buffers are never reset or freed one by one and are reused in the
+	// order they were handed out.
+	class FrameCommandPools final
+	{
+	public:
+		bool Create(const Device& device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t threadCount);
+		void Destroy();
+
+		// Main thread, once the frame fence has signaled
+		void BeginFrame(uint32_t frameIndex);
+
+		// The frame's primary command buffer, the same one until the next BeginFrame()
+		VkCommandBuffer Primary();
+
+		// From the calling thread's pool, begun with RENDER_PASS_CONTINUE for the render pass,
+		// subpass and framebuffer of inheritance. The caller ends it.
+		VkCommandBuffer BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance);
+
+		uint32_t ThreadCount() const { return _threadCount; }
+
+	private:
+		struct ThreadPool
+		{
+			VkCommandPool pool{ VK_NULL_HANDLE };
+			VkCommandBuffer primary{ VK_NULL_HANDLE };
+			std::vector<VkCommandBuffer> secondaries;
+			uint32_t usedSecondaries{};
+		};
+
+		ThreadPool& threadPool(uint32_t threadIndex) { return _pools[_frame * _threadCount + threadIndex]; }
+
+		VkDevice _device{ VK_NULL_HANDLE };
+		uint32_t _threadCount{};
+		uint32_t _frame{};
+
+		std::vector<ThreadPool> _pools;	// Frame major
+	};
+} // namespace Eugenix::Render::Vulkan
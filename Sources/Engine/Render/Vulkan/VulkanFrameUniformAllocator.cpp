@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cstddef>
+
+#include "Core/Log.h"
+
+#include "VulkanFrameUniformAllocator.h"
+
+namespace
+{
+	constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+namespace Eugenix::Render::Vulkan
+{
+	bool FrameUniformAllocator::Create(const Adapter& adapter, Device& device, uint32_t framesInFlight, VkDeviceSize frameSize)
+	{
+		const VkPhysicalDeviceLimits& limits = adapter.Properties().limits;
+
+		_device = &device;
+		_alignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+		_frameSize = alignUp(frameSize, _alignment);
+		_framesInFlight = framesInFlight;
+
+		// Dynamic offsets are 32 bit
+		if (_frameSize * framesInFlight > UINT32_MAX)
+		{
+			LogError("Frame uniform allocator: {} frames of {} bytes do not fit dynamic offsets", framesInFlight, _frameSize);
+			return false;
+		}
+
+		// Coherent or not, EndFrame() flushes what the frame wrote
+		_buffer = device.CreateBuffer(_frameSize * framesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+		if (!_buffer.allocation.mapped)
+		{
+			LogError("Frame uniform allocator: no host visible memory");
+			return false;
+		}
+
+		_frameStart = 0;
+		_head = 0;
+		_overflowLogged = false;
+
+		return true;
+	}
+
+	void FrameUniformAllocator::Destroy()
+	{
+		if (!_device)
+			return;
+
+		_device->DestroyBuffer(_buffer);
+		_device = nullptr;
+	}
+
+	void FrameUniformAllocator::BeginFrame(uint32_t frameIndex)
+	{
+		_frameStart = (frameIndex % _framesInFlight) * _frameSize;
+		_head = 0;
+	}
+
+	void FrameUniformAllocator::EndFrame()
+	{
+		if (_head != 0)
+			_device->MemoryAllocator().Flush(_buffer.allocation, _frameStart, _head);
+	}
+
+	FrameUniformAllocator::Range FrameUniformAllocator::Allocate(VkDeviceSize size)
+	{
+		const VkDeviceSize start = alignUp(_head, _alignment);
+		if (start + size > _frameSize)
+		{
+			if (!_overflowLogged)
+			{
+				LogError("Frame uniform allocator: a frame needs more than {} bytes", _frameSize);
+				_overflowLogged = true;
+			}
+			return {};
+		}
+
+		_head = start + size;
+
+		const VkDeviceSize offset = _frameStart + start;
+		return { static_cast<std::byte*>(_buffer.allocation.mapped) + offset, static_cast<uint32_t>(offset), size };
+	}
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "VulkanAdapter.h"
+#include "VulkanBuffer.h"
+#include "VulkanCommon.h"
+#include "VulkanDevice.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	// Per-frame constants in one persistently mapped uniform buffer. Every frame in flight owns a
+	// region of it that is handed out front to back, so an update is a memcpy into memory the GPU
+	// has finished reading: the region is only reset once its frame fence has signaled. Ranges are
+	// bound through VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC descriptors with their offset as the
+	// dynamic offset, the descriptors themselves are written once.
+	class FrameUniformAllocator final
+	{
+	public:
+		// Push() result when the frame's region is full, never a valid dynamic offset
+		static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+		struct Range
+		{
+			void* data{ nullptr };
+			uint32_t offset{};	// Dynamic offset
+			VkDeviceSize size{};
+
+			explicit operator bool() const { return data != nullptr; }
+		};
+
+		bool Create(const Adapter& adapter, Device& device, uint32_t framesInFlight, VkDeviceSize frameSize = 256ull << 10);
+		void Destroy();
+
+		// Call once the frame fence has signaled, the ranges the slot handed out last time are reused
+		void BeginFrame(uint32_t frameIndex);
+
+		// Call before the frame is submitted, makes the writes visible on non-coherent memory
+		void EndFrame();
+
+		// Aligned to minUniformBufferOffsetAlignment. When the frame's region is full the failure is
+		// logged and the range is empty.
+		Range Allocate(VkDeviceSize size);
+
+		// Copies value into a new range, returns its dynamic offset or InvalidOffset when the frame's
+		// region is full. Binding InvalidOffset is invalid usage, the caller skips what reads it.
+		template<typename T>
+		[[nodiscard]] uint32_t Push(const T& value)
+		{
+			const Range range = Allocate(sizeof(T));
+			assert(range && "FrameUniformAllocator: the frame's region is full, create it with a larger frameSize");
+			if (!range)
+				return InvalidOffset;
+
+			memcpy(range.data, &value, sizeof(T));
+			return range.offset;
+		}
+
+		VkBuffer Handle() const { return _buffer.buffer; }
+
+		// For a dynamic uniform buffer binding. range is the size the shader reads, it must not be
+		// larger than the ranges bound with the descriptor.
+		VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize range) const { return { _buffer.buffer, 0, range }; }
+
+		VkDeviceSize FrameSize() const { return _frameSize; }
+
+		// Bytes handed out by the current frame, including alignment padding
+		VkDeviceSize FrameUsed() const { return _head; }
+
+	private:
+		Device* _device{ nullptr };
+		Buffer _buffer;
+
+		VkDeviceSize _alignment{ 1 };
+		VkDeviceSize _frameSize{};
+		uint32_t _framesInFlight{};
+
+		VkDeviceSize _frameStart{};
+		VkDeviceSize _head{};	// Relative to _frameStart
+		bool _overflowLogged{ false };
+	};
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#include "Core/Log.h"
+#include "Core/Platform.h"
+
+
+#include "VulkanGpuProfiler.h"
+
+namespace
+{
+	constexpr uint32_t NoZone = UINT32_MAX;
+
+	// Clocks drift apart slowly, re-anchoring once a second keeps the error well under a zone
+	constexpr int64_t AnchorLifetime = 1'000'000'000;
+
+#if EUGENIX_PLATFORM_WINDOWS
+	constexpr VkTimeDomainEXT HostTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+	constexpr VkTimeDomainEXT HostTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+
+	// steady_clock is built on the same counter as the host time domain on both platforms
+	int64_t hostTimeToProfiler(uint64_t value)
+	{
+#if EUGENIX_PLATFORM_WINDOWS
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+
+		const auto seconds = value / frequency.QuadPart;
+		const auto remainder = value % frequency.QuadPart;
+		const std::chrono::nanoseconds time{ seconds * 1'000'000'000ll + remainder * 1'000'000'000ll / frequency.QuadPart };
+#else
+		const std::chrono::nanoseconds time{ static_cast<int64_t>(value) };
+#endif
+		return Eugenix::Profiler::FromSteadyClock(std::chrono::steady_clock::time_point(
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(time)));
+	}
+}
+
+namespace Eugenix::Render::Vulkan
+{
+	bool GpuProfiler::Create(const Adapter& adapter, const Device& device, uint32_t framesInFlight)
+	{
+		if (adapter.TimestampValidBits() == 0)
+		{
+			LogWarn("GPU profiler: the graphics queue does not support timestamps");
+			return false;
+		}
+
+		_device = device.Handle();
+		_timestampPeriod = adapter.Properties().limits.timestampPeriod;
+		_timestampMask = adapter.TimestampValidBits() >= 64 ? ~0ull : (1ull << adapter.TimestampValidBits()) - 1;
+
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = framesInFlight * MaxZonesPerFrame * 2;
+
+		VERIFYVULKANRESULT(vkCreateQueryPool(_device, &poolInfo, EUGENIX_VULKAN_ALLOCATOR, &_queryPool));
+
+		_slots.resize(framesInFlight);
+		for (auto& slot : _slots)
+			slot.names.reserve(MaxZonesPerFrame);
+
+		_timestamps.resize(MaxZonesPerFrame * 2);
+		_resolved.reserve(MaxZonesPerFrame);
+
+		if (device.CalibratedTimestamps())
+		{
+			auto getTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+				vkGetInstanceProcAddr(adapter.Instance(), "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+
+			uint32_t domainCount = 0;
+			std::vector<VkTimeDomainEXT> domains;
+			if (getTimeDomains && getTimeDomains(adapter.Handle(), &domainCount, nullptr) == VK_SUCCESS)
+			{
+				domains.resize(domainCount);
+				getTimeDomains(adapter.Handle(), &domainCount, domains.data());
+			}
+
+			const bool hasDevice = std::ranges::find(domains, VK_TIME_DOMAIN_DEVICE_EXT) != domains.end();
+			const bool hasHost = std::ranges::find(domains, HostTimeDomain) != domains.end();
+			if (hasDevice && hasHost)
+			{
+				_calibrate = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(vkGetDeviceProcAddr(_device, "vkGetCalibratedTimestampsEXT"));
+				_hostDomain = HostTimeDomain;
+			}
+		}
+
+		static const uint32_t track = Profiler::CreateTrack("GPU Graphics Queue");
+		_track = track;
+
+		LogSuccess("GPU profiler created ({} frames latent, {}).", framesInFlight,
+			_calibrate ? "calibrated timestamps" : "clocks aligned at submit");
+		return true;
+	}
+
+	void GpuProfiler::Destroy()
+	{
+		if (_queryPool)
+		{
+			vkDestroyQueryPool(_device, _queryPool, EUGENIX_VULKAN_ALLOCATOR);
+			_queryPool = VK_NULL_HANDLE;
+		}
+
+		_slots.clear();
+		_current = nullptr;
+		_calibrate = nullptr;
+		_anchor = {};
+	}
+
+	void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		if (!_queryPool)
+			return;
+
+		FrameSlot& slot = _slots[frameIndex];
+		const uint32_t firstQuery = frameIndex * MaxZonesPerFrame * 2;
+
+		if (!slot.names.empty())
+			resolve(slot, firstQuery);
+
+		vkCmdResetQueryPool(commandBuffer, _queryPool, firstQuery, MaxZonesPerFrame * 2);
+
+		slot.names.clear();
+		slot.recordTime = Profiler::Now();
+
+		_current = &slot;
+		_currentFirstQuery = firstQuery;
+	}
+
+	uint32_t GpuProfiler::BeginZone(VkCommandBuffer commandBuffer, const char* name)
+	{
+		if (!_current || _current->names.size() == MaxZonesPerFrame)
+			return NoZone;
+
+		const auto zone = static_cast<uint32_t>(_current->names.size());
+		_current->names.push_back(name);
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _queryPool, _currentFirstQuery + zone * 2);
+		return zone;
+	}
+
+	void GpuProfiler::EndZone(VkCommandBuffer commandBuffer, uint32_t zone)
+	{
+		if (zone == NoZone)
+			return;
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _queryPool, _currentFirstQuery + zone * 2 + 1);
+	}
+
+	void GpuProfiler::resolve(FrameSlot& slot, uint32_t firstQuery)
+	{
+		const auto queryCount = static_cast<uint32_t>(slot.names.size() * 2);
+
+		// The frame fence has signaled, so the results are there; never wait for them
+		const VkResult result = vkGetQueryPoolResults(_device, _queryPool, firstQuery, queryCount,
+			queryCount * sizeof(uint64_t), _timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return;
+
+		const uint64_t first = _timestamps[0] & _timestampMask;
+
+		if (_calibrate)
+		{
+			if (!_anchor.valid || Profiler::Now() - _anchor.cpuTime > AnchorLifetime)
+				calibrate();
+		}
+		else
+		{
+			// Without a shared clock, assume the GPU started the frame when it was recorded.
+			// It can start later but never earlier, so only move the anchor forward.
+			if (!_anchor.valid || toCpuTime(first) < slot.recordTime || slot.recordTime - _anchor.cpuTime > AnchorLifetime)
+				_anchor = { first, slot.recordTime, true };
+		}
+
+		_resolved.clear();
+
+		const bool capturing = Profiler::IsCapturing();
+		int64_t frameStart = INT64_MAX;
+		int64_t frameEnd = INT64_MIN;
+
+		for (size_t zone = 0; zone < slot.names.size(); ++zone)
+		{
+			const int64_t start = toCpuTime(_timestamps[zone * 2] & _timestampMask);
+			const int64_t end = toCpuTime(_timestamps[zone * 2 + 1] & _timestampMask);
+
+			_resolved.push_back({ slot.names[zone], start, end });
+			frameStart = std::min(frameStart, start);
+			frameEnd = std::max(frameEnd, end);
+
+			if (capturing)
+				Profiler::RecordZone(_track, slot.names[zone], start, end);
+		}
+
+		_lastFrameMilliseconds = static_cast<double>(frameEnd - frameStart) / 1'000'000.0;
+	}
+
+	void GpuProfiler::calibrate()
+	{
+		std::array<VkCalibratedTimestampInfoEXT, 2> infos{};
+		infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[1].timeDomain = _hostDomain;
+
+		std::array<uint64_t, 2> timestamps{};
+		uint64_t maxDeviation = 0;
+		if (_calibrate(_device, static_cast<uint32_t>(infos.size()), infos.data(), timestamps.data(), &maxDeviation) != VK_SUCCESS)
+			return;
+
+		_anchor = { timestamps[0] & _timestampMask, hostTimeToProfiler(timestamps[1]), true };
+	}
+
+	int64_t GpuProfiler::toCpuTime(uint64_t ticks) const
+	{
+		// Ticks wrap at the valid bit count, the signed distance to the anchor survives that
+		uint64_t delta = (ticks - _anchor.ticks) & _timestampMask;
+		int64_t signedDelta = static_cast<int64_t>(delta);
+		if (_timestampMask != ~0ull && delta > (_timestampMask >> 1))
+			signedDelta -= static_cast<int64_t>(_timestampMask) + 1;
+
+		return _anchor.cpuTime + static_cast<int64_t>(static_cast<double>(signedDelta) * _timestampPeriod);
+	}
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Core/Profiler.h"
+
+#include "VulkanAdapter.h"
+#include "VulkanCommon.h"
+#include "VulkanDevice.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	// Timestamp queries on the graphics queue, converted to the CPU profiler timeline.
+	// Every frame in flight owns a slice of the query pool. A slice is read back when its frame
+	// comes round again, after the frame fence was waited on, so results are framesInFlight
+	// frames old and reading them never stalls.
+	class GpuProfiler final
+	{
+	public:
+		static constexpr uint32_t MaxZonesPerFrame = 64;
+
+		struct ZoneResult
+		{
+			const char* name;
+			int64_t start;	// Profiler::Now() timeline, ns
+			int64_t end;
+		};
+
+		bool Create(const Adapter& adapter, const Device& device, uint32_t framesInFlight);
+		void Destroy();
+
+		// Call once the frame fence has signaled, right after vkBeginCommandBuffer and outside a render pass.
+		// Resolves the timestamps the slot recorded last time and resets it for this frame.
+		void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		// Returns the zone to pass to EndZone. Zones over MaxZonesPerFrame are dropped.
+		uint32_t BeginZone(VkCommandBuffer commandBuffer, const char* name);
+		void EndZone(VkCommandBuffer commandBuffer, uint32_t zone);
+
+		bool IsCalibrated() const { return _calibrate != nullptr; }
+
+		// Zones of the most recently resolved frame
+		std::span<const ZoneResult> LastFrameZones() const { return _resolved; }
+
+		// From the first to the last timestamp of the most recently resolved frame
+		double LastFrameMilliseconds() const { return _lastFrameMilliseconds; }
+
+	private:
+		struct FrameSlot
+		{
+			std::vector<const char*> names;
+			int64_t recordTime{};	// CPU time the slot was recorded, anchors uncalibrated clocks
+		};
+
+		// GPU ticks at a known CPU time
+		struct Anchor
+		{
+			uint64_t ticks{};
+			int64_t cpuTime{};
+			bool valid{ false };
+		};
+
+		void resolve(FrameSlot& slot, uint32_t firstQuery);
+		void calibrate();
+
+		int64_t toCpuTime(uint64_t ticks) const;
+
+		VkDevice _device{ VK_NULL_HANDLE };
+		VkQueryPool _queryPool{ VK_NULL_HANDLE };
+
+		std::vector<FrameSlot> _slots;
+		FrameSlot* _current{ nullptr };
+		uint32_t _currentFirstQuery{};
+
+		double _timestampPeriod{ 1.0 };
+		uint64_t _timestampMask{ ~0ull };
+
+		PFN_vkGetCalibratedTimestampsEXT _calibrate{ nullptr };
+		VkTimeDomainEXT _hostDomain{};
+		Anchor _anchor{};
+
+		uint32_t _track{};
+		std::vector<uint64_t> _timestamps;
+		std::vector<ZoneResult> _resolved;
+		double _lastFrameMilliseconds{};
+	};
+
+	class GpuZone final
+	{
+	public:
+		GpuZone(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name)
+			: _profiler(profiler)
+			, _commandBuffer(commandBuffer)
+			, _zone(profiler.BeginZone(commandBuffer, name))
+		{
+		}
+
+		~GpuZone()
+		{
+			_profiler.EndZone(_commandBuffer, _zone);
+		}
+
+		GpuZone(const GpuZone&) = delete;
+		GpuZone& operator=(const GpuZone&) = delete;
+
+	private:
+		GpuProfiler& _profiler;
+		VkCommandBuffer _commandBuffer;
+		uint32_t _zone;
+	};
+} // namespace Eugenix::Render::Vulkan
+
+#if EUGENIX_PROFILING_ENABLED
+#	define EUGENIX_GPU_PROFILE_SCOPE(profiler, commandBuffer, name) ::Eugenix::Render::Vulkan::GpuZone EUGENIX_PROFILE_CONCAT(_eugenixGpuZone, __LINE__){ profiler, commandBuffer, name }
+#else
+#	define EUGENIX_GPU_PROFILE_SCOPE(profiler, commandBuffer, name)
+#endif
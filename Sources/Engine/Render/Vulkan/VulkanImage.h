@@ -1,5 +1,6 @@
 #pragma once
 
+#include "VulkanAllocator.h"
 #include "VulkanCommon.h"
 
 namespace Eugenix::Render::Vulkan
@@ -9,6 +10,6 @@ namespace Eugenix::Render::Vulkan
 		VkImage image{ VK_NULL_HANDLE };
 		VkImageView view{ VK_NULL_HANDLE };
 
-		VkDeviceMemory memory{ VK_NULL_HANDLE };
+		Allocation allocation;
 	};
 } // Eugenix::Render::Vulkan
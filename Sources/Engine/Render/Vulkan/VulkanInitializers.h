@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <span>
 #include <vector>
 
@@ -369,6 +370,17 @@ namespace Eugenix
 				return shaderModuleInfo;
 			}
 
+			// SPIR-V straight from a mapped file, mappings are page aligned so pCode alignment holds
+			inline VkShaderModuleCreateInfo ShaderModuleInfo(std::span<const std::byte> code)
+			{
+				VkShaderModuleCreateInfo shaderModuleInfo{};
+				shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+				shaderModuleInfo.codeSize = code.size();
+				shaderModuleInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+				return shaderModuleInfo;
+			}
+
 			inline VkCommandPoolCreateInfo CommandPoolInfo(uint32_t familyIndex, VkCommandPoolCreateFlags flags)
 			{
 				VkCommandPoolCreateInfo commandPoolInfo{};
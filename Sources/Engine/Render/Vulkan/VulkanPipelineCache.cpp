@@ -0,0 +1,286 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+
+#include "VulkanPipelineCache.h"
+
+namespace
+{
+	constexpr uint32_t FileMagic = 0x43505645;	// "EVPC"
+	constexpr uint32_t FileVersion = 1;
+
+	uint64_t hashBytes(std::span<const uint8_t> bytes)
+	{
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+		for (uint8_t byte : bytes)
+		{
+			hash ^= byte;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	double millisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+namespace Eugenix::Render::Vulkan
+{
+	bool PipelineCache::Create(const Adapter& adapter, VkDevice device, const std::filesystem::path& path)
+	{
+		_device = device;
+		_path = path;
+		_owner = std::this_thread::get_id();
+		_stats = {};
+
+		VkPhysicalDeviceIDProperties idProperties{};
+		idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &idProperties;
+		vkGetPhysicalDeviceProperties2(adapter.Handle(), &properties);
+
+		_properties = properties.properties;
+		memcpy(_driverUUID, idProperties.driverUUID, VK_UUID_SIZE);
+
+		_initialData = load();
+		_stats.warm = !_initialData.empty();
+
+		_cache = createCache(_initialData);
+		if (!_cache && _stats.warm)
+		{
+			LogWarn("Pipeline cache: the driver rejected {}, starting cold", _path.string());
+			_initialData.clear();
+			_stats.warm = false;
+			_cache = createCache({});
+		}
+
+		if (!_cache)
+			return false;
+
+		LogSuccess("Pipeline cache created ({}).", _stats.warm ? "warm" : "cold");
+		return true;
+	}
+
+	void PipelineCache::Destroy()
+	{
+		if (!_cache)
+			return;
+
+		Save();
+
+		std::lock_guard lock(_mutex);
+		for (const auto& [thread, cache] : _threadCaches)
+			vkDestroyPipelineCache(_device, cache, EUGENIX_VULKAN_ALLOCATOR);
+		_threadCaches.clear();
+
+		vkDestroyPipelineCache(_device, _cache, EUGENIX_VULKAN_ALLOCATOR);
+		_cache = VK_NULL_HANDLE;
+		_initialData.clear();
+	}
+
+	bool PipelineCache::Save()
+	{
+		EUGENIX_PROFILE_SCOPE("PipelineCache::Save");
+
+		std::lock_guard lock(_mutex);
+
+		mergeThreadCaches();
+
+		size_t size{};
+		VERIFYVULKANRESULT(vkGetPipelineCacheData(_device, _cache, &size, nullptr));
+
+		std::vector<uint8_t> data(size);
+		VERIFYVULKANRESULT(vkGetPipelineCacheData(_device, _cache, &size, data.data()));
+		data.resize(size);
+
+		FileHeader header = expectedHeader();
+		header.dataSize = data.size();
+		header.dataHash = hashBytes(data);
+
+		// Written next to the target and renamed over it, a crash mid-write leaves the old blob
+		std::filesystem::path temporary = _path;
+		temporary += ".tmp";
+
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				LogError("Pipeline cache: failed to open {}", temporary.string());
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+			if (!file)
+			{
+				LogError("Pipeline cache: failed to write {}", temporary.string());
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, _path, error);
+		if (error)
+		{
+			LogError("Pipeline cache: failed to replace {}: {}", _path.string(), error.message());
+			return false;
+		}
+
+		LogInfo("Pipeline cache: {} bytes saved to {}", data.size(), _path.string());
+		return true;
+	}
+
+	VkPipelineCache PipelineCache::Handle()
+	{
+		const auto thread = std::this_thread::get_id();
+		if (thread == _owner)
+			return _cache;
+
+		std::lock_guard lock(_mutex);
+
+		auto [it, inserted] = _threadCaches.try_emplace(thread, VK_NULL_HANDLE);
+		if (inserted)
+			it->second = createCache(_initialData);
+
+		return it->second;
+	}
+
+	VkResult PipelineCache::CreateGraphicsPipelines(std::span<const VkGraphicsPipelineCreateInfo> createInfos, VkPipeline* pipelines)
+	{
+		EUGENIX_PROFILE_SCOPE("PipelineCache::CreateGraphicsPipelines");
+
+		const VkPipelineCache cache = Handle();
+		const auto start = std::chrono::steady_clock::now();
+
+		const VkResult result = vkCreateGraphicsPipelines(_device, cache, static_cast<uint32_t>(createInfos.size()),
+			createInfos.data(), EUGENIX_VULKAN_ALLOCATOR, pipelines);
+
+		addTime(static_cast<uint32_t>(createInfos.size()), millisecondsSince(start));
+		return result;
+	}
+
+	VkResult PipelineCache::CreateComputePipelines(std::span<const VkComputePipelineCreateInfo> createInfos, VkPipeline* pipelines)
+	{
+		EUGENIX_PROFILE_SCOPE("PipelineCache::CreateComputePipelines");
+
+		const VkPipelineCache cache = Handle();
+		const auto start = std::chrono::steady_clock::now();
+
+		const VkResult result = vkCreateComputePipelines(_device, cache, static_cast<uint32_t>(createInfos.size()),
+			createInfos.data(), EUGENIX_VULKAN_ALLOCATOR, pipelines);
+
+		addTime(static_cast<uint32_t>(createInfos.size()), millisecondsSince(start));
+		return result;
+	}
+
+	PipelineCacheStats PipelineCache::Stats() const
+	{
+		std::lock_guard lock(_mutex);
+		return _stats;
+	}
+
+	PipelineCache::FileHeader PipelineCache::expectedHeader() const
+	{
+		FileHeader header{};
+		header.magic = FileMagic;
+		header.version = FileVersion;
+		header.vendorID = _properties.vendorID;
+		header.deviceID = _properties.deviceID;
+		header.driverVersion = _properties.driverVersion;
+		memcpy(header.driverUUID, _driverUUID, VK_UUID_SIZE);
+		memcpy(header.pipelineCacheUUID, _properties.pipelineCacheUUID, VK_UUID_SIZE);
+		return header;
+	}
+
+	std::vector<uint8_t> PipelineCache::load() const
+	{
+		EUGENIX_PROFILE_SCOPE("PipelineCache::load");
+
+		std::error_code error;
+		if (!std::filesystem::is_regular_file(_path, error))
+			return {};
+
+		std::ifstream file(_path, std::ios::binary);
+		if (!file)
+			return {};
+
+		FileHeader header{};
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+		const FileHeader expected = expectedHeader();
+		if (!file || header.magic != expected.magic || header.version != expected.version)
+		{
+			LogWarn("Pipeline cache: {} is not a pipeline cache file", _path.string());
+			return {};
+		}
+
+		// A driver update or another GPU makes the blob useless, it is rebuilt and overwritten
+		if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID ||
+			header.driverVersion != expected.driverVersion ||
+			memcmp(header.driverUUID, expected.driverUUID, VK_UUID_SIZE) != 0 ||
+			memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		{
+			LogInfo("Pipeline cache: {} was written by another device or driver", _path.string());
+			return {};
+		}
+
+		std::vector<uint8_t> data(static_cast<size_t>(header.dataSize));
+		file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+		if (!file || hashBytes(data) != header.dataHash)
+		{
+			LogWarn("Pipeline cache: {} is truncated or corrupt", _path.string());
+			return {};
+		}
+
+		return data;
+	}
+
+	VkPipelineCache PipelineCache::createCache(std::span<const uint8_t> initialData) const
+	{
+		VkPipelineCacheCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		createInfo.initialDataSize = initialData.size();
+		createInfo.pInitialData = initialData.data();
+
+		VkPipelineCache cache{ VK_NULL_HANDLE };
+		if (vkCreatePipelineCache(_device, &createInfo, EUGENIX_VULKAN_ALLOCATOR, &cache) != VK_SUCCESS)
+			return VK_NULL_HANDLE;
+
+		return cache;
+	}
+
+	void PipelineCache::mergeThreadCaches()
+	{
+		if (_threadCaches.empty())
+			return;
+
+		std::vector<VkPipelineCache> sources;
+		sources.reserve(_threadCaches.size());
+		for (const auto& [thread, cache] : _threadCaches)
+		{
+			if (cache)
+				sources.push_back(cache);
+		}
+
+		// The thread caches keep working, they just contribute their pipelines to the saved blob
+		if (!sources.empty())
+			VERIFYVULKANRESULT(vkMergePipelineCaches(_device, _cache, static_cast<uint32_t>(sources.size()), sources.data()));
+	}
+
+	void PipelineCache::addTime(uint32_t pipelines, double milliseconds)
+	{
+		std::lock_guard lock(_mutex);
+		_stats.pipelines += pipelines;
+		_stats.milliseconds += milliseconds;
+	}
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "VulkanAdapter.h"
+#include "VulkanCommon.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	struct PipelineCacheStats
+	{
+		uint32_t pipelines{};
+		double milliseconds{};	// Spent in vkCreate*Pipelines
+		bool warm{ false };		// Started from a valid blob on disk
+	};
+
+	// VkPipelineCache that outlives the process. The blob is loaded at Create() when it was written
+	// by the same vendor, device, driver and cache UUID, and written back at Destroy(). The thread
+	// that created the cache uses it directly, every other thread gets a cache of its own seeded
+	// with the loaded blob so compiles on different threads never contend for one cache. Thread
+	// caches are merged into the main one before it is saved.
+	class PipelineCache final
+	{
+	public:
+		bool Create(const Adapter& adapter, VkDevice device, const std::filesystem::path& path);
+		void Destroy();
+
+		// Merges the thread caches and writes the blob, Destroy() does this as well. From the thread
+		// that created the cache, it is the only one using the main cache directly.
+		bool Save();
+
+		// The calling thread's cache
+		VkPipelineCache Handle();
+
+		// Timed, the calling thread's cache
+		VkResult CreateGraphicsPipelines(std::span<const VkGraphicsPipelineCreateInfo> createInfos, VkPipeline* pipelines);
+		VkResult CreateComputePipelines(std::span<const VkComputePipelineCreateInfo> createInfos, VkPipeline* pipelines);
+
+		PipelineCacheStats Stats() const;
+
+	private:
+		// Precedes the driver's blob on disk. The driver validates its own header as well, but a
+		// truncated or stale file must never reach vkCreatePipelineCache.
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t driverUUID[VK_UUID_SIZE];
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+			uint64_t dataSize;
+			uint64_t dataHash;
+		};
+
+		FileHeader expectedHeader() const;
+		std::vector<uint8_t> load() const;
+		VkPipelineCache createCache(std::span<const uint8_t> initialData) const;
+		void mergeThreadCaches();
+		void addTime(uint32_t pipelines, double milliseconds);
+
+		VkDevice _device{ VK_NULL_HANDLE };
+		std::filesystem::path _path;
+
+		VkPhysicalDeviceProperties _properties{};
+		uint8_t _driverUUID[VK_UUID_SIZE]{};
+
+		VkPipelineCache _cache{ VK_NULL_HANDLE };
+		std::thread::id _owner;
+		std::vector<uint8_t> _initialData;
+
+		mutable std::mutex _mutex;
+		std::unordered_map<std::thread::id, VkPipelineCache> _threadCaches;
+
+		PipelineCacheStats _stats;
+	};
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,525 @@
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <sstream>
+
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+#include "IO/IO.h"
+
+#include "VulkanInitializers.h"
+#include "VulkanPipelineCompiler.h"
+
+namespace
+{
+	constexpr std::string_view ManifestHeader = "EugenixPipelines 1";
+
+	template<typename T>
+	void hashCombine(uint64_t& seed, const T& value)
+	{
+		seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+	}
+
+	bool usesLayout(const Eugenix::Render::Vulkan::GraphicsPipelineDesc& desc, std::string_view name) { return desc.layout == name; }
+	bool usesRenderPass(const Eugenix::Render::Vulkan::GraphicsPipelineDesc& desc, std::string_view name) { return desc.renderPass == name; }
+	bool usesVertexLayout(const Eugenix::Render::Vulkan::GraphicsPipelineDesc& desc, std::string_view name) { return desc.vertexLayout == name; }
+}
+
+namespace Eugenix::Render::Vulkan
+{
+	uint64_t GraphicsPipelineDesc::Hash() const
+	{
+		uint64_t seed = 0;
+		hashCombine(seed, vertexShader);
+		hashCombine(seed, fragmentShader);
+		hashCombine(seed, vertexLayout);
+		hashCombine(seed, layout);
+		hashCombine(seed, renderPass);
+		hashCombine(seed, subpass);
+		hashCombine(seed, static_cast<uint32_t>(topology));
+		hashCombine(seed, static_cast<uint32_t>(polygonMode));
+		hashCombine(seed, static_cast<uint32_t>(cullMode));
+		hashCombine(seed, static_cast<uint32_t>(frontFace));
+		hashCombine(seed, static_cast<uint32_t>(samples));
+		hashCombine(seed, depthTest);
+		hashCombine(seed, depthWrite);
+		hashCombine(seed, static_cast<uint32_t>(depthCompare));
+		hashCombine(seed, blend);
+		return seed;
+	}
+
+	bool PipelineCompiler::Create(Device& device, const std::filesystem::path& manifestPath, uint32_t threadCount)
+	{
+		_device = &device;
+		_manifestPath = manifestPath;
+		_previousSession = loadManifest();
+
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency() / 4);
+
+		_running = true;
+		for (uint32_t i = 0; i < threadCount; ++i)
+			_threads.emplace_back([this] { run(); });
+
+		LogSuccess("Pipeline compiler created ({} threads, {} pipelines in the manifest).", threadCount, _previousSession.size());
+		return true;
+	}
+
+	void PipelineCompiler::Destroy()
+	{
+		if (!_device)
+			return;
+
+		{
+			std::lock_guard lock(_mutex);
+			_running = false;
+		}
+		_wake.notify_all();
+
+		for (auto& thread : _threads)
+			thread.join();
+		_threads.clear();
+
+		saveManifest();
+
+		for (auto& [key, entry] : _entries)
+			vkDestroyPipeline(_device->Handle(), entry.pipeline, EUGENIX_VULKAN_ALLOCATOR);
+		_entries.clear();
+		_queue.clear();
+
+		for (auto& [path, module] : _shaders)
+			vkDestroyShaderModule(_device->Handle(), module, EUGENIX_VULKAN_ALLOCATOR);
+		_shaders.clear();
+
+		_layouts.clear();
+		_renderPasses.clear();
+		_vertexLayouts.clear();
+		_previousSession.clear();
+		_device = nullptr;
+	}
+
+	void PipelineCompiler::SetLayout(std::string_view name, VkPipelineLayout layout)
+	{
+		std::unique_lock lock(_mutex);
+		beginChange(lock);
+
+		if (layout)
+			_layouts[std::string(name)] = layout;
+		else
+			_layouts.erase(std::string(name));
+
+		endChange(usesLayout, name);
+	}
+
+	void PipelineCompiler::SetRenderPass(std::string_view name, VkRenderPass renderPass)
+	{
+		std::unique_lock lock(_mutex);
+		beginChange(lock);
+
+		if (renderPass)
+			_renderPasses[std::string(name)] = renderPass;
+		else
+			_renderPasses.erase(std::string(name));
+
+		endChange(usesRenderPass, name);
+	}
+
+	void PipelineCompiler::SetVertexLayout(std::string_view name, std::span<const VkVertexInputBindingDescription> bindings,
+		std::span<const VkVertexInputAttributeDescription> attributes)
+	{
+		std::unique_lock lock(_mutex);
+		beginChange(lock);
+
+		_vertexLayouts[std::string(name)] = { { bindings.begin(), bindings.end() }, { attributes.begin(), attributes.end() } };
+
+		endChange(usesVertexLayout, name);
+	}
+
+	PipelineCompiler::Key PipelineCompiler::Request(const GraphicsPipelineDesc& desc)
+	{
+		Key key{};
+
+		{
+			std::lock_guard lock(_mutex);
+
+			auto [it, inserted] = emplaceEntry(desc);
+			key = it->first;
+			if (!inserted)
+				return key;
+
+			enqueue(key, it->second);
+		}
+
+		_wake.notify_one();
+		return key;
+	}
+
+	VkPipeline PipelineCompiler::Get(Key key, VkPipeline fallback) const
+	{
+		std::lock_guard lock(_mutex);
+
+		const auto it = _entries.find(key);
+		if (it == _entries.end() || it->second.state != State::Ready)
+			return fallback;
+
+		return it->second.pipeline;
+	}
+
+	bool PipelineCompiler::Ready(Key key) const
+	{
+		std::lock_guard lock(_mutex);
+
+		const auto it = _entries.find(key);
+		return it != _entries.end() && it->second.state == State::Ready;
+	}
+
+	uint32_t PipelineCompiler::WarmUp()
+	{
+		EUGENIX_PROFILE_SCOPE("PipelineCompiler::WarmUp");
+
+		uint32_t queued = 0;
+		{
+			std::lock_guard lock(_mutex);
+
+			for (const auto& desc : _previousSession)
+			{
+				if (!resolvable(desc))
+					continue;
+
+				auto [it, inserted] = emplaceEntry(desc);
+				if (!inserted)
+					continue;
+
+				enqueue(it->first, it->second);
+				++queued;
+			}
+		}
+
+		_wake.notify_all();
+		LogInfo("Pipeline compiler: warming up {} of {} pipelines from the last session", queued, _previousSession.size());
+		return queued;
+	}
+
+	uint32_t PipelineCompiler::Pending() const
+	{
+		std::lock_guard lock(_mutex);
+
+		uint32_t pending = 0;
+		for (const auto& [key, entry] : _entries)
+		{
+			if (entry.state != State::Ready && entry.state != State::Failed)
+				++pending;
+		}
+		return pending;
+	}
+
+	void PipelineCompiler::run()
+	{
+		EUGENIX_PROFILE_THREAD("PipelineCompiler");
+
+		std::unique_lock lock(_mutex);
+
+		while (true)
+		{
+			_wake.wait(lock, [this] { return !_running || (_changes == 0 && !_queue.empty()); });
+			if (!_running)
+				break;
+
+			const Key key = _queue.front();
+			_queue.pop_front();
+
+			// Dropped from the queue by a name that went away since
+			Entry& entry = _entries.at(key);
+			if (entry.state != State::Queued)
+				continue;
+
+			const GraphicsPipelineDesc desc = entry.desc;
+			const Resolved resolved{ _layouts.at(desc.layout), _renderPasses.at(desc.renderPass), _vertexLayouts.at(desc.vertexLayout) };
+
+			entry.state = State::Compiling;
+			++_compiling;
+
+			lock.unlock();
+			const VkPipeline pipeline = compile(desc, resolved);
+			lock.lock();
+
+			// Entries are never erased while running, the reference is still good
+			Entry& done = _entries.at(key);
+			done.pipeline = pipeline;
+			done.state = pipeline ? State::Ready : State::Failed;
+
+			if (--_compiling == 0)
+				_idle.notify_all();
+		}
+	}
+
+	VkPipeline PipelineCompiler::compile(const GraphicsPipelineDesc& desc, const Resolved& resolved)
+	{
+		EUGENIX_PROFILE_SCOPE("PipelineCompiler::compile");
+
+		const VkShaderModule vertexModule = shaderModule(desc.vertexShader);
+		const VkShaderModule fragmentModule = shaderModule(desc.fragmentShader);
+		if (!vertexModule || !fragmentModule)
+			return VK_NULL_HANDLE;
+
+		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages =
+		{
+			ShaderStageInfo(VK_SHADER_STAGE_VERTEX_BIT, vertexModule, "main"),
+			ShaderStageInfo(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentModule, "main")
+		};
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = VertexInputStateInfo(resolved.vertexLayout.bindings,
+			resolved.vertexLayout.attributes);
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly = InputAssemplyInfo(desc.topology, VK_FALSE);
+
+		// Dynamic, the pipeline does not depend on the swapchain extent
+		VkPipelineViewportStateCreateInfo viewportState{};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+		std::array<VkDynamicState, 2> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+		VkPipelineDynamicStateCreateInfo dynamicState{};
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		dynamicState.pDynamicStates = dynamicStates.data();
+
+		VkPipelineRasterizationStateCreateInfo rasterizer = RasterizationStateInfo(VK_FALSE, desc.polygonMode, VK_FALSE, 1.0f,
+			desc.cullMode, desc.frontFace, VK_FALSE, 0.0f, 0.0f, 0.0f);
+
+		VkPipelineMultisampleStateCreateInfo multisampling = MultisampleStateInfo(VK_FALSE, desc.samples, 1.0f, nullptr, VK_FALSE, VK_FALSE);
+
+		VkPipelineDepthStencilStateCreateInfo depthStencil = DepthStencilStateInfo(desc.depthTest, desc.depthWrite,
+			desc.depthCompare, VK_FALSE, VK_FALSE);
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+			VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachment.blendEnable = desc.blend;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstColorBlendFactor = desc.blend ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = desc.blend ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		std::array<VkPipelineColorBlendAttachmentState, 1> colorAttachments = { colorBlendAttachment };
+		VkPipelineColorBlendStateCreateInfo colorBlending = ColorBlendStateInfo(VK_FALSE, VK_LOGIC_OP_COPY, colorAttachments,
+			{ 0.0f, 0.0f, 0.0f, 0.0f });
+
+		VkGraphicsPipelineCreateInfo pipelineInfo = PipelineInfo(shaderStages, vertexInputInfo, inputAssembly, viewportState,
+			rasterizer, multisampling, depthStencil, colorBlending, &dynamicState, resolved.layout, resolved.renderPass,
+			desc.subpass, VK_NULL_HANDLE, -1);
+
+		// Each worker goes through a pipeline cache of its own
+		VkPipeline pipeline{ VK_NULL_HANDLE };
+		if (_device->Pipelines().CreateGraphicsPipelines({ &pipelineInfo, 1 }, &pipeline) != VK_SUCCESS)
+		{
+			LogError("Pipeline compiler: failed to build {} / {}", desc.vertexShader, desc.fragmentShader);
+			return VK_NULL_HANDLE;
+		}
+
+		return pipeline;
+	}
+
+	VkShaderModule PipelineCompiler::shaderModule(const std::string& path)
+	{
+		std::lock_guard lock(_shaderMutex);
+
+		if (const auto it = _shaders.find(path); it != _shaders.end())
+			return it->second;
+
+		VkShaderModule module{ VK_NULL_HANDLE };
+
+		const auto code = IO::File::Map(path);
+		if (code.IsOpen())
+		{
+			VkShaderModuleCreateInfo createInfo = ShaderModuleInfo(code.Bytes());
+			if (vkCreateShaderModule(_device->Handle(), &createInfo, EUGENIX_VULKAN_ALLOCATOR, &module) != VK_SUCCESS)
+				module = VK_NULL_HANDLE;
+		}
+
+		if (!module)
+			LogError("Pipeline compiler: failed to load shader {}", path);
+
+		// Failures are remembered as well, every pipeline using the shader fails without a retry
+		_shaders.emplace(path, module);
+		return module;
+	}
+
+	bool PipelineCompiler::resolvable(const GraphicsPipelineDesc& desc) const
+	{
+		return _layouts.contains(desc.layout) && _renderPasses.contains(desc.renderPass) &&
+			_vertexLayouts.contains(desc.vertexLayout);
+	}
+
+	void PipelineCompiler::enqueue(Key key, Entry& entry)
+	{
+		if (!resolvable(entry.desc))
+		{
+			entry.state = State::Waiting;
+			return;
+		}
+
+		entry.state = State::Queued;
+		_queue.push_back(key);
+	}
+
+	std::pair<std::unordered_map<PipelineCompiler::Key, PipelineCompiler::Entry>::iterator, bool> PipelineCompiler::emplaceEntry(const GraphicsPipelineDesc& desc)
+	{
+		for (Key key = desc.Hash();; ++key)
+		{
+			auto [it, inserted] = _entries.try_emplace(key);
+			if (inserted)
+			{
+				it->second.desc = desc;
+				return { it, true };
+			}
+
+			if (it->second.desc == desc)
+				return { it, false };
+
+			LogWarn("Pipeline compiler: {} / {} collides with {} / {} on key {:#x}, probing the next one",
+				desc.vertexShader, desc.fragmentShader, it->second.desc.vertexShader, it->second.desc.fragmentShader, key);
+		}
+	}
+
+	const PipelineCompiler::Entry* PipelineCompiler::findEntry(const GraphicsPipelineDesc& desc) const
+	{
+		for (Key key = desc.Hash();; ++key)
+		{
+			const auto it = _entries.find(key);
+			if (it == _entries.end())
+				return nullptr;
+
+			if (it->second.desc == desc)
+				return &it->second;
+		}
+	}
+
+	void PipelineCompiler::beginChange(std::unique_lock<std::mutex>& lock)
+	{
+		EUGENIX_PROFILE_SCOPE("PipelineCompiler::beginChange");
+
+		++_changes;
+		_idle.wait(lock, [this] { return _compiling == 0; });
+	}
+
+	void PipelineCompiler::endChange(bool (*uses)(const GraphicsPipelineDesc&, std::string_view), std::string_view name)
+	{
+		for (auto& [key, entry] : _entries)
+		{
+			if (!uses(entry.desc, name))
+				continue;
+
+			vkDestroyPipeline(_device->Handle(), entry.pipeline, EUGENIX_VULKAN_ALLOCATOR);
+			entry.pipeline = VK_NULL_HANDLE;
+			entry.state = State::Waiting;
+		}
+
+		// Everything the change made resolvable goes to the back of the queue, stale queue keys are
+		// skipped by the workers
+		for (auto& [key, entry] : _entries)
+		{
+			if (entry.state == State::Waiting)
+				enqueue(key, entry);
+		}
+
+		--_changes;
+		_wake.notify_all();
+	}
+
+	std::vector<GraphicsPipelineDesc> PipelineCompiler::loadManifest() const
+	{
+		std::vector<GraphicsPipelineDesc> descs;
+
+		std::ifstream file(_manifestPath);
+		if (!file)
+			return descs;
+
+		std::string line;
+		if (!std::getline(file, line) || line != ManifestHeader)
+		{
+			LogWarn("Pipeline compiler: {} is not a pipeline manifest", _manifestPath.string());
+			return descs;
+		}
+
+		// One pipeline per line, tab separated so paths may contain spaces
+		while (std::getline(file, line))
+		{
+			std::istringstream fields(line);
+
+			GraphicsPipelineDesc desc;
+			uint32_t topology, polygonMode, cullMode, frontFace, samples, depthCompare;
+			int depthTest, depthWrite, blend;
+
+			std::getline(fields, desc.vertexShader, '\t');
+			std::getline(fields, desc.fragmentShader, '\t');
+			std::getline(fields, desc.vertexLayout, '\t');
+			std::getline(fields, desc.layout, '\t');
+			std::getline(fields, desc.renderPass, '\t');
+			fields >> desc.subpass >> topology >> polygonMode >> cullMode >> frontFace >> samples
+				>> depthTest >> depthWrite >> depthCompare >> blend;
+
+			if (!fields)
+			{
+				LogWarn("Pipeline compiler: skipping a malformed line in {}", _manifestPath.string());
+				continue;
+			}
+
+			desc.topology = static_cast<VkPrimitiveTopology>(topology);
+			desc.polygonMode = static_cast<VkPolygonMode>(polygonMode);
+			desc.cullMode = static_cast<VkCullModeFlags>(cullMode);
+			desc.frontFace = static_cast<VkFrontFace>(frontFace);
+			desc.samples = static_cast<VkSampleCountFlagBits>(samples);
+			desc.depthTest = depthTest != 0;
+			desc.depthWrite = depthWrite != 0;
+			desc.depthCompare = static_cast<VkCompareOp>(depthCompare);
+			desc.blend = blend != 0;
+
+			descs.push_back(std::move(desc));
+		}
+
+		return descs;
+	}
+
+	void PipelineCompiler::saveManifest() const
+	{
+		std::ofstream file(_manifestPath, std::ios::trunc);
+		if (!file)
+		{
+			LogError("Pipeline compiler: failed to open {}", _manifestPath.string());
+			return;
+		}
+
+		file << ManifestHeader << '\n';
+
+		// Pipelines of the last session nobody asked for this time stay in, a code path that did
+		// not run is not a reason to compile it late next time. Those that failed are dropped.
+		std::vector<GraphicsPipelineDesc> descs;
+		for (const auto& desc : _previousSession)
+		{
+			const Entry* entry = findEntry(desc);
+			if (!entry || entry->state != State::Failed)
+				descs.push_back(desc);
+		}
+
+		for (const auto& [key, entry] : _entries)
+		{
+			if (entry.state != State::Failed && std::ranges::find(descs, entry.desc) == descs.end())
+				descs.push_back(entry.desc);
+		}
+
+		for (const auto& desc : descs)
+		{
+			file << desc.vertexShader << '\t' << desc.fragmentShader << '\t' << desc.vertexLayout << '\t'
+				<< desc.layout << '\t' << desc.renderPass << '\t' << desc.subpass << ' '
+				<< static_cast<uint32_t>(desc.topology) << ' ' << static_cast<uint32_t>(desc.polygonMode) << ' '
+				<< static_cast<uint32_t>(desc.cullMode) << ' ' << static_cast<uint32_t>(desc.frontFace) << ' '
+				<< static_cast<uint32_t>(desc.samples) << ' ' << desc.depthTest << ' ' << desc.depthWrite << ' '
+				<< static_cast<uint32_t>(desc.depthCompare) << ' ' << desc.blend << '\n';
+		}
+	}
+} // namespace Eugenix::Render::Vulkan
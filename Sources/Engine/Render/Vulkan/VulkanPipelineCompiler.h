@@ -0,0 +1,157 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "VulkanCommon.h"
+#include "VulkanDevice.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	// Everything a graphics pipeline is built from. Objects that only exist at runtime are named
+	// (see PipelineCompiler::SetLayout and friends), so a description means the same pipeline in
+	// every session and can be written to the warm-up manifest. Viewport and scissor are dynamic.
+	struct GraphicsPipelineDesc
+	{
+		std::string vertexShader;	// SPIR-V paths
+		std::string fragmentShader;
+		std::string vertexLayout;
+		std::string layout;
+		std::string renderPass;
+		uint32_t subpass{ 0 };
+
+		VkPrimitiveTopology topology{ VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+		VkPolygonMode polygonMode{ VK_POLYGON_MODE_FILL };
+		VkCullModeFlags cullMode{ VK_CULL_MODE_BACK_BIT };
+		VkFrontFace frontFace{ VK_FRONT_FACE_COUNTER_CLOCKWISE };
+		VkSampleCountFlagBits samples{ VK_SAMPLE_COUNT_1_BIT };
+
+		bool depthTest{ true };
+		bool depthWrite{ true };
+		VkCompareOp depthCompare{ VK_COMPARE_OP_LESS };
+
+		bool blend{ false };	// Premultiplied alpha over the first color attachment
+
+		uint64_t Hash() const;
+		bool operator==(const GraphicsPipelineDesc&) const = default;
+	};
+
+	// Builds pipelines on worker threads of its own, so a compile never lands on the render thread
+	// and never occupies a job worker a frame is waiting for. Request() returns at once, Get() hands
+	// out the pipeline when it is ready and the fallback until then; a draw without a fallback is
+	// skipped. Every pipeline requested in a session is written to a manifest at Destroy(), WarmUp()
+	// queues that set at the next launch before anything asks for it.
+	class PipelineCompiler final
+	{
+	public:
+		using Key = uint64_t;
+
+		// threadCount == 0 uses a quarter of the hardware threads
+		bool Create(Device& device, const std::filesystem::path& manifestPath, uint32_t threadCount = 0);
+		void Destroy();
+
+		// Register the runtime objects descriptions refer to. The manifest stores only the names, a
+		// name stands for one interface: objects that differ in it (e.g. a layout's sets or push
+		// constants) are registered under different names. Replacing or clearing (VK_NULL_HANDLE)
+		// one waits for running compiles and destroys the pipelines built with the old object, the
+		// GPU has to be done with them. They are rebuilt once the name is set again.
+		void SetLayout(std::string_view name, VkPipelineLayout layout);
+		void SetRenderPass(std::string_view name, VkRenderPass renderPass);
+		void SetVertexLayout(std::string_view name, std::span<const VkVertexInputBindingDescription> bindings,
+			std::span<const VkVertexInputAttributeDescription> attributes);
+
+		// Queues the pipeline unless it is known already
+		Key Request(const GraphicsPipelineDesc& desc);
+
+		VkPipeline Get(Key key, VkPipeline fallback = VK_NULL_HANDLE) const;
+		bool Ready(Key key) const;
+
+		// Queues the pipelines of the previous session's manifest whose names are registered,
+		// returns how many
+		uint32_t WarmUp();
+
+		// Requested pipelines that are not built yet
+		uint32_t Pending() const;
+
+	private:
+		enum class State : uint8_t
+		{
+			Waiting,	// A name it refers to is not registered
+			Queued,
+			Compiling,
+			Ready,
+			Failed
+		};
+
+		struct Entry
+		{
+			GraphicsPipelineDesc desc;
+			State state{ State::Waiting };
+			VkPipeline pipeline{ VK_NULL_HANDLE };
+		};
+
+		struct VertexLayout
+		{
+			std::vector<VkVertexInputBindingDescription> bindings;
+			std::vector<VkVertexInputAttributeDescription> attributes;
+		};
+
+		// What a worker needs once the lock is released
+		struct Resolved
+		{
+			VkPipelineLayout layout;
+			VkRenderPass renderPass;
+			VertexLayout vertexLayout;
+		};
+
+		void run();
+		VkPipeline compile(const GraphicsPipelineDesc& desc, const Resolved& resolved);
+		VkShaderModule shaderModule(const std::string& path);
+
+		bool resolvable(const GraphicsPipelineDesc& desc) const;
+		void enqueue(Key key, Entry& entry);
+
+		// With the lock held. A description whose hash is taken by a different one moves on to the
+		// next free key, callers only ever use keys they were handed.
+		std::pair<std::unordered_map<Key, Entry>::iterator, bool> emplaceEntry(const GraphicsPipelineDesc& desc);
+		const Entry* findEntry(const GraphicsPipelineDesc& desc) const;
+
+		// Called with the lock held, blocks new compiles and waits for running ones
+		void beginChange(std::unique_lock<std::mutex>& lock);
+		void endChange(bool (*uses)(const GraphicsPipelineDesc&, std::string_view), std::string_view name);
+
+		std::vector<GraphicsPipelineDesc> loadManifest() const;
+		void saveManifest() const;
+
+		Device* _device{ nullptr };
+		std::filesystem::path _manifestPath;
+		std::vector<GraphicsPipelineDesc> _previousSession;
+
+		mutable std::mutex _mutex;
+		std::condition_variable _wake;		// Workers: queue or shutdown
+		std::condition_variable _idle;		// beginChange(): running compiles finished
+		std::vector<std::thread> _threads;
+		bool _running{ false };
+
+		std::unordered_map<Key, Entry> _entries;
+		std::deque<Key> _queue;
+		uint32_t _compiling{};
+		uint32_t _changes{};
+
+		std::unordered_map<std::string, VkPipelineLayout> _layouts;
+		std::unordered_map<std::string, VkRenderPass> _renderPasses;
+		std::unordered_map<std::string, VertexLayout> _vertexLayouts;
+
+		std::mutex _shaderMutex;
+		std::unordered_map<std::string, VkShaderModule> _shaders;
+	};
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+
+#include "VulkanInitializers.h"
+#include "VulkanUploadManager.h"
+
+namespace
+{
+	constexpr uint64_t alignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+namespace Eugenix::Render::Vulkan
+{
+	bool UploadManager::Create(Device& device, VkDeviceSize stagingSize)
+	{
+		_device = &device;
+		_queue = device.TransferQueue();
+		_transferFamily = device.TransferFamily();
+		_graphicsFamily = device.GraphicsFamily();
+
+		VkCommandPoolCreateInfo poolInfo = CommandPoolInfo(_transferFamily,
+			VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		VERIFYVULKANRESULT(vkCreateCommandPool(device.Handle(), &poolInfo, EUGENIX_VULKAN_ALLOCATOR, &_commandPool));
+
+		VkSemaphoreTypeCreateInfo typeInfo{};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+		VERIFYVULKANRESULT(vkCreateSemaphore(device.Handle(), &semaphoreInfo, EUGENIX_VULKAN_ALLOCATOR, &_timeline));
+
+		_ringSize = alignUp(stagingSize, StagingAlignment);
+		_ring = device.CreateBuffer(_ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		_head = 0;
+		_tail = 0;
+		_nextTicket = 1;
+		_acquired = 0;
+
+		if (!_ring.allocation.mapped)
+		{
+			LogError("Upload manager: no host visible memory for the staging ring");
+			return false;
+		}
+
+		LogSuccess("Upload manager created, copies run on the {}.", DedicatedQueue() ? "dedicated transfer queue" : "graphics queue");
+		return true;
+	}
+
+	void UploadManager::Destroy()
+	{
+		if (!_device)
+			return;
+
+		std::lock_guard lock(_mutex);
+
+		// The staging memory of batches still in flight has to outlive them
+		if (!_inFlight.empty())
+			waitValue(_inFlight.back().ticket);
+		reclaim(completedValue());
+
+		for (auto& temporary : _current.temporaries)
+			_device->DestroyBuffer(temporary);
+		_current = {};
+
+		_device->DestroyBuffer(_ring);
+
+		// Destroying the pool frees its command buffers
+		vkDestroyCommandPool(_device->Handle(), _commandPool, EUGENIX_VULKAN_ALLOCATOR);
+		vkDestroySemaphore(_device->Handle(), _timeline, EUGENIX_VULKAN_ALLOCATOR);
+
+		_commandPool = VK_NULL_HANDLE;
+		_timeline = VK_NULL_HANDLE;
+		_freeCommandBuffers.clear();
+		_bufferReleases.clear();
+		_imageReleases.clear();
+		_bufferAcquires.clear();
+		_imageAcquires.clear();
+		_device = nullptr;
+	}
+
+	UploadManager::Ticket UploadManager::UploadBuffer(const Buffer& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size,
+		VkPipelineStageFlags stages, VkAccessFlags access)
+	{
+		EUGENIX_PROFILE_SCOPE("UploadManager::UploadBuffer");
+
+		std::lock_guard lock(_mutex);
+
+		VkDeviceSize stagingOffset{};
+		const VkBuffer staging = stage(data, size, stagingOffset);
+		const VkCommandBuffer commandBuffer = recording();
+
+		VkBufferCopy region{};
+		region.srcOffset = stagingOffset;
+		region.dstOffset = offset;
+		region.size = size;
+		vkCmdCopyBuffer(commandBuffer, staging, buffer.buffer, 1, &region);
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = access;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = buffer.buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+
+		if (DedicatedQueue())
+		{
+			// Release and acquire name the same families and range, the access masks stay on their side
+			barrier.srcQueueFamilyIndex = _transferFamily;
+			barrier.dstQueueFamilyIndex = _graphicsFamily;
+
+			BufferAcquire& acquire = _bufferAcquires.emplace_back(BufferAcquire{ _current.ticket, barrier, stages });
+			acquire.barrier.srcAccessMask = 0;
+
+			barrier.dstAccessMask = 0;
+		}
+		else
+		{
+			_releaseStages |= stages;
+		}
+
+		_bufferReleases.push_back(barrier);
+		return _current.ticket;
+	}
+
+	UploadManager::Ticket UploadManager::UploadImage(const Image& image, VkExtent3D extent, VkImageAspectFlags aspect, const void* data, VkDeviceSize size,
+		VkPipelineStageFlags stages, VkAccessFlags access)
+	{
+		EUGENIX_PROFILE_SCOPE("UploadManager::UploadImage");
+
+		std::lock_guard lock(_mutex);
+
+		VkDeviceSize stagingOffset{};
+		const VkBuffer staging = stage(data, size, stagingOffset);
+		const VkCommandBuffer commandBuffer = recording();
+
+		VkImageMemoryBarrier toTransfer = ImageMemoryBarrier(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.image, aspect, 0, 1, 0, 1);
+		toTransfer.srcAccessMask = 0;
+		toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &toTransfer);
+
+		VkBufferImageCopy region{};
+		region.bufferOffset = stagingOffset;
+		region.imageSubresource.aspectMask = aspect;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = extent;
+		vkCmdCopyBufferToImage(commandBuffer, staging, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		VkImageMemoryBarrier barrier = ImageMemoryBarrier(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.image, aspect, 0, 1, 0, 1);
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = access;
+
+		if (DedicatedQueue())
+		{
+			// The layout transition is part of both the release and the acquire
+			barrier.srcQueueFamilyIndex = _transferFamily;
+			barrier.dstQueueFamilyIndex = _graphicsFamily;
+
+			ImageAcquire& acquire = _imageAcquires.emplace_back(ImageAcquire{ _current.ticket, barrier, stages });
+			acquire.barrier.srcAccessMask = 0;
+
+			barrier.dstAccessMask = 0;
+		}
+		else
+		{
+			_releaseStages |= stages;
+		}
+
+		_imageReleases.push_back(barrier);
+		return _current.ticket;
+	}
+
+	UploadManager::Ticket UploadManager::Flush()
+	{
+		std::lock_guard lock(_mutex);
+
+		if (!_current.commandBuffer)
+			return _nextTicket - 1;
+
+		return submit();
+	}
+
+	void UploadManager::RecordAcquires(VkCommandBuffer commandBuffer)
+	{
+		EUGENIX_PROFILE_SCOPE("UploadManager::RecordAcquires");
+
+		std::lock_guard lock(_mutex);
+
+		const uint64_t completed = completedValue();
+		reclaim(completed);
+
+		_bufferBarriers.clear();
+		_imageBarriers.clear();
+		VkPipelineStageFlags stages{};
+
+		std::erase_if(_bufferAcquires, [&](const BufferAcquire& acquire)
+			{
+				if (acquire.ticket > completed)
+					return false;
+
+				_bufferBarriers.push_back(acquire.barrier);
+				stages |= acquire.stages;
+				return true;
+			});
+
+		std::erase_if(_imageAcquires, [&](const ImageAcquire& acquire)
+			{
+				if (acquire.ticket > completed)
+					return false;
+
+				_imageBarriers.push_back(acquire.barrier);
+				stages |= acquire.stages;
+				return true;
+			});
+
+		if (!_bufferBarriers.empty() || !_imageBarriers.empty())
+		{
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, stages, 0, 0, nullptr,
+				static_cast<uint32_t>(_bufferBarriers.size()), _bufferBarriers.data(),
+				static_cast<uint32_t>(_imageBarriers.size()), _imageBarriers.data());
+		}
+
+		_acquired = std::max(_acquired, completed);
+	}
+
+	bool UploadManager::Ready(Ticket ticket) const
+	{
+		std::lock_guard lock(_mutex);
+		return ticket <= _acquired;
+	}
+
+	bool UploadManager::Complete(Ticket ticket) const
+	{
+		return completedValue() >= ticket;
+	}
+
+	void UploadManager::Wait(Ticket ticket)
+	{
+		{
+			std::lock_guard lock(_mutex);
+			if (_current.commandBuffer && ticket >= _current.ticket)
+				submit();
+		}
+
+		EUGENIX_PROFILE_SCOPE("UploadManager::Wait");
+		waitValue(ticket);
+	}
+
+	VkBuffer UploadManager::stage(const void* data, VkDeviceSize size, VkDeviceSize& offset)
+	{
+		// Larger than the whole ring, staged on its own and released with its batch
+		if (size > _ringSize)
+		{
+			Buffer temporary = _device->CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			memcpy(temporary.allocation.mapped, data, static_cast<size_t>(size));
+
+			offset = 0;
+			_current.temporaries.push_back(temporary);
+			return temporary.buffer;
+		}
+
+		// A range never wraps, when it does not fit before the end it starts over at the beginning
+		uint64_t start = alignUp(_head, StagingAlignment);
+		if (start % _ringSize + size > _ringSize)
+			start = alignUp(start, _ringSize);
+
+		while (start + size - _tail > _ringSize)
+		{
+			reclaim(completedValue());
+			if (start + size - _tail <= _ringSize)
+				break;
+
+			// Nothing holds the ring, start a fresh lap
+			if (_inFlight.empty() && !_current.commandBuffer)
+			{
+				start = alignUp(_head, _ringSize);
+				_tail = start;
+				break;
+			}
+
+			EUGENIX_PROFILE_SCOPE("UploadManager::WaitForStaging");
+
+			// Only the batch being recorded holds the ring
+			if (_inFlight.empty())
+				submit();
+
+			waitValue(_inFlight.front().ticket);
+		}
+
+		_head = start + size;
+		offset = start % _ringSize;
+
+		memcpy(static_cast<std::byte*>(_ring.allocation.mapped) + offset, data, static_cast<size_t>(size));
+		return _ring.buffer;
+	}
+
+	VkCommandBuffer UploadManager::recording()
+	{
+		if (_current.commandBuffer)
+			return _current.commandBuffer;
+
+		if (_freeCommandBuffers.empty())
+		{
+			VkCommandBufferAllocateInfo allocInfo = CommandBufferAllocateInfo(_commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+			VERIFYVULKANRESULT(vkAllocateCommandBuffers(_device->Handle(), &allocInfo, &_current.commandBuffer));
+		}
+		else
+		{
+			_current.commandBuffer = _freeCommandBuffers.back();
+			_freeCommandBuffers.pop_back();
+			VERIFYVULKANRESULT(vkResetCommandBuffer(_current.commandBuffer, 0));
+		}
+
+		VkCommandBufferBeginInfo beginInfo = CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		VERIFYVULKANRESULT(vkBeginCommandBuffer(_current.commandBuffer, &beginInfo));
+
+		_current.ticket = _nextTicket;
+		return _current.commandBuffer;
+	}
+
+	UploadManager::Ticket UploadManager::submit()
+	{
+		EUGENIX_PROFILE_SCOPE("UploadManager::Submit");
+
+		if (!_bufferReleases.empty() || !_imageReleases.empty())
+		{
+			// A release only has to be ordered after the copies, the acquire does the rest
+			const VkPipelineStageFlags dstStages = DedicatedQueue() ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : _releaseStages;
+			vkCmdPipelineBarrier(_current.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages, 0, 0, nullptr,
+				static_cast<uint32_t>(_bufferReleases.size()), _bufferReleases.data(),
+				static_cast<uint32_t>(_imageReleases.size()), _imageReleases.data());
+		}
+
+		_bufferReleases.clear();
+		_imageReleases.clear();
+		_releaseStages = 0;
+
+		VERIFYVULKANRESULT(vkEndCommandBuffer(_current.commandBuffer));
+
+		const uint64_t signalValue = _current.ticket;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &_current.commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &_timeline;
+
+		VERIFYVULKANRESULT(vkQueueSubmit(_queue, 1, &submitInfo, VK_NULL_HANDLE));
+
+		_current.ringEnd = _head;
+		_inFlight.push_back(std::move(_current));
+		_current = {};
+
+		return _nextTicket++;
+	}
+
+	void UploadManager::reclaim(uint64_t completed)
+	{
+		while (!_inFlight.empty() && _inFlight.front().ticket <= completed)
+		{
+			Batch& batch = _inFlight.front();
+
+			_tail = batch.ringEnd;
+			for (auto& temporary : batch.temporaries)
+				_device->DestroyBuffer(temporary);
+
+			_freeCommandBuffers.push_back(batch.commandBuffer);
+			_inFlight.pop_front();
+		}
+	}
+
+	uint64_t UploadManager::completedValue() const
+	{
+		uint64_t value = 0;
+		VERIFYVULKANRESULT(vkGetSemaphoreCounterValue(_device->Handle(), _timeline, &value));
+		return value;
+	}
+
+	void UploadManager::waitValue(uint64_t value) const
+	{
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &_timeline;
+		waitInfo.pValues = &value;
+
+		VERIFYVULKANRESULT(vkWaitSemaphores(_device->Handle(), &waitInfo, UINT64_MAX));
+	}
+} // namespace Eugenix::Render::Vulkan
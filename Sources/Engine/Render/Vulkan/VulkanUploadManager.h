@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "VulkanBuffer.h"
+#include "VulkanCommon.h"
+#include "VulkanDevice.h"
+#include "VulkanImage.h"
+
+namespace Eugenix::Render::Vulkan
+{
+	// Streams buffer and image data to device local memory on the transfer queue. The data is
+	// copied into a persistently mapped staging ring, the copies of everything uploaded between
+	// two Flush() calls go out as one submission that signals a timeline semaphore. Nothing
+	// waits on the CPU unless the ring is full.
+	//
+	// On a dedicated transfer family the resources are released to the graphics family, the
+	// render thread acquires them with RecordAcquires() once their batch has finished. Without
+	// one the copies run on the graphics queue and the batch ends with the barriers instead, then
+	// Upload*() and Flush() have to be called from the thread that submits graphics work.
+	class UploadManager final
+	{
+	public:
+		// Timeline value the batch holding an upload signals
+		using Ticket = uint64_t;
+
+		bool Create(Device& device, VkDeviceSize stagingSize = 32ull << 20);
+		void Destroy();
+
+		// The data is in the staging ring when these return. stages / access are the first use on
+		// the graphics queue.
+		Ticket UploadBuffer(const Buffer& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size,
+			VkPipelineStageFlags stages, VkAccessFlags access);
+
+		// Mip 0 of layer 0, tightly packed texels, left in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		Ticket UploadImage(const Image& image, VkExtent3D extent, VkImageAspectFlags aspect, const void* data, VkDeviceSize size,
+			VkPipelineStageFlags stages, VkAccessFlags access);
+
+		// Submits what was uploaded since the last call, returns the ticket of the last batch
+		Ticket Flush();
+
+		// Graphics command buffer, ahead of anything that reads uploads. Acquires the resources of
+		// every batch that has finished, their tickets are Ready() from here on.
+		void RecordAcquires(VkCommandBuffer commandBuffer);
+
+		// Usable by graphics commands recorded after the RecordAcquires() that made it ready
+		bool Ready(Ticket ticket) const;
+
+		// The transfer queue is done with the batch
+		bool Complete(Ticket ticket) const;
+
+		// Submits the ticket's batch first when it is still being recorded
+		void Wait(Ticket ticket);
+
+		// Timeline semaphore, for submissions that wait on a ticket on the GPU instead
+		VkSemaphore Semaphore() const { return _timeline; }
+
+		bool DedicatedQueue() const { return _transferFamily != _graphicsFamily; }
+
+	private:
+		static constexpr VkDeviceSize StagingAlignment = 16;
+
+		struct Batch
+		{
+			VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+			Ticket ticket{};
+			uint64_t ringEnd{};
+			std::vector<Buffer> temporaries;	// Staging for uploads larger than the ring
+		};
+
+		struct BufferAcquire
+		{
+			Ticket ticket;
+			VkBufferMemoryBarrier barrier;
+			VkPipelineStageFlags stages;
+		};
+
+		struct ImageAcquire
+		{
+			Ticket ticket;
+			VkImageMemoryBarrier barrier;
+			VkPipelineStageFlags stages;
+		};
+
+		// Returns the staging buffer and offset to copy from
+		VkBuffer stage(const void* data, VkDeviceSize size, VkDeviceSize& offset);
+		VkCommandBuffer recording();
+		Ticket submit();
+		void reclaim(uint64_t completed);
+		uint64_t completedValue() const;
+		void waitValue(uint64_t value) const;
+
+		Device* _device{ nullptr };
+
+		VkQueue _queue{ VK_NULL_HANDLE };
+		uint32_t _transferFamily{};
+		uint32_t _graphicsFamily{};
+
+		VkCommandPool _commandPool{ VK_NULL_HANDLE };
+		VkSemaphore _timeline{ VK_NULL_HANDLE };
+
+		mutable std::mutex _mutex;
+
+		Buffer _ring;
+		VkDeviceSize _ringSize{};
+		uint64_t _head{};	// Bytes ever staged, the ring offset is this modulo _ringSize
+		uint64_t _tail{};	// Staged bytes of finished batches
+
+		Batch _current;
+		Ticket _nextTicket{ 1 };
+		std::deque<Batch> _inFlight;
+		std::vector<VkCommandBuffer> _freeCommandBuffers;
+
+		std::vector<VkBufferMemoryBarrier> _bufferReleases;
+		std::vector<VkImageMemoryBarrier> _imageReleases;
+		VkPipelineStageFlags _releaseStages{};
+
+		std::vector<BufferAcquire> _bufferAcquires;
+		std::vector<ImageAcquire> _imageAcquires;
+		Ticket _acquired{};
+
+		// RecordAcquires() scratch
+		std::vector<VkBufferMemoryBarrier> _bufferBarriers;
+		std::vector<VkImageMemoryBarrier> _imageBarriers;
+	};
+} // namespace Eugenix::Render::Vulkan
@@ -0,0 +1,910 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Core/Jobs.h"
+#include "Core/Profiler.h"
+
+#if EUGENIX_ARCH_X64
+#	include <immintrin.h>
+#endif
+
+namespace
+{
+	using namespace Eugenix::Scene;
+	using Node = Bvh::Node;
+
+	constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+	constexpr uint32_t BinCount = 16;
+
+	// Nodes with more primitives bin in parallel chunks and build their children as separate jobs
+	constexpr uint32_t ParallelThreshold = 16 * 1024;
+	constexpr uint32_t ParallelGrain = 4 * 1024;
+
+	// Below this depth SAH splits are allowed to be lopsided, deeper nodes split at the median.
+	// Depth stays under SahDepth + 32, which the traversal stacks are sized for.
+	constexpr uint32_t SahDepth = 64;
+	constexpr uint32_t StackSize = 128;
+
+	// Build marks the node slots it did not use, see BvhBuilder
+	constexpr uint32_t UnusedSlot = UINT32_MAX;
+
+	struct Bounds
+	{
+		glm::vec3 min{ Infinity };
+		glm::vec3 max{ -Infinity };
+
+		void Grow(const glm::vec3& point)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		void Grow(const Bounds& other)
+		{
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+
+		// Surface area / 2, the SAH only compares ratios
+		float HalfArea() const
+		{
+			const glm::vec3 e = max - min;
+			return e.x * e.y + e.y * e.z + e.z * e.x;
+		}
+	};
+
+	struct Bin
+	{
+		Bounds bounds;
+		uint32_t count{ 0 };
+	};
+
+	using AxisBins = std::array<std::array<Bin, BinCount>, 3>;
+
+	// Box of the primitives and box of their centroids
+	struct RangeBounds
+	{
+		Bounds bounds;
+		Bounds centroids;
+
+		void Merge(const RangeBounds& other)
+		{
+			bounds.Grow(other.bounds);
+			centroids.Grow(other.centroids);
+		}
+	};
+
+	struct BinnedRange
+	{
+		AxisBins bins;
+
+		void Merge(const BinnedRange& other)
+		{
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				for (uint32_t b = 0; b < BinCount; ++b)
+				{
+					bins[axis][b].bounds.Grow(other.bins[axis][b].bounds);
+					bins[axis][b].count += other.bins[axis][b].count;
+				}
+			}
+		}
+	};
+
+	// fn(T&, first, last) over chunks of ParallelGrain spread across the job workers, merged in order
+	template<typename T, typename Fn>
+	T parallelReduce(uint32_t first, uint32_t last, Fn&& fn)
+	{
+		const uint32_t chunkCount = (last - first + ParallelGrain - 1) / ParallelGrain;
+		std::vector<T> partials(chunkCount);
+
+		Eugenix::Jobs::ParallelFor(first, last, ParallelGrain, [&](uint32_t rangeFirst, uint32_t rangeLast)
+			{
+				for (uint32_t chunkFirst = rangeFirst; chunkFirst < rangeLast; chunkFirst += ParallelGrain)
+				{
+					const uint32_t chunkLast = std::min(chunkFirst + ParallelGrain, rangeLast);
+					fn(partials[(chunkFirst - first) / ParallelGrain], chunkFirst, chunkLast);
+				}
+			});
+
+		T result{};
+		for (const T& partial : partials)
+			result.Merge(partial);
+		return result;
+	}
+
+	inline bool overlaps(const glm::vec3& minA, const glm::vec3& maxA, const glm::vec3& minB, const glm::vec3& maxB)
+	{
+		return minA.x <= maxB.x && maxA.x >= minB.x
+			&& minA.y <= maxB.y && maxA.y >= minB.y
+			&& minA.z <= maxB.z && maxA.z >= minB.z;
+	}
+
+	enum class Containment { Outside, Intersects, Inside };
+
+	inline Containment classify(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max)
+	{
+		const glm::vec3 center = (min + max) * 0.5f;
+		const glm::vec3 extent = (max - min) * 0.5f;
+
+		Containment result = Containment::Inside;
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+			const float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+			if (distance < -radius)
+				return Containment::Outside;
+			if (distance < radius)
+				result = Containment::Intersects;
+		}
+		return result;
+	}
+
+	// Slab test with the inverse direction precomputed, Enter() returns the entry distance or
+	// Infinity when the box is missed or further than closest
+	struct RayBox
+	{
+#if EUGENIX_ARCH_X64
+		__m128 origin;
+		__m128 inverseDirection;
+
+		explicit RayBox(const Ray& ray)
+			: origin{ _mm_set_ps(0.0f, ray.origin.z, ray.origin.y, ray.origin.x) }
+			, inverseDirection{ _mm_div_ps(_mm_set1_ps(1.0f), _mm_set_ps(1.0f, ray.direction.z, ray.direction.y, ray.direction.x)) }
+		{
+		}
+
+		float enter(__m128 min, __m128 max, float closest) const
+		{
+			const __m128 t1 = _mm_mul_ps(_mm_sub_ps(min, origin), inverseDirection);
+			const __m128 t2 = _mm_mul_ps(_mm_sub_ps(max, origin), inverseDirection);
+			const __m128 tNear = _mm_min_ps(t1, t2);
+			const __m128 tFar = _mm_max_ps(t1, t2);
+
+			// x, y and z only, lane 3 of a node load holds its index or count
+			__m128 entry = _mm_max_ss(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1, 1, 1, 1)));
+			entry = _mm_max_ss(entry, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 2, 2, 2)));
+			entry = _mm_max_ss(entry, _mm_setzero_ps());
+
+			__m128 exit = _mm_min_ss(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1, 1, 1, 1)));
+			exit = _mm_min_ss(exit, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 2, 2, 2)));
+			exit = _mm_min_ss(exit, _mm_set_ss(closest));
+
+			return _mm_comile_ss(entry, exit) ? _mm_cvtss_f32(entry) : Infinity;
+		}
+
+		float Enter(const Node& node, float closest) const
+		{
+			return enter(_mm_loadu_ps(&node.min.x), _mm_loadu_ps(&node.max.x), closest);
+		}
+
+		float Enter(const Aabb& box, float closest) const
+		{
+			return enter(_mm_set_ps(0.0f, box.min.z, box.min.y, box.min.x), _mm_set_ps(0.0f, box.max.z, box.max.y, box.max.x), closest);
+		}
+#else
+		glm::vec3 origin;
+		glm::vec3 inverseDirection;
+
+		explicit RayBox(const Ray& ray)
+			: origin{ ray.origin }
+			, inverseDirection{ 1.0f / ray.direction }
+		{
+		}
+
+		float Enter(const glm::vec3& min, const glm::vec3& max, float closest) const
+		{
+			const glm::vec3 t1 = (min - origin) * inverseDirection;
+			const glm::vec3 t2 = (max - origin) * inverseDirection;
+			const glm::vec3 tNear = glm::min(t1, t2);
+			const glm::vec3 tFar = glm::max(t1, t2);
+
+			const float entry = std::max({ tNear.x, tNear.y, tNear.z, 0.0f });
+			const float exit = std::min({ tFar.x, tFar.y, tFar.z, closest });
+			return entry <= exit ? entry : Infinity;
+		}
+
+		float Enter(const Node& node, float closest) const { return Enter(node.min, node.max, closest); }
+		float Enter(const Aabb& box, float closest) const { return Enter(box.min, box.max, closest); }
+#endif
+	};
+
+	// Closest-first descent: both children are tested, the nearer one is visited next and the other
+	// waits on the stack with its entry distance, so it is dropped once a closer hit was found.
+	// leafTest(first, count, closest) tests the leaf's primitives and lowers closest on a hit.
+	template<typename LeafTest>
+	void traverse(std::span<const Node> nodes, const RayBox& ray, float& closest, LeafTest&& leafTest)
+	{
+		if (nodes.empty() || ray.Enter(nodes[0], closest) == Infinity)
+			return;
+
+		struct Entry
+		{
+			uint32_t node;
+			float distance;
+		};
+
+		Entry stack[StackSize];
+		uint32_t size = 0;
+		uint32_t current = 0;
+
+		for (;;)
+		{
+			const Node& node = nodes[current];
+			if (!node.IsLeaf())
+			{
+				uint32_t nearChild = current + 1;
+				uint32_t farChild = node.index;
+				float nearEntry = ray.Enter(nodes[nearChild], closest);
+				float farEntry = ray.Enter(nodes[farChild], closest);
+
+				if (farEntry < nearEntry)
+				{
+					std::swap(nearChild, farChild);
+					std::swap(nearEntry, farEntry);
+				}
+
+				if (nearEntry != Infinity)
+				{
+					if (farEntry != Infinity)
+						stack[size++] = { farChild, farEntry };
+
+					current = nearChild;
+					continue;
+				}
+			}
+			else
+			{
+				leafTest(node.index, node.count, closest);
+			}
+
+			do
+			{
+				if (size == 0)
+					return;
+				current = stack[--size].node;
+			} while (stack[size].distance > closest);
+		}
+	}
+
+	// Möller-Trumbore, double sided. Distance or Infinity.
+	inline float intersectTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& e1, const glm::vec3& e2)
+	{
+		const glm::vec3 p = glm::cross(ray.direction, e2);
+		const float det = glm::dot(e1, p);
+		if (std::abs(det) < 1e-12f)
+			return Infinity;
+
+		const float inverseDet = 1.0f / det;
+		const glm::vec3 s = ray.origin - v0;
+		const float u = glm::dot(s, p) * inverseDet;
+		if (u < 0.0f || u > 1.0f)
+			return Infinity;
+
+		const glm::vec3 q = glm::cross(s, e1);
+		const float v = glm::dot(ray.direction, q) * inverseDet;
+		if (v < 0.0f || u + v > 1.0f)
+			return Infinity;
+
+		const float t = glm::dot(e2, q) * inverseDet;
+		return t > 0.0f ? t : Infinity;
+	}
+
+	struct TriangleStreams
+	{
+		const float* v0x; const float* v0y; const float* v0z;
+		const float* e1x; const float* e1y; const float* e1z;
+		const float* e2x; const float* e2y; const float* e2z;
+	};
+
+	// Leaf kernels test triangles [first, first + count) and lower closest / set hit on a closer one
+	void intersectLeafScalar(const Ray& ray, const TriangleStreams& s, uint32_t first, uint32_t count, float& closest, uint32_t& hit)
+	{
+		for (uint32_t i = first; i < first + count; ++i)
+		{
+			const float t = intersectTriangle(ray,
+				{ s.v0x[i], s.v0y[i], s.v0z[i] }, { s.e1x[i], s.e1y[i], s.e1z[i] }, { s.e2x[i], s.e2y[i], s.e2z[i] });
+			if (t < closest)
+			{
+				closest = t;
+				hit = i;
+			}
+		}
+	}
+
+#if EUGENIX_ARCH_X64
+	void intersectLeafSSE(const Ray& ray, const TriangleStreams& s, uint32_t first, uint32_t count, float& closest, uint32_t& hit)
+	{
+		const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+		const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 epsilon = _mm_set1_ps(1e-12f);
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		const __m128i lanes = _mm_set_epi32(3, 2, 1, 0);
+
+		for (uint32_t i = first; i < first + count; i += 4)
+		{
+			const __m128 e1x = _mm_loadu_ps(s.e1x + i), e1y = _mm_loadu_ps(s.e1y + i), e1z = _mm_loadu_ps(s.e1z + i);
+			const __m128 e2x = _mm_loadu_ps(s.e2x + i), e2y = _mm_loadu_ps(s.e2y + i), e2z = _mm_loadu_ps(s.e2z + i);
+
+			// p = d x e2, det = e1 . p
+			const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+			const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+			const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+			const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+			const __m128 inverseDet = _mm_div_ps(one, det);
+
+			// s = o - v0, u = s . p
+			const __m128 sx = _mm_sub_ps(ox, _mm_loadu_ps(s.v0x + i));
+			const __m128 sy = _mm_sub_ps(oy, _mm_loadu_ps(s.v0y + i));
+			const __m128 sz = _mm_sub_ps(oz, _mm_loadu_ps(s.v0z + i));
+			const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+
+			// q = s x e1, v = d . q, t = e2 . q
+			const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+			const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+			const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+			const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+			const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+			__m128 mask = _mm_castsi128_ps(_mm_cmplt_epi32(lanes, _mm_set1_epi32(static_cast<int>(first + count - i))));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_and_ps(det, absMask), epsilon));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+			mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+			mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, zero));
+			mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(closest)));
+
+			uint32_t lanesHit = static_cast<uint32_t>(_mm_movemask_ps(mask));
+			if (!lanesHit)
+				continue;
+
+			alignas(16) float distances[4];
+			_mm_store_ps(distances, t);
+			while (lanesHit)
+			{
+				const uint32_t lane = static_cast<uint32_t>(std::countr_zero(lanesHit));
+				if (distances[lane] < closest)
+				{
+					closest = distances[lane];
+					hit = i + lane;
+				}
+				lanesHit &= lanesHit - 1;
+			}
+		}
+	}
+
+	// A leaf holds at most 8 triangles, one pass
+	EUGENIX_TARGET_AVX2 void intersectLeafAVX2(const Ray& ray, const TriangleStreams& s, uint32_t first, uint32_t count, float& closest, uint32_t& hit)
+	{
+		const __m256 dx = _mm256_set1_ps(ray.direction.x), dy = _mm256_set1_ps(ray.direction.y), dz = _mm256_set1_ps(ray.direction.z);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const uint32_t i = first;
+
+		const __m256 e1x = _mm256_loadu_ps(s.e1x + i), e1y = _mm256_loadu_ps(s.e1y + i), e1z = _mm256_loadu_ps(s.e1z + i);
+		const __m256 e2x = _mm256_loadu_ps(s.e2x + i), e2y = _mm256_loadu_ps(s.e2y + i), e2z = _mm256_loadu_ps(s.e2z + i);
+
+		const __m256 px = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+		const __m256 py = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+		const __m256 pz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+		const __m256 det = _mm256_fmadd_ps(e1x, px, _mm256_fmadd_ps(e1y, py, _mm256_mul_ps(e1z, pz)));
+		const __m256 inverseDet = _mm256_div_ps(one, det);
+
+		const __m256 sx = _mm256_sub_ps(_mm256_set1_ps(ray.origin.x), _mm256_loadu_ps(s.v0x + i));
+		const __m256 sy = _mm256_sub_ps(_mm256_set1_ps(ray.origin.y), _mm256_loadu_ps(s.v0y + i));
+		const __m256 sz = _mm256_sub_ps(_mm256_set1_ps(ray.origin.z), _mm256_loadu_ps(s.v0z + i));
+		const __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(sx, px, _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sz, pz))), inverseDet);
+
+		const __m256 qx = _mm256_fmsub_ps(sy, e1z, _mm256_mul_ps(sz, e1y));
+		const __m256 qy = _mm256_fmsub_ps(sz, e1x, _mm256_mul_ps(sx, e1z));
+		const __m256 qz = _mm256_fmsub_ps(sx, e1y, _mm256_mul_ps(sy, e1x));
+		const __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(dx, qx, _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dz, qz))), inverseDet);
+		const __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(e2x, qx, _mm256_fmadd_ps(e2y, qy, _mm256_mul_ps(e2z, qz))), inverseDet);
+
+		const __m256 absDet = _mm256_and_ps(det, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+
+		__m256 mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count)), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0)));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(absDet, _mm256_set1_ps(1e-12f), _CMP_GE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, zero, _CMP_GT_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, _mm256_set1_ps(closest), _CMP_LT_OQ));
+
+		uint32_t lanesHit = static_cast<uint32_t>(_mm256_movemask_ps(mask));
+		if (!lanesHit)
+			return;
+
+		alignas(32) float distances[8];
+		_mm256_store_ps(distances, t);
+		while (lanesHit)
+		{
+			const uint32_t lane = static_cast<uint32_t>(std::countr_zero(lanesHit));
+			if (distances[lane] < closest)
+			{
+				closest = distances[lane];
+				hit = i + lane;
+			}
+			lanesHit &= lanesHit - 1;
+		}
+	}
+#endif
+}
+
+namespace Eugenix::Scene
+{
+	// A node over primitives [first, last) at slot s owns slots [s, s + 2 * count - 1): the left child
+	// takes s + 1 and the right one s + 2 * leftCount. Subtrees never share slots, so jobs build them
+	// without synchronization. Leaves leave their unused slots behind, compact() closes the gaps.
+	struct BvhBuilder
+	{
+		std::span<const Aabb> bounds;
+		std::vector<glm::vec3> centroids;
+		std::vector<Node>& nodes;
+		std::vector<uint32_t>& order;
+		uint32_t maxLeafSize;
+
+		void Build(uint32_t slot, uint32_t first, uint32_t last, uint32_t depth)
+		{
+			const uint32_t count = last - first;
+
+			auto gather = [this](RangeBounds& range, uint32_t rangeFirst, uint32_t rangeLast)
+				{
+					for (uint32_t i = rangeFirst; i < rangeLast; ++i)
+					{
+						const uint32_t primitive = order[i];
+						range.bounds.Grow(bounds[primitive].min);
+						range.bounds.Grow(bounds[primitive].max);
+						range.centroids.Grow(centroids[primitive]);
+					}
+				};
+
+			RangeBounds range{};
+			if (count >= ParallelThreshold)
+				range = parallelReduce<RangeBounds>(first, last, gather);
+			else
+				gather(range, first, last);
+
+			Node& node = nodes[slot];
+			node.min = range.bounds.min;
+			node.max = range.bounds.max;
+
+			uint32_t mid = count > 1 ? split(first, last, depth, range) : first;
+			if (mid == first)
+			{
+				node.index = first;
+				node.count = count;
+				return;
+			}
+
+			node.index = slot + 2 * (mid - first);
+			node.count = 0;
+
+			if (count >= ParallelThreshold)
+			{
+				Jobs::Counter counter;
+				Jobs::Run([this, slot, first, mid, depth] { Build(slot + 1, first, mid, depth + 1); }, &counter);
+				Build(node.index, mid, last, depth + 1);
+				Jobs::Wait(counter);
+			}
+			else
+			{
+				Build(slot + 1, first, mid, depth + 1);
+				Build(node.index, mid, last, depth + 1);
+			}
+		}
+
+		// Partitions order[first, last) and returns the first index of the right child, or first for a leaf
+		uint32_t split(uint32_t first, uint32_t last, uint32_t depth, const RangeBounds& range)
+		{
+			const uint32_t count = last - first;
+			const glm::vec3 extent = range.centroids.max - range.centroids.min;
+
+			// Centroids on top of each other, no plane separates them
+			if (extent.x <= 0.0f && extent.y <= 0.0f && extent.z <= 0.0f)
+				return count <= maxLeafSize ? first : first + count / 2;
+
+			const int longest = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+			if (depth >= SahDepth)
+				return medianSplit(first, last, longest);
+
+			const glm::vec3 binScale = glm::vec3(static_cast<float>(BinCount)) / glm::max(extent, glm::vec3(1e-30f));
+			const glm::vec3 centroidMin = range.centroids.min;
+
+			auto binOf = [&](uint32_t primitive, int axis)
+				{
+					const float position = (centroids[primitive][axis] - centroidMin[axis]) * binScale[axis];
+					return std::min(BinCount - 1, static_cast<uint32_t>(std::max(position, 0.0f)));
+				};
+
+			auto fill = [&](BinnedRange& binned, uint32_t rangeFirst, uint32_t rangeLast)
+				{
+					for (uint32_t i = rangeFirst; i < rangeLast; ++i)
+					{
+						const uint32_t primitive = order[i];
+						for (int axis = 0; axis < 3; ++axis)
+						{
+							Bin& bin = binned.bins[axis][binOf(primitive, axis)];
+							bin.bounds.Grow(bounds[primitive].min);
+							bin.bounds.Grow(bounds[primitive].max);
+							++bin.count;
+						}
+					}
+				};
+
+			BinnedRange binned{};
+			if (count >= ParallelThreshold)
+				binned = parallelReduce<BinnedRange>(first, last, fill);
+			else
+				fill(binned, first, last);
+
+			// Costs relative to a traversal step, scaled by the parent's area to skip the division
+			const float parentArea = range.bounds.HalfArea();
+			float bestCost = static_cast<float>(count) * parentArea;
+			int bestAxis = -1;
+			uint32_t bestBin = 0;
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (extent[axis] <= 0.0f)
+					continue;
+
+				const auto& bins = binned.bins[axis];
+
+				// Area * count of everything right of each plane, then sweep from the left
+				std::array<float, BinCount> rightCost{};
+				Bounds right;
+				uint32_t rightCount = 0;
+				for (uint32_t b = BinCount - 1; b > 0; --b)
+				{
+					right.Grow(bins[b].bounds);
+					rightCount += bins[b].count;
+					rightCost[b] = rightCount ? right.HalfArea() * static_cast<float>(rightCount) : 0.0f;
+				}
+
+				Bounds left;
+				uint32_t leftCount = 0;
+				for (uint32_t b = 0; b < BinCount - 1; ++b)
+				{
+					left.Grow(bins[b].bounds);
+					leftCount += bins[b].count;
+					if (leftCount == 0 || leftCount == count)
+						continue;
+
+					const float cost = parentArea + left.HalfArea() * static_cast<float>(leftCount) + rightCost[b + 1];
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestBin = b;
+					}
+				}
+			}
+
+			if (bestAxis < 0)
+				return count <= maxLeafSize ? first : medianSplit(first, last, longest);
+
+			const auto middle = std::partition(order.begin() + first, order.begin() + last,
+				[&](uint32_t primitive) { return binOf(primitive, bestAxis) <= bestBin; });
+
+			return static_cast<uint32_t>(middle - order.begin());
+		}
+
+		uint32_t medianSplit(uint32_t first, uint32_t last, int axis)
+		{
+			const uint32_t mid = first + (last - first) / 2;
+			std::nth_element(order.begin() + first, order.begin() + mid, order.begin() + last,
+				[&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+			return mid;
+		}
+
+		// Drops the unused slots, depth-first order and the adjacent left children are kept
+		void Compact()
+		{
+			std::vector<uint32_t> remap(nodes.size());
+			uint32_t used = 0;
+			for (uint32_t slot = 0; slot < nodes.size(); ++slot)
+			{
+				if (nodes[slot].count != UnusedSlot)
+					remap[slot] = used++;
+			}
+
+			// Targets never pass the slot being read
+			for (uint32_t slot = 0; slot < nodes.size(); ++slot)
+			{
+				Node node = nodes[slot];
+				if (node.count == UnusedSlot)
+					continue;
+
+				if (!node.IsLeaf())
+					node.index = remap[node.index];
+
+				nodes[remap[slot]] = node;
+			}
+
+			nodes.resize(used);
+			nodes.shrink_to_fit();
+		}
+	};
+
+	Ray Ray::FromScreen(const glm::vec2& cursor, const glm::vec2& viewportSize, const glm::mat4& view, const glm::mat4& projection)
+	{
+		const glm::vec4 viewport{ 0.0f, 0.0f, viewportSize.x, viewportSize.y };
+		const glm::vec2 window{ cursor.x, viewportSize.y - cursor.y };
+
+		const glm::vec3 nearPoint = glm::unProject(glm::vec3(window, 0.0f), view, projection, viewport);
+		const glm::vec3 farPoint = glm::unProject(glm::vec3(window, 1.0f), view, projection, viewport);
+
+		return { nearPoint, glm::normalize(farPoint - nearPoint) };
+	}
+
+	void Bvh::Build(std::span<const Aabb> bounds, uint32_t maxLeafSize)
+	{
+		EUGENIX_PROFILE_SCOPE("Bvh::Build");
+
+		Clear();
+
+		const uint32_t count = static_cast<uint32_t>(bounds.size());
+		if (count == 0)
+			return;
+
+		_order.resize(count);
+		_nodes.assign(2 * count - 1, Node{ glm::vec3{ 0.0f }, 0, glm::vec3{ 0.0f }, UnusedSlot });
+
+		BvhBuilder builder{ bounds, std::vector<glm::vec3>(count), _nodes, _order, std::max(1u, maxLeafSize) };
+
+		Jobs::ParallelFor(0, count, ParallelGrain, [&](uint32_t first, uint32_t last)
+			{
+				for (uint32_t i = first; i < last; ++i)
+				{
+					_order[i] = i;
+					builder.centroids[i] = bounds[i].Center();
+				}
+			});
+
+		builder.Build(0, 0, count, 0);
+		builder.Compact();
+
+		_primitiveBounds.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+			_primitiveBounds[i] = bounds[_order[i]];
+	}
+
+	void Bvh::Refit(std::span<const Aabb> bounds)
+	{
+		EUGENIX_PROFILE_SCOPE("Bvh::Refit");
+
+		assert(bounds.size() == _order.size());
+
+		for (uint32_t i = 0; i < _order.size(); ++i)
+			_primitiveBounds[i] = bounds[_order[i]];
+
+		// Children always come after their parent
+		for (uint32_t i = static_cast<uint32_t>(_nodes.size()); i-- > 0;)
+		{
+			Node& node = _nodes[i];
+			if (node.IsLeaf())
+			{
+				node.min = _primitiveBounds[node.index].min;
+				node.max = _primitiveBounds[node.index].max;
+				for (uint32_t p = node.index + 1; p < node.index + node.count; ++p)
+				{
+					node.min = glm::min(node.min, _primitiveBounds[p].min);
+					node.max = glm::max(node.max, _primitiveBounds[p].max);
+				}
+			}
+			else
+			{
+				const Node& left = _nodes[i + 1];
+				const Node& right = _nodes[node.index];
+				node.min = glm::min(left.min, right.min);
+				node.max = glm::max(left.max, right.max);
+			}
+		}
+	}
+
+	void Bvh::Clear()
+	{
+		_nodes.clear();
+		_order.clear();
+		_primitiveBounds.clear();
+	}
+
+	RayHit Bvh::Raycast(const Ray& ray, float maxDistance) const
+	{
+		const RayBox rayBox{ ray };
+		float closest = maxDistance;
+		RayHit hit{};
+
+		traverse(_nodes, rayBox, closest, [&](uint32_t first, uint32_t count, float& leafClosest)
+			{
+				for (uint32_t slot = first; slot < first + count; ++slot)
+				{
+					const float distance = rayBox.Enter(_primitiveBounds[slot], leafClosest);
+					if (distance < leafClosest)
+					{
+						leafClosest = distance;
+						hit.primitive = _order[slot];
+					}
+				}
+			});
+
+		if (hit)
+			hit.distance = closest;
+		return hit;
+	}
+
+	void Bvh::Query(const Aabb& region, std::vector<uint32_t>& out) const
+	{
+		if (_nodes.empty())
+			return;
+
+		uint32_t stack[StackSize];
+		uint32_t size = 0;
+		stack[size++] = 0;
+
+		while (size)
+		{
+			const Node& node = _nodes[stack[--size]];
+			if (!overlaps(node.min, node.max, region.min, region.max))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				for (uint32_t slot = node.index; slot < node.index + node.count; ++slot)
+				{
+					const Aabb& box = _primitiveBounds[slot];
+					if (overlaps(box.min, box.max, region.min, region.max))
+						out.push_back(_order[slot]);
+				}
+			}
+			else
+			{
+				stack[size++] = node.index;
+				stack[size++] = static_cast<uint32_t>(&node - _nodes.data()) + 1;
+			}
+		}
+	}
+
+	void Bvh::Query(const Frustum& frustum, std::vector<uint32_t>& out) const
+	{
+		if (_nodes.empty())
+			return;
+
+		uint32_t stack[StackSize];
+		uint32_t size = 0;
+		stack[size++] = 0;
+
+		while (size)
+		{
+			const uint32_t index = stack[--size];
+			const Node& node = _nodes[index];
+
+			const Containment containment = classify(frustum, node.min, node.max);
+			if (containment == Containment::Outside)
+				continue;
+
+			if (containment == Containment::Inside)
+			{
+				// A subtree covers a contiguous run of the primitive order, from its leftmost
+				// to its rightmost leaf
+				uint32_t leftmost = index;
+				while (!_nodes[leftmost].IsLeaf())
+					leftmost = leftmost + 1;
+
+				uint32_t rightmost = index;
+				while (!_nodes[rightmost].IsLeaf())
+					rightmost = _nodes[rightmost].index;
+
+				const uint32_t first = _nodes[leftmost].index;
+				const uint32_t last = _nodes[rightmost].index + _nodes[rightmost].count;
+				out.insert(out.end(), _order.begin() + first, _order.begin() + last);
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				for (uint32_t slot = node.index; slot < node.index + node.count; ++slot)
+				{
+					const Aabb& box = _primitiveBounds[slot];
+					if (classify(frustum, box.min, box.max) != Containment::Outside)
+						out.push_back(_order[slot]);
+				}
+			}
+			else
+			{
+				stack[size++] = node.index;
+				stack[size++] = index + 1;
+			}
+		}
+	}
+
+	void MeshBvh::Build(std::span<const glm::vec3> positions, std::span<const uint32_t> indices)
+	{
+		EUGENIX_PROFILE_SCOPE("MeshBvh::Build");
+
+		Clear();
+
+		const uint32_t count = static_cast<uint32_t>(indices.size() / 3);
+
+		std::vector<Aabb> boxes(count);
+		for (uint32_t t = 0; t < count; ++t)
+		{
+			const glm::vec3& a = positions[indices[3 * t + 0]];
+			const glm::vec3& b = positions[indices[3 * t + 1]];
+			const glm::vec3& c = positions[indices[3 * t + 2]];
+			boxes[t] = { glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)) };
+		}
+
+		_bvh.Build(boxes, LeafSize);
+
+		for (auto* stream : { &_v0x, &_v0y, &_v0z, &_e1x, &_e1y, &_e1z, &_e2x, &_e2y, &_e2z })
+			stream->assign(count + LeafSize, 0.0f);
+
+		const auto order = _bvh.PrimitiveOrder();
+		for (uint32_t slot = 0; slot < count; ++slot)
+		{
+			const uint32_t t = order[slot];
+			const glm::vec3& v0 = positions[indices[3 * t + 0]];
+			const glm::vec3 e1 = positions[indices[3 * t + 1]] - v0;
+			const glm::vec3 e2 = positions[indices[3 * t + 2]] - v0;
+
+			_v0x[slot] = v0.x; _v0y[slot] = v0.y; _v0z[slot] = v0.z;
+			_e1x[slot] = e1.x; _e1y[slot] = e1.y; _e1z[slot] = e1.z;
+			_e2x[slot] = e2.x; _e2y[slot] = e2.y; _e2z[slot] = e2.z;
+		}
+	}
+
+	void MeshBvh::Clear()
+	{
+		_bvh.Clear();
+		for (auto* stream : { &_v0x, &_v0y, &_v0z, &_e1x, &_e1y, &_e1z, &_e2x, &_e2y, &_e2z })
+			stream->clear();
+	}
+
+	RayHit MeshBvh::Raycast(const Ray& ray, float maxDistance, Math::SimdLevel level) const
+	{
+		const TriangleStreams streams
+		{
+			_v0x.data(), _v0y.data(), _v0z.data(),
+			_e1x.data(), _e1y.data(), _e1z.data(),
+			_e2x.data(), _e2y.data(), _e2z.data()
+		};
+
+		auto leafTest = intersectLeafScalar;
+#if EUGENIX_ARCH_X64
+		switch (Math::SupportedSimdLevel(level))
+		{
+		case Math::SimdLevel::AVX2: leafTest = intersectLeafAVX2; break;
+		case Math::SimdLevel::SSE: leafTest = intersectLeafSSE; break;
+		case Math::SimdLevel::Scalar: break;
+		}
+#else
+		(void)level;
+#endif
+
+		float closest = maxDistance;
+		uint32_t slot = InvalidPrimitive;
+
+		traverse(_bvh.Nodes(), RayBox{ ray }, closest, [&](uint32_t first, uint32_t count, float& leafClosest)
+			{
+				leafTest(ray, streams, first, count, leafClosest, slot);
+			});
+
+		if (slot == InvalidPrimitive)
+			return {};
+
+		return { _bvh.PrimitiveOrder()[slot], closest };
+	}
+} // namespace Eugenix::Scene
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+#include "Math/Simd.h"
+
+namespace Eugenix::Scene
+{
+	constexpr uint32_t InvalidPrimitive = UINT32_MAX;
+
+	struct Ray
+	{
+		glm::vec3 origin{ 0.0f };
+		glm::vec3 direction{ 0.0f, 0.0f, -1.0f }; // Normalized, distances are then in world units
+
+		// Through a window position, cursor origin at the top left like GLFW
+		static Ray FromScreen(const glm::vec2& cursor, const glm::vec2& viewportSize, const glm::mat4& view, const glm::mat4& projection);
+	};
+
+	struct RayHit
+	{
+		uint32_t primitive{ InvalidPrimitive };
+		float distance{ std::numeric_limits<float>::infinity() };
+
+		explicit operator bool() const { return primitive != InvalidPrimitive; }
+	};
+
+	// Bounding volume hierarchy over boxes, indices are the positions in the span given to Build().
+	// Binned SAH build, the upper levels are split across the job workers. Moving objects keep the
+	// tree and Refit() the boxes, rebuild when the queries get slower. Queries are const and can run
+	// from several threads, Build() and Refit() cannot run alongside them.
+	class Bvh final
+	{
+	public:
+		// Depth-first order, the left child directly follows its parent
+		struct Node
+		{
+			glm::vec3 min;
+			uint32_t index;	// Leaf: first slot in PrimitiveOrder(), inner node: right child
+			glm::vec3 max;
+			uint32_t count;	// Primitives of a leaf, 0 for inner nodes
+
+			bool IsLeaf() const { return count != 0; }
+		};
+
+		void Build(std::span<const Aabb> bounds, uint32_t maxLeafSize = 4);
+
+		// Same objects in the same order, only the boxes moved
+		void Refit(std::span<const Aabb> bounds);
+
+		void Clear();
+
+		// Closest primitive box along the ray, distance 0 when the origin is inside one
+		RayHit Raycast(const Ray& ray, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+		// Appends the primitives whose box touches the region
+		void Query(const Aabb& region, std::vector<uint32_t>& out) const;
+		void Query(const Frustum& frustum, std::vector<uint32_t>& out) const;
+
+		std::span<const Node> Nodes() const { return _nodes; }
+		std::span<const uint32_t> PrimitiveOrder() const { return _order; }
+
+		// Boxes in PrimitiveOrder()
+		std::span<const Aabb> PrimitiveBounds() const { return _primitiveBounds; }
+
+		uint32_t PrimitiveCount() const { return static_cast<uint32_t>(_order.size()); }
+		bool Empty() const { return _nodes.empty(); }
+
+	private:
+		std::vector<Node> _nodes;
+		std::vector<uint32_t> _order;
+		std::vector<Aabb> _primitiveBounds;
+	};
+
+	// Triangle mesh for exact picking. The leaves hold up to 8 triangles that are tested in one go
+	// with AVX2 (4 at a time with SSE). Hits report the triangle index, i.e. indices[3 * t].
+	class MeshBvh final
+	{
+	public:
+		void Build(std::span<const glm::vec3> positions, std::span<const uint32_t> indices);
+		void Clear();
+
+		RayHit Raycast(const Ray& ray, float maxDistance = std::numeric_limits<float>::infinity(),
+			Math::SimdLevel level = Math::DetectedSimdLevel()) const;
+
+		const Bvh& Tree() const { return _bvh; }
+		uint32_t TriangleCount() const { return _bvh.PrimitiveCount(); }
+
+	private:
+		static constexpr uint32_t LeafSize = 8;
+
+		Bvh _bvh;
+
+		// Triangles in the tree's primitive order as the first vertex and two edges, padded so
+		// a leaf at the end can load 8 lanes
+		std::vector<float> _v0x, _v0y, _v0z;
+		std::vector<float> _e1x, _e1y, _e1z;
+		std::vector<float> _e2x, _e2y, _e2z;
+	};
+} // namespace Eugenix::Scene
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Culling.h"
 
 namespace Eugenix::Scene
 {
@@ -22,6 +25,10 @@ namespace Eugenix::Scene
 		glm::vec3 right;
 		glm::vec3 up;
 
+		float fovY{ 45.0f };	// Degrees
+		float nearPlane{ 0.1f };
+		float farPlane{ 100.0f };
+
 		void updateOrientation()
 		{
 			float yawRad = glm::radians(yaw);
@@ -35,5 +42,21 @@ namespace Eugenix::Scene
 			right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
 			up = glm::normalize(glm::cross(right, forward));
 		}
+
+		glm::mat4 viewMatrix() const
+		{
+			return glm::lookAt(position, position + forward, up);
+		}
+
+		glm::mat4 projectionMatrix(float aspect) const
+		{
+			return glm::perspective(glm::radians(fovY), aspect, nearPlane, farPlane);
+		}
+
+		// What the culling stage tests the draw lists against
+		Frustum frustum(float aspect, bool zeroToOneDepth = false) const
+		{
+			return Frustum::FromViewProjection(projectionMatrix(aspect) * viewMatrix(), zeroToOneDepth);
+		}
 	};
 } // namespace Eugenix::Scene
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "SceneGraph.h"
+
+namespace Eugenix::Scene
+{
+	// Transform of an entity outside the scene graph, composed into WorldTransform as T * R * S
+	struct LocalTransform
+	{
+		glm::vec3 position{ 0.0f };
+		glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+		glm::vec3 scale{ 1.0f };
+	};
+
+	struct WorldTransform
+	{
+		glm::mat4 matrix{ 1.0f };
+	};
+
+	// Entity placed in a SceneGraph, its WorldTransform is copied from the node
+	struct SceneNode
+	{
+		NodeId node{ InvalidNode };
+	};
+
+	// Level of detail drawn last frame, where the next SelectLod() starts from
+	struct LodState
+	{
+		uint32_t level{ 0 };
+	};
+} // namespace Eugenix::Scene
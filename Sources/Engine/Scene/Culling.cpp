@@ -0,0 +1,425 @@
+#include "Culling.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include "Core/Jobs.h"
+#include "Core/Profiler.h"
+
+#if EUGENIX_ARCH_X64
+#	include <immintrin.h>
+#endif
+
+namespace
+{
+	using namespace Eugenix::Scene;
+
+	struct SphereStreams
+	{
+		const float* x;
+		const float* y;
+		const float* z;
+		const float* radius;
+	};
+
+	struct BoxStreams
+	{
+		const float* cx;
+		const float* cy;
+		const float* cz;
+		const float* ex;
+		const float* ey;
+		const float* ez;
+	};
+
+	// Lane k of the mask set means object base + k is visible
+	inline uint32_t appendVisible(uint32_t mask, uint32_t base, uint32_t* out)
+	{
+		uint32_t written = 0;
+		while (mask)
+		{
+			out[written++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+			mask &= mask - 1;
+		}
+		return written;
+	}
+
+	inline bool sphereVisible(const Frustum& frustum, float x, float y, float z, float radius)
+	{
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	// Distance of the center against the box's projected radius on the plane normal
+	inline bool boxVisible(const Frustum& frustum, float cx, float cy, float cz, float ex, float ey, float ez)
+	{
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			const float distance = plane.x * cx + plane.y * cy + plane.z * cz + plane.w;
+			const float radius = std::abs(plane.x) * ex + std::abs(plane.y) * ey + std::abs(plane.z) * ez;
+			if (distance < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	// Kernels test from i up to last in steps of their width, append the visible indices to out
+	// and leave i at the first object they did not test
+	uint32_t cullSpheresScalar(const Frustum& frustum, const SphereStreams& s, uint32_t& i, uint32_t last, uint32_t* out)
+	{
+		uint32_t written = 0;
+		for (; i < last; ++i)
+		{
+			if (sphereVisible(frustum, s.x[i], s.y[i], s.z[i], s.radius[i]))
+				out[written++] = i;
+		}
+		return written;
+	}
+
+	uint32_t cullBoxesScalar(const Frustum& frustum, const BoxStreams& s, uint32_t& i, uint32_t last, uint32_t* out)
+	{
+		uint32_t written = 0;
+		for (; i < last; ++i)
+		{
+			if (boxVisible(frustum, s.cx[i], s.cy[i], s.cz[i], s.ex[i], s.ey[i], s.ez[i]))
+				out[written++] = i;
+		}
+		return written;
+	}
+
+#if EUGENIX_ARCH_X64
+	uint32_t cullSpheresSSE(const Frustum& frustum, const SphereStreams& s, uint32_t& i, uint32_t last, uint32_t* out)
+	{
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+
+		uint32_t written = 0;
+		for (; i + 4 <= last; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(s.x + i);
+			const __m128 y = _mm_loadu_ps(s.y + i);
+			const __m128 z = _mm_loadu_ps(s.z + i);
+			const __m128 negRadius = _mm_xor_ps(_mm_loadu_ps(s.radius + i), signBit);
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const glm::vec4& plane : frustum.planes)
+			{
+				const __m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+			}
+
+			written += appendVisible(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, out + written);
+		}
+		return written;
+	}
+
+	uint32_t cullBoxesSSE(const Frustum& frustum, const BoxStreams& s, uint32_t& i, uint32_t last, uint32_t* out)
+	{
+		uint32_t written = 0;
+		for (; i + 4 <= last; i += 4)
+		{
+			const __m128 cx = _mm_loadu_ps(s.cx + i);
+			const __m128 cy = _mm_loadu_ps(s.cy + i);
+			const __m128 cz = _mm_loadu_ps(s.cz + i);
+			const __m128 ex = _mm_loadu_ps(s.ex + i);
+			const __m128 ey = _mm_loadu_ps(s.ey + i);
+			const __m128 ez = _mm_loadu_ps(s.ez + i);
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const glm::vec4& plane : frustum.planes)
+			{
+				const __m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w)));
+				const __m128 radius = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), ex), _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), ey)),
+					_mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), ez));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+			}
+
+			written += appendVisible(static_cast<uint32_t>(_mm_movemask_ps(inside)), i, out + written);
+		}
+		return written;
+	}
+
+	// Planes broadcast once per chunk instead of once per iteration
+	struct PlanesAVX
+	{
+		__m256 x[Frustum::PlaneCount];
+		__m256 y[Frustum::PlaneCount];
+		__m256 z[Frustum::PlaneCount];
+		__m256 w[Frustum::PlaneCount];
+	};
+
+	EUGENIX_TARGET_AVX2 PlanesAVX broadcastPlanes(const Frustum& frustum, bool absoluteNormals)
+	{
+		PlanesAVX planes;
+		for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+			planes.x[p] = _mm256_set1_ps(absoluteNormals ? std::abs(plane.x) : plane.x);
+			planes.y[p] = _mm256_set1_ps(absoluteNormals ? std::abs(plane.y) : plane.y);
+			planes.z[p] = _mm256_set1_ps(absoluteNormals ? std::abs(plane.z) : plane.z);
+			planes.w[p] = _mm256_set1_ps(plane.w);
+		}
+		return planes;
+	}
+
+	EUGENIX_TARGET_AVX2 uint32_t cullSpheresAVX2(const Frustum& frustum, const SphereStreams& s, uint32_t& i, uint32_t last, uint32_t* out)
+	{
+		const PlanesAVX planes = broadcastPlanes(frustum, false);
+		const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+		uint32_t written = 0;
+		for (; i + 8 <= last; i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(s.x + i);
+			const __m256 y = _mm256_loadu_ps(s.y + i);
+			const __m256 z = _mm256_loadu_ps(s.z + i);
+			const __m256 negRadius = _mm256_xor_ps(_mm256_loadu_ps(s.radius + i), signBit);
+
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+			{
+				const __m256 distance = _mm256_fmadd_ps(planes.x[p], x,
+					_mm256_fmadd_ps(planes.y[p], y, _mm256_fmadd_ps(planes.z[p], z, planes.w[p])));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+			}
+
+			written += appendVisible(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, out + written);
+		}
+		return written;
+	}
+
+	EUGENIX_TARGET_AVX2 uint32_t cullBoxesAVX2(const Frustum& frustum, const BoxStreams& s, uint32_t& i, uint32_t last, uint32_t* out)
+	{
+		const PlanesAVX planes = broadcastPlanes(frustum, false);
+		const PlanesAVX absolute = broadcastPlanes(frustum, true);
+
+		uint32_t written = 0;
+		for (; i + 8 <= last; i += 8)
+		{
+			const __m256 cx = _mm256_loadu_ps(s.cx + i);
+			const __m256 cy = _mm256_loadu_ps(s.cy + i);
+			const __m256 cz = _mm256_loadu_ps(s.cz + i);
+			const __m256 ex = _mm256_loadu_ps(s.ex + i);
+			const __m256 ey = _mm256_loadu_ps(s.ey + i);
+			const __m256 ez = _mm256_loadu_ps(s.ez + i);
+
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+			{
+				// distance + projected radius, one FMA chain
+				const __m256 distance = _mm256_fmadd_ps(planes.x[p], cx,
+					_mm256_fmadd_ps(planes.y[p], cy, _mm256_fmadd_ps(planes.z[p], cz, planes.w[p])));
+				const __m256 reach = _mm256_fmadd_ps(absolute.x[p], ex,
+					_mm256_fmadd_ps(absolute.y[p], ey, _mm256_fmadd_ps(absolute.z[p], ez, distance)));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(reach, _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+
+			written += appendVisible(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, out + written);
+		}
+		return written;
+	}
+#endif
+
+	template<typename Streams, typename Scalar, typename SSE, typename AVX2>
+	uint32_t cullRange(const Frustum& frustum, const Streams& streams, uint32_t first, uint32_t last, uint32_t* out,
+		Eugenix::Math::SimdLevel level, Scalar scalar, [[maybe_unused]] SSE sse, [[maybe_unused]] AVX2 avx2)
+	{
+		using Eugenix::Math::SimdLevel;
+
+		uint32_t i = first;
+		uint32_t written = 0;
+
+#if EUGENIX_ARCH_X64
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+			written += avx2(frustum, streams, i, last, out + written);
+			// The remaining 0-7 go through SSE first
+			[[fallthrough]];
+		case SimdLevel::SSE:
+			written += sse(frustum, streams, i, last, out + written);
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+#else
+		(void)level;
+#endif
+
+		written += scalar(frustum, streams, i, last, out + written);
+		return written;
+	}
+}
+
+namespace Eugenix::Scene
+{
+	Aabb TransformAabb(const Aabb& local, const glm::mat4& world)
+	{
+		const glm::vec3 center = glm::vec3(world * glm::vec4(local.Center(), 1.0f));
+		const glm::vec3 extent = local.Extent();
+
+		// Each world axis gets the extents projected through the absolute rotation-scale part
+		glm::vec3 worldExtent{ 0.0f };
+		for (int column = 0; column < 3; ++column)
+			worldExtent += glm::abs(glm::vec3(world[column])) * extent[column];
+
+		return { center - worldExtent, center + worldExtent };
+	}
+
+	Frustum Frustum::FromViewProjection(const glm::mat4& viewProjection, bool zeroToOneDepth)
+	{
+		// glm is column-major, row r is (m[0][r], m[1][r], m[2][r], m[3][r])
+		const glm::mat4 m = glm::transpose(viewProjection);
+
+		Frustum frustum;
+		frustum.planes[Left] = m[3] + m[0];
+		frustum.planes[Right] = m[3] - m[0];
+		frustum.planes[Bottom] = m[3] + m[1];
+		frustum.planes[Top] = m[3] - m[1];
+		frustum.planes[Near] = zeroToOneDepth ? m[2] : m[3] + m[2];
+		frustum.planes[Far] = m[3] - m[2];
+
+		for (glm::vec4& plane : frustum.planes)
+			plane /= glm::length(glm::vec3(plane));
+
+		return frustum;
+	}
+
+	bool Frustum::Intersects(const Aabb& box) const
+	{
+		const glm::vec3 center = box.Center();
+		const glm::vec3 extent = box.Extent();
+		return boxVisible(*this, center.x, center.y, center.z, extent.x, extent.y, extent.z);
+	}
+
+	bool Frustum::Intersects(const BoundingSphere& sphere) const
+	{
+		return sphereVisible(*this, sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius);
+	}
+
+	void SphereBounds::Add(const BoundingSphere& sphere)
+	{
+		x.push_back(sphere.center.x);
+		y.push_back(sphere.center.y);
+		z.push_back(sphere.center.z);
+		radius.push_back(sphere.radius);
+	}
+
+	void SphereBounds::Reserve(uint32_t capacity)
+	{
+		for (auto* stream : { &x, &y, &z, &radius })
+			stream->reserve(capacity);
+	}
+
+	void SphereBounds::Clear()
+	{
+		for (auto* stream : { &x, &y, &z, &radius })
+			stream->clear();
+	}
+
+	void AabbBounds::Add(const Aabb& box)
+	{
+		const glm::vec3 center = box.Center();
+		const glm::vec3 extent = box.Extent();
+
+		centerX.push_back(center.x);
+		centerY.push_back(center.y);
+		centerZ.push_back(center.z);
+		extentX.push_back(extent.x);
+		extentY.push_back(extent.y);
+		extentZ.push_back(extent.z);
+	}
+
+	void AabbBounds::Reserve(uint32_t capacity)
+	{
+		for (auto* stream : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ })
+			stream->reserve(capacity);
+	}
+
+	void AabbBounds::Clear()
+	{
+		for (auto* stream : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ })
+			stream->clear();
+	}
+
+	template<typename Kernel>
+	uint32_t FrustumCuller::run(uint32_t count, Kernel&& kernel)
+	{
+		const uint32_t chunkCount = (count + GrainSize - 1) / GrainSize;
+
+		_visible.resize(count);
+		_chunkCounts.resize(chunkCount);
+		_testedCount = count;
+
+		// Every chunk writes its visible indices at its own offset, no synchronization needed
+		Jobs::ParallelFor(0, count, GrainSize, [this, &kernel, count](uint32_t first, uint32_t last)
+			{
+				// A single thread gets the whole range at once
+				for (uint32_t chunkFirst = first; chunkFirst < last; chunkFirst += GrainSize)
+				{
+					const uint32_t chunkLast = std::min(chunkFirst + GrainSize, count);
+					_chunkCounts[chunkFirst / GrainSize] = kernel(chunkFirst, chunkLast, _visible.data() + chunkFirst);
+				}
+			});
+
+		// Close the gaps between the chunks, ascending order is kept
+		uint32_t visible = 0;
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			const uint32_t offset = chunk * GrainSize;
+			if (visible != offset)
+				std::memmove(_visible.data() + visible, _visible.data() + offset, _chunkCounts[chunk] * sizeof(uint32_t));
+			visible += _chunkCounts[chunk];
+		}
+
+		_visibleCount = visible;
+		return visible;
+	}
+	uint32_t FrustumCuller::Cull(const Frustum& frustum, const SphereBounds& bounds, Math::SimdLevel level)
+	{
+		EUGENIX_PROFILE_SCOPE("FrustumCuller::Cull");
+
+		const SphereStreams streams{ bounds.x.data(), bounds.y.data(), bounds.z.data(), bounds.radius.data() };
+		level = Math::SupportedSimdLevel(level);
+
+		return run(bounds.Size(), [&](uint32_t first, uint32_t last, uint32_t* out)
+			{
+#if EUGENIX_ARCH_X64
+				return cullRange(frustum, streams, first, last, out, level, cullSpheresScalar, cullSpheresSSE, cullSpheresAVX2);
+#else
+				return cullRange(frustum, streams, first, last, out, level, cullSpheresScalar, nullptr, nullptr);
+#endif
+			});
+	}
+
+	uint32_t FrustumCuller::Cull(const Frustum& frustum, const AabbBounds& bounds, Math::SimdLevel level)
+	{
+		EUGENIX_PROFILE_SCOPE("FrustumCuller::Cull");
+
+		const BoxStreams streams
+		{
+			bounds.centerX.data(), bounds.centerY.data(), bounds.centerZ.data(),
+			bounds.extentX.data(), bounds.extentY.data(), bounds.extentZ.data()
+		};
+		level = Math::SupportedSimdLevel(level);
+
+		return run(bounds.Size(), [&](uint32_t first, uint32_t last, uint32_t* out)
+			{
+#if EUGENIX_ARCH_X64
+				return cullRange(frustum, streams, first, last, out, level, cullBoxesScalar, cullBoxesSSE, cullBoxesAVX2);
+#else
+				return cullRange(frustum, streams, first, last, out, level, cullBoxesScalar, nullptr, nullptr);
+#endif
+			});
+	}
+} // namespace Eugenix::Scene
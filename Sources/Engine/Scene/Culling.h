@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Math/Simd.h"
+
+namespace Eugenix::Scene
+{
+	struct Aabb
+	{
+		glm::vec3 min{ 0.0f };
+		glm::vec3 max{ 0.0f };
+
+		glm::vec3 Center() const { return (min + max) * 0.5f; }
+		glm::vec3 Extent() const { return (max - min) * 0.5f; }
+	};
+
+	struct BoundingSphere
+	{
+		glm::vec3 center{ 0.0f };
+		float radius{ 0.0f };
+	};
+
+	// Box around the transformed corners of a local box, rotations make it grow
+	Aabb TransformAabb(const Aabb& local, const glm::mat4& world);
+
+	// Six planes facing inwards, a point p is inside when dot(plane.xyz, p) + plane.w >= 0 for all of them
+	struct Frustum
+	{
+		enum Plane : uint32_t { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+		std::array<glm::vec4, PlaneCount> planes;
+
+		// Gribb-Hartmann extraction with normalized planes. zeroToOneDepth for Vulkan style clip space
+		// (GLM_FORCE_DEPTH_ZERO_TO_ONE), otherwise OpenGL's [-1, 1].
+		static Frustum FromViewProjection(const glm::mat4& viewProjection, bool zeroToOneDepth = false);
+
+		// Conservative: boxes straddling two planes outside a corner are kept
+		bool Intersects(const Aabb& box) const;
+		bool Intersects(const BoundingSphere& sphere) const;
+	};
+
+	// Bounds of many objects as separate float arrays, indices match the caller's draw list
+	struct SphereBounds
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> radius;
+
+		void Add(const BoundingSphere& sphere);
+		void Reserve(uint32_t capacity);
+		void Clear();
+		uint32_t Size() const { return static_cast<uint32_t>(x.size()); }
+	};
+
+	// Boxes as center and half extent, the form the plane test wants
+	struct AabbBounds
+	{
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> extentX;
+		std::vector<float> extentY;
+		std::vector<float> extentZ;
+
+		void Add(const Aabb& box);
+		void Reserve(uint32_t capacity);
+		void Clear();
+		uint32_t Size() const { return static_cast<uint32_t>(centerX.size()); }
+	};
+
+	// Tests bounds against a frustum, 8 per iteration with AVX2 (4 with SSE), in parallel chunks
+	// over the job workers. The result is the ascending list of visible indices, which the
+	// renderers walk instead of the full draw list. Keep one per draw list, the buffers are reused
+	// from frame to frame. Not thread-safe.
+	class FrustumCuller final
+	{
+	public:
+		// Returns the number of visible objects
+		uint32_t Cull(const Frustum& frustum, const SphereBounds& bounds, Math::SimdLevel level = Math::DetectedSimdLevel());
+		uint32_t Cull(const Frustum& frustum, const AabbBounds& bounds, Math::SimdLevel level = Math::DetectedSimdLevel());
+
+		// As of the last Cull()
+		std::span<const uint32_t> Visible() const { return { _visible.data(), _visibleCount }; }
+		uint32_t VisibleCount() const { return _visibleCount; }
+		uint32_t TestedCount() const { return _testedCount; }
+		uint32_t CulledCount() const { return _testedCount - _visibleCount; }
+
+	private:
+		// Objects per job, a multiple of 8 so only the last chunk has a scalar tail
+		static constexpr uint32_t GrainSize = 4096;
+
+		template<typename Kernel>
+		uint32_t run(uint32_t count, Kernel&& kernel);
+
+		std::vector<uint32_t> _visible;
+		std::vector<uint32_t> _chunkCounts;
+		uint32_t _visibleCount{ 0 };
+		uint32_t _testedCount{ 0 };
+	};
+} // namespace Eugenix::Scene
@@ -0,0 +1,241 @@
+#include "Ecs.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace
+{
+	using namespace Eugenix::Scene;
+
+	struct ComponentInfo
+	{
+		uint32_t size;
+		uint32_t alignment;
+	};
+
+	// Fixed array so lookups never race with a registration on another thread
+	std::array<ComponentInfo, MaxComponentTypes> componentInfos{};
+	std::atomic<uint32_t> componentCount{ 0 };
+	std::mutex componentMutex;
+
+	constexpr std::align_val_t ChunkAlignment{ 64 };
+
+	std::byte* allocateChunk()
+	{
+		return static_cast<std::byte*>(::operator new(Archetype::ChunkBytes, ChunkAlignment));
+	}
+
+	void freeChunk(std::byte* data)
+	{
+		::operator delete(data, ChunkAlignment);
+	}
+
+	uint32_t alignUp(uint32_t value, uint32_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+namespace Eugenix::Scene
+{
+	namespace Detail
+	{
+		ComponentId RegisterComponent(uint32_t size, uint32_t alignment)
+		{
+			std::scoped_lock lock(componentMutex);
+
+			const ComponentId id = componentCount.load(std::memory_order_relaxed);
+			assert(id < MaxComponentTypes && "Raise MaxComponentTypes");
+
+			componentInfos[id] = { size, alignment };
+			componentCount.store(id + 1, std::memory_order_release);
+			return id;
+		}
+
+		uint32_t ComponentSize(ComponentId id)
+		{
+			return componentInfos[id].size;
+		}
+
+		uint32_t ComponentAlignment(ComponentId id)
+		{
+			return componentInfos[id].alignment;
+		}
+	} // namespace Detail
+
+	Archetype::Archetype(const ComponentMask& mask)
+		: _mask(mask)
+	{
+		_columnOf.fill(InvalidColumn);
+
+		uint32_t rowBytes = sizeof(Entity);
+		for (ComponentId id = 0; id < MaxComponentTypes; ++id)
+		{
+			if (!mask.test(id))
+				continue;
+
+			_columnOf[id] = static_cast<uint32_t>(_columns.size());
+			_columns.push_back({ id, 0, Detail::ComponentSize(id) });
+			rowBytes += Detail::ComponentSize(id);
+		}
+
+		// Shrink until the aligned arrays fit
+		auto layout = [this](uint32_t capacity)
+			{
+				uint32_t offset = capacity * static_cast<uint32_t>(sizeof(Entity));
+				for (auto& column : _columns)
+				{
+					offset = alignUp(offset, Detail::ComponentAlignment(column.id));
+					column.offset = offset;
+					offset += capacity * column.size;
+				}
+				return offset;
+			};
+
+		_capacity = ChunkBytes / rowBytes;
+		while (layout(_capacity) > ChunkBytes)
+			--_capacity;
+
+		assert(_capacity > 0 && "Components do not fit into a chunk");
+	}
+
+	Archetype::~Archetype()
+	{
+		for (auto& chunk : _chunks)
+			freeChunk(chunk.data);
+	}
+
+	void Registry::Destroy(Entity entity)
+	{
+		assert(IsAlive(entity));
+
+		const Record record = _records[entity.index];
+		removeRow(*record.archetype, record.chunk, record.row);
+
+		Record& freed = _records[entity.index];
+		freed.archetype = nullptr;
+		++freed.generation;
+		_freeIndices.push_back(entity.index);
+	}
+
+	Archetype* Registry::findOrCreateArchetype(const ComponentMask& mask)
+	{
+		if (auto it = _archetypeByMask.find(mask); it != _archetypeByMask.end())
+			return it->second;
+
+		Archetype* archetype = _archetypes.emplace_back(std::make_unique<Archetype>(mask)).get();
+		_archetypeByMask.emplace(mask, archetype);
+		return archetype;
+	}
+
+	Entity Registry::createEntity(Archetype* archetype)
+	{
+		uint32_t index{};
+		if (!_freeIndices.empty())
+		{
+			index = _freeIndices.back();
+			_freeIndices.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(_records.size());
+			_records.emplace_back();
+		}
+
+		const Entity entity{ index, _records[index].generation };
+		pushRow(*archetype, entity);
+		return entity;
+	}
+
+	void Registry::pushRow(Archetype& archetype, Entity entity)
+	{
+		if (archetype._chunks.empty() || archetype._chunks.back().count == archetype._capacity)
+			archetype._chunks.push_back({ allocateChunk(), 0 });
+
+		Chunk& chunk = archetype._chunks.back();
+		const uint32_t row = chunk.count++;
+		archetype.Entities(chunk)[row] = entity;
+		++archetype._entityCount;
+
+		Record& record = _records[entity.index];
+		record.archetype = &archetype;
+		record.chunk = static_cast<uint32_t>(archetype._chunks.size() - 1);
+		record.row = row;
+	}
+
+	void Registry::removeRow(Archetype& archetype, uint32_t chunkIndex, uint32_t row)
+	{
+		const uint32_t lastChunkIndex = static_cast<uint32_t>(archetype._chunks.size() - 1);
+		Chunk& lastChunk = archetype._chunks[lastChunkIndex];
+		const uint32_t lastRow = lastChunk.count - 1;
+
+		if (chunkIndex != lastChunkIndex || row != lastRow)
+		{
+			Chunk& chunk = archetype._chunks[chunkIndex];
+
+			const Entity moved = archetype.Entities(lastChunk)[lastRow];
+			archetype.Entities(chunk)[row] = moved;
+
+			for (uint32_t column = 0; column < archetype._columns.size(); ++column)
+			{
+				std::memcpy(archetype.Component(chunk, column, row), archetype.Component(lastChunk, column, lastRow), archetype._columns[column].size);
+			}
+
+			_records[moved.index].chunk = chunkIndex;
+			_records[moved.index].row = row;
+		}
+
+		--lastChunk.count;
+		--archetype._entityCount;
+
+		if (lastChunk.count == 0)
+		{
+			freeChunk(lastChunk.data);
+			archetype._chunks.pop_back();
+		}
+	}
+
+	void Registry::migrate(Entity entity, ComponentId id, bool add)
+	{
+		assert(IsAlive(entity));
+
+		const Record source = _records[entity.index];
+		Archetype& from = *source.archetype;
+
+		Archetype*& edge = add ? from._addEdges[id] : from._removeEdges[id];
+		if (!edge)
+		{
+			ComponentMask mask = from._mask;
+			mask.set(id, add);
+			edge = findOrCreateArchetype(mask);
+		}
+		Archetype& to = *edge;
+
+		pushRow(to, entity);
+		const Record target = _records[entity.index];
+
+		const Chunk& fromChunk = from._chunks[source.chunk];
+		const Chunk& toChunk = to._chunks[target.chunk];
+
+		for (uint32_t column = 0; column < from._columns.size(); ++column)
+		{
+			const uint32_t toColumn = to.Column(from._columns[column].id);
+			if (toColumn == Archetype::InvalidColumn)
+				continue;
+
+			std::memcpy(to.Component(toChunk, toColumn, target.row), from.Component(fromChunk, column, source.row), from._columns[column].size);
+		}
+
+		// The entity's record already points at the new archetype, only the row moved into the hole is patched
+		removeRow(from, source.chunk, source.row);
+	}
+
+	void Registry::write(Entity entity, ComponentId id, const void* value)
+	{
+		const Record& record = _records[entity.index];
+		Archetype& archetype = *record.archetype;
+		std::memcpy(archetype.Component(archetype._chunks[record.chunk], archetype.Column(id), record.row), value, Detail::ComponentSize(id));
+	}
+} // namespace Eugenix::Scene
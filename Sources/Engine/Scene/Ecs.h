@@ -0,0 +1,343 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/Jobs.h"
+
+namespace Eugenix::Scene
+{
+	struct Entity
+	{
+		uint32_t index{ UINT32_MAX };
+		uint32_t generation{ 0 };
+
+		bool operator==(const Entity&) const = default;
+	};
+
+	constexpr Entity InvalidEntity{};
+
+	constexpr uint32_t MaxComponentTypes = 64;
+	using ComponentId = uint32_t;
+	using ComponentMask = std::bitset<MaxComponentTypes>;
+
+	namespace Detail
+	{
+		ComponentId RegisterComponent(uint32_t size, uint32_t alignment);
+		uint32_t ComponentSize(ComponentId id);
+		uint32_t ComponentAlignment(ComponentId id);
+
+		template<typename T>
+		ComponentId TypeId()
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Components must be trivially copyable");
+
+			static const ComponentId id = RegisterComponent(sizeof(T), alignof(T));
+			return id;
+		}
+	} // namespace Detail
+
+	// Components are plain data, moved between chunks with memcpy. const T is the same component as T.
+	template<typename T>
+	ComponentId ComponentTypeId()
+	{
+		return Detail::TypeId<std::remove_cv_t<T>>();
+	}
+
+	template<typename... Ts>
+	ComponentMask MaskOf()
+	{
+		ComponentMask mask;
+		(mask.set(ComponentTypeId<Ts>()), ...);
+		return mask;
+	}
+
+	// Fixed size block holding up to `capacity` entities of one archetype: the entity ids,
+	// then one tightly packed array per component
+	struct Chunk
+	{
+		std::byte* data{ nullptr };
+		uint32_t count{ 0 };
+	};
+
+	// All entities with exactly the same set of components
+	class Archetype final
+	{
+	public:
+		static constexpr uint32_t ChunkBytes = 16 * 1024;
+		static constexpr uint32_t InvalidColumn = UINT32_MAX;
+
+		explicit Archetype(const ComponentMask& mask);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		const ComponentMask& Mask() const { return _mask; }
+		uint32_t Capacity() const { return _capacity; }
+		uint32_t EntityCount() const { return _entityCount; }
+
+		std::vector<Chunk>& Chunks() { return _chunks; }
+		const std::vector<Chunk>& Chunks() const { return _chunks; }
+
+		uint32_t Column(ComponentId id) const { return _columnOf[id]; }
+
+		Entity* Entities(const Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.data); }
+
+		void* ColumnData(const Chunk& chunk, uint32_t column) const { return chunk.data + _columns[column].offset; }
+
+		void* Component(const Chunk& chunk, uint32_t column, uint32_t row) const
+		{
+			return chunk.data + _columns[column].offset + size_t(row) * _columns[column].size;
+		}
+
+	private:
+		friend class Registry;
+
+		struct ColumnLayout
+		{
+			ComponentId id;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		ComponentMask _mask;
+		std::vector<ColumnLayout> _columns;
+		std::array<uint32_t, MaxComponentTypes> _columnOf;
+		uint32_t _capacity{ 0 };
+
+		std::vector<Chunk> _chunks;		// All full except the last one
+		uint32_t _entityCount{ 0 };
+
+		// Archetype reached by adding / removing one component, filled on first use
+		std::array<Archetype*, MaxComponentTypes> _addEdges{};
+		std::array<Archetype*, MaxComponentTypes> _removeEdges{};
+	};
+
+	// Archetype based entity storage. Entities with the same component set share chunks,
+	// so iterating a component is a linear walk over packed arrays.
+	// Structural changes (create, destroy, add, remove) are single threaded; systems running
+	// in parallel may only touch component values.
+	class Registry final
+	{
+	public:
+		Registry() = default;
+
+		Registry(const Registry&) = delete;
+		Registry& operator=(const Registry&) = delete;
+
+		template<typename... Ts>
+		Entity Create(const Ts&... components)
+		{
+			const Entity entity = createEntity(findOrCreateArchetype(MaskOf<Ts...>()));
+			(write(entity, ComponentTypeId<Ts>(), &components), ...);
+			return entity;
+		}
+
+		void Destroy(Entity entity);
+
+		bool IsAlive(Entity entity) const
+		{
+			return entity.index < _records.size() && _records[entity.index].generation == entity.generation && _records[entity.index].archetype;
+		}
+
+		template<typename T>
+		void Add(Entity entity, const T& component)
+		{
+			const ComponentId id = ComponentTypeId<T>();
+			if (!_records[entity.index].archetype->_mask.test(id))
+				migrate(entity, id, true);
+			write(entity, id, &component);
+		}
+
+		template<typename T>
+		void Remove(Entity entity)
+		{
+			const ComponentId id = ComponentTypeId<T>();
+			if (_records[entity.index].archetype->_mask.test(id))
+				migrate(entity, id, false);
+		}
+
+		template<typename T>
+		bool Has(Entity entity) const
+		{
+			assert(IsAlive(entity));
+			return _records[entity.index].archetype->_mask.test(ComponentTypeId<T>());
+		}
+
+		template<typename T>
+		T& Get(Entity entity)
+		{
+			assert(Has<T>(entity));
+			const Record& record = _records[entity.index];
+			Archetype& archetype = *record.archetype;
+			return *static_cast<T*>(archetype.Component(archetype._chunks[record.chunk], archetype.Column(ComponentTypeId<T>()), record.row));
+		}
+
+		uint32_t EntityCount() const { return static_cast<uint32_t>(_records.size() - _freeIndices.size()); }
+
+		// Never shrinks, queries keep pointers to the archetypes
+		const std::vector<std::unique_ptr<Archetype>>& Archetypes() const { return _archetypes; }
+
+	private:
+		struct Record
+		{
+			Archetype* archetype{ nullptr };
+			uint32_t chunk{ 0 };
+			uint32_t row{ 0 };
+			uint32_t generation{ 0 };
+		};
+
+		Archetype* findOrCreateArchetype(const ComponentMask& mask);
+		Entity createEntity(Archetype* archetype);
+
+		// Appends a row for the entity and points its record there
+		void pushRow(Archetype& archetype, Entity entity);
+		// Moves the archetype's last row into the hole
+		void removeRow(Archetype& archetype, uint32_t chunk, uint32_t row);
+
+		void migrate(Entity entity, ComponentId id, bool add);
+		void write(Entity entity, ComponentId id, const void* value);
+
+		std::vector<Record> _records;
+		std::vector<uint32_t> _freeIndices;
+
+		std::vector<std::unique_ptr<Archetype>> _archetypes;
+		std::unordered_map<ComponentMask, Archetype*> _archetypeByMask;
+	};
+
+	// Archetypes containing all of Ts (and none of the excluded components). The match list is
+	// cached and only extended with archetypes created since the previous iteration.
+	// Component pointers are handed out per chunk: fn(count, entities, Ts*...).
+	template<typename... Ts>
+	class Query final
+	{
+	public:
+		explicit Query(Registry& registry)
+			: _registry(registry)
+			, _mask(MaskOf<Ts...>())
+		{
+		}
+
+		template<typename T>
+		Query& Exclude()
+		{
+			_excluded.set(ComponentTypeId<T>());
+			_matches.clear();
+			_seenArchetypes = 0;
+			return *this;
+		}
+
+		template<typename Fn>
+		void ForEachChunk(Fn&& fn)
+		{
+			refresh();
+			for (const Match& match : _matches)
+			{
+				for (const Chunk& chunk : match.archetype->Chunks())
+				{
+					invoke(fn, match, chunk);
+				}
+			}
+		}
+
+		// Chunks spread over the job workers, fn must only touch its own chunk
+		template<typename Fn>
+		void ParallelForEachChunk(Fn&& fn)
+		{
+			refresh();
+
+			_work.clear();
+			for (const Match& match : _matches)
+			{
+				for (const Chunk& chunk : match.archetype->Chunks())
+					_work.push_back({ &match, &chunk });
+			}
+
+			Jobs::ParallelFor(0, static_cast<uint32_t>(_work.size()), 0, [this, &fn](uint32_t first, uint32_t last)
+				{
+					for (uint32_t i = first; i < last; ++i)
+						invoke(fn, *_work[i].match, *_work[i].chunk);
+				});
+		}
+
+		// fn(Ts&...) per entity
+		template<typename Fn>
+		void ForEach(Fn&& fn)
+		{
+			ForEachChunk([&fn](uint32_t count, const Entity*, Ts*... columns)
+				{
+					for (uint32_t i = 0; i < count; ++i)
+						fn(columns[i]...);
+				});
+		}
+
+		uint32_t Count()
+		{
+			refresh();
+
+			uint32_t count = 0;
+			for (const Match& match : _matches)
+				count += match.archetype->EntityCount();
+			return count;
+		}
+
+	private:
+		struct Match
+		{
+			Archetype* archetype;
+			std::array<uint32_t, sizeof...(Ts)> columns;
+		};
+
+		struct WorkItem
+		{
+			const Match* match;
+			const Chunk* chunk;
+		};
+
+		void refresh()
+		{
+			const auto& archetypes = _registry.Archetypes();
+			for (; _seenArchetypes < archetypes.size(); ++_seenArchetypes)
+			{
+				Archetype* archetype = archetypes[_seenArchetypes].get();
+				if ((archetype->Mask() & _mask) != _mask || (archetype->Mask() & _excluded).any())
+					continue;
+
+				_matches.push_back({ archetype, { archetype->Column(ComponentTypeId<Ts>())... } });
+			}
+		}
+
+		template<typename Fn>
+		static void invoke(Fn& fn, const Match& match, const Chunk& chunk)
+		{
+			if (chunk.count == 0)
+				return;
+
+			invokeColumns(fn, match, chunk, std::index_sequence_for<Ts...>{});
+		}
+
+		template<typename Fn, size_t... I>
+		static void invokeColumns(Fn& fn, const Match& match, const Chunk& chunk, std::index_sequence<I...>)
+		{
+			fn(chunk.count, match.archetype->Entities(chunk),
+				static_cast<Ts*>(match.archetype->ColumnData(chunk, match.columns[I]))...);
+		}
+
+		Registry& _registry;
+		ComponentMask _mask;
+		ComponentMask _excluded;
+
+		std::vector<Match> _matches;
+		size_t _seenArchetypes{ 0 };
+
+		std::vector<WorkItem> _work;
+	};
+} // namespace Eugenix::Scene
@@ -0,0 +1,574 @@
+#include "Lod.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "Core/Profiler.h"
+
+namespace
+{
+	using namespace Eugenix::Scene;
+
+	constexpr uint32_t NoVertex = UINT32_MAX;
+
+	// Open border edges add a plane through the edge standing on their triangle, weighted like
+	// this many squares of the edge length
+	constexpr double BorderWeight = 2.0;
+
+	// Collapses that turn a remaining triangle's normal further than this cosine are rejected
+	constexpr float MinNormalCos = 0.25f;
+
+	// A level that removes less than this share of the previous one ends the chain
+	constexpr float MinLevelReduction = 0.1f;
+
+	enum class VertexKind : uint8_t
+	{
+		Manifold,	// The only vertex at its position, inside the surface
+		Border,		// On an open edge, slides along it
+		Seam,		// One of two vertices at a position, slides along the seam with its twin
+		Locked		// Corners of seams and borders, never moves
+	};
+
+	struct Quadric
+	{
+		double a00{ 0.0 }, a11{ 0.0 }, a22{ 0.0 }, a01{ 0.0 }, a02{ 0.0 }, a12{ 0.0 };
+		double b0{ 0.0 }, b1{ 0.0 }, b2{ 0.0 };
+		double c{ 0.0 };
+		double weight{ 0.0 };
+
+		// Squared distance to the plane dot(normal, p) + d = 0, normal of unit length
+		static Quadric FromPlane(const glm::dvec3& normal, double d, double weight)
+		{
+			Quadric q;
+			q.a00 = weight * normal.x * normal.x;
+			q.a11 = weight * normal.y * normal.y;
+			q.a22 = weight * normal.z * normal.z;
+			q.a01 = weight * normal.x * normal.y;
+			q.a02 = weight * normal.x * normal.z;
+			q.a12 = weight * normal.y * normal.z;
+			q.b0 = weight * normal.x * d;
+			q.b1 = weight * normal.y * d;
+			q.b2 = weight * normal.z * d;
+			q.c = weight * d * d;
+			q.weight = weight;
+			return q;
+		}
+
+		Quadric& operator+=(const Quadric& o)
+		{
+			a00 += o.a00; a11 += o.a11; a22 += o.a22;
+			a01 += o.a01; a02 += o.a02; a12 += o.a12;
+			b0 += o.b0; b1 += o.b1; b2 += o.b2;
+			c += o.c;
+			weight += o.weight;
+			return *this;
+		}
+
+		// Weighted mean distance of p to the planes
+		float Error(const glm::vec3& p) const
+		{
+			if (weight <= 0.0)
+				return 0.0f;
+
+			const double x = p.x, y = p.y, z = p.z;
+			const double sum = a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return static_cast<float>(std::sqrt(std::max(sum, 0.0) / weight));
+		}
+	};
+
+	uint64_t edgeKey(uint32_t a, uint32_t b)
+	{
+		return (uint64_t(a) << 32) | b;
+	}
+
+	// Directed edges of the triangles, sorted for binary search
+	class EdgeSet
+	{
+	public:
+		template<typename Map>
+		void Build(std::span<const uint32_t> indices, Map&& map)
+		{
+			_keys.clear();
+			_keys.reserve(indices.size());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					_keys.push_back(edgeKey(map(indices[i + k]), map(indices[i + (k + 1) % 3])));
+				}
+			}
+			std::sort(_keys.begin(), _keys.end());
+		}
+
+		bool Has(uint32_t a, uint32_t b) const
+		{
+			return std::binary_search(_keys.begin(), _keys.end(), edgeKey(a, b));
+		}
+
+		// Only one direction exists
+		bool IsOpen(uint32_t a, uint32_t b) const
+		{
+			return !Has(a, b) || !Has(b, a);
+		}
+
+		std::span<const uint64_t> Keys() const { return _keys; }
+
+	private:
+		std::vector<uint64_t> _keys;
+	};
+
+	class Simplifier
+	{
+	public:
+		Simplifier(std::span<const glm::vec3> positions, std::span<const uint32_t> indices)
+			: _positions(positions)
+			, _indices(indices.begin(), indices.end())
+		{
+			buildPositionGroups();
+			removeDegenerates();
+			buildQuadrics();
+		}
+
+		void Run(uint32_t targetIndexCount, float maxError)
+		{
+			bool done = false;
+			while (!done && _indices.size() > targetIndexCount)
+			{
+				classify();
+				buildAdjacency();
+
+				uint32_t collapsed = 0;
+				done = !collapsePass(targetIndexCount, maxError, collapsed);
+				if (collapsed == 0)
+					break;
+
+				removeDegenerates();
+			}
+		}
+
+		std::vector<uint32_t>& Indices() { return _indices; }
+		float Error() const { return _error; }
+
+	private:
+		struct Candidate
+		{
+			uint32_t from;
+			uint32_t to;
+			float error;
+		};
+
+		uint32_t group(uint32_t vertex) const { return _group[vertex]; }
+
+		// Vertices at the same position form a group, listed as a ring through _wedge
+		void buildPositionGroups()
+		{
+			const uint32_t vertexCount = static_cast<uint32_t>(_positions.size());
+
+			std::vector<uint32_t> order(vertexCount);
+			std::iota(order.begin(), order.end(), 0u);
+			std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+				{
+					const glm::vec3& pa = _positions[a];
+					const glm::vec3& pb = _positions[b];
+					if (pa.x != pb.x) return pa.x < pb.x;
+					if (pa.y != pb.y) return pa.y < pb.y;
+					return pa.z < pb.z;
+				});
+
+			_group.resize(vertexCount);
+			_wedge.resize(vertexCount);
+			_groupSize.assign(vertexCount, 0);
+
+			for (uint32_t first = 0; first < vertexCount;)
+			{
+				uint32_t last = first + 1;
+				while (last < vertexCount && _positions[order[last]] == _positions[order[first]])
+					++last;
+
+				for (uint32_t i = first; i < last; ++i)
+				{
+					_group[order[i]] = order[first];
+					_wedge[order[i]] = order[i + 1 < last ? i + 1 : first];
+				}
+				_groupSize[order[first]] = last - first;
+
+				first = last;
+			}
+
+			_collapse.resize(vertexCount);
+			std::iota(_collapse.begin(), _collapse.end(), 0u);
+		}
+
+		void buildQuadrics()
+		{
+			_quadrics.assign(_positions.size(), Quadric{});
+
+			_positionEdges.Build(_indices, [this](uint32_t v) { return group(v); });
+
+			for (size_t i = 0; i < _indices.size(); i += 3)
+			{
+				const glm::dvec3 p0 = _positions[_indices[i + 0]];
+				const glm::dvec3 p1 = _positions[_indices[i + 1]];
+				const glm::dvec3 p2 = _positions[_indices[i + 2]];
+
+				glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const double length = glm::length(normal);
+				if (length <= 0.0)
+					continue;
+				normal /= length;
+
+				const Quadric face = Quadric::FromPlane(normal, -glm::dot(normal, p0), length * 0.5);
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					_quadrics[group(_indices[i + k])] += face;
+				}
+
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					const uint32_t a = _indices[i + k];
+					const uint32_t b = _indices[i + (k + 1) % 3];
+					if (_positionEdges.Has(group(b), group(a)))
+						continue;
+
+					const glm::dvec3 pa = _positions[a];
+					const glm::dvec3 edge = glm::dvec3(_positions[b]) - pa;
+					const glm::dvec3 side = glm::cross(edge, normal);
+					const double sideLength = glm::length(side);
+					if (sideLength <= 0.0)
+						continue;
+
+					const glm::dvec3 sideNormal = side / sideLength;
+					const Quadric border = Quadric::FromPlane(sideNormal, -glm::dot(sideNormal, pa), glm::dot(edge, edge) * BorderWeight);
+					_quadrics[group(a)] += border;
+					_quadrics[group(b)] += border;
+				}
+			}
+		}
+
+		void classify()
+		{
+			_vertexEdges.Build(_indices, [](uint32_t v) { return v; });
+			_positionEdges.Build(_indices, [this](uint32_t v) { return group(v); });
+
+			std::vector<uint8_t> open(_positions.size(), 0);
+			for (const uint64_t key : _positionEdges.Keys())
+			{
+				const uint32_t a = static_cast<uint32_t>(key >> 32);
+				const uint32_t b = static_cast<uint32_t>(key);
+				if (!_positionEdges.Has(b, a))
+					open[a] = open[b] = 1;
+			}
+
+			_kind.resize(_positions.size());
+			for (uint32_t v = 0; v < _positions.size(); ++v)
+			{
+				const uint32_t g = group(v);
+				const uint32_t size = _groupSize[g];
+				if (open[g])
+					_kind[v] = size == 1 ? VertexKind::Border : VertexKind::Locked;
+				else
+					_kind[v] = size == 1 ? VertexKind::Manifold : size == 2 ? VertexKind::Seam : VertexKind::Locked;
+			}
+		}
+
+		void buildAdjacency()
+		{
+			_adjacencyOffsets.assign(_positions.size() + 1, 0);
+			for (const uint32_t v : _indices)
+			{
+				++_adjacencyOffsets[v + 1];
+			}
+			std::partial_sum(_adjacencyOffsets.begin(), _adjacencyOffsets.end(), _adjacencyOffsets.begin());
+
+			_adjacency.resize(_indices.size());
+			std::vector<uint32_t> fill(_adjacencyOffsets.begin(), _adjacencyOffsets.end() - 1);
+			for (uint32_t i = 0; i < _indices.size(); ++i)
+			{
+				_adjacency[fill[_indices[i]]++] = i / 3;
+			}
+		}
+
+		// The vertex of to's group that from's twin moves onto, NoVertex when there is none
+		uint32_t seamPartner(uint32_t from, uint32_t to) const
+		{
+			const uint32_t twin = _wedge[from];
+			uint32_t candidate = to;
+			do
+			{
+				if (_vertexEdges.Has(twin, candidate) || _vertexEdges.Has(candidate, twin))
+					return candidate;
+				candidate = _wedge[candidate];
+			} while (candidate != to);
+
+			return NoVertex;
+		}
+
+		bool canCollapse(uint32_t from, uint32_t to) const
+		{
+			switch (_kind[from])
+			{
+			case VertexKind::Manifold:
+				return true;
+			case VertexKind::Border:
+				return _positionEdges.IsOpen(group(from), group(to));
+			case VertexKind::Seam:
+				return _vertexEdges.IsOpen(from, to) && seamPartner(from, to) != NoVertex;
+			default:
+				return false;
+			}
+		}
+
+		// Triangles around from keep facing the same way with from moved onto to. Counts the
+		// triangles the collapse removes.
+		bool keepsOrientation(uint32_t from, uint32_t to, uint32_t& removed) const
+		{
+			for (uint32_t a = _adjacencyOffsets[from]; a < _adjacencyOffsets[from + 1]; ++a)
+			{
+				const uint32_t triangle = _adjacency[a];
+
+				uint32_t v[3];
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					v[k] = _collapse[_indices[triangle * 3 + k]];
+				}
+
+				// Already gone with an earlier collapse of this pass
+				if (group(v[0]) == group(v[1]) || group(v[1]) == group(v[2]) || group(v[2]) == group(v[0]))
+					continue;
+
+				uint32_t moved[3];
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					moved[k] = v[k] == from ? to : v[k];
+				}
+
+				if (group(moved[0]) == group(moved[1]) || group(moved[1]) == group(moved[2]) || group(moved[2]) == group(moved[0]))
+				{
+					++removed;
+					continue;
+				}
+
+				const glm::vec3 before = glm::cross(_positions[v[1]] - _positions[v[0]], _positions[v[2]] - _positions[v[0]]);
+				const glm::vec3 after = glm::cross(_positions[moved[1]] - _positions[moved[0]], _positions[moved[2]] - _positions[moved[0]]);
+				if (glm::dot(before, after) < MinNormalCos * glm::length(before) * glm::length(after))
+					return false;
+			}
+
+			return true;
+		}
+
+		// False when the error limit stopped it
+		bool collapsePass(uint32_t targetIndexCount, float maxError, uint32_t& collapsed)
+		{
+			std::vector<Candidate> candidates;
+			candidates.reserve(_indices.size() * 2);
+
+			for (size_t i = 0; i < _indices.size(); i += 3)
+			{
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					const uint32_t a = _indices[i + k];
+					const uint32_t b = _indices[i + (k + 1) % 3];
+
+					for (const auto& [from, to] : { std::pair{ a, b }, std::pair{ b, a } })
+					{
+						if (!canCollapse(from, to))
+							continue;
+
+						Quadric merged = _quadrics[group(from)];
+						merged += _quadrics[group(to)];
+						candidates.push_back({ from, to, merged.Error(_positions[to]) });
+					}
+				}
+			}
+
+			std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.error < b.error; });
+
+			std::vector<uint8_t> touched(_positions.size(), 0);
+			uint32_t triangleCount = static_cast<uint32_t>(_indices.size() / 3);
+
+			for (const Candidate& candidate : candidates)
+			{
+				if (triangleCount * 3 <= targetIndexCount)
+					return true;
+				if (candidate.error > maxError)
+					return false;
+
+				const uint32_t fromGroup = group(candidate.from);
+				const uint32_t toGroup = group(candidate.to);
+				if (touched[fromGroup] || touched[toGroup])
+					continue;
+
+				uint32_t twin = NoVertex;
+				uint32_t twinTarget = NoVertex;
+				if (_kind[candidate.from] == VertexKind::Seam)
+				{
+					twin = _wedge[candidate.from];
+					twinTarget = seamPartner(candidate.from, candidate.to);
+				}
+
+				uint32_t removed = 0;
+				if (!keepsOrientation(candidate.from, candidate.to, removed))
+					continue;
+				if (twin != NoVertex && !keepsOrientation(twin, twinTarget, removed))
+					continue;
+
+				_collapse[candidate.from] = candidate.to;
+				if (twin != NoVertex)
+					_collapse[twin] = twinTarget;
+
+				_quadrics[toGroup] += _quadrics[fromGroup];
+				touched[fromGroup] = touched[toGroup] = 1;
+
+				triangleCount -= std::min(removed, triangleCount);
+				_error = std::max(_error, candidate.error);
+				++collapsed;
+			}
+
+			return true;
+		}
+
+		// Applies the pass's collapses and drops triangles with two corners at one position
+		void removeDegenerates()
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < _indices.size(); i += 3)
+			{
+				const uint32_t a = _collapse[_indices[i + 0]];
+				const uint32_t b = _collapse[_indices[i + 1]];
+				const uint32_t c = _collapse[_indices[i + 2]];
+				if (group(a) == group(b) || group(b) == group(c) || group(c) == group(a))
+					continue;
+
+				_indices[count++] = a;
+				_indices[count++] = b;
+				_indices[count++] = c;
+			}
+			_indices.resize(count);
+
+			std::iota(_collapse.begin(), _collapse.end(), 0u);
+		}
+
+		std::span<const glm::vec3> _positions;
+		std::vector<uint32_t> _indices;
+
+		std::vector<uint32_t> _group;		// First vertex at the same position
+		std::vector<uint32_t> _wedge;		// Next vertex at the same position
+		std::vector<uint32_t> _groupSize;	// By group
+		std::vector<Quadric> _quadrics;		// By group
+		std::vector<VertexKind> _kind;
+		std::vector<uint32_t> _collapse;	// Where each vertex moved during the current pass
+
+		EdgeSet _vertexEdges;
+		EdgeSet _positionEdges;
+
+		std::vector<uint32_t> _adjacencyOffsets;
+		std::vector<uint32_t> _adjacency;	// Triangles around each vertex
+
+		float _error{ 0.0f };
+	};
+} // namespace
+
+namespace Eugenix::Scene
+{
+	std::vector<uint32_t> Simplify(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+		uint32_t targetIndexCount, float maxError, float* resultError)
+	{
+		EUGENIX_PROFILE_SCOPE("Scene::Simplify");
+
+		Simplifier simplifier{ positions, indices };
+		simplifier.Run(targetIndexCount, maxError);
+
+		if (resultError)
+			*resultError = simplifier.Error();
+
+		return std::move(simplifier.Indices());
+	}
+
+	LodChain BuildLods(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const LodSettings& settings)
+	{
+		EUGENIX_PROFILE_SCOPE("Scene::BuildLods");
+
+		LodChain chain;
+		chain.indices.assign(indices.begin(), indices.end());
+		chain.levels.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+		if (positions.empty())
+			return chain;
+
+		glm::vec3 min = positions[0];
+		glm::vec3 max = positions[0];
+		for (const glm::vec3& p : positions)
+		{
+			min = glm::min(min, p);
+			max = glm::max(max, p);
+		}
+		const glm::vec3 size = max - min;
+		const float errorLimit = settings.maxError * std::max({ size.x, size.y, size.z });
+
+		std::vector<uint32_t> source{ indices.begin(), indices.end() };
+		float error = 0.0f;
+
+		while (chain.levels.size() < settings.maxLevels)
+		{
+			const uint32_t targetTriangles = static_cast<uint32_t>(source.size() / 3 * settings.reduction);
+			if (targetTriangles < settings.minTriangles)
+				break;
+
+			float stepError = 0.0f;
+			std::vector<uint32_t> level = Simplify(positions, source, targetTriangles * 3, errorLimit - error, &stepError);
+			if (level.size() > source.size() * (1.0f - MinLevelReduction))
+				break;
+
+			error += stepError;
+			chain.levels.push_back({ static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(level.size()), error });
+			chain.indices.insert(chain.indices.end(), level.begin(), level.end());
+			source = std::move(level);
+		}
+
+		return chain;
+	}
+
+	LodView LodView::FromPerspective(const glm::vec3& eye, float fovY, float viewportHeight, float maxPixelError)
+	{
+		LodView view;
+		view.eye = eye;
+		view.pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+		view.maxPixelError = maxPixelError;
+		return view;
+	}
+
+	float MaxScale(const glm::mat4& world)
+	{
+		const float x = glm::dot(glm::vec3(world[0]), glm::vec3(world[0]));
+		const float y = glm::dot(glm::vec3(world[1]), glm::vec3(world[1]));
+		const float z = glm::dot(glm::vec3(world[2]), glm::vec3(world[2]));
+		return std::sqrt(std::max({ x, y, z }));
+	}
+
+	uint32_t SelectLod(std::span<const LodLevel> levels, const LodView& view, const Aabb& worldBounds, float worldScale, uint32_t current)
+	{
+		if (levels.empty())
+			return 0;
+
+		// Inside the box the full mesh is drawn, the clamp keeps the scale finite
+		const glm::vec3 nearest = glm::clamp(view.eye, worldBounds.min, worldBounds.max);
+		const float distance = std::max(glm::length(nearest - view.eye), 1e-4f);
+		const float pixelsPerError = worldScale * view.pixelsPerUnit / distance;
+
+		auto pixels = [&](uint32_t level) { return levels[level].error * pixelsPerError; };
+
+		const uint32_t last = static_cast<uint32_t>(levels.size()) - 1;
+		uint32_t level = std::min(current, last);
+
+		while (level < last && pixels(level + 1) <= view.maxPixelError * (1.0f - view.hysteresis))
+			++level;
+		while (level > 0 && pixels(level) > view.maxPixelError)
+			--level;
+
+		return level;
+	}
+} // namespace Eugenix::Scene
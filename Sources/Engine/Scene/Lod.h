@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+
+namespace Eugenix::Scene
+{
+	// One level of detail, a range of the chain's shared index buffer over the same vertices
+	struct LodLevel
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float error;	// Estimated distance to the full mesh surface, object units, not a bound (see BuildLods)
+	};
+
+	struct LodSettings
+	{
+		uint32_t maxLevels{ 4 };		// Including the full mesh
+		float reduction{ 0.5f };		// Triangles of a level relative to the previous one
+		uint32_t minTriangles{ 64 };	// Levels below this are not worth a draw of their own
+		float maxError{ 0.05f };		// Relative to the largest extent of the mesh
+	};
+
+	// Level 0 is the mesh as given, then coarser levels that reuse its vertices
+	struct LodChain
+	{
+		std::vector<uint32_t> indices;
+		std::vector<LodLevel> levels;
+	};
+
+	// Quadric error metric edge collapses onto existing vertices, so the result indexes the same
+	// vertex buffer. Vertices sharing a position are collapsed together and only along UV / normal
+	// seams, open borders only along the border, both keep their shape. Stops at targetIndexCount
+	// or when the next collapse's quadric error, the area weighted root mean square distance of the
+	// kept vertex to the planes of the triangles merged into it, would exceed maxError (object
+	// units). resultError receives the largest quadric error of the collapses taken.
+	std::vector<uint32_t> Simplify(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+		uint32_t targetIndexCount, float maxError, float* resultError = nullptr);
+
+	// Each level is simplified from the previous one. Its error is the sum of the steps' resultError,
+	// an estimate that follows the visible deviation closely enough to select levels by, but a mean
+	// over planes rather than a maximum, so single points of the surface can move further.
+	LodChain BuildLods(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const LodSettings& settings = {});
+
+	// Camera terms of the screen-space error a level may have
+	struct LodView
+	{
+		glm::vec3 eye{ 0.0f };
+		float pixelsPerUnit{ 1.0f };	// Projected size of one unit at distance one
+		float maxPixelError{ 1.0f };
+		float hysteresis{ 0.25f };		// A coarser level is taken once its error is this much under the limit
+
+		static LodView FromPerspective(const glm::vec3& eye, float fovY, float viewportHeight, float maxPixelError = 1.0f);
+	};
+
+	// Largest axis scale of a world matrix, turns object space errors into world units
+	float MaxScale(const glm::mat4& world);
+
+	// Coarsest level whose error estimate, projected from the nearest point of worldBounds, stays under the
+	// view's limit. Starting from the level drawn last frame so objects near a switch distance do
+	// not flip every frame.
+	uint32_t SelectLod(std::span<const LodLevel> levels, const LodView& view, const Aabb& worldBounds, float worldScale, uint32_t current);
+} // namespace Eugenix::Scene
@@ -0,0 +1,475 @@
+#include "Occlusion.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include "Core/Jobs.h"
+#include "Core/Profiler.h"
+
+#if EUGENIX_ARCH_X64
+#	include <immintrin.h>
+#endif
+
+namespace
+{
+	using namespace Eugenix::Scene;
+	using Triangle = OcclusionCuller::Triangle;
+
+	// Triangles per binning job and occludees per test job
+	constexpr uint32_t BinChunkSize = 1024;
+	constexpr uint32_t CullGrain = 256;
+
+	// Triangles smaller than this (in pixels, doubled) cover no pixel center worth the setup
+	constexpr float MinArea = 1e-4f;
+
+	// a * x + b * y + c of the edge a -> b, >= 0 on the left, which is the inside of a
+	// counter-clockwise triangle. Evaluated at pixel centers.
+	inline glm::vec3 edgeFunction(const glm::vec2& a, const glm::vec2& b)
+	{
+		return { a.y - b.y, b.x - a.x, (b.y - a.y) * a.x - (b.x - a.x) * a.y };
+	}
+
+	// Kernels draw the triangle inside rect (pixels, inclusive) into a row-major buffer,
+	// keeping the nearest, i.e. largest, inverse depth
+	void rasterizeScalar(const Triangle& t, const glm::ivec4& rect, float* depth, uint32_t stride)
+	{
+		for (int y = rect.y; y <= rect.w; ++y)
+		{
+			const float py = static_cast<float>(y) + 0.5f;
+			float* row = depth + static_cast<size_t>(y) * stride;
+
+			for (int x = rect.x; x <= rect.z; ++x)
+			{
+				const float px = static_cast<float>(x) + 0.5f;
+				const glm::vec3 p{ px, py, 1.0f };
+
+				if (glm::dot(t.edges[0], p) >= 0.0f && glm::dot(t.edges[1], p) >= 0.0f && glm::dot(t.edges[2], p) >= 0.0f)
+					row[x] = std::max(row[x], glm::dot(t.depth, p));
+			}
+		}
+	}
+
+#if EUGENIX_ARCH_X64
+	// Rows start on a multiple of the width, the tiles are aligned to it and the triangle's edges
+	// mask the pixels outside rect
+	void rasterizeSSE(const Triangle& t, const glm::ivec4& rect, float* depth, uint32_t stride)
+	{
+		const __m128 laneX = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 zero = _mm_setzero_ps();
+
+		const __m128 a0 = _mm_set1_ps(t.edges[0].x), a1 = _mm_set1_ps(t.edges[1].x), a2 = _mm_set1_ps(t.edges[2].x);
+		const __m128 ad = _mm_set1_ps(t.depth.x);
+
+		const int xStart = rect.x & ~3;
+
+		for (int y = rect.y; y <= rect.w; ++y)
+		{
+			const float py = static_cast<float>(y) + 0.5f;
+			const __m128 row0 = _mm_set1_ps(t.edges[0].y * py + t.edges[0].z);
+			const __m128 row1 = _mm_set1_ps(t.edges[1].y * py + t.edges[1].z);
+			const __m128 row2 = _mm_set1_ps(t.edges[2].y * py + t.edges[2].z);
+			const __m128 rowDepth = _mm_set1_ps(t.depth.y * py + t.depth.z);
+			float* row = depth + static_cast<size_t>(y) * stride;
+
+			for (int x = xStart; x <= rect.z; x += 4)
+			{
+				const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneX);
+
+				__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), row0), zero);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), row1), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), row2), zero));
+
+				const __m128 z = _mm_and_ps(inside, _mm_add_ps(_mm_mul_ps(ad, px), rowDepth));
+				_mm_storeu_ps(row + x, _mm_max_ps(_mm_loadu_ps(row + x), z));
+			}
+		}
+	}
+
+	EUGENIX_TARGET_AVX2 void rasterizeAVX2(const Triangle& t, const glm::ivec4& rect, float* depth, uint32_t stride)
+	{
+		const __m256 laneX = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		const __m256 zero = _mm256_setzero_ps();
+
+		const __m256 a0 = _mm256_set1_ps(t.edges[0].x), a1 = _mm256_set1_ps(t.edges[1].x), a2 = _mm256_set1_ps(t.edges[2].x);
+		const __m256 ad = _mm256_set1_ps(t.depth.x);
+
+		const int xStart = rect.x & ~7;
+
+		for (int y = rect.y; y <= rect.w; ++y)
+		{
+			const float py = static_cast<float>(y) + 0.5f;
+			const __m256 row0 = _mm256_set1_ps(t.edges[0].y * py + t.edges[0].z);
+			const __m256 row1 = _mm256_set1_ps(t.edges[1].y * py + t.edges[1].z);
+			const __m256 row2 = _mm256_set1_ps(t.edges[2].y * py + t.edges[2].z);
+			const __m256 rowDepth = _mm256_set1_ps(t.depth.y * py + t.depth.z);
+			float* row = depth + static_cast<size_t>(y) * stride;
+
+			for (int x = xStart; x <= rect.z; x += 8)
+			{
+				const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneX);
+
+				__m256 inside = _mm256_cmp_ps(_mm256_fmadd_ps(a0, px, row0), zero, _CMP_GE_OQ);
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_fmadd_ps(a1, px, row1), zero, _CMP_GE_OQ));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_fmadd_ps(a2, px, row2), zero, _CMP_GE_OQ));
+
+				const __m256 z = _mm256_and_ps(inside, _mm256_fmadd_ps(ad, px, rowDepth));
+				_mm256_storeu_ps(row + x, _mm256_max_ps(_mm256_loadu_ps(row + x), z));
+			}
+		}
+	}
+#endif
+
+	using RasterizeKernel = void(*)(const Triangle&, const glm::ivec4&, float*, uint32_t);
+
+	RasterizeKernel selectKernel([[maybe_unused]] Eugenix::Math::SimdLevel level)
+	{
+#if EUGENIX_ARCH_X64
+		switch (Eugenix::Math::SupportedSimdLevel(level))
+		{
+		case Eugenix::Math::SimdLevel::AVX2: return rasterizeAVX2;
+		case Eugenix::Math::SimdLevel::SSE: return rasterizeSSE;
+		case Eugenix::Math::SimdLevel::Scalar: break;
+		}
+#endif
+		return rasterizeScalar;
+	}
+}
+
+namespace Eugenix::Scene
+{
+	const OccluderMesh& UnitCubeOccluder()
+	{
+		// Corner i has +0.5 on x when bit 0 is set, on y for bit 1, on z for bit 2
+		static const std::array<glm::vec3, 8> positions = []
+			{
+				std::array<glm::vec3, 8> corners{};
+				for (int i = 0; i < 8; ++i)
+					corners[i] = { i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f };
+				return corners;
+			}();
+
+		// Counter-clockwise seen from outside
+		static const std::array<uint32_t, 36> indices
+		{
+			0, 2, 3,  0, 3, 1,	// -Z
+			4, 5, 7,  4, 7, 6,	// +Z
+			0, 4, 6,  0, 6, 2,	// -X
+			1, 3, 7,  1, 7, 5,	// +X
+			0, 1, 5,  0, 5, 4,	// -Y
+			2, 6, 7,  2, 7, 3,	// +Y
+		};
+
+		static const OccluderMesh mesh{ positions, indices };
+		return mesh;
+	}
+
+	void OcclusionCuller::Resize(uint32_t width, uint32_t height)
+	{
+		_tilesX = std::max(1u, (width + TileWidth - 1) / TileWidth);
+		_tilesY = std::max(1u, (height + TileHeight - 1) / TileHeight);
+		_width = _tilesX * TileWidth;
+		_height = _tilesY * TileHeight;
+
+		_depth.assign(static_cast<size_t>(_width) * _height, 0.0f);
+		_blockMin.assign(static_cast<size_t>(_width / BlockSize) * (_height / BlockSize), 0.0f);
+	}
+
+	void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection, bool zeroToOneDepth)
+	{
+		if (_width == 0)
+			Resize(320, 192);
+
+		_viewProjection = viewProjection;
+		_zeroToOneDepth = zeroToOneDepth;
+
+		// A y-flipped projection (Vulkan) mirrors the screen and with it the winding
+		_mirrored = glm::determinant(viewProjection) > 0.0f;
+
+		_occluders.clear();
+		_vertexCount = 0;
+		_triangleCount = 0;
+	}
+
+	void OcclusionCuller::AddOccluder(const OccluderMesh& mesh, const glm::mat4& world)
+	{
+		const uint32_t triangles = static_cast<uint32_t>(mesh.indices.size() / 3);
+		if (triangles == 0)
+			return;
+
+		_occluders.push_back({ mesh, world, _vertexCount, _triangleCount });
+		_vertexCount += static_cast<uint32_t>(mesh.positions.size());
+		_triangleCount += triangles;
+	}
+
+	void OcclusionCuller::Rasterize(Math::SimdLevel level)
+	{
+		EUGENIX_PROFILE_SCOPE("OcclusionCuller::Rasterize");
+
+		const RasterizeKernel kernel = selectKernel(level);
+		const uint32_t tileCount = _tilesX * _tilesY;
+		const glm::vec2 screen{ static_cast<float>(_width), static_cast<float>(_height) };
+
+		// Screen position, 1 / w, and whether the vertex is in front of the near plane
+		_screenVertices.resize(_vertexCount);
+		Jobs::ParallelFor(0, static_cast<uint32_t>(_occluders.size()), 1, [this, screen](uint32_t first, uint32_t last)
+			{
+				for (uint32_t o = first; o < last; ++o)
+				{
+					const Occluder& occluder = _occluders[o];
+					const glm::mat4 toClip = _viewProjection * occluder.world;
+
+					glm::vec4* out = _screenVertices.data() + occluder.firstVertex;
+					for (const glm::vec3& position : occluder.mesh.positions)
+					{
+						const glm::vec4 clip = toClip * glm::vec4(position, 1.0f);
+						const bool inFront = _zeroToOneDepth ? clip.z >= 0.0f : clip.z >= -clip.w;
+						if (!inFront || clip.w <= 0.0f)
+						{
+							*out++ = glm::vec4{ 0.0f };
+							continue;
+						}
+
+						const float inverseW = 1.0f / clip.w;
+						const glm::vec2 ndc = glm::vec2(clip) * inverseW;
+						*out++ = { (ndc * 0.5f + 0.5f) * screen, inverseW, 1.0f };
+					}
+				}
+			});
+
+		// Triangle setup and binning, every chunk fills its own bins so tiles replay them in order
+		const uint32_t chunkCount = (_triangleCount + BinChunkSize - 1) / BinChunkSize;
+		if (_bins.size() < static_cast<size_t>(chunkCount) * tileCount)
+			_bins.resize(static_cast<size_t>(chunkCount) * tileCount);
+		for (uint32_t b = 0; b < chunkCount * tileCount; ++b)
+			_bins[b].clear();
+
+		_triangles.resize(_triangleCount);
+
+		Jobs::ParallelFor(0, _triangleCount, BinChunkSize, [this, tileCount](uint32_t first, uint32_t last)
+			{
+				auto occluder = std::upper_bound(_occluders.begin(), _occluders.end(), first,
+					[](uint32_t triangle, const Occluder& o) { return triangle < o.firstTriangle; }) - 1;
+
+				for (uint32_t triangle = first; triangle < last; ++triangle)
+				{
+					while (triangle >= occluder->firstTriangle + occluder->mesh.indices.size() / 3)
+						++occluder;
+
+					const uint32_t local = triangle - occluder->firstTriangle;
+					const glm::vec4& v0 = _screenVertices[occluder->firstVertex + occluder->mesh.indices[3 * local + 0]];
+					glm::vec4 v1 = _screenVertices[occluder->firstVertex + occluder->mesh.indices[3 * local + 1]];
+					glm::vec4 v2 = _screenVertices[occluder->firstVertex + occluder->mesh.indices[3 * local + 2]];
+
+					Triangle& setup = _triangles[triangle];
+					setup.rect = { 1, 1, 0, 0 };
+
+					// Crossing the near plane, dropping it only makes the buffer less occluding
+					if (v0.w == 0.0f || v1.w == 0.0f || v2.w == 0.0f)
+						continue;
+
+					if (_mirrored)
+						std::swap(v1, v2);
+
+					const glm::vec2 p0{ v0 }, p1{ v1 }, p2{ v2 };
+					const glm::vec3 e01 = edgeFunction(p0, p1);
+					const glm::vec3 e12 = edgeFunction(p1, p2);
+					const glm::vec3 e20 = edgeFunction(p2, p0);
+
+					// Back facing or degenerate
+					const float area = glm::dot(e01, glm::vec3(p2, 1.0f));
+					if (area <= MinArea)
+						continue;
+
+					const glm::vec2 min = glm::min(p0, glm::min(p1, p2));
+					const glm::vec2 max = glm::max(p0, glm::max(p1, p2));
+
+					// Pixels whose centers can be covered
+					const glm::ivec4 rect
+					{
+						std::max(0, static_cast<int>(std::ceil(min.x - 0.5f))),
+						std::max(0, static_cast<int>(std::ceil(min.y - 0.5f))),
+						std::min(static_cast<int>(_width) - 1, static_cast<int>(std::floor(max.x - 0.5f))),
+						std::min(static_cast<int>(_height) - 1, static_cast<int>(std::floor(max.y - 0.5f)))
+					};
+					if (rect.x > rect.z || rect.y > rect.w)
+						continue;
+
+					setup.edges[0] = e01;
+					setup.edges[1] = e12;
+					setup.edges[2] = e20;
+
+					// 1 / w is linear in screen space, weighted by the barycentrics from the opposite edges
+					setup.depth = (e12 * v0.z + e20 * v1.z + e01 * v2.z) / area;
+					setup.rect = rect;
+
+					std::vector<uint32_t>* bins = _bins.data() + static_cast<size_t>(first / BinChunkSize) * tileCount;
+					for (int ty = rect.y / static_cast<int>(TileHeight); ty <= rect.w / static_cast<int>(TileHeight); ++ty)
+					{
+						for (int tx = rect.x / static_cast<int>(TileWidth); tx <= rect.z / static_cast<int>(TileWidth); ++tx)
+							bins[ty * _tilesX + tx].push_back(triangle);
+					}
+				}
+			});
+
+		// One tile per job: clear, draw its triangles, then the farthest depth per block
+		const uint32_t blocksX = _width / BlockSize;
+		Jobs::ParallelFor(0, tileCount, 1, [this, kernel, tileCount, chunkCount, blocksX](uint32_t first, uint32_t last)
+			{
+				for (uint32_t tile = first; tile < last; ++tile)
+				{
+					const int x0 = static_cast<int>((tile % _tilesX) * TileWidth);
+					const int y0 = static_cast<int>((tile / _tilesX) * TileHeight);
+					const glm::ivec4 tileRect{ x0, y0, x0 + static_cast<int>(TileWidth) - 1, y0 + static_cast<int>(TileHeight) - 1 };
+
+					for (int y = tileRect.y; y <= tileRect.w; ++y)
+						std::memset(_depth.data() + static_cast<size_t>(y) * _width + x0, 0, TileWidth * sizeof(float));
+
+					for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+					{
+						for (uint32_t triangle : _bins[static_cast<size_t>(chunk) * tileCount + tile])
+						{
+							const Triangle& t = _triangles[triangle];
+							const glm::ivec4 rect{ glm::max(glm::ivec2(t.rect.x, t.rect.y), glm::ivec2(tileRect.x, tileRect.y)),
+								glm::min(glm::ivec2(t.rect.z, t.rect.w), glm::ivec2(tileRect.z, tileRect.w)) };
+							kernel(t, rect, _depth.data(), _width);
+						}
+					}
+
+					for (int by = y0; by < y0 + static_cast<int>(TileHeight); by += BlockSize)
+					{
+						for (int bx = x0; bx < x0 + static_cast<int>(TileWidth); bx += BlockSize)
+						{
+							float farthest = _depth[static_cast<size_t>(by) * _width + bx];
+							for (int y = by; y < by + static_cast<int>(BlockSize); ++y)
+							{
+								const float* row = _depth.data() + static_cast<size_t>(y) * _width;
+								for (int x = bx; x < bx + static_cast<int>(BlockSize); ++x)
+									farthest = std::min(farthest, row[x]);
+							}
+							_blockMin[(by / BlockSize) * blocksX + bx / BlockSize] = farthest;
+						}
+					}
+				}
+			});
+	}
+
+	bool OcclusionCuller::isVisible(const glm::vec3& center, const glm::vec3& extent) const
+	{
+		const glm::vec2 screen{ static_cast<float>(_width), static_cast<float>(_height) };
+
+		glm::vec2 min{ std::numeric_limits<float>::max() };
+		glm::vec2 max{ std::numeric_limits<float>::lowest() };
+		float nearest = 0.0f;
+
+		for (int i = 0; i < 8; ++i)
+		{
+			const glm::vec3 corner = center + glm::vec3(i & 1 ? extent.x : -extent.x, i & 2 ? extent.y : -extent.y, i & 4 ? extent.z : -extent.z);
+			const glm::vec4 clip = _viewProjection * glm::vec4(corner, 1.0f);
+
+			// Reaches behind the near plane, the projected rect is meaningless
+			const bool inFront = _zeroToOneDepth ? clip.z >= 0.0f : clip.z >= -clip.w;
+			if (!inFront || clip.w <= 0.0f)
+				return true;
+
+			const float inverseW = 1.0f / clip.w;
+			const glm::vec2 position = (glm::vec2(clip) * inverseW * 0.5f + 0.5f) * screen;
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+			nearest = std::max(nearest, inverseW);
+		}
+
+		// Every pixel the rect touches
+		const int x0 = std::max(0, static_cast<int>(std::floor(min.x)));
+		const int y0 = std::max(0, static_cast<int>(std::floor(min.y)));
+		const int x1 = std::min(static_cast<int>(_width) - 1, static_cast<int>(std::floor(max.x)));
+		const int y1 = std::min(static_cast<int>(_height) - 1, static_cast<int>(std::floor(max.y)));
+
+		// Off screen is for the frustum test to decide
+		if (x0 > x1 || y0 > y1)
+			return true;
+
+		const uint32_t blocksX = _width / BlockSize;
+		for (int by = y0 / static_cast<int>(BlockSize); by <= y1 / static_cast<int>(BlockSize); ++by)
+		{
+			for (int bx = x0 / static_cast<int>(BlockSize); bx <= x1 / static_cast<int>(BlockSize); ++bx)
+			{
+				// Everything in the block is nearer than the box
+				if (nearest < _blockMin[by * blocksX + bx])
+					continue;
+
+				const int px0 = std::max(x0, bx * static_cast<int>(BlockSize));
+				const int px1 = std::min(x1, bx * static_cast<int>(BlockSize) + static_cast<int>(BlockSize) - 1);
+				const int py0 = std::max(y0, by * static_cast<int>(BlockSize));
+				const int py1 = std::min(y1, by * static_cast<int>(BlockSize) + static_cast<int>(BlockSize) - 1);
+
+				for (int y = py0; y <= py1; ++y)
+				{
+					const float* row = _depth.data() + static_cast<size_t>(y) * _width;
+					for (int x = px0; x <= px1; ++x)
+					{
+						if (nearest >= row[x])
+							return true;
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool OcclusionCuller::IsVisible(const Aabb& box) const
+	{
+		return _width == 0 || isVisible(box.Center(), box.Extent());
+	}
+
+	uint32_t OcclusionCuller::Cull(const AabbBounds& bounds, std::span<const uint32_t> candidates, std::vector<uint32_t>& visible) const
+	{
+		EUGENIX_PROFILE_SCOPE("OcclusionCuller::Cull");
+
+		const uint32_t count = static_cast<uint32_t>(candidates.size());
+		const size_t base = visible.size();
+
+		if (_width == 0)
+		{
+			visible.insert(visible.end(), candidates.begin(), candidates.end());
+			return count;
+		}
+
+		const uint32_t chunkCount = (count + CullGrain - 1) / CullGrain;
+		std::vector<uint32_t> chunkCounts(chunkCount);
+		visible.resize(base + count);
+
+		// Same scheme as FrustumCuller: each chunk writes at its own offset, then the gaps close
+		Jobs::ParallelFor(0, count, CullGrain, [&](uint32_t first, uint32_t last)
+			{
+				for (uint32_t chunkFirst = first; chunkFirst < last; chunkFirst += CullGrain)
+				{
+					const uint32_t chunkLast = std::min(chunkFirst + CullGrain, last);
+					uint32_t written = 0;
+					for (uint32_t c = chunkFirst; c < chunkLast; ++c)
+					{
+						const uint32_t i = candidates[c];
+						const glm::vec3 center{ bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i] };
+						const glm::vec3 extent{ bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i] };
+						if (isVisible(center, extent))
+							visible[base + chunkFirst + written++] = i;
+					}
+					chunkCounts[chunkFirst / CullGrain] = written;
+				}
+			});
+
+		uint32_t kept = 0;
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			const size_t offset = base + static_cast<size_t>(chunk) * CullGrain;
+			if (base + kept != offset)
+				std::memmove(visible.data() + base + kept, visible.data() + offset, chunkCounts[chunk] * sizeof(uint32_t));
+			kept += chunkCounts[chunk];
+		}
+
+		visible.resize(base + kept);
+		return kept;
+	}
+} // namespace Eugenix::Scene
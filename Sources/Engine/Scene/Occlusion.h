@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+#include "Math/Simd.h"
+
+namespace Eugenix::Scene
+{
+	// Geometry drawn into the occlusion buffer, usually a simplified closed mesh. Has to outlive
+	// the Rasterize() of every frame it is added to.
+	struct OccluderMesh
+	{
+		std::span<const glm::vec3> positions;
+		std::span<const uint32_t> indices;
+	};
+
+	// Unit cube around the origin, [-0.5, 0.5] on every axis
+	const OccluderMesh& UnitCubeOccluder();
+
+	// Software occlusion culling. Occluder triangles are binned into screen tiles and rasterized into
+	// a small inverse depth buffer, one tile per job with 8 pixels per step (AVX2, 4 with SSE). Each
+	// 8x8 block keeps its farthest depth, the hierarchical-Z that occludees are tested against before
+	// going down to pixels. Runs after frustum culling on its visible list, the same for both backends.
+	//
+	//   BeginFrame() -> AddOccluder()... -> Rasterize() -> Cull()...
+	//
+	// Cull() is const and can run for several draw lists at once, the rest is not thread-safe.
+	class OcclusionCuller final
+	{
+	public:
+		static constexpr uint32_t TileWidth = 32;
+		static constexpr uint32_t TileHeight = 16;
+		static constexpr uint32_t BlockSize = 8;
+
+		// Rounded up to whole tiles
+		void Resize(uint32_t width, uint32_t height);
+
+		// zeroToOneDepth as for Frustum::FromViewProjection
+		void BeginFrame(const glm::mat4& viewProjection, bool zeroToOneDepth = false);
+
+		// Counter-clockwise triangles face the camera, the others are skipped
+		void AddOccluder(const OccluderMesh& mesh, const glm::mat4& world);
+
+		void Rasterize(Math::SimdLevel level = Math::DetectedSimdLevel());
+
+		// Appends the candidates whose box is not hidden behind the occluders, in candidate order.
+		// Returns the number appended.
+		uint32_t Cull(const AabbBounds& bounds, std::span<const uint32_t> candidates, std::vector<uint32_t>& visible) const;
+
+		bool IsVisible(const Aabb& box) const;
+
+		uint32_t Width() const { return _width; }
+		uint32_t Height() const { return _height; }
+
+		// Inverse view depth (1 / w) per pixel, bottom row first, 0 where no occluder was drawn
+		std::span<const float> Depth() const { return _depth; }
+
+		uint32_t OccluderTriangleCount() const { return _triangleCount; }
+
+		// Edges and the depth plane as functions of the pixel position, a * x + b * y + c
+		struct Triangle
+		{
+			glm::vec3 edges[3];
+			glm::vec3 depth;
+			glm::ivec4 rect; // Pixel bounds, inclusive
+		};
+
+	private:
+		struct Occluder
+		{
+			OccluderMesh mesh;
+			glm::mat4 world;
+			uint32_t firstVertex;
+			uint32_t firstTriangle;
+		};
+
+		bool isVisible(const glm::vec3& center, const glm::vec3& extent) const;
+
+		uint32_t _width{ 0 };
+		uint32_t _height{ 0 };
+		uint32_t _tilesX{ 0 };
+		uint32_t _tilesY{ 0 };
+
+		glm::mat4 _viewProjection{ 1.0f };
+		bool _zeroToOneDepth{ false };
+		bool _mirrored{ false };
+
+		std::vector<Occluder> _occluders;
+		uint32_t _vertexCount{ 0 };
+		uint32_t _triangleCount{ 0 };
+
+		// Screen x, y, 1 / w and 1 (0 behind the near plane) per occluder vertex
+		std::vector<glm::vec4> _screenVertices;
+		std::vector<Triangle> _triangles;
+
+		// Triangle indices per binning chunk and tile, tiles rasterize the chunks in order
+		std::vector<std::vector<uint32_t>> _bins;
+
+		std::vector<float> _depth;
+		std::vector<float> _blockMin;
+	};
+} // namespace Eugenix::Scene
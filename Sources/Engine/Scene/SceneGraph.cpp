@@ -0,0 +1,258 @@
+#include "SceneGraph.h"
+
+#include <atomic>
+#include <cassert>
+
+#include "Core/Jobs.h"
+#include "Core/Profiler.h"
+
+namespace Eugenix::Scene
+{
+	NodeId SceneGraph::Create(NodeId parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		assert(parent == InvalidNode || IsValid(parent));
+
+		const uint32_t depth = parent == InvalidNode ? 0 : _locations[parent].level + 1;
+		const uint32_t parentIndex = parent == InvalidNode ? InvalidIndex : _locations[parent].index;
+
+		if (depth == _levels.size())
+			_levels.emplace_back();
+
+		Level& level = _levels[depth];
+		const uint32_t index = level.local.Add(position, rotation, scale);
+		level.world.emplace_back(1.0f);
+		level.parent.push_back(parentIndex);
+		level.dirty.push_back(1);
+		level.changed.push_back(0);
+		level.anyDirty = true;
+
+		NodeId node{};
+		if (!_freeIds.empty())
+		{
+			node = _freeIds.back();
+			_freeIds.pop_back();
+		}
+		else
+		{
+			node = static_cast<NodeId>(_locations.size());
+			_locations.emplace_back();
+			_generations.push_back(0);
+		}
+
+		_locations[node] = { depth, index };
+		++_generations[node];
+		level.ids.push_back(node);
+
+		return node;
+	}
+
+	void SceneGraph::Destroy(NodeId node)
+	{
+		assert(IsValid(node));
+
+		const Location location = _locations[node];
+
+		if (location.level + 1 < _levels.size())
+		{
+			// Backwards, so the nodes swapped into the freed slots were already visited
+			Level& children = _levels[location.level + 1];
+			for (uint32_t i = children.Size(); i-- > 0;)
+			{
+				if (children.parent[i] == location.index)
+					Destroy(children.ids[i]);
+			}
+		}
+
+		removeAt(location.level, location.index);
+
+		_locations[node] = { InvalidIndex, InvalidIndex };
+		_freeIds.push_back(node);
+	}
+
+	NodeId SceneGraph::Parent(NodeId node) const
+	{
+		const Location& location = _locations[node];
+		if (location.level == 0)
+			return InvalidNode;
+
+		return _levels[location.level - 1].ids[_levels[location.level].parent[location.index]];
+	}
+
+	void SceneGraph::SetPosition(NodeId node, const glm::vec3& position)
+	{
+		const Location& location = _locations[node];
+		_levels[location.level].local.SetPosition(location.index, position);
+		markDirty(location);
+	}
+
+	void SceneGraph::SetRotation(NodeId node, const glm::quat& rotation)
+	{
+		const Location& location = _locations[node];
+		_levels[location.level].local.SetRotation(location.index, rotation);
+		markDirty(location);
+	}
+
+	void SceneGraph::SetScale(NodeId node, const glm::vec3& scale)
+	{
+		const Location& location = _locations[node];
+		_levels[location.level].local.SetScale(location.index, scale);
+		markDirty(location);
+	}
+
+	glm::vec3 SceneGraph::Position(NodeId node) const
+	{
+		const Location& location = _locations[node];
+		return _levels[location.level].local.Position(location.index);
+	}
+
+	glm::quat SceneGraph::Rotation(NodeId node) const
+	{
+		const Location& location = _locations[node];
+		return _levels[location.level].local.Rotation(location.index);
+	}
+
+	glm::vec3 SceneGraph::Scale(NodeId node) const
+	{
+		const Location& location = _locations[node];
+		return _levels[location.level].local.Scale(location.index);
+	}
+
+	void SceneGraph::Translate(NodeId node, const glm::vec3& translate)
+	{
+		const Location& location = _locations[node];
+		_levels[location.level].local.Translate(location.index, translate);
+		markDirty(location);
+	}
+
+	void SceneGraph::Rotate(NodeId node, const glm::quat& rotation)
+	{
+		const Location& location = _locations[node];
+		_levels[location.level].local.Rotate(location.index, rotation);
+		markDirty(location);
+	}
+
+	void SceneGraph::Scale(NodeId node, const glm::vec3& scale)
+	{
+		const Location& location = _locations[node];
+		_levels[location.level].local.Scale(location.index, scale);
+		markDirty(location);
+	}
+
+	const glm::mat4& SceneGraph::World(NodeId node) const
+	{
+		const Location& location = _locations[node];
+		return _levels[location.level].world[location.index];
+	}
+
+	void SceneGraph::Update()
+	{
+		EUGENIX_PROFILE_COUNTERS_SCOPE("SceneGraph::Update");
+
+		_lastUpdatedCount = 0;
+
+		const Level* parentLevel = nullptr;
+		for (Level& level : _levels)
+		{
+			const bool parentChanged = parentLevel && parentLevel->anyChanged;
+
+			// Stale changed flags of a skipped level are never read, the level below checks anyChanged first
+			level.anyChanged = false;
+
+			if (level.anyDirty || parentChanged)
+			{
+				std::atomic<uint32_t> updated{ 0 };
+
+				Jobs::ParallelFor(0, level.Size(), GrainSize, [&](uint32_t first, uint32_t last)
+					{
+						updated.fetch_add(updateRange(level, parentLevel, parentChanged, first, last), std::memory_order_relaxed);
+					});
+
+				const uint32_t updatedCount = updated.load(std::memory_order_relaxed);
+				level.anyDirty = false;
+				level.anyChanged = updatedCount > 0;
+				_lastUpdatedCount += updatedCount;
+			}
+
+			parentLevel = &level;
+		}
+	}
+
+	uint32_t SceneGraph::updateRange(Level& level, const Level* parentLevel, bool parentChanged, uint32_t first, uint32_t last)
+	{
+		// Local matrices of consecutive dirty nodes go through the batch kernels together
+		for (uint32_t i = first; i < last;)
+		{
+			if (!level.dirty[i])
+			{
+				++i;
+				continue;
+			}
+
+			uint32_t runEnd = i + 1;
+			while (runEnd < last && level.dirty[runEnd])
+				++runEnd;
+
+			level.local.Update(i, runEnd);
+			i = runEnd;
+		}
+
+		uint32_t updated = 0;
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const bool parentMoved = parentChanged && parentLevel->changed[level.parent[i]];
+			if (!level.dirty[i] && !parentMoved)
+			{
+				level.changed[i] = 0;
+				continue;
+			}
+
+			level.world[i] = parentLevel ? parentLevel->world[level.parent[i]] * level.local.World(i) : level.local.World(i);
+			level.dirty[i] = 0;
+			level.changed[i] = 1;
+			++updated;
+		}
+		return updated;
+	}
+
+	void SceneGraph::markDirty(const Location& location)
+	{
+		Level& level = _levels[location.level];
+		level.dirty[location.index] = 1;
+		level.anyDirty = true;
+	}
+
+	void SceneGraph::removeAt(uint32_t levelIndex, uint32_t index)
+	{
+		Level& level = _levels[levelIndex];
+		const uint32_t last = level.Size() - 1;
+
+		level.local.Remove(index);
+
+		if (index != last)
+		{
+			level.world[index] = level.world[last];
+			level.parent[index] = level.parent[last];
+			level.ids[index] = level.ids[last];
+			level.dirty[index] = level.dirty[last];
+			level.changed[index] = level.changed[last];
+
+			_locations[level.ids[index]].index = index;
+
+			// Children of the moved node follow it
+			if (levelIndex + 1 < _levels.size())
+			{
+				for (uint32_t& parent : _levels[levelIndex + 1].parent)
+				{
+					if (parent == last)
+						parent = index;
+				}
+			}
+		}
+
+		level.world.pop_back();
+		level.parent.pop_back();
+		level.ids.pop_back();
+		level.dirty.pop_back();
+		level.changed.pop_back();
+	}
+} // namespace Eugenix::Scene
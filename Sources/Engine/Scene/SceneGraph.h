@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Math/TransformBatch.h"
+
+namespace Eugenix::Scene
+{
+	using NodeId = uint32_t;
+	constexpr NodeId InvalidNode = UINT32_MAX;
+
+	// Transform hierarchy stored level by level: every node sits in the contiguous arrays of its depth
+	// and refers to its parent by index into the level above. Update() walks the levels top-down and
+	// only recomposes nodes whose local transform changed or whose parent moved, so a static scene
+	// costs one check per level. Nodes of one level are independent and updated in parallel.
+	// Not thread-safe.
+	class SceneGraph final
+	{
+	public:
+		NodeId Create(NodeId parent = InvalidNode,
+			const glm::vec3& position = glm::vec3{ 0.0f },
+			const glm::quat& rotation = glm::quat{ 1.0f, 0.0f, 0.0f, 0.0f },
+			const glm::vec3& scale = glm::vec3{ 1.0f });
+
+		// Destroys the node and its subtree
+		void Destroy(NodeId node);
+
+		bool IsValid(NodeId node) const { return node < _locations.size() && _locations[node].level != InvalidIndex; }
+
+		// Bumped every time Create() hands the id out, tells a recycled id from the node it named before
+		uint32_t Generation(NodeId node) const { return _generations[node]; }
+
+		NodeId Parent(NodeId node) const;
+		uint32_t Depth(NodeId node) const { return _locations[node].level; }
+
+		// Local transform, same semantics as Math::Transform
+		void SetPosition(NodeId node, const glm::vec3& position);
+		void SetRotation(NodeId node, const glm::quat& rotation);
+		void SetScale(NodeId node, const glm::vec3& scale);
+
+		glm::vec3 Position(NodeId node) const;
+		glm::quat Rotation(NodeId node) const;
+		glm::vec3 Scale(NodeId node) const;
+
+		void Translate(NodeId node, const glm::vec3& translate);
+		void Rotate(NodeId node, const glm::quat& rotation);
+		void Scale(NodeId node, const glm::vec3& scale);
+
+		// Propagates the dirty subtrees into the world matrices
+		void Update();
+
+		// As of the last Update()
+		const glm::mat4& World(NodeId node) const;
+
+		uint32_t NodeCount() const { return static_cast<uint32_t>(_locations.size() - _freeIds.size()); }
+
+		// Every id handed out so far is below this, destroyed ones included
+		uint32_t IdRange() const { return static_cast<uint32_t>(_locations.size()); }
+		uint32_t LevelCount() const { return static_cast<uint32_t>(_levels.size()); }
+
+		// World matrices recomposed by the last Update()
+		uint32_t LastUpdatedCount() const { return _lastUpdatedCount; }
+
+	private:
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		// Nodes per job when a level is split across the workers
+		static constexpr uint32_t GrainSize = 1024;
+
+		struct Location
+		{
+			uint32_t level;
+			uint32_t index;
+		};
+
+		struct Level
+		{
+			Math::TransformBatch local;		// Composed local matrices in its World()
+			std::vector<glm::mat4> world;
+			std::vector<uint32_t> parent;	// Index in the level above, InvalidIndex for roots
+			std::vector<NodeId> ids;
+			std::vector<uint8_t> dirty;		// Local transform changed
+			std::vector<uint8_t> changed;	// World matrix recomposed by the last Update(), read by the level below
+			bool anyDirty{ false };
+			bool anyChanged{ false };
+
+			uint32_t Size() const { return static_cast<uint32_t>(ids.size()); }
+		};
+
+		void markDirty(const Location& location);
+		void removeAt(uint32_t levelIndex, uint32_t index);
+
+		static uint32_t updateRange(Level& level, const Level* parentLevel, bool parentChanged, uint32_t first, uint32_t last);
+
+		std::vector<Level> _levels;
+		std::vector<Location> _locations;
+		std::vector<uint32_t> _generations;	// By NodeId
+		std::vector<NodeId> _freeIds;
+		uint32_t _lastUpdatedCount{ 0 };
+	};
+} // namespace Eugenix::Scene
@@ -0,0 +1,63 @@
+#include "Systems.h"
+
+#include <algorithm>
+
+#include "Core/Profiler.h"
+
+namespace
+{
+	void runSystem(const char* name, const Eugenix::Scene::SystemScheduler::SystemFn& fn, Eugenix::Scene::Registry& registry)
+	{
+		EUGENIX_PROFILE_SCOPE(name);
+		fn(registry);
+	}
+}
+
+namespace Eugenix::Scene
+{
+	void SystemScheduler::Add(const char* name, const ComponentMask& reads, const ComponentMask& writes, SystemFn fn)
+	{
+		// One phase after the last system it conflicts with
+		uint32_t phase = 0;
+		for (const System& other : _systems)
+		{
+			const bool conflict = (writes & (other.reads | other.writes)).any() || (other.writes & reads).any();
+			if (conflict)
+				phase = std::max(phase, other.phase + 1);
+		}
+
+		if (phase == _phases.size())
+			_phases.emplace_back();
+
+		_phases[phase].push_back(static_cast<uint32_t>(_systems.size()));
+		_systems.push_back({ name, reads, writes, std::move(fn), phase });
+	}
+
+	void SystemScheduler::Run(Registry& registry)
+	{
+		EUGENIX_PROFILE_SCOPE("SystemScheduler::Run");
+
+		for (const auto& phase : _phases)
+		{
+			if (phase.size() == 1)
+			{
+				const System& system = _systems[phase.front()];
+				runSystem(system.name, system.fn, registry);
+				continue;
+			}
+
+			// The caller runs the first system itself and then helps with the rest
+			Jobs::Counter counter;
+			for (size_t i = 1; i < phase.size(); ++i)
+			{
+				const System& system = _systems[phase[i]];
+				Jobs::Run([&system, &registry] { runSystem(system.name, system.fn, registry); }, &counter);
+			}
+
+			const System& first = _systems[phase.front()];
+			runSystem(first.name, first.fn, registry);
+
+			Jobs::Wait(counter);
+		}
+	}
+} // namespace Eugenix::Scene
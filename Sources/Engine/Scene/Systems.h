@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Ecs.h"
+
+namespace Eugenix::Scene
+{
+	// Runs systems over a registry in phases. A system declares the components it reads and writes;
+	// systems without conflicting access share a phase and run as parallel jobs, conflicting ones
+	// keep the order they were added in.
+	class SystemScheduler final
+	{
+	public:
+		using SystemFn = std::function<void(Registry&)>;
+
+		// The name shows up as a profiler zone, string literals only
+		void Add(const char* name, const ComponentMask& reads, const ComponentMask& writes, SystemFn fn);
+
+		void Run(Registry& registry);
+
+		uint32_t PhaseCount() const { return static_cast<uint32_t>(_phases.size()); }
+
+	private:
+		struct System
+		{
+			const char* name;
+			ComponentMask reads;
+			ComponentMask writes;
+			SystemFn fn;
+			uint32_t phase;
+		};
+
+		std::vector<System> _systems;
+		std::vector<std::vector<uint32_t>> _phases;
+	};
+} // namespace Eugenix::Scene
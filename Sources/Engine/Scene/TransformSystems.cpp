@@ -0,0 +1,94 @@
+#include "TransformSystems.h"
+
+#include "Core/Profiler.h"
+#include "Math/Transform.h"
+
+namespace Eugenix::Scene
+{
+	TransformSystem::TransformSystem(Registry& registry)
+		: _query(registry)
+	{
+		_query.Exclude<SceneNode>();
+	}
+
+	void TransformSystem::Update()
+	{
+		EUGENIX_PROFILE_COUNTERS_SCOPE("TransformSystem::Update");
+
+		_query.ParallelForEachChunk([](uint32_t count, const Entity*, const LocalTransform* locals, WorldTransform* worlds)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const LocalTransform& local = locals[i];
+					const glm::mat3 rotation = glm::mat3_cast(local.rotation);
+
+					worlds[i].matrix = glm::mat4(
+						glm::vec4(rotation[0] * local.scale.x, 0.0f),
+						glm::vec4(rotation[1] * local.scale.y, 0.0f),
+						glm::vec4(rotation[2] * local.scale.z, 0.0f),
+						glm::vec4(local.position, 1.0f));
+				}
+			});
+	}
+
+	SceneGraphSyncSystem::SceneGraphSyncSystem(Registry& registry, const SceneGraph& graph)
+		: _query(registry)
+		, _graph(graph)
+	{
+	}
+
+	void SceneGraphSyncSystem::Update()
+	{
+		_query.ForEachChunk([this](uint32_t count, const Entity*, const SceneNode* nodes, WorldTransform* worlds)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+					worlds[i].matrix = _graph.World(nodes[i].node);
+			});
+	}
+
+	void SceneSnapshot::Capture(const SceneGraph& graph)
+	{
+		world.resize(graph.IdRange());
+		generation.resize(graph.IdRange());
+		for (NodeId node = 0; node < graph.IdRange(); ++node)
+		{
+			const bool valid = graph.IsValid(node);
+			world[node] = valid ? graph.World(node) : glm::mat4{ 1.0f };
+			generation[node] = valid ? graph.Generation(node) : 0;
+		}
+	}
+
+	SnapshotSyncSystem::SnapshotSyncSystem(Registry& registry)
+		: _query(registry)
+	{
+	}
+
+	void SnapshotSyncSystem::Update(const SceneSnapshot& previous, const SceneSnapshot& latest, float alpha)
+	{
+		EUGENIX_PROFILE_SCOPE("SnapshotSyncSystem::Update");
+
+		_query.ParallelForEachChunk([&previous, &latest, alpha](uint32_t count, const Entity*, const SceneNode* nodes, WorldTransform* worlds)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const NodeId node = nodes[i].node;
+					if (node >= latest.world.size())
+						continue;
+
+					// Nodes created after the previous step, or whose id was recycled since, have nothing
+					// to blend from
+					const uint32_t generation = latest.generation[node];
+					if (generation != 0 && node < previous.world.size() && previous.generation[node] == generation)
+						worlds[i].matrix = Math::Interpolate(previous.world[node], latest.world[node], alpha);
+					else
+						worlds[i].matrix = latest.world[node];
+				}
+			});
+	}
+
+	void AddTransformSystems(SystemScheduler& scheduler, TransformSystem& transforms, SceneGraphSyncSystem& sceneGraph)
+	{
+		scheduler.Add("TransformSystem", MaskOf<LocalTransform>(), MaskOf<WorldTransform>(), [&transforms](Registry&) { transforms.Update(); });
+		scheduler.Add("SceneGraphSyncSystem", MaskOf<SceneNode>(), MaskOf<WorldTransform>(), [&sceneGraph](Registry&) { sceneGraph.Update(); });
+	}
+} // namespace Eugenix::Scene
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include "Components.h"
+#include "Ecs.h"
+#include "SceneGraph.h"
+#include "Systems.h"
+
+namespace Eugenix::Scene
+{
+	// LocalTransform -> WorldTransform for every entity that is not a SceneNode, chunks in parallel
+	class TransformSystem final
+	{
+	public:
+		explicit TransformSystem(Registry& registry);
+
+		void Update();
+
+	private:
+		Query<const LocalTransform, WorldTransform> _query;
+	};
+
+	// SceneGraph world matrices -> WorldTransform of SceneNode entities, run after SceneGraph::Update()
+	class SceneGraphSyncSystem final
+	{
+	public:
+		SceneGraphSyncSystem(Registry& registry, const SceneGraph& graph);
+
+		void Update();
+
+	private:
+		Query<const SceneNode, WorldTransform> _query;
+		const SceneGraph& _graph;
+	};
+
+	// World matrices of a SceneGraph by NodeId, what a simulation thread hands to the renderer
+	struct SceneSnapshot
+	{
+		std::vector<glm::mat4> world;
+		std::vector<uint32_t> generation;	// SceneGraph::Generation(), 0 where no node was alive
+
+		// After SceneGraph::Update(), destroyed nodes get the identity
+		void Capture(const SceneGraph& graph);
+	};
+
+	// Two snapshots blended into WorldTransform of SceneNode entities, for when the SceneGraph is
+	// owned by a simulation thread and the render thread only sees its snapshots
+	class SnapshotSyncSystem final
+	{
+	public:
+		explicit SnapshotSyncSystem(Registry& registry);
+
+		void Update(const SceneSnapshot& previous, const SceneSnapshot& latest, float alpha);
+
+	private:
+		Query<const SceneNode, WorldTransform> _query;
+	};
+
+	// Schedules both, they write disjoint entity sets but the same component so they run one after another
+	void AddTransformSystems(SystemScheduler& scheduler, TransformSystem& transforms, SceneGraphSyncSystem& sceneGraph);
+} // namespace Eugenix::Scene
@@ -1,3 +1,10 @@
+#include <array>
+#include <format>
+#include <fstream>
+#include <iterator>
+
+#include <json11.hpp>
+
 #include <imgui.h>
 #include <imgui/backends/imgui_impl_glfw.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
@@ -8,12 +15,46 @@
 #include "Render/OpenGL/Pipeline.h"
 
 #include "Engine/CompileConfig.h"
+#include "Engine/Core/FrameStats.h"
+#include "Engine/Core/Jobs.h"
 #include "Engine/Core/Log.h"
+#include "Engine/Core/Memory.h"
 #include "Engine/Core/Platform.h"
+#include "Engine/Core/Profiler.h"
 #include "Engine/Core/Time.h"
 
 namespace
 {
+	// Benchmark input, replayed identically every run so frame times are comparable between builds.
+	// Turning holds the right mouse button, which is what the sandbox cameras look for.
+	struct CameraStep
+	{
+		uint32_t frames;
+		int key;
+		float turnX;
+		float turnY;
+	};
+
+	constexpr std::array CameraScript =
+	{
+		CameraStep{ 120, GLFW_KEY_W, 0.0f, 0.0f },
+		CameraStep{ 120, -1, 4.0f, 0.0f },
+		CameraStep{ 120, GLFW_KEY_A, 0.0f, 1.0f },
+		CameraStep{ 120, GLFW_KEY_S, -4.0f, -1.0f },
+		CameraStep{ 120, GLFW_KEY_D, 0.0f, 0.0f },
+	};
+
+	constexpr std::array ScriptKeys = { GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D };
+
+	json11::Json toJson(const Eugenix::FrameStats::Percentiles& percentiles)
+	{
+		return json11::Json::object{
+			{ "p50", percentiles.p50 },
+			{ "p95", percentiles.p95 },
+			{ "p99", percentiles.p99 },
+			{ "max", percentiles.max } };
+	}
+
 #if EUGENIX_DEBUG
 	void debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, GLchar const* message, void const* user_param)
 	{
@@ -87,55 +128,121 @@ namespace Eugenix
 			return EXIT_FAILURE;
 		}
 
+		_gpuProfiler.Create();
+
+		// GLFW and the GL context stay on this thread, jobs that need them go through Jobs::RunOnMainThread
+		Jobs::Initialize();
+		EUGENIX_PROFILE_THREAD("Main");
+
 		if (!onInit())
 		{
 			LogError("Failed to init client app");
+			Jobs::Shutdown();
+			_gpuProfiler.Destroy();
 			return EXIT_FAILURE;
 		}
 
 		auto lastTime = Time::Clock::now();
-		auto fpsTime = lastTime;
-		int frameCount = 0;
+		auto statsTime = lastTime;
+		uint32_t frameIndex = 0;
 
 		while (!glfwWindowShouldClose(_window))
 		{
+			EUGENIX_PROFILE_SCOPE("Frame");
+
+			Memory::BeginFrame();
+			FrameStats::BeginFrame();
+
+			_gpuProfiler.BeginFrame();
+			FrameStats::SetGpuTime(_gpuProfiler.LastFrameMilliseconds());
+
 			auto currentTime = Time::Clock::now();
 			Time::Duration deltaTime = currentTime - lastTime;
 			lastTime = currentTime;
 
-			glfwPollEvents();
+			{
+				EUGENIX_PROFILE_SCOPE("PollEvents");
+				glfwPollEvents();
+				Jobs::PumpMainThread();
+			}
 
-			onUpdate(deltaTime.count());
-			onRender();
+			if (_benchmark)
+			{
+				if (frameIndex == _benchmark->warmupFrames)
+					FrameStats::Reset();
+				if (frameIndex == _benchmark->warmupFrames + _benchmark->frames)
+					break;
+
+				deltaTime = Time::Duration(_benchmark->deltaTime);
+				applyCameraScript(frameIndex);
+			}
+			++frameIndex;
+
+			{
+				EUGENIX_PROFILE_SCOPE("onUpdate");
+				onUpdate(deltaTime.count());
+			}
+			{
+				EUGENIX_PROFILE_SCOPE("onRender");
+				EUGENIX_GL_PROFILE_SCOPE(_gpuProfiler, "onRender");
+				onRender();
+			}
 
 #if EUGENIX_DEBUG_UI_ENABLED
-			ImGui_ImplOpenGL3_NewFrame();
-			ImGui_ImplGlfw_NewFrame();
-			ImGui::NewFrame();
+			{
+				EUGENIX_PROFILE_SCOPE("DebugUI");
+				EUGENIX_GL_PROFILE_SCOPE(_gpuProfiler, "DebugUI");
+				ImGui_ImplOpenGL3_NewFrame();
+				ImGui_ImplGlfw_NewFrame();
+				ImGui::NewFrame();
 
-			onDebugUI();
+				onDebugUI();
 
-			ImGui::Render();
-			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+				if (_showFrameStats)
+					drawFrameStats();
+
+				ImGui::Render();
+				ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+			}
 #endif EUGENIX_DEBUG_UI_ENABLED
 
-			glfwSwapBuffers(_window);
+			{
+				EUGENIX_PROFILE_SCOPE("SwapBuffers");
+
+				// Blocks once the driver queue is full, the closest GL has to a fence wait.
+				// Offscreen there is nothing to present, waiting for the GPU keeps every frame's work inside it.
+				const auto swapStart = Time::Clock::now();
+				if (_benchmark)
+					glFinish();
+				else
+					glfwSwapBuffers(_window);
+				FrameStats::AddFenceWait(std::chrono::duration<double, std::milli>(Time::Clock::now() - swapStart).count());
+			}
 
-			frameCount++;
-			if (Time::Duration(currentTime - fpsTime).count() >= 1.0f)
+			if (Time::Duration(currentTime - statsTime).count() >= 1.0f)
 			{
-				float fps = static_cast<float>(frameCount);
-				std::ostringstream title;
-				title << "EugenixSandbox - FPS: " << std::fixed << std::setprecision(1) << fps
-					<< " | Frame Time: " << std::setprecision(3) << (deltaTime.count() * 1000.0f) << " ms";
-				glfwSetWindowTitle(_window, title.str().c_str());
-
-				frameCount = 0;
-				fpsTime = currentTime;
+				const FrameStats::Summary stats = FrameStats::Compute();
+				const FrameStats::Frame& frame = FrameStats::LastFrame();
+
+				Memory::String title{ Memory::FrameResource() };
+				std::format_to(std::back_inserter(title),
+					"EugenixSandbox - CPU p50/p99/max: {:.2f}/{:.2f}/{:.2f} ms | GPU p50: {:.2f} ms | Hitches: {} | Visible: {}/{} | Heap allocs/frame: {}",
+					stats.cpu.p50, stats.cpu.p99, stats.cpu.max, stats.gpu.p50, stats.hitchCount, frame.objectsVisible - frame.objectsOccluded, frame.objectsTested,
+					Memory::LastFrameStats().heapAllocations);
+				glfwSetWindowTitle(_window, title.c_str());
+
+				statsTime = currentTime;
 			}
 		}
 
+		int result = EXIT_SUCCESS;
+		if (_benchmark && !writeBenchmarkReport())
+			result = EXIT_FAILURE;
+
 		onCleanup();
+		Jobs::Shutdown();
+		_gpuProfiler.Destroy();
+		destroyOffscreenTarget();
 
 #if EUGENIX_DEBUG_UI_ENABLED
 		ImGui_ImplOpenGL3_Shutdown();
@@ -145,11 +252,141 @@ namespace Eugenix
 
 		glfwTerminate();
 
-		return EXIT_SUCCESS;
+		FrameStats::SaveCsv("FrameStats.csv");
+
+		return result;
+	}
+
+	void SandboxApp::drawFrameStats()
+	{
+#if EUGENIX_DEBUG_UI_ENABLED
+		const FrameStats::Summary stats = FrameStats::Compute();
+		const FrameStats::History history = FrameStats::CpuHistory();
+
+		ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_FirstUseEver);
+		ImGui::Begin("Frame Stats", &_showFrameStats, ImGuiWindowFlags_AlwaysAutoResize);
+
+		ImGui::Text("Last %u frames (%llu total)", stats.sampleCount, static_cast<unsigned long long>(stats.frameCount));
+		ImGui::Separator();
+		ImGui::Text("           p50     p95     p99     max");
+		ImGui::Text("CPU    %7.2f %7.2f %7.2f %7.2f ms", stats.cpu.p50, stats.cpu.p95, stats.cpu.p99, stats.cpu.max);
+		ImGui::Text("GPU    %7.2f %7.2f %7.2f %7.2f ms", stats.gpu.p50, stats.gpu.p95, stats.gpu.p99, stats.gpu.max);
+		ImGui::Text("Swap   %7.2f %7.2f %7.2f %7.2f ms", stats.fenceWait.p50, stats.fenceWait.p95, stats.fenceWait.p99, stats.fenceWait.max);
+		ImGui::Separator();
+		ImGui::Text("Hitches (> %.1fx average): %llu", FrameStats::HitchFactor, static_cast<unsigned long long>(stats.hitchCount));
+
+		const FrameStats::Frame& frame = FrameStats::LastFrame();
+		ImGui::Text("Culling: %u visible, %u culled, %u occluded of %u", frame.objectsVisible - frame.objectsOccluded,
+			frame.objectsTested - frame.objectsVisible, frame.objectsOccluded, frame.objectsTested);
+		ImGui::Text("Triangles: %llu", static_cast<unsigned long long>(frame.triangles));
+
+		ImGui::PlotLines("##cpu", history.values, history.count, history.offset, "CPU ms", 0.0f,
+			static_cast<float>(stats.cpu.max), ImVec2(320.0f, 80.0f));
+
+		ImGui::End();
+#endif // EUGENIX_DEBUG_UI_ENABLED
+	}
+
+	bool SandboxApp::createOffscreenTarget()
+	{
+		// Surfaceless contexts have no default framebuffer, tests render into this one instead
+		glCreateRenderbuffers(1, &_offscreenColor);
+		glNamedRenderbufferStorage(_offscreenColor, GL_SRGB8_ALPHA8, _width, _height);
+
+		glCreateRenderbuffers(1, &_offscreenDepth);
+		glNamedRenderbufferStorage(_offscreenDepth, GL_DEPTH24_STENCIL8, _width, _height);
+
+		glCreateFramebuffers(1, &_offscreenFramebuffer);
+		glNamedFramebufferRenderbuffer(_offscreenFramebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _offscreenColor);
+		glNamedFramebufferRenderbuffer(_offscreenFramebuffer, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _offscreenDepth);
+
+		if (glCheckNamedFramebufferStatus(_offscreenFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			destroyOffscreenTarget();
+			return false;
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, _offscreenFramebuffer);
+		return true;
+	}
+
+	void SandboxApp::destroyOffscreenTarget()
+	{
+		if (_offscreenFramebuffer)
+		{
+			glDeleteFramebuffers(1, &_offscreenFramebuffer);
+			glDeleteRenderbuffers(1, &_offscreenColor);
+			glDeleteRenderbuffers(1, &_offscreenDepth);
+			_offscreenFramebuffer = _offscreenColor = _offscreenDepth = 0;
+		}
+	}
+
+	void SandboxApp::applyCameraScript(uint32_t frame)
+	{
+		uint32_t scriptFrames = 0;
+		for (const auto& step : CameraScript)
+			scriptFrames += step.frames;
+
+		frame %= scriptFrames;
+
+		const CameraStep* current = &CameraScript.front();
+		for (const auto& step : CameraScript)
+		{
+			current = &step;
+			if (frame < step.frames)
+				break;
+			frame -= step.frames;
+		}
+
+		for (int key : ScriptKeys)
+			_keys[key] = key == current->key;
+
+		_buttons[GLFW_MOUSE_BUTTON_RIGHT] = current->turnX != 0.0f || current->turnY != 0.0f;
+		_xChange = current->turnX;
+		_yChange = current->turnY;
+	}
+
+	bool SandboxApp::writeBenchmarkReport() const
+	{
+		const FrameStats::Summary stats = FrameStats::ComputeHistory();
+		if (stats.sampleCount < _benchmark->frames)
+			LogWarn("Benchmark: only the last {} of {} frames are kept for the report", stats.sampleCount, _benchmark->frames);
+
+		const json11::Json report = json11::Json::object{
+			{ "test", _benchmark->name },
+			{ "frames", static_cast<int>(stats.sampleCount) },
+			{ "warmupFrames", static_cast<int>(_benchmark->warmupFrames) },
+			{ "deltaTime", _benchmark->deltaTime },
+			{ "width", _width },
+			{ "height", _height },
+			{ "renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)) },
+			{ "averageMs", stats.averageMs },
+			{ "hitches", static_cast<int>(stats.hitchCount) },
+			{ "cpuMs", toJson(stats.cpu) },
+			{ "gpuMs", toJson(stats.gpu) },
+			{ "fenceWaitMs", toJson(stats.fenceWait) } };
+
+		std::ofstream file(_benchmark->output);
+		if (!file)
+		{
+			LogError("Benchmark: failed to open {}", _benchmark->output.string());
+			return false;
+		}
+
+		file << report.dump() << '\n';
+		LogInfo("Benchmark {}: {} frames, CPU p50 {:.3f} ms, p99 {:.3f} ms, GPU p50 {:.3f} ms -> {}",
+			_benchmark->name, stats.sampleCount, stats.cpu.p50, stats.cpu.p99, stats.gpu.p50, _benchmark->output.string());
+		return true;
 	}
 
 	bool SandboxApp::initRuntime()
 	{
+#if !EUGENIX_PLATFORM_WINDOWS
+		// CI boxes have no display: the null platform with an EGL surfaceless context runs on Mesa llvmpipe
+		if (_benchmark && glfwPlatformSupported(GLFW_PLATFORM_NULL))
+			glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
 		if (glfwInit() != GLFW_TRUE)
 		{
 			LogError("Failed to init GLFW");
@@ -161,6 +398,13 @@ namespace Eugenix
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+		if (_benchmark)
+		{
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			if (glfwGetPlatform() == GLFW_PLATFORM_NULL)
+				glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+		}
+
 		_window = glfwCreateWindow(_width, _height, "EugenixSandbox", nullptr, nullptr);
 		if (_window == nullptr)
 		{
@@ -189,6 +433,17 @@ namespace Eugenix
 					glfwSetWindowShouldClose(window, true);
 				}
 
+				if (key == GLFW_KEY_F9 && action == GLFW_PRESS)
+				{
+					Profiler::ToggleCapture("ProfilerCapture.json");
+				}
+
+				if (key == GLFW_KEY_F8 && action == GLFW_PRESS)
+				{
+					if (auto* self = static_cast<SandboxApp*>(glfwGetWindowUserPointer(window)))
+						self->_showFrameStats = !self->_showFrameStats;
+				}
+
 				if (key == GLFW_KEY_TAB && action == GLFW_PRESS)
 				{
 					//Render::OpenGL::Pipeline::EnableSolidMode();
@@ -281,6 +536,7 @@ namespace Eugenix
 		{
 			LogError("Failed to init OpenGL!");
 			glfwTerminate();
+			return false;
 		}
 
 		LogInfo("OpenGL Renderer : {}", (const char*)glGetString(GL_RENDERER));
@@ -296,6 +552,19 @@ namespace Eugenix
 		//Render::OpenGL::Pipeline::Enable(Render::PipelineFeature::GL_FRAMEBUFFER_SRGB);
 		glEnable(GL_FRAMEBUFFER_SRGB);
 
+		if (_benchmark)
+		{
+			// Measure rendering, not the display refresh
+			glfwSwapInterval(0);
+
+			if (!createOffscreenTarget())
+			{
+				LogError("Failed to create the benchmark framebuffer");
+				glfwTerminate();
+				return false;
+			}
+		}
+
 #if EUGENIX_DEBUG
 		glEnable(GL_DEBUG_OUTPUT);
 		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
@@ -1,23 +1,41 @@
 #pragma once
 
+#include <filesystem>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
+#include <string>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "Render/RenderCaps.h"
+#include "Render/OpenGL/GpuProfiler.h"
 
 constexpr auto DEFAULT_WIDTH = 1024;
 constexpr auto DEFAULT_HEIGHT = 768;
 
 namespace Eugenix
 {
+	struct BenchmarkConfig
+	{
+		std::string name;
+		uint32_t frames{ 600 };
+		uint32_t warmupFrames{ 60 };
+		float deltaTime{ 1.0f / 60.0f };
+		std::filesystem::path output;
+	};
+
 	class SandboxApp
 	{
 	public:
 		SandboxApp(int width = DEFAULT_WIDTH, int height = DEFAULT_HEIGHT);
 
+		// Call before Run(). Runs without a visible window (EGL surfaceless on Linux, so Mesa llvmpipe works
+		// without a display) into an offscreen framebuffer, with a fixed delta time and a scripted camera path,
+		// then writes the frame-time percentiles of the measured frames to config.output as JSON.
+		void SetBenchmark(const BenchmarkConfig& config) { _benchmark = config; }
+
 		int Run();
 
 	protected:
@@ -37,6 +55,9 @@ namespace Eugenix
 
 		GLFWwindow* WindowHandle() const { return _window; }
 
+		// Timestamps of the passes wrapped in EUGENIX_GL_PROFILE_SCOPE, a few frames behind
+		Render::OpenGL::GpuProfiler& gpuProfiler() { return _gpuProfiler; }
+
 		bool* getKeys() { return _keys; };
 		bool* getMouseButtons() { return _buttons; };
 
@@ -57,7 +78,22 @@ namespace Eugenix
 	private:
 		bool initRuntime();
 
+		// Percentile overlay, toggled with F8
+		void drawFrameStats();
+
+		bool createOffscreenTarget();
+		void destroyOffscreenTarget();
+		void applyCameraScript(uint32_t frame);
+		bool writeBenchmarkReport() const;
+
 		Render::Caps _renderCaps{};
+		Render::OpenGL::GpuProfiler _gpuProfiler;
+		bool _showFrameStats{ false };
+
+		std::optional<BenchmarkConfig> _benchmark;
+		GLuint _offscreenFramebuffer{};
+		GLuint _offscreenColor{};
+		GLuint _offscreenDepth{};
 
 		GLFWwindow* _window{ nullptr };
 		int _width{};
@@ -7,6 +7,7 @@
 #include <assimp/Importer.hpp>
 
 #include "Engine/Core/Log.h"
+#include "Engine/Core/Profiler.h"
 
 namespace
 {
@@ -23,6 +24,8 @@ namespace Eugenix::Assets
 	public:
 		const aiScene* Load(const std::filesystem::path& path)
 		{
+			EUGENIX_PROFILE_SCOPE("AssimpModelLoader::Load");
+
 			auto scene = _importer.ReadFile(path.string(), ImportFlags);
 			if (!scene)
 			{
@@ -30,7 +33,7 @@ namespace Eugenix::Assets
 				return nullptr;
 			}
 
-			return _importer.ReadFile(path.string(), ImportFlags);
+			return scene;
 		}
 	private:
 		Assimp::Importer _importer;
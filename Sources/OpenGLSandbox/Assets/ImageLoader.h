@@ -1,11 +1,17 @@
 #pragma once
 
+#include <future>
+#include <memory>
+#include <span>
 #include <string_view>
 
 #include <stb_image.h>
 
 #include "Image.h"
 #include "Core/Log.h"
+#include "Engine/Core/Profiler.h"
+#include "Engine/IO/AsyncReader.h"
+#include "Engine/IO/IO.h"
 
 namespace Eugenix::Assets
 {
@@ -14,17 +20,58 @@ namespace Eugenix::Assets
 	public:
 		ImageData Load(std::string_view name)
 		{
-			ImageData data{};
+			EUGENIX_PROFILE_SCOPE("ImageLoader::Load");
 
 			//stbi_set_flip_vertically_on_load(1);
 
-			uint8_t* raw = stbi_load(name.data(), &data.width, &data.height, &data.channels, 0);
-			if (!raw)
+			// Decode straight from the mapping instead of letting stb buffer the file through stdio
+			const auto file = IO::File::Map(name, IO::AccessHint::Sequential);
+			if (!file.IsOpen())
 			{
 				LogError("Failed to load image at path {}", name);
 				return {};
 			}
 
+			ImageData data = Decode(file.Bytes());
+			if (!data.pixels)
+			{
+				LogError("Failed to load image at path {}", name);
+			}
+			return data;
+		}
+
+		// Read + decode on the reader's workers; only the GL upload has to stay on the main thread
+		std::future<ImageData> LoadAsync(IO::AsyncReader& reader, std::string_view name)
+		{
+			auto promise = std::make_shared<std::promise<ImageData>>();
+			auto future = promise->get_future();
+
+			reader.Read(std::filesystem::path{ name }, [promise](const IO::ReadCompletion& completion)
+				{
+					ImageData data = completion.ok ? Decode(completion.data) : ImageData{};
+					if (!data.pixels)
+					{
+						LogError("Failed to load image at path {}", completion.path.string());
+					}
+					promise->set_value(std::move(data));
+				});
+
+			return future;
+		}
+
+		static ImageData Decode(std::span<const std::byte> bytes)
+		{
+			EUGENIX_PROFILE_SCOPE("ImageLoader::Decode");
+
+			ImageData data{};
+
+			uint8_t* raw = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(bytes.data()), static_cast<int>(bytes.size()),
+				&data.width, &data.height, &data.channels, 0);
+			if (!raw)
+			{
+				return {};
+			}
+
 			data.pixels.reset(raw);
 			return data;
 		}
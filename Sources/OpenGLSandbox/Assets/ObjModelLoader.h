@@ -1,5 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
+#include "Engine/Core/Jobs.h"
+#include "Engine/Core/Memory.h"
+#include "Engine/Core/Profiler.h"
+#include "Engine/IO/AsyncReader.h"
+#include "Engine/IO/IO.h"
+#include "Engine/IO/MemoryStream.h"
+#include "Engine/Scene/Lod.h"
+
+#include "Assets/ImageLoader.h"
 #include "Render/Model.h"
 
 namespace Eugenix::Assets
@@ -12,71 +24,64 @@ namespace Eugenix::Assets
 	public:
 		Render::Model Load(const std::filesystem::path& modelPath, const std::filesystem::path& materialDir = {}, bool flipV = true)
 		{
+			EUGENIX_PROFILE_SCOPE("ObjModelLoader::Load");
+
 			Render::Model model;
 
-			tinyobj::ObjReaderConfig readerConfig;
-			readerConfig.mtl_search_path = materialDir.string();
-			readerConfig.triangulate = true;
-			readerConfig.vertex_color = false;
+			tinyobj::attrib_t attrib;
+			std::vector<tinyobj::shape_t> shapes;
+			std::vector<tinyobj::material_t> materials;
+			std::string warning, error;
+
+			// Parse straight out of the mapped file, no intermediate std::ifstream buffering/copy
+			const auto objFile = IO::File::Map(modelPath, IO::AccessHint::Sequential);
+			IO::MemoryStream objStream{ objFile.Bytes() };
+
+			std::string mtlSearchPath = materialDir.empty() ? modelPath.parent_path().string() : materialDir.string();
+			if (!mtlSearchPath.empty())
+				mtlSearchPath += '/';
+			tinyobj::MaterialFileReader materialReader{ mtlSearchPath };
 
-			tinyobj::ObjReader reader;
-			if (!reader.ParseFromFile(modelPath.string(), readerConfig))
+			if (!objFile.IsOpen() || !tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, &objStream, &materialReader,
+				/*triangulate*/true, /*default_vcols_fallback*/false))
 			{
-				if (!reader.Error().empty())
-					LogError("TinyObjReader error: {}", reader.Error());
+				if (!error.empty())
+					LogError("TinyObjReader error: {}", error);
 			}
-			if (!reader.Warning().empty())
-				LogWarn("TinyObjReader warning: {}", reader.Warning());
-
-			const auto& attrib = reader.GetAttrib();
-			const auto& shapes = reader.GetShapes();
-			const auto& materials = reader.GetMaterials();
+			if (!warning.empty())
+				LogWarn("TinyObjReader warning: {}", warning);
 
 			const bool isFindMaterials = !materials.empty();
 
+			struct PendingTextures
+			{
+				std::future<ImageData> diffuse;
+				std::future<ImageData> normals;
+				std::future<ImageData> specular;
+			};
+
+			Assets::ImageLoader imageLoader{};
+			IO::AsyncReader& reader = IO::SharedReader();
+			std::vector<PendingTextures> pending(materials.size());
+
+			// Kick off every texture read first, disk I/O and decoding overlap with building the meshes below
 			if (isFindMaterials)
 			{
-				Assets::ImageLoader imageLoader{};
+				const std::filesystem::path base =
+					materialDir.empty() ? modelPath.parent_path() : materialDir;
 
-				for (const auto& m : materials)
+				for (size_t i = 0; i < materials.size(); ++i)
 				{
-					Eugenix::Render::Material out{};
-
-					std::filesystem::path base =
-						materialDir.empty() ? modelPath.parent_path() : materialDir;
+					const auto& m = materials[i];
 
 					if (!m.diffuse_texname.empty())
-					{
-						const std::filesystem::path diffuseTexPath = base / m.diffuse_texname;
-						const auto image = imageLoader.Load(diffuseTexPath.string());
-
-						out.diffuseTex = std::make_shared<Render::OpenGL::Texture2D>();
-						out.diffuseTex->Create();
-						out.diffuseTex->Upload(image);
-					}
-
+						pending[i].diffuse = imageLoader.LoadAsync(reader, (base / m.diffuse_texname).string());
 					if (!m.normal_texname.empty())
-					{
-						const std::filesystem::path normalTexPath = base / m.normal_texname;
-						const auto image = imageLoader.Load(normalTexPath.string());
-
-						out.normalsTex = std::make_shared<Render::OpenGL::Texture2D>();
-						out.normalsTex->Create();
-						out.normalsTex->Upload(image, {.colorSpace = Render::TextureColorSpace::Linear});
-					}
-
+						pending[i].normals = imageLoader.LoadAsync(reader, (base / m.normal_texname).string());
 					if (!m.specular_texname.empty())
-					{
-						const std::filesystem::path specularTexPath = base / m.specular_texname;
-						const auto image = imageLoader.Load(specularTexPath.string());
-
-						out.specularTex = std::make_shared<Eugenix::Render::OpenGL::Texture2D>();
-						out.specularTex->Create();
-						out.specularTex->Upload(image, { .colorSpace = Render::TextureColorSpace::Linear });
-					}
-
-					model.AddMaterial(out);
+						pending[i].specular = imageLoader.LoadAsync(reader, (base / m.specular_texname).string());
 				}
+
 			}
 
 			struct Key
@@ -98,103 +103,174 @@ namespace Eugenix::Assets
 				}
 			};
 
+			// Per-shape dedup tables are thrown away once the mesh is built, keep them in one arena
+			Memory::LinearArena scratch{ 4 * 1024 * 1024 };
+
 			for (const auto& shape : shapes)
 			{
+				scratch.Reset();
+
 				struct Bucket
 				{
-					std::vector<TVertex> verts;
-					std::vector<uint32_t> idx;
-					std::unordered_map<Key, uint32_t, KeyHash> remap;
+					using allocator_type = Memory::Allocator;
+
+					explicit Bucket(const allocator_type& allocator)
+						: verts(allocator), idx(allocator), remap(allocator)
+					{
+					}
+
+					Memory::Vector<TVertex> verts;
+					Memory::Vector<uint32_t> idx;
+					Memory::UnorderedMap<Key, uint32_t, KeyHash> remap;
 				};
-				std::unordered_map<int, Bucket> buckets;
+				Memory::UnorderedMap<int, Bucket> buckets{ &scratch };
 
 				size_t indexOffset = 0;
 				const auto& fvList = shape.mesh.num_face_vertices;
 				const auto& matIds = shape.mesh.material_ids;
 
-				for (size_t f = 0; f < fvList.size(); ++f)
 				{
-					int fv = fvList[f];
-					int matId = (f < matIds.size()) ? matIds[f] : -1;
-
-					auto& B = buckets[matId];
+					EUGENIX_PROFILE_COUNTERS_SCOPE("ObjModelLoader::Dedup");
 
-					for (int v = 0; v < fv; ++v)
+					for (size_t f = 0; f < fvList.size(); ++f)
 					{
-						const tinyobj::index_t idx = shape.mesh.indices[indexOffset + v];
-						const Key key{ idx.vertex_index, idx.texcoord_index, idx.normal_index };
+						int fv = fvList[f];
+						int matId = (f < matIds.size()) ? matIds[f] : -1;
 
-						auto it = B.remap.find(key);
-						uint32_t dstIndex;
-						if (it == B.remap.end())
-						{
-							TVertex vert{};
-
-							if (idx.vertex_index >= 0)
-							{
-								const int vi = idx.vertex_index * 3;
-								vert.pos = glm::vec3(
-									attrib.vertices[vi + 0],
-									attrib.vertices[vi + 1],
-									attrib.vertices[vi + 2]);
-							}
+						auto& B = buckets[matId];
 
-							if (idx.normal_index >= 0)
-							{
-								const int ni = idx.normal_index * 3;
-								vert.normal = glm::vec3(
-									attrib.normals[ni + 0],
-									attrib.normals[ni + 1],
-									attrib.normals[ni + 2]);
-							}
-							else
-							{
-								vert.normal = glm::vec3(0.0f, 0.0f, 1.0f);
-							}
+						for (int v = 0; v < fv; ++v)
+						{
+							const tinyobj::index_t idx = shape.mesh.indices[indexOffset + v];
+							const Key key{ idx.vertex_index, idx.texcoord_index, idx.normal_index };
 
-							if (idx.texcoord_index >= 0)
+							auto it = B.remap.find(key);
+							uint32_t dstIndex;
+							if (it == B.remap.end())
 							{
-								const int ti = idx.texcoord_index * 2;
-								float u = attrib.texcoords[ti + 0];
-								float v_ = attrib.texcoords[ti + 1];
-								if (flipV) v_ = 1.0f - v_;
-								vert.uv = glm::vec2(u, v_);
+								TVertex vert{};
+
+								if (idx.vertex_index >= 0)
+								{
+									const int vi = idx.vertex_index * 3;
+									vert.pos = glm::vec3(
+										attrib.vertices[vi + 0],
+										attrib.vertices[vi + 1],
+										attrib.vertices[vi + 2]);
+								}
+
+								if (idx.normal_index >= 0)
+								{
+									const int ni = idx.normal_index * 3;
+									vert.normal = glm::vec3(
+										attrib.normals[ni + 0],
+										attrib.normals[ni + 1],
+										attrib.normals[ni + 2]);
+								}
+								else
+								{
+									vert.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+								}
+
+								if (idx.texcoord_index >= 0)
+								{
+									const int ti = idx.texcoord_index * 2;
+									float u = attrib.texcoords[ti + 0];
+									float v_ = attrib.texcoords[ti + 1];
+									if (flipV) v_ = 1.0f - v_;
+									vert.uv = glm::vec2(u, v_);
+								}
+								else
+								{
+									vert.uv = glm::vec2(0.0f);
+								}
+
+								dstIndex = static_cast<uint32_t>(B.verts.size());
+								B.verts.push_back(vert);
+								B.remap.emplace(key, dstIndex);
 							}
 							else
 							{
-								vert.uv = glm::vec2(0.0f);
+								dstIndex = it->second;
 							}
 
-							dstIndex = static_cast<uint32_t>(B.verts.size());
-							B.verts.push_back(vert);
-							B.remap.emplace(key, dstIndex);
-						}
-						else
-						{
-							dstIndex = it->second;
+							B.idx.push_back(dstIndex);
 						}
 
-						B.idx.push_back(dstIndex);
+						indexOffset += fv;
 					}
-
-					indexOffset += fv;
 				}
 
-				for (auto& [matId, B] : buckets)
+				std::vector<std::pair<int, const Bucket*>> parts;
+				for (const auto& [matId, B] : buckets)
 				{
-					if (B.idx.empty()) continue;
+					if (!B.idx.empty())
+						parts.emplace_back(matId, &B);
+				}
+
+				// LOD chains of the parts simplify on the job workers, the GL uploads stay on this thread
+				std::vector<Scene::LodChain> lods(parts.size());
+				Jobs::ParallelFor(0, static_cast<uint32_t>(parts.size()), 1, [&parts, &lods](uint32_t first, uint32_t last)
+					{
+						for (uint32_t i = first; i < last; ++i)
+						{
+							const Bucket& B = *parts[i].second;
 
+							std::vector<glm::vec3> positions(B.verts.size());
+							std::transform(B.verts.begin(), B.verts.end(), positions.begin(), [](const TVertex& v) { return v.pos; });
+
+							lods[i] = Scene::BuildLods(positions, std::span<const uint32_t>{ B.idx.data(), B.idx.size() });
+						}
+					});
+
+				for (size_t i = 0; i < parts.size(); ++i)
+				{
 					Render::ModelPart part;
-					part.materialIndex = matId;
+					part.materialIndex = parts[i].first;
 
-					std::span<const TVertex> vspan{ B.verts.data(), B.verts.size() };
-					std::span<const uint32_t> ispan{ B.idx.data(), B.idx.size() };
-					part.mesh.Build(vspan, ispan);
+					std::span<const TVertex> vspan{ parts[i].second->verts.data(), parts[i].second->verts.size() };
+					part.mesh.Build(vspan, std::span<const uint32_t>{ lods[i].indices });
+					part.mesh.SetLods(lods[i].levels);
 
 					model.AddPart(part);
 				}
 			}
 
+			// GL uploads stay on the calling thread, by now most textures are already decoded
+			for (auto& p : pending)
+			{
+				Eugenix::Render::Material out{};
+
+				if (p.diffuse.valid())
+				{
+					const auto image = p.diffuse.get();
+
+					out.diffuseTex = std::make_shared<Render::OpenGL::Texture2D>();
+					out.diffuseTex->Create();
+					out.diffuseTex->Upload(image);
+				}
+
+				if (p.normals.valid())
+				{
+					const auto image = p.normals.get();
+
+					out.normalsTex = std::make_shared<Render::OpenGL::Texture2D>();
+					out.normalsTex->Create();
+					out.normalsTex->Upload(image, {.colorSpace = Render::TextureColorSpace::Linear});
+				}
+
+				if (p.specular.valid())
+				{
+					const auto image = p.specular.get();
+
+					out.specularTex = std::make_shared<Eugenix::Render::OpenGL::Texture2D>();
+					out.specularTex->Create();
+					out.specularTex->Upload(image, { .colorSpace = Render::TextureColorSpace::Linear });
+				}
+
+				model.AddMaterial(out);
+			}
+
 			return model;
 		}
 	};
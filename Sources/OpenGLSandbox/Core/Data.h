@@ -35,8 +35,9 @@ namespace Eugenix::Core
 		return{ span.data(), span.size_bytes() };
 	}
 
-	template <typename type>
-	static Data MakeData(const std::vector<type>& vector)
+	// Any allocator, so std::pmr vectors from the frame arena upload the same way
+	template <typename type, typename Alloc>
+	static Data MakeData(const std::vector<type, Alloc>& vector)
 	{
 		return{ vector.data(), vector.size() * sizeof(type) };
 	}
@@ -12,6 +12,8 @@
 #include "Render/OpenGL/ShaderProgram.h"
 #include "Render/OpenGL/VertexArray.h"
 
+#include "Engine/Scene/Bvh.h"
+
 namespace Game
 {
 	enum class CardAnim { None, TurningToFront, TurningToBack };
@@ -50,8 +52,6 @@ namespace Game
 	};
 }
 
-btCollisionWorld* world;
-
 Game::Card cards[4][13]{ };
 //static constexpr int Rows = 4;
 //static constexpr int Cols = 13;
@@ -132,11 +132,9 @@ namespace Eugenix
 				_cardColors.emplace_back(glm::linearRand(glm::vec3(0.0f), glm::vec3(1.0f)));
 			}
 
-			const auto bt_world_configuration = new btDefaultCollisionConfiguration;
-
-			world = new btCollisionWorld(new btCollisionDispatcher(bt_world_configuration), new btDbvtBroadphase(), bt_world_configuration);
+			const glm::vec3 card_extent{ 65.0f, 97.0f, 0.2f };
 
-			auto card_shape = new btBoxShape(btVector3(65.0f, 97.0f, 0.2f));
+			std::vector<Scene::Aabb> card_bounds;
 
 			auto card_pairing = false;
 			auto card_type = 0;
@@ -148,18 +146,9 @@ namespace Eugenix
 					const auto x = tile_width_size * col - 6.0f * tile_width_size + static_cast<float>(width()) / 2.0f;
 					const auto y = tile_height_size * row - 1.5f * tile_height_size + static_cast<float>(height()) / 2.0f;
 
-					btTransform transform;
-					transform.setIdentity();
-					transform.setOrigin(btVector3(x, y, 0.0f));
-
-					auto card_object = new btCollisionObject();
-					card_object->setCollisionShape(card_shape);
-					card_object->setWorldTransform(transform);
-
-					card_object->setUserIndex(row);
-					card_object->setUserIndex2(col);
-
-					world->addCollisionObject(card_object);
+					// Picked by index, row * card_columns_count + col
+					const glm::vec3 center{ x, y, 0.0f };
+					card_bounds.push_back({ center - card_extent, center + card_extent });
 
 					cards[row][col].type = card_type;
 
@@ -175,6 +164,8 @@ namespace Eugenix
 				}
 			}
 
+			_cardBvh.Build(card_bounds);
+
 			for (auto row = 0; row < 4; row++)
 			{
 				for (auto col = 0; col < card_columns_count; col++)
@@ -364,22 +355,12 @@ namespace Eugenix
 		{
 			if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
 			{
-				const glm::vec4 viewport{ 0.0f, 0.0f, (float)width(), (float)height()};
-
-				auto start = glm::unProject(glm::vec3(cursor_x, height() - cursor_y, -1.0f), _cameraData.view, _cameraData.proj, viewport);
-				auto end = glm::unProject(glm::vec3(cursor_x, height() - cursor_y, 1.0f), _cameraData.view, _cameraData.proj, viewport);
-				end = start + glm::normalize(end - start) * 1000.0f;
-
-				const btVector3 from(start.x, start.y, start.z);
-				const btVector3   to(end.x, end.y, end.z);
+				const auto ray = Scene::Ray::FromScreen({ cursor_x, cursor_y }, { (float)width(), (float)height() }, _cameraData.view, _cameraData.proj);
 
-				btCollisionWorld::ClosestRayResultCallback result(from, to);
-				world->rayTest(from, to, result);
-
-				if (result.hasHit())
+				if (const auto hit = _cardBvh.Raycast(ray))
 				{
-					const auto row = result.m_collisionObject->getUserIndex();
-					const auto col = result.m_collisionObject->getUserIndex2();
+					const auto row = static_cast<int>(hit.primitive) / card_columns_count;
+					const auto col = static_cast<int>(hit.primitive) % card_columns_count;
 
 					auto& card = cards[row][col];
 
@@ -433,6 +414,8 @@ namespace Eugenix
 
 		Eugenix::Render::Data::Camera _cameraData;
 
+		Scene::Bvh _cardBvh;
+
 		std::vector<glm::vec3> card_vertices;
 		std::vector<uint32_t>  card_elements;
 
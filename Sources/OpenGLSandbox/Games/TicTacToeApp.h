@@ -2,12 +2,12 @@
 
 #include <cstdint>
 
-#include <btBulletCollisionCommon.h>
-
 #include "Shared.h"
 
 // Engine headers
+#include "Engine/Core/Memory.h"
 #include "Engine/IO/IO.h"
+#include "Engine/Scene/Bvh.h"
 
 // Sandbox headers
 #include "App/SandboxApp.h"
@@ -72,22 +72,22 @@ namespace core::data
     };
 }
 
-class PhysicsDebugRenderer final : public btIDebugDraw
+// Wireframe boxes of a Scene::Bvh, the tiles and the tree nodes above them
+class BvhDebugRenderer final
 {
 public:
     struct Settings
     {
         size_t initialCapacityBytes = 256 * 1024;
-        int debugMode = btIDebugDraw::DBG_DrawWireframe | btIDebugDraw::DBG_DrawAabb;
+        bool drawNodes = true;
     };
 
-    PhysicsDebugRenderer() = default;
-    explicit PhysicsDebugRenderer(const Settings& s) { Init(s); }
+    BvhDebugRenderer() = default;
+    explicit BvhDebugRenderer(const Settings& s) { Init(s); }
 
     void Init(const Settings& settings)
     {
         _settings = settings;
-        _debugMode = settings.debugMode;
 
         _capacityBytes = std::max<size_t>(1, settings.initialCapacityBytes);
 
@@ -105,69 +105,60 @@ public:
     {
         _vao.Destroy();
         _vbo.Destroy();
-        _vertices.clear();
-        _vertices.shrink_to_fit();
         _capacityBytes = 0;
     }
 
-    void Attach(btCollisionWorld& world)
+    void Render(const Eugenix::Scene::Bvh& bvh)
     {
-        _world = &world;
-        world.setDebugDrawer(this);
-        setDebugMode(_debugMode);
-    }
+        // Line vertices only live for this frame, collect them in the frame arena
+        Eugenix::Memory::Vector<float> vertices{ Eugenix::Memory::FrameResource() };
+        vertices.reserve(_capacityBytes / sizeof(float));
 
-    void Render()
-    {
-        clearLines();
+        for (const auto& box : bvh.PrimitiveBounds())
+            addBox(vertices, box.min, box.max);
 
-        _world->debugDrawWorld();
+        if (_settings.drawNodes)
+        {
+            for (const auto& node : bvh.Nodes())
+                addBox(vertices, node.min, node.max);
+        }
 
-        if (_vertices.empty())
+        if (vertices.empty())
             return;
 
-        const size_t neededBytes = _vertices.size() * sizeof(float);
+        const size_t neededBytes = vertices.size() * sizeof(float);
         ensureCapacity(neededBytes);
 
-        _vbo.Update(Eugenix::Core::MakeData(_vertices));
+        _vbo.Update(Eugenix::Core::MakeData(vertices));
         _vao.Bind();
 
         Eugenix::Render::OpenGL::Commands::DrawVertices(
             Eugenix::Render::PrimitiveType::Lines,
-            static_cast<uint32_t>(_vertices.size() / 3)
+            static_cast<uint32_t>(vertices.size() / 3)
         );
     }
 
-    //
-    // Bullet overrides
-    //
-
-    void drawLine(const btVector3& from, const btVector3& to, const btVector3& color) override
+private:
+    static void addBox(Eugenix::Memory::Vector<float>& vertices, const glm::vec3& min, const glm::vec3& max)
     {
-        _vertices.push_back(from.x());
-        _vertices.push_back(from.y());
-        _vertices.push_back(from.z());
+        auto corner = [&](int i) { return glm::vec3(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z); };
 
-        _vertices.push_back(to.x());
-        _vertices.push_back(to.y());
-        _vertices.push_back(to.z());
-    }
+        // Corners differing in one bit share an edge
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int bit : { 1, 2, 4 })
+            {
+                if (i & bit)
+                    continue;
 
-    void clearLines() override
-    {
-        _vertices.clear();
+                const glm::vec3 from = corner(i);
+                const glm::vec3 to = corner(i | bit);
+                const float line[] = { from.x, from.y, from.z, to.x, to.y, to.z };
+                vertices.insert(vertices.end(), std::begin(line), std::end(line));
+            }
+        }
     }
 
-    void drawContactPoint(const btVector3& PointOnB, const btVector3& normalOnB, btScalar distance, int lifeTime, const btVector3& color) override {}
-    void reportErrorWarning(const char* warningString) override {}
-    void draw3dText(const btVector3& location, const char* textString) override {}
-
-    void setDebugMode(int debugMode) override { _debugMode = debugMode; }
-    int getDebugMode() const override { return _debugMode; }
-
-//private:
-
-private:
     void ensureCapacity(size_t neededBytes)
     {
         if (neededBytes == 0)
@@ -194,12 +185,7 @@ private:
         _vao.Attribute(position_attr);
     }
 
-    btCollisionWorld* _world{ nullptr };
-
     Settings _settings{};
-    int _debugMode = btIDebugDraw::DBG_DrawWireframe;
-
-    std::vector<float> _vertices;
 
     Eugenix::Render::OpenGL::Buffer _vbo;
     Eugenix::Render::OpenGL::VertexArray _vao;
@@ -389,25 +375,16 @@ namespace Eugenix
             //glBindBufferBase(GL_UNIFORM_BUFFER, (GLint)UBO::Location::Material, _materialUbo.NativeHandle());
             _materialUbo.Bind(Render::BufferTarget::UBO, Render::BufferBinding::Material);
 
-            auto bt_default_configuration = new btDefaultCollisionConfiguration();
-            _world = std::make_unique<btCollisionWorld>(
-                new btCollisionDispatcher(bt_default_configuration), 
-                new btDbvtBroadphase(), 
-                bt_default_configuration);
-
-            _physDebugRenderer = std::make_unique<PhysicsDebugRenderer>(
-                PhysicsDebugRenderer::Settings{
+            _debugRenderer = std::make_unique<BvhDebugRenderer>(
+                BvhDebugRenderer::Settings{
                     .initialCapacityBytes = 256 * 1024,
-                    .debugMode = btIDebugDraw::DBG_DrawWireframe | btIDebugDraw::DBG_DrawAabb
+                    .drawNodes = true
                 }
             );
-            _physDebugRenderer->setDebugMode(
-                btIDebugDraw::DBG_DrawWireframe |
-                btIDebugDraw::DBG_DrawAabb
-            );
-            _physDebugRenderer->Attach(*_world);
 
-            _tileShape = std::make_unique<btBoxShape>(btVector3(0.5f, 0.5f, 0.105f));
+            // One pickable box per cell, in board order
+            std::vector<Scene::Aabb> cells;
+            constexpr glm::vec3 cell_extent{ 0.5f, 0.5f, 0.105f };
 
             for (auto row = 0; row < _state.board.Rows; row++)
             {
@@ -422,20 +399,13 @@ namespace Eugenix
 
                     printf("create shape {%f} {%f}\n", x, y);
 
-                    btTransform transform;
-                    transform.setIdentity();
-                    transform.setOrigin(btVector3(x, y, 0.0f));
-
-                    auto bt_collision_object = new btCollisionObject();
-                    bt_collision_object->setCollisionShape(_tileShape.get());
-                    bt_collision_object->setWorldTransform(transform);
-                    bt_collision_object->setUserIndex(row);
-                    bt_collision_object->setUserIndex2(col);
-
-                    _world->addCollisionObject(bt_collision_object);
+                    const glm::vec3 center{ x, y, 0.0f };
+                    cells.push_back({ center - cell_extent, center + cell_extent });
                 }
             }
 
+            _cells.Build(cells);
+
             Render::OpenGL::Commands::Clear(0.42745098039215684f, 0.8823529411764706f, 0.8235294117647058f);
 
             return true;
@@ -467,23 +437,15 @@ namespace Eugenix
         {
             if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && !_state.isEnd)
             {
-                const glm::vec4 viewport{ 0.0f, 0.0f, (float)width(), (float)height() };
-
-                auto start = glm::unProject(glm::vec3(cursor_x, height() - cursor_y, -1.0f), _cameraData.view, _cameraData.proj, viewport);
-                auto end = glm::unProject(glm::vec3(cursor_x, height() - cursor_y, 1.0f), _cameraData.view, _cameraData.proj, viewport);
-                end = start + glm::normalize(end - start) * 1000.0f;
-
-                const btVector3 from(start.x, start.y, start.z);
-                const btVector3   to(end.x, end.y, end.z);
+                const auto ray = Scene::Ray::FromScreen({ cursor_x, cursor_y }, { (float)width(), (float)height() }, _cameraData.view, _cameraData.proj);
 
-                btCollisionWorld::ClosestRayResultCallback result(from, to);
-                _world->rayTest(from, to, result);
-                if (result.hasHit())
+                // Cells were added row by row
+                if (const auto hit = _cells.Raycast(ray))
                 {
                     core::data::GridPosition pos
                     {
-                        result.m_collisionObject->getUserIndex(),
-                        result.m_collisionObject->getUserIndex2()
+                        static_cast<int32_t>(hit.primitive) / _state.board.Cols,
+                        static_cast<int32_t>(hit.primitive) % _state.board.Cols
                     };
 
                     auto& cell = _state.board.At(pos);
@@ -512,7 +474,7 @@ namespace Eugenix
             {
                 _materialUbo.Update(Core::MakeData(&grid_color));
 
-                _physDebugRenderer->Render();
+                _debugRenderer->Render(_cells);
             }
             else
             {
@@ -592,10 +554,9 @@ namespace Eugenix
         glm::vec3 o_color{ 0.9686274509803922f, 0.35294117647058826f, 0.35294117647058826f };
         glm::vec3 grid_color{ 1.0f, 0.6627450980392157f, 0.3333333333333333f };
 
-        std::unique_ptr<btCollisionWorld> _world;
-        std::unique_ptr<btCollisionShape> _tileShape;
+        Scene::Bvh _cells;
 
-        std::unique_ptr<PhysicsDebugRenderer> _physDebugRenderer;
+        std::unique_ptr<BvhDebugRenderer> _debugRenderer;
 
         float cursor_x = 0.0f;
         float cursor_y = 0.0f;
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <concepts>
 #include <cstddef>
 #include <span>
+#include <vector>
+
+#include "Engine/Scene/Lod.h"
 
 #include "Render/Types.h"
 
@@ -21,6 +25,20 @@ namespace Eugenix::Render
 			_vbo.Create();
 			_vbo.Storage(Eugenix::Core::MakeData(verts));
 
+			// 2D formats (sprites) keep an empty box
+			if constexpr (requires(const TVertex& v) { { v.pos } -> std::convertible_to<glm::vec3>; })
+			{
+				if (!verts.empty())
+				{
+					_bounds = { verts[0].pos, verts[0].pos };
+					for (const TVertex& v : verts)
+					{
+						_bounds.min = glm::min(_bounds.min, v.pos);
+						_bounds.max = glm::max(_bounds.max, v.pos);
+					}
+				}
+			}
+
 			_vao.Create();
 			_vao.AttachVertices(0, _vbo, TVertex::stride);
 
@@ -43,14 +61,40 @@ namespace Eugenix::Render
 			}
 		}
 
+		// Object space box around the vertices
+		const Scene::Aabb& Bounds() const
+		{
+			return _bounds;
+		}
+
+		// Index ranges of a Scene::LodChain built into the index buffer, level 0 first
+		void SetLods(std::span<const Scene::LodLevel> lods)
+		{
+			_lods.assign(lods.begin(), lods.end());
+		}
+
+		std::span<const Scene::LodLevel> Lods() const
+		{
+			return _lods;
+		}
+
+		uint32_t TriangleCount(uint32_t lod = 0) const
+		{
+			return (lod < _lods.size() ? _lods[lod].indexCount : _count) / 3;
+		}
+
 		void Bind()
 		{ 
 			_vao.Bind(); 
 		}
 
-		void Draw() const 
+		void Draw(uint32_t lod = 0) const 
 		{
-			if (_indexed) 
+			if (_indexed && lod < _lods.size())
+			{
+				Render::OpenGL::Commands::DrawIndexed(Render::PrimitiveType::Triangles, _lods[lod].indexCount, Render::DataType::UInt, _lods[lod].firstIndex);
+			}
+			else if (_indexed) 
 			{
 				Render::OpenGL::Commands::DrawIndexed(Render::PrimitiveType::Triangles, _count, Render::DataType::UInt);
 			}
@@ -71,6 +115,8 @@ namespace Eugenix::Render
 		Render::OpenGL::VertexArray _vao{};
 		Render::OpenGL::Buffer _vbo{};
 		Render::OpenGL::Buffer _ebo{};
+		Scene::Aabb _bounds{};
+		std::vector<Scene::LodLevel> _lods;
 		uint32_t _count = 0;
 		bool _indexed = false;
 	};
@@ -3,6 +3,8 @@
 #include "Render/Mesh.h"
 #include "Render/Material.h"
 
+#include "Engine/Scene/Occlusion.h"
+
 namespace Eugenix::Render
 {
 	struct ModelPart final
@@ -42,20 +44,67 @@ namespace Eugenix::Render
 		{
 			for (auto& part : _parts)
 			{
-				if (part.materialIndex >= 0 && part.materialIndex < (int)_materials.size())
-				{
-					auto& diffuse = _materials[part.materialIndex].diffuseTex;
-					auto& specular = _materials[part.materialIndex].specularTex;
+				renderPart(part);
+			}
+		}
+
+		// Draws only the parts whose box, moved by world, touches the frustum and, when given, is not
+		// hidden behind the rasterized occluders. With a LOD view each part is drawn at the coarsest
+		// level its screen-space error allows. Returns the number drawn.
+		uint32_t Render(const Scene::Frustum& frustum, const glm::mat4& world, const Scene::OcclusionCuller* occlusion = nullptr,
+			const Scene::LodView* lodView = nullptr)
+		{
+			_partLods.resize(_parts.size(), 0);
+			_partBounds.Clear();
+			for (const auto& part : _parts)
+			{
+				_partBounds.Add(Scene::TransformAabb(part.mesh.Bounds(), world));
+			}
+
+			_culler.Cull(frustum, _partBounds);
 
-					if (diffuse) 
-						diffuse->Bind(0); // TODO : use TextureLocation
-					if (specular) 
-						specular->Bind(1); // TODO : use TextureLocation
+			std::span<const uint32_t> visible = _culler.Visible();
+			if (occlusion)
+			{
+				_partVisible.clear();
+				occlusion->Cull(_partBounds, visible, _partVisible);
+				visible = _partVisible;
+			}
+
+			const float worldScale = Scene::MaxScale(world);
+			_drawnTriangles = 0;
+
+			for (uint32_t i : visible)
+			{
+				auto& part = _parts[i];
+				const auto lods = part.mesh.Lods();
+				if (lodView && !lods.empty())
+				{
+					_partLods[i] = Scene::SelectLod(lods, *lodView, Scene::TransformAabb(part.mesh.Bounds(), world), worldScale, _partLods[i]);
 				}
 
-				part.mesh.Bind();
-				part.mesh.Draw();
+				renderPart(part, _partLods[i]);
+				_drawnTriangles += part.mesh.TriangleCount(_partLods[i]);
 			}
+
+			return static_cast<uint32_t>(visible.size());
+		}
+
+		// Triangles of the LODs drawn on the last Render()
+		uint64_t DrawnTriangles() const
+		{
+			return _drawnTriangles;
+		}
+
+		// Parts inside the frustum on the last Render(), before the occlusion test
+		uint32_t FrustumVisibleCount() const
+		{
+			return _culler.VisibleCount();
+		}
+
+		uint32_t PartCount() const
+		{
+			return static_cast<uint32_t>(_parts.size());
 		}
 
 		void Destroy()
@@ -75,8 +124,31 @@ namespace Eugenix::Render
 		}
 
 	private:
+		void renderPart(Eugenix::Render::ModelPart& part, uint32_t lod = 0)
+		{
+			if (part.materialIndex >= 0 && part.materialIndex < (int)_materials.size())
+			{
+				auto& diffuse = _materials[part.materialIndex].diffuseTex;
+				auto& specular = _materials[part.materialIndex].specularTex;
+
+				if (diffuse) 
+					diffuse->Bind(0); // TODO : use TextureLocation
+				if (specular) 
+					specular->Bind(1); // TODO : use TextureLocation
+			}
+
+			part.mesh.Bind();
+			part.mesh.Draw(lod);
+		}
+
 		std::vector<Eugenix::Render::ModelPart> _parts;
 		std::vector<Eugenix::Render::Material> _materials;
+
+		Scene::AabbBounds _partBounds;
+		Scene::FrustumCuller _culler;
+		std::vector<uint32_t> _partVisible;
+		std::vector<uint32_t> _partLods;	// Level drawn last time per part
+		uint64_t _drawnTriangles = 0;
 	};
 
 	inline Eugenix::Render::Model CreateModelFromMeshes(std::vector<Eugenix::Render::Mesh>&& meshes)
@@ -32,8 +32,9 @@ namespace Eugenix::Render::OpenGL::Commands
 		glDrawArrays(to_opengl_type(primitiveType), first, verticesCount);
 	}
 
-	inline void DrawIndexed(PrimitiveType primitiveType, uint32_t indicesCount, DataType indexType)
+	inline void DrawIndexed(PrimitiveType primitiveType, uint32_t indicesCount, DataType indexType, uint32_t firstIndex = 0)
 	{
-		glDrawElements(to_opengl_type(primitiveType), indicesCount, to_opengl_type(indexType), nullptr);
+		const size_t indexSize = indexType == DataType::UByte ? 1 : 4;
+		glDrawElements(to_opengl_type(primitiveType), indicesCount, to_opengl_type(indexType), reinterpret_cast<const void*>(firstIndex * indexSize));
 	}
 } // Eugenix::Render::Opengl
@@ -6,11 +6,18 @@
 #	include <glad/glad.h>
 #endif // EUGENIX_OPENGL_GLAD
 
+#if defined(EUGENIX_OPENGL_GLAD) && defined(EUGENIX_RUNTIME_GLFW)
+#	include <GLFW/glfw3.h>
+#endif
+
 namespace Eugenix::Render::OpenGL
 {
 	inline bool Init()
 	{
-#ifdef EUGENIX_OPENGL_GLAD
+#if defined(EUGENIX_OPENGL_GLAD) && defined(EUGENIX_RUNTIME_GLFW)
+		// Resolves through the context's own API, so EGL contexts (headless benchmarks) load too
+		return gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+#elif defined(EUGENIX_OPENGL_GLAD)
 		return gladLoadGL();
 #endif // EUGENIX_OPENGL_GLAD
 	}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "SandboxCompileConfig.h"
+
+#include "EugenixGL.h"
+
+#include "Engine/Core/Profiler.h"
+
+namespace Eugenix::Render::OpenGL
+{
+	// glQueryCounter timestamps around passes, converted to the CPU profiler timeline.
+	// Queries rotate through FramesLatency slots; a slot is read back FramesLatency frames after
+	// it was issued and only if the driver already has the results, so the CPU never waits on the GPU.
+	class GpuProfiler final
+	{
+	public:
+		static constexpr uint32_t FramesLatency = 3;
+		static constexpr uint32_t MaxZonesPerFrame = 64;
+
+		struct ZoneResult
+		{
+			const char* name;
+			int64_t start;	// Profiler::Now() timeline, ns
+			int64_t end;
+		};
+
+		void Create()
+		{
+			for (auto& slot : _slots)
+			{
+				glCreateQueries(GL_TIMESTAMP, MaxZonesPerFrame * 2, slot.queries.data());
+				slot.names.reserve(MaxZonesPerFrame);
+			}
+			_resolved.reserve(MaxZonesPerFrame);
+
+			static const uint32_t track = Profiler::CreateTrack("GPU OpenGL");
+			_track = track;
+
+			calibrate();
+		}
+
+		void Destroy()
+		{
+			for (auto& slot : _slots)
+			{
+				glDeleteQueries(MaxZonesPerFrame * 2, slot.queries.data());
+				slot.names.clear();
+			}
+		}
+
+		// Resolves the slot this frame reuses, call once per frame before any zone
+		void BeginFrame()
+		{
+			_frame = (_frame + 1) % FramesLatency;
+
+			auto& slot = _slots[_frame];
+			if (!slot.names.empty())
+				resolve(slot);
+
+			slot.names.clear();
+		}
+
+		// Returns the zone to pass to EndZone. Zones over MaxZonesPerFrame are dropped.
+		uint32_t BeginZone(const char* name)
+		{
+			auto& slot = _slots[_frame];
+			if (slot.names.size() == MaxZonesPerFrame)
+				return NoZone;
+
+			const auto zone = static_cast<uint32_t>(slot.names.size());
+			slot.names.push_back(name);
+
+			glQueryCounter(slot.queries[zone * 2], GL_TIMESTAMP);
+			return zone;
+		}
+
+		void EndZone(uint32_t zone)
+		{
+			if (zone == NoZone)
+				return;
+
+			glQueryCounter(_slots[_frame].queries[zone * 2 + 1], GL_TIMESTAMP);
+		}
+
+		// Zones of the most recently resolved frame
+		std::span<const ZoneResult> LastFrameZones() const { return _resolved; }
+
+		// From the first to the last timestamp of the most recently resolved frame
+		double LastFrameMilliseconds() const { return _lastFrameMilliseconds; }
+
+	private:
+		static constexpr uint32_t NoZone = UINT32_MAX;
+
+		// GL_TIMESTAMP drifts from the CPU clock slowly, re-read the pair once a second
+		static constexpr int64_t CalibrationInterval = 1'000'000'000;
+
+		struct FrameSlot
+		{
+			std::array<GLuint, MaxZonesPerFrame * 2> queries{};
+			std::vector<const char*> names;
+		};
+
+		void resolve(FrameSlot& slot)
+		{
+			// Queries complete in order, the last one being ready means the whole slot is
+			const GLuint last = slot.queries[slot.names.size() * 2 - 1];
+
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(last, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				return;
+
+			if (Profiler::Now() - _calibrationTime > CalibrationInterval)
+				calibrate();
+
+			_resolved.clear();
+
+			const bool capturing = Profiler::IsCapturing();
+			int64_t frameStart = INT64_MAX;
+			int64_t frameEnd = INT64_MIN;
+
+			for (size_t zone = 0; zone < slot.names.size(); ++zone)
+			{
+				GLuint64 start = 0, end = 0;
+				glGetQueryObjectui64v(slot.queries[zone * 2], GL_QUERY_RESULT, &start);
+				glGetQueryObjectui64v(slot.queries[zone * 2 + 1], GL_QUERY_RESULT, &end);
+
+				const ZoneResult result{ slot.names[zone], static_cast<int64_t>(start) + _offset, static_cast<int64_t>(end) + _offset };
+				_resolved.push_back(result);
+
+				frameStart = std::min(frameStart, result.start);
+				frameEnd = std::max(frameEnd, result.end);
+
+				if (capturing)
+					Profiler::RecordZone(_track, result.name, result.start, result.end);
+			}
+
+			_lastFrameMilliseconds = static_cast<double>(frameEnd - frameStart) / 1'000'000.0;
+		}
+
+		void calibrate()
+		{
+			// GL has no calibrated pair, read both clocks back to back; the GL query does not flush
+			GLint64 gpuTime = 0;
+			const int64_t before = Profiler::Now();
+			glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+			const int64_t after = Profiler::Now();
+
+			_calibrationTime = before + (after - before) / 2;
+			_offset = _calibrationTime - gpuTime;
+		}
+
+		std::array<FrameSlot, FramesLatency> _slots{};
+		uint32_t _frame{};
+
+		int64_t _offset{};
+		int64_t _calibrationTime{};
+
+		uint32_t _track{};
+		std::vector<ZoneResult> _resolved;
+		double _lastFrameMilliseconds{};
+	};
+
+	class GpuZone final
+	{
+	public:
+		GpuZone(GpuProfiler& profiler, const char* name)
+			: _profiler(profiler)
+			, _zone(profiler.BeginZone(name))
+		{
+		}
+
+		~GpuZone()
+		{
+			_profiler.EndZone(_zone);
+		}
+
+		GpuZone(const GpuZone&) = delete;
+		GpuZone& operator=(const GpuZone&) = delete;
+
+	private:
+		GpuProfiler& _profiler;
+		uint32_t _zone;
+	};
+} // namespace Eugenix::Render::OpenGL
+
+#if EUGENIX_PROFILING_ENABLED
+#	define EUGENIX_GL_PROFILE_SCOPE(profiler, name) ::Eugenix::Render::OpenGL::GpuZone EUGENIX_PROFILE_CONCAT(_eugenixGpuZone, __LINE__){ profiler, name }
+#else
+#	define EUGENIX_GL_PROFILE_SCOPE(profiler, name)
+#endif
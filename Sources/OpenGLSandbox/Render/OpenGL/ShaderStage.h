@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <vector>
 
 #include "SandboxCompileConfig.h"
@@ -69,6 +71,11 @@ namespace Eugenix::Render::OpenGL
 		}
 
 		void SpecializeSPIRV(const std::vector<char>& source, const char* entry = "main")
+		{
+			SpecializeSPIRV(std::as_bytes(std::span{ source }), entry);
+		}
+
+		void SpecializeSPIRV(std::span<const std::byte> source, const char* entry = "main")
 		{
 			if (source.size() % 4 != 0)
 				throw std::runtime_error("SPIR-V size must be multiple of 4 bytes");
@@ -7,6 +7,8 @@
 #include "Assets/Image.h"
 #include "Render/Types.h"
 
+#include "Engine/Core/Profiler.h"
+
 namespace
 {
 	inline std::pair<GLenum, GLenum> ChooseTextureFormat(int channels, bool srgb)
@@ -72,6 +74,8 @@ namespace Eugenix::Render::OpenGL
 
 		void Upload(const Assets::ImageData& img, const TextureDesc& desc = {})
 		{
+			EUGENIX_PROFILE_SCOPE("Texture2D::Upload");
+
 			// allocate
 			Storage(img.width, img.height, img.channels, desc);
 			// upload base level
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <array>
+#include <future>
 #include <span>
 #include <string_view>
 
 #include "Assets/ImageLoader.h"
+#include "Engine/Core/Profiler.h"
+#include "Engine/IO/AsyncReader.h"
 #include "Render/Mesh.h"
 #include "Render/Vertex.h"
 #include "Render/OpenGL/TextureCubemap.h"
@@ -18,6 +21,8 @@ namespace Eugenix::Scene
 	public:
 		void Create(const std::array<std::string_view, 6> imagePaths)
 		{
+			EUGENIX_PROFILE_SCOPE("Skybox::Create");
+
 			const std::array<Eugenix::Render::Vertex::Pos, 24> vertices
 			{ {
 				//Front
@@ -68,17 +73,21 @@ namespace Eugenix::Scene
 			pipeline.SetUniform("u_cubemap", 0);
 
 			Eugenix::Assets::ImageLoader loader{};
+			Eugenix::IO::AsyncReader& reader = Eugenix::IO::SharedReader();
 
-			const std::array<Eugenix::Assets::ImageData, 6> images =
+			// All six faces are in flight at once, each one is decoded as soon as its read completes
+			std::array<std::future<Eugenix::Assets::ImageData>, 6> pending;
+			for (size_t face = 0; face < imagePaths.size(); ++face)
 			{
-				loader.Load(imagePaths[0]),
-				loader.Load(imagePaths[1]),
-				loader.Load(imagePaths[2]),
-				loader.Load(imagePaths[3]),
-				loader.Load(imagePaths[4]),
-				loader.Load(imagePaths[5])
-			};
-			;
+				pending[face] = loader.LoadAsync(reader, imagePaths[face]);
+			}
+
+			std::array<Eugenix::Assets::ImageData, 6> images;
+			for (size_t face = 0; face < images.size(); ++face)
+			{
+				images[face] = pending[face].get();
+			}
+
 			cubemap.Create();
 			cubemap.Storage(images);
 			cubemap.Update(images);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Sandbox headers
+#include "TestUtils.h"
+
+#include "Engine/Core/Jobs.h"
+#include "Engine/Core/Log.h"
+
+namespace Eugenix
+{
+	// Scaling of the job system from 1 to N threads on two workloads:
+	// a compute bound ParallelFor and a flood of tiny jobs that measures scheduling overhead.
+	class JobsBenchApp final : public BenchApp
+	{
+	protected:
+		void run() override
+		{
+			const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+			_data.resize(ElementCount);
+
+			double baseParallelFor = 0.0;
+			double baseTinyJobs = 0.0;
+
+			LogInfo("JobsBench: threads | ParallelFor ms (speedup) | {} tiny jobs ms (speedup)", TinyJobCount);
+
+			for (uint32_t threads = 1; threads <= maxThreads; ++threads)
+			{
+				// One thread is the baseline without a scheduler, jobs then run inline
+				Jobs::Shutdown();
+				if (threads > 1)
+					Jobs::Initialize(threads - 1);
+
+				const double parallelFor = BestOf(Runs, [this] { runParallelFor(); });
+				const double tinyJobs = BestOf(Runs, [] { runTinyJobs(); });
+
+				if (threads == 1)
+				{
+					baseParallelFor = parallelFor;
+					baseTinyJobs = tinyJobs;
+				}
+
+				LogInfo("JobsBench: {:7} | {:8.2f} ({:4.2f}x) | {:8.2f} ({:4.2f}x)", threads,
+					parallelFor, baseParallelFor / parallelFor, tinyJobs, baseTinyJobs / tinyJobs);
+			}
+
+			// Back to the default configuration for the rest of the app
+			Jobs::Shutdown();
+			Jobs::Initialize();
+		}
+
+	private:
+		static constexpr uint32_t ElementCount = 4 * 1024 * 1024;
+		static constexpr uint32_t TinyJobCount = 100'000;
+		static constexpr int Runs = 5;
+
+		void runParallelFor()
+		{
+			Jobs::ParallelFor(0, ElementCount, 0, [this](uint32_t first, uint32_t last)
+				{
+					for (uint32_t i = first; i < last; ++i)
+					{
+						const float x = static_cast<float>(i) * 0.001f;
+						_data[i] = std::sqrt(x) * std::sin(x) + std::cos(x * 0.5f);
+					}
+				});
+		}
+
+		static void runTinyJobs()
+		{
+			std::atomic<uint32_t> sum{ 0 };
+			Jobs::Counter counter;
+
+			for (uint32_t i = 0; i < TinyJobCount; ++i)
+			{
+				Jobs::Run([&sum] { sum.fetch_add(1, std::memory_order_relaxed); }, &counter);
+			}
+			Jobs::Wait(counter);
+		}
+
+		std::vector<float> _data;
+	};
+} // namespace Eugenix
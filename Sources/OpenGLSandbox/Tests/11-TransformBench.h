@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+// Sandbox headers
+#include "TestUtils.h"
+
+#include "Engine/Core/Jobs.h"
+#include "Engine/Core/Log.h"
+#include "Engine/Math/Transform.h"
+#include "Engine/Math/TransformBatch.h"
+
+namespace Eugenix
+{
+	// World matrices of N objects: per object glm (Math::Transform, Reset/Translate/Rotate/Scale)
+	// against TransformBatch with each SIMD level, and the widest level split across the job workers.
+	class TransformBenchApp final : public BenchApp
+	{
+	protected:
+		void run() override
+		{
+			LogInfo("TransformBench: detected {}, ns per transform (speedup over glm)", Math::SimdLevelName(Math::DetectedSimdLevel()));
+			LogInfo("TransformBench: {:>9} | {:>16} | {:>16} | {:>16} | {:>16} | {:>16} | max error", "count", "glm", "Scalar", "SSE", "AVX2", "parallel");
+
+			for (uint32_t count : { 1'000u, 100'000u, 1'000'000u })
+			{
+				runCount(count);
+			}
+		}
+
+	private:
+		static constexpr int Runs = 5;
+
+		struct Input
+		{
+			glm::vec3 position;
+			glm::vec3 rotation; // degrees
+			glm::vec3 scale;
+		};
+
+		static std::vector<Input> makeInputs(uint32_t count)
+		{
+			std::mt19937 random{ count };
+			std::uniform_real_distribution<float> position{ -100.0f, 100.0f };
+			std::uniform_real_distribution<float> angle{ -180.0f, 180.0f };
+			std::uniform_real_distribution<float> scale{ 0.25f, 4.0f };
+
+			std::vector<Input> inputs(count);
+			for (auto& input : inputs)
+			{
+				input.position = { position(random), position(random), position(random) };
+				input.rotation = { angle(random), angle(random), angle(random) };
+				input.scale = { scale(random), scale(random), scale(random) };
+			}
+			return inputs;
+		}
+
+		static void runCount(uint32_t count)
+		{
+			const auto inputs = makeInputs(count);
+
+			std::vector<Math::Transform> transforms(count);
+			const double glmMs = BestOf(Runs, [&]
+				{
+					for (uint32_t i = 0; i < count; ++i)
+					{
+						auto& transform = transforms[i];
+						transform.Reset();
+						transform.Translate(inputs[i].position);
+						transform.Rotate(inputs[i].rotation);
+						transform.Scale(inputs[i].scale);
+					}
+				});
+
+			Math::TransformBatch batch;
+			batch.Reserve(count);
+			for (const auto& input : inputs)
+			{
+				batch.Add(input.position, Math::EulerToQuat(input.rotation), input.scale);
+			}
+
+			std::array<double, 3> levelMs{};
+			float maxError = 0.0f;
+
+			for (auto level : { Math::SimdLevel::Scalar, Math::SimdLevel::SSE, Math::SimdLevel::AVX2 })
+			{
+				if (Math::SupportedSimdLevel(level) != level)
+					continue;
+
+				levelMs[static_cast<size_t>(level)] = BestOf(Runs, [&] { batch.Update(level); });
+				maxError = std::max(maxError, compare(batch, transforms));
+			}
+
+			const double parallelMs = BestOf(Runs, [&]
+				{
+					Jobs::ParallelFor(0, count, 0, [&batch](uint32_t first, uint32_t last) { batch.Update(first, last); });
+				});
+			maxError = std::max(maxError, compare(batch, transforms));
+
+			auto column = [count, glmMs](double ms)
+				{
+					if (ms <= 0.0)
+						return std::string("n/a");
+					return std::format("{:7.2f} ({:5.1f}x)", ms * 1e6 / count, glmMs / ms);
+				};
+
+			LogInfo("TransformBench: {:9} | {:>16} | {:>16} | {:>16} | {:>16} | {:>16} | {:.2e}", count,
+				column(glmMs), column(levelMs[0]), column(levelMs[1]), column(levelMs[2]), column(parallelMs), maxError);
+		}
+
+		static float compare(const Math::TransformBatch& batch, const std::vector<Math::Transform>& transforms)
+		{
+			float maxError = 0.0f;
+			for (uint32_t i = 0; i < batch.Size(); ++i)
+			{
+				const glm::mat4& a = batch.World(i);
+				const glm::mat4& b = transforms[i].Matrix();
+				for (int c = 0; c < 4; ++c)
+				{
+					for (int r = 0; r < 4; ++r)
+						maxError = std::max(maxError, std::abs(a[c][r] - b[c][r]));
+				}
+			}
+			return maxError;
+		}
+	};
+} // namespace Eugenix
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Sandbox headers
+#include "TestUtils.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Time.h"
+#include "Engine/Scene/Bvh.h"
+#include "Engine/Scene/Culling.h"
+
+namespace Eugenix
+{
+	// Scene::Bvh over N random boxes: build, refit after every box moved, closest-hit rays against
+	// a linear scan over all boxes, and a frustum query against the FrustumCuller's full pass.
+	class BvhBenchApp final : public BenchApp
+	{
+	protected:
+		void run() override
+		{
+			LogInfo("BvhBench: {} rays | count | build ms | refit ms | ray us (linear us) | frustum ms (culler ms) | nodes | mismatches", Rays);
+
+			for (uint32_t count : { 10'000u, 100'000u, 1'000'000u })
+			{
+				runCount(count);
+			}
+		}
+
+	private:
+		static constexpr uint32_t Rays = 1000;
+
+		static float linearRaycast(const Scene::Ray& ray, const std::vector<Scene::Aabb>& boxes)
+		{
+			float closest = std::numeric_limits<float>::infinity();
+			for (const auto& box : boxes)
+			{
+				float enter = 0.0f;
+				float exit = closest;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					const float inverse = 1.0f / ray.direction[axis];
+					float t1 = (box.min[axis] - ray.origin[axis]) * inverse;
+					float t2 = (box.max[axis] - ray.origin[axis]) * inverse;
+					if (t1 > t2)
+						std::swap(t1, t2);
+					enter = std::max(enter, t1);
+					exit = std::min(exit, t2);
+				}
+				if (enter <= exit)
+					closest = enter;
+			}
+			return closest;
+		}
+
+		static void runCount(uint32_t count)
+		{
+			std::mt19937 random{ count };
+			std::uniform_real_distribution<float> position{ -500.0f, 500.0f };
+			std::uniform_real_distribution<float> size{ 0.5f, 4.0f };
+			std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+
+			std::vector<Scene::Aabb> boxes(count);
+			for (auto& box : boxes)
+			{
+				const glm::vec3 center{ position(random), position(random), position(random) };
+				const glm::vec3 extent{ size(random), size(random), size(random) };
+				box = { center - extent, center + extent };
+			}
+
+			Scene::Bvh bvh;
+			auto start = Time::Clock::now();
+			bvh.Build(boxes);
+			const double buildMs = MillisecondsSince(start);
+
+			for (auto& box : boxes)
+			{
+				const glm::vec3 move{ unit(random), unit(random), unit(random) };
+				box.min += move;
+				box.max += move;
+			}
+
+			start = Time::Clock::now();
+			bvh.Refit(boxes);
+			const double refitMs = MillisecondsSince(start);
+
+			std::vector<Scene::Ray> rays(Rays);
+			for (auto& ray : rays)
+			{
+				ray.origin = { position(random), position(random), position(random) };
+				ray.direction = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)));
+			}
+
+			std::vector<float> bvhHits(Rays);
+			start = Time::Clock::now();
+			for (uint32_t i = 0; i < Rays; ++i)
+			{
+				bvhHits[i] = bvh.Raycast(rays[i]).distance;
+			}
+			const double rayUs = MillisecondsSince(start) * 1000.0 / Rays;
+
+			// The linear scan is slow at 1M, a tenth of the rays is enough for the average
+			const uint32_t linearRays = std::max(1u, Rays / 10);
+			uint32_t mismatches = 0;
+			start = Time::Clock::now();
+			for (uint32_t i = 0; i < linearRays; ++i)
+			{
+				if (std::abs(linearRaycast(rays[i], boxes) - bvhHits[i]) > 1e-3f)
+					++mismatches;
+			}
+			const double linearUs = MillisecondsSince(start) * 1000.0 / linearRays;
+
+			const auto view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			const auto frustum = Scene::Frustum::FromViewProjection(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f) * view);
+
+			std::vector<uint32_t> visible;
+			start = Time::Clock::now();
+			bvh.Query(frustum, visible);
+			const double frustumMs = MillisecondsSince(start);
+
+			Scene::AabbBounds bounds;
+			bounds.Reserve(count);
+			for (const auto& box : boxes)
+			{
+				bounds.Add(box);
+			}
+
+			Scene::FrustumCuller culler;
+			start = Time::Clock::now();
+			culler.Cull(frustum, bounds);
+			const double cullerMs = MillisecondsSince(start);
+
+			if (visible.size() != culler.VisibleCount())
+				++mismatches;
+
+			LogInfo("BvhBench: {:8} | {:7.2f} | {:6.2f} | {:7.2f} ({:9.2f}) | {:6.3f} ({:6.3f}) | {} | {}", count,
+				buildMs, refitMs, rayUs, linearUs, frustumMs, cullerMs, bvh.Nodes().size(), mismatches);
+		}
+	};
+} // namespace Eugenix
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Sandbox headers
+#include "TestUtils.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Scene/Culling.h"
+#include "Engine/Scene/Occlusion.h"
+
+namespace Eugenix
+{
+	// Scene::OcclusionCuller on a city block: a grid of building boxes as occluders and N small
+	// boxes scattered between them. Rasterize per SIMD level, all levels have to give the same
+	// depth buffer, then Cull over the frustum survivors.
+	class OcclusionBenchApp final : public BenchApp
+	{
+	protected:
+		void run() override
+		{
+			LogInfo("OcclusionBench: {}x{}, {} buildings | count | raster ms scalar / SSE / AVX2 | cull ms | frustum visible | occluded | mismatches",
+				Width, Height, Buildings * Buildings);
+
+			for (uint32_t count : { 10'000u, 100'000u, 1'000'000u })
+			{
+				runCount(count);
+			}
+		}
+
+	private:
+		static constexpr uint32_t Width = 320;
+		static constexpr uint32_t Height = 192;
+		static constexpr uint32_t Buildings = 16;
+		static constexpr uint32_t Runs = 10;
+
+		// The kernels may contract the plane equation into FMAs differently, a few ulp apart
+		static bool sameDepth(float a, float b)
+		{
+			return std::abs(a - b) <= 1e-5f * std::max(a, b);
+		}
+
+		static void runCount(uint32_t count)
+		{
+			std::mt19937 random{ count };
+			std::uniform_real_distribution<float> height{ 5.0f, 30.0f };
+			std::uniform_real_distribution<float> spread{ -200.0f, 200.0f };
+			std::uniform_real_distribution<float> depth{ -400.0f, -5.0f };
+			std::uniform_real_distribution<float> size{ 0.2f, 1.0f };
+
+			// Buildings on a 25 m grid, 15 m wide, streets in between
+			std::vector<glm::mat4> buildings;
+			for (uint32_t x = 0; x < Buildings; ++x)
+			{
+				for (uint32_t z = 0; z < Buildings; ++z)
+				{
+					const float h = height(random);
+					const glm::vec3 center{ (float(x) - Buildings * 0.5f) * 25.0f, h * 0.5f, -10.0f - float(z) * 25.0f };
+					buildings.push_back(glm::scale(glm::translate(glm::mat4{ 1.0f }, center), glm::vec3(15.0f, h, 15.0f)));
+				}
+			}
+
+			Scene::AabbBounds bounds;
+			bounds.Reserve(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const glm::vec3 center{ spread(random), size(random), depth(random) };
+				const glm::vec3 extent{ size(random) };
+				bounds.Add({ center - extent, center + extent });
+			}
+
+			// Down the street between two rows of buildings
+			const auto view = glm::lookAt(glm::vec3(12.5f, 1.7f, 0.0f), glm::vec3(12.5f, 1.7f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			const auto viewProjection = glm::perspective(glm::radians(60.0f), float(Width) / float(Height), 0.1f, 500.0f) * view;
+
+			Scene::FrustumCuller culler;
+			culler.Cull(Scene::Frustum::FromViewProjection(viewProjection), bounds);
+
+			Scene::OcclusionCuller occlusion;
+			occlusion.Resize(Width, Height);
+
+			std::array<double, 3> rasterMs{};
+			std::vector<float> reference;
+			uint32_t mismatches = 0;
+
+			for (auto level : { Math::SimdLevel::Scalar, Math::SimdLevel::SSE, Math::SimdLevel::AVX2 })
+			{
+				if (Math::SupportedSimdLevel(level) != level)
+					continue;
+
+				rasterMs[static_cast<size_t>(level)] = BestOf(Runs, [&]
+					{
+						occlusion.BeginFrame(viewProjection);
+						for (const auto& building : buildings)
+						{
+							occlusion.AddOccluder(Scene::UnitCubeOccluder(), building);
+						}
+						occlusion.Rasterize(level);
+					});
+
+				const auto depthBuffer = occlusion.Depth();
+				if (reference.empty())
+					reference.assign(depthBuffer.begin(), depthBuffer.end());
+				else if (!std::equal(reference.begin(), reference.end(), depthBuffer.begin(), sameDepth))
+					++mismatches;
+			}
+
+			std::vector<uint32_t> visible;
+			const double cullMs = BestOf(Runs, [&]
+				{
+					visible.clear();
+					occlusion.Cull(bounds, culler.Visible(), visible);
+				});
+
+			// The survivors are a subsequence of the candidates
+			if (!std::includes(culler.Visible().begin(), culler.Visible().end(), visible.begin(), visible.end()))
+				++mismatches;
+
+			auto column = [](double ms) { return ms > 0.0 ? std::format("{:6.3f}", ms) : std::string("   n/a"); };
+
+			LogInfo("OcclusionBench: {:8} | {} / {} / {} | {:6.3f} | {:7} | {:7} | {}", count,
+				column(rasterMs[0]), column(rasterMs[1]), column(rasterMs[2]), cullMs,
+				culler.VisibleCount(), culler.VisibleCount() - visible.size(), mismatches);
+		}
+	};
+} // namespace Eugenix
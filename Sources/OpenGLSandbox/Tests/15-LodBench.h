@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+
+// Sandbox headers
+#include "TestUtils.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Time.h"
+#include "Engine/Scene/Lod.h"
+
+namespace Eugenix
+{
+	// Scene::BuildLods on a UV sphere with its seam column and pole rows, then SelectLod for a
+	// field of objects spread away from the camera: triangles submitted with and without LODs.
+	class LodBenchApp final : public BenchApp
+	{
+	protected:
+		void run() override
+		{
+			LogInfo("LodBench: sphere triangles | build ms | level triangles (error) ...");
+
+			for (uint32_t segments : { 64u, 256u, 512u })
+			{
+				runSphere(segments);
+			}
+		}
+
+	private:
+		static constexpr uint32_t Objects = 100'000;
+
+		static void runSphere(uint32_t segments)
+		{
+			const uint32_t rings = segments / 2;
+
+			std::vector<glm::vec3> positions;
+			for (uint32_t r = 0; r <= rings; ++r)
+			{
+				for (uint32_t s = 0; s <= segments; ++s)
+				{
+					const float theta = glm::pi<float>() * r / rings;
+					const float phi = glm::two_pi<float>() * (s % segments) / segments;
+					positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+				}
+			}
+
+			std::vector<uint32_t> indices;
+			for (uint32_t r = 0; r < rings; ++r)
+			{
+				for (uint32_t s = 0; s < segments; ++s)
+				{
+					const uint32_t a = r * (segments + 1) + s;
+					const uint32_t c = a + segments + 1;
+					indices.insert(indices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+				}
+			}
+
+			auto start = Time::Clock::now();
+			const Scene::LodChain chain = Scene::BuildLods(positions, indices);
+			const double buildMs = MillisecondsSince(start);
+
+			std::string levels;
+			for (const auto& level : chain.levels)
+			{
+				levels += std::format(" | {} ({:.4f})", level.indexCount / 3, level.error);
+			}
+			LogInfo("LodBench: {:8} | {:7.2f}{}", indices.size() / 3, buildMs, levels);
+
+			// Unit spheres between 2 and 200 units away, seen on a 1080p screen
+			std::mt19937 random{ segments };
+			std::uniform_real_distribution<float> distance{ 2.0f, 200.0f };
+			const auto view = Scene::LodView::FromPerspective(glm::vec3(0.0f), glm::radians(45.0f), 1080.0f);
+
+			std::vector<uint32_t> current(Objects, 0);
+			std::vector<Scene::Aabb> bounds(Objects);
+			for (auto& box : bounds)
+			{
+				const glm::vec3 center{ 0.0f, 0.0f, -distance(random) };
+				box = { center - glm::vec3(1.0f), center + glm::vec3(1.0f) };
+			}
+
+			std::array<uint32_t, 8> histogram{};
+			uint64_t triangles = 0;
+
+			start = Time::Clock::now();
+			for (uint32_t i = 0; i < Objects; ++i)
+			{
+				current[i] = Scene::SelectLod(chain.levels, view, bounds[i], 1.0f, current[i]);
+			}
+			const double selectMs = MillisecondsSince(start);
+
+			for (uint32_t level : current)
+			{
+				++histogram[std::min<size_t>(level, histogram.size() - 1)];
+				triangles += chain.levels[level].indexCount / 3;
+			}
+
+			LogInfo("LodBench: {} objects, select {:.3f} ms, objects per level {} {} {} {}, triangles {} of {}", Objects, selectMs,
+				histogram[0], histogram[1], histogram[2], histogram[3], triangles, uint64_t(Objects) * chain.levels[0].indexCount / 3);
+		}
+	};
+} // namespace Eugenix
@@ -147,7 +147,7 @@ namespace Eugenix
 		{
 			_transformUbo.Create();
 			// TODO : see GP4 (create by size, not by data)
-			_transformUbo.Storage(Core::MakeData(&_transform), GL_DYNAMIC_STORAGE_BIT);
+			_transformUbo.Storage(Core::MakeData(&_transform.Matrix()), GL_DYNAMIC_STORAGE_BIT);
 			_transformUbo.Bind(Render::BufferTarget::UBO, Render::BufferBinding::Transform);
 
 			_cameraUbo.Create();
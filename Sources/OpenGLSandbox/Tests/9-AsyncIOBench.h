@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <numeric>
+
+#if defined(__linux__)
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+// Sandbox headers
+#include "App/SandboxApp.h"
+#include "Assets/ImageLoader.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Time.h"
+#include "Engine/IO/AsyncReader.h"
+#include "Engine/IO/IO.h"
+
+namespace Eugenix
+{
+	// Compares sequential Map+decode against IO::AsyncReader on the viking room + skybox asset set.
+	// On Linux the page cache for every file is dropped before each run, so the numbers are cold-cache.
+	// Elsewhere the first run is cold only if nothing touched the files yet, the following runs are warm.
+	class AsyncIOBenchApp final : public SandboxApp
+	{
+	protected:
+		bool onInit() override
+		{
+			constexpr int Runs = 5;
+
+			std::array<double, Runs> syncMs{};
+			std::array<double, Runs> asyncMs{};
+
+			// The ring and the worker pool are set up once per process, keep that out of the runs
+			IO::AsyncReader& reader = IO::SharedReader();
+
+			for (int i = 0; i < Runs; ++i)
+			{
+				dropCache();
+				syncMs[i] = loadSync();
+
+				dropCache();
+				asyncMs[i] = loadAsync(reader);
+			}
+
+			const auto average = [](const auto& values)
+				{
+					return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+				};
+
+			LogInfo("AsyncIOBench: backend {}", reader.Backend() == IO::AsyncReaderBackend::IoUring ? "io_uring" : "thread pool");
+			LogInfo("AsyncIOBench: sync  avg {:.2f} ms (first {:.2f} ms)", average(syncMs), syncMs[0]);
+			LogInfo("AsyncIOBench: async avg {:.2f} ms (first {:.2f} ms)", average(asyncMs), asyncMs[0]);
+
+			glfwSetWindowShouldClose(WindowHandle(), true);
+			return true;
+		}
+
+	private:
+		static constexpr std::array<const char*, 7> Images
+		{
+			"models/viking_room.png",
+			"Textures/Skybox/right.jpg",
+			"Textures/Skybox/left.jpg",
+			"Textures/Skybox/top.jpg",
+			"Textures/Skybox/bottom.jpg",
+			"Textures/Skybox/front.jpg",
+			"Textures/Skybox/back.jpg"
+		};
+
+		static constexpr const char* Model = "models/viking_room.obj";
+
+		static void dropCache()
+		{
+#if defined(__linux__)
+			auto drop = [](const char* path)
+				{
+					const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+					if (fd < 0)
+						return;
+
+					::fdatasync(fd);
+					::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+					::close(fd);
+				};
+
+			drop(Model);
+			for (const auto* image : Images)
+				drop(image);
+#endif
+		}
+
+		// Touches every page so the sync path pays for the whole read, like the parser would
+		static size_t checksum(std::span<const std::byte> bytes)
+		{
+			size_t sum = 0;
+			for (size_t i = 0; i < bytes.size(); i += 4096)
+				sum += static_cast<size_t>(bytes[i]);
+			return sum;
+		}
+
+		double loadSync()
+		{
+			const auto start = Time::Clock::now();
+
+			const auto model = IO::File::Map(Model, IO::AccessHint::Sequential);
+			volatile size_t sink = checksum(model.Bytes());
+			(void)sink;
+
+			Assets::ImageLoader loader{};
+			for (const auto* image : Images)
+			{
+				const auto data = loader.Load(image);
+				(void)data;
+			}
+
+			return std::chrono::duration<double, std::milli>(Time::Clock::now() - start).count();
+		}
+
+		double loadAsync(IO::AsyncReader& reader)
+		{
+			const auto start = Time::Clock::now();
+
+			Assets::ImageLoader loader{};
+
+			auto model = reader.Load(Model, [](std::span<const std::byte> bytes) { return checksum(bytes); });
+
+			std::vector<std::future<Assets::ImageData>> images;
+			images.reserve(Images.size());
+			for (const auto* image : Images)
+				images.push_back(loader.LoadAsync(reader, image));
+
+			for (auto& image : images)
+				image.get();
+
+			try
+			{
+				model.get();
+			}
+			catch (const std::exception& e)
+			{
+				LogError("AsyncIOBench: {}", e.what());
+			}
+
+			return std::chrono::duration<double, std::milli>(Time::Clock::now() - start).count();
+		}
+	};
+} // namespace Eugenix
@@ -3,6 +3,13 @@
 #include "LearnOpenGLApp-Base.h"
 #include "LearnOpenGL-Shared.h"
 
+#include "Engine/Core/FrameStats.h"
+#include "Engine/Core/Simulation.h"
+#include "Engine/Math/Transform.h"
+#include "Engine/Scene/Culling.h"
+#include "Engine/Scene/Lod.h"
+#include "Engine/Scene/Occlusion.h"
+
 namespace Eugenix
 {
     class LearnOpenGLCurrentApp final : public LearnOpenGLAppBase
@@ -154,6 +161,20 @@ namespace Eugenix
 
             _model = _modelLoader.Load("Models/nanosuit/nanosuit.obj");
 
+            // Every 3rd cube (including the first) spins, stepped on the simulation thread
+            _cubeSimulation.Start(
+                [this](float stepSeconds) { _cubeSpin += 25.0f * stepSeconds; },
+                [this](std::vector<glm::mat4>& snapshot)
+                {
+                    snapshot.clear();
+                    for (size_t i = 0; i < std::size(cubePositions); ++i)
+                    {
+                        const float angle = i % 3 == 0 ? _cubeSpin : 20.0f * i;
+                        const auto model = glm::translate(glm::mat4{ 1.0f }, cubePositions[i]);
+                        snapshot.push_back(glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f)));
+                    }
+                });
+
             return true;
         }
 
@@ -214,6 +235,9 @@ namespace Eugenix
             _defaultShader.SetUniform("view", view);
             _defaultShader.SetUniform("projection", projection);
 
+            const auto frustum = Scene::Frustum::FromViewProjection(projection * view);
+            _occlusion.BeginFrame(projection * view);
+
             _defaultShader.SetUniform("viewPos", _camera.Position);
 
             _defaultShader.SetUniform("material.diffuse", 0);
@@ -276,23 +300,49 @@ namespace Eugenix
 
             glm::mat4 model = glm::mat4{ 1.0f };
 
-            for (GLuint i = 0; i < 10; i++)
+            // Unit cubes, the sphere around the corners covers every rotation
+            _cubeBounds.Clear();
+            _cubeBoxes.Clear();
+            _cubeModels.clear();
+            const auto cubes = _cubeSimulation.Acquire();
+            for (size_t i = 0; i < std::size(cubePositions); ++i)
             {
-                model = glm::translate(glm::mat4{ 1.0f }, cubePositions[i]);
-                float angle = 20.0f * i;
-                if (i % 3 == 0)  // every 3rd iteration (including the first) we set the angle using GLFW's time function.
-                    angle = glfwGetTime() * 25.0f;
-                model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-                _defaultShader.SetUniform("model", model);
+                _cubeBounds.Add({ cubePositions[i], 0.87f });
+                _cubeBoxes.Add({ cubePositions[i] - glm::vec3(0.87f), cubePositions[i] + glm::vec3(0.87f) });
+                _cubeModels.push_back(Math::Interpolate(cubes.previous[i], cubes.latest[i], cubes.alpha));
+            }
+            _cubeCuller.Cull(frustum, _cubeBounds);
+            FrameStats::AddCulling(_cubeCuller.TestedCount(), _cubeCuller.VisibleCount());
+
+            // The cubes in view hide each other and the model parts behind them
+            for (GLuint i : _cubeCuller.Visible())
+            {
+                _occlusion.AddOccluder(Scene::UnitCubeOccluder(), _cubeModels[i]);
+            }
+            _occlusion.Rasterize();
+
+            _cubeVisible.clear();
+            const uint32_t cubesDrawn = _occlusion.Cull(_cubeBoxes, _cubeCuller.Visible(), _cubeVisible);
+            FrameStats::AddOccluded(_cubeCuller.VisibleCount() - cubesDrawn);
+
+            for (GLuint i : _cubeVisible)
+            {
+                _defaultShader.SetUniform("model", _cubeModels[i]);
 
                 Render::OpenGL::Commands::DrawVertices(Render::PrimitiveType::Triangles, 36);
             }
+            FrameStats::AddTriangles(_cubeVisible.size() * 12);
 
             // model
             {
                 model = glm::scale(glm::mat4{ 1.0f }, glm::vec3(0.1f));
                 _defaultShader.SetUniform("model", model);
-                _model.Render();
+
+                const auto lodView = Scene::LodView::FromPerspective(_camera.Position, glm::radians(45.0f), static_cast<float>(height()));
+                const uint32_t partsDrawn = _model.Render(frustum, model, &_occlusion, &lodView);
+                FrameStats::AddCulling(_model.PartCount(), _model.FrustumVisibleCount());
+                FrameStats::AddOccluded(_model.FrustumVisibleCount() - partsDrawn);
+                FrameStats::AddTriangles(_model.DrawnTriangles());
             }
 
             // floor
@@ -348,5 +398,17 @@ namespace Eugenix
         Render::OpenGL::ShaderProgram _skyboxProgram;
 
         Render::Model _model;
+
+        Scene::SphereBounds _cubeBounds;
+        Scene::FrustumCuller _cubeCuller;
+
+        Scene::AabbBounds _cubeBoxes;
+        std::vector<glm::mat4> _cubeModels;
+        std::vector<uint32_t> _cubeVisible;
+        Scene::OcclusionCuller _occlusion;
+
+        // Owned by the simulation thread while it runs, declared before it so it is stopped first
+        float _cubeSpin{ 0.0f };
+        Simulation::FixedStepThread<std::vector<glm::mat4>> _cubeSimulation;
     };
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
 #include <span>
 
 #include <glm/glm.hpp>
@@ -7,6 +9,9 @@
 
 #include <stb_image.h>
 
+#include "App/SandboxApp.h"
+
+#include "Engine/Core/Time.h"
 #include "Engine/IO/IO.h"
 
 #include "Render/OpenGL/Commands.h"
@@ -165,7 +170,7 @@ namespace Eugenix
 		return stage;
 	}
 
-	Render::OpenGL::ShaderStage CreateStage(const std::vector<char>& source, Render::ShaderStageType type)
+	Render::OpenGL::ShaderStage CreateStage(std::span<const std::byte> source, Render::ShaderStageType type)
 	{
 		Render::OpenGL::ShaderStage stage{ type };
 		stage.Create();
@@ -173,6 +178,11 @@ namespace Eugenix
 		return stage;
 	}
 
+	Render::OpenGL::ShaderStage CreateStage(const std::vector<char>& source, Render::ShaderStageType type)
+	{
+		return CreateStage(std::as_bytes(std::span{ source }), type);
+	}
+
 	inline Render::OpenGL::ShaderProgram MakeShaderProgram(std::string_view vsSource, std::string_view fsSource)
 	{
 		auto vs = CreateStage(vsSource, Render::ShaderStageType::Vertex);
@@ -187,7 +197,7 @@ namespace Eugenix
 		return p;
 	}
 
-	inline Render::OpenGL::ShaderProgram MakeShaderProgram(const std::vector<char>& vsSource, const std::vector<char>& fsSource)
+	inline Render::OpenGL::ShaderProgram MakeShaderProgram(std::span<const std::byte> vsSource, std::span<const std::byte> fsSource)
 	{
 		auto vs = CreateStage(vsSource, Render::ShaderStageType::Vertex);
 		auto fs = CreateStage(fsSource, Render::ShaderStageType::Fragment);
@@ -208,22 +218,16 @@ namespace Eugenix
 		if (vsSpv != fsSpv)
 			throw std::runtime_error("VS/FS format mismatch: both must be .spv or both must be GLSL.");
 
+		const auto vsData = IO::File::Map(vsPath);
+		const auto fsData = IO::File::Map(fsPath);
+
 		if (vsSpv)
 		{
-			auto vsData = IO::File::ReadBinary(vsPath);
-			auto fsData = IO::File::ReadBinary(fsPath);
-
-			return MakeShaderProgram(vsData, fsData);
+			return MakeShaderProgram(vsData.Bytes(), fsData.Bytes());
 		}
 		else
 		{
-			auto vsData = IO::File::ReadText(vsPath);
-			auto fsData = IO::File::ReadText(fsPath);
-
-			return MakeShaderProgram(
-				std::string_view{ vsData.data(), vsData.size() },
-				std::string_view{ fsData.data(), fsData.size() }
-			);
+			return MakeShaderProgram(vsData.Text(), fsData.Text());
 		}
 	}
 
@@ -264,4 +268,39 @@ namespace Eugenix
 
 		return attrib;
 	}
+
+	// Benchmarks
+
+	inline double MillisecondsSince(Time::Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Time::Clock::now() - start).count();
+	}
+
+	// Fastest of runs calls, in milliseconds
+	template<typename Fn>
+	double BestOf(uint32_t runs, Fn&& fn)
+	{
+		double result = std::numeric_limits<double>::max();
+		for (uint32_t run = 0; run < runs; ++run)
+		{
+			const auto start = Time::Clock::now();
+			fn();
+			result = std::min(result, MillisecondsSince(start));
+		}
+		return result;
+	}
+
+	// Measures everything in run(), called from onInit(), then closes the window
+	class BenchApp : public SandboxApp
+	{
+	protected:
+		virtual void run() = 0;
+
+		bool onInit() final
+		{
+			run();
+			glfwSetWindowShouldClose(WindowHandle(), true);
+			return true;
+		}
+	};
 }
@@ -1,4 +1,5 @@
 #include <functional>
+#include <string_view>
 
 // Tests headers
 #include "Tests/0-TriangleApp.h"
@@ -9,6 +10,13 @@
 #include "Tests/4.2-AssimpLoader.h"
 #include "Tests/6-DebugDraw.h"
 #include "Tests/8-Skybox.h"
+#include "Tests/9-AsyncIOBench.h"
+#include "Tests/10-JobsBench.h"
+#include "Tests/11-TransformBench.h"
+#include "Tests/12-EcsBench.h"
+#include "Tests/13-BvhBench.h"
+#include "Tests/14-OcclusionBench.h"
+#include "Tests/15-LodBench.h"
 
 #include "Tests/LearnOpenGLApp.h"
 #include "Tests/MainSandbox.h"
@@ -43,6 +51,13 @@ REGISTER_TEST("5", "TinyObjLoader", TinyObjLoaderApp);
 REGISTER_TEST("6", "AssimpLoader", AssimpLoaderApp);
 REGISTER_TEST("7", "DebugDraw", DebugDrawerApp);
 REGISTER_TEST("8", "Skybox", SkyboxApp);
+REGISTER_TEST("9", "AsyncIOBench", AsyncIOBenchApp);
+REGISTER_TEST("10", "JobsBench", JobsBenchApp);
+REGISTER_TEST("11", "TransformBench", TransformBenchApp);
+REGISTER_TEST("12", "EcsBench", EcsBenchApp);
+REGISTER_TEST("13", "BvhBench", BvhBenchApp);
+REGISTER_TEST("14", "OcclusionBench", OcclusionBenchApp);
+REGISTER_TEST("15", "LodBench", LodBenchApp);
 
 static inline std::string trim(std::string s) 
 {
@@ -59,10 +74,85 @@ public:
 	{
 		return app->Run();
 	}
+
+	// --bench <key> [--frames N] [--warmup N] [--out file.json]
+	static int RunBenchmark(int argc, char** argv)
+	{
+		constexpr std::string_view Usage = "Usage: --bench <key> [--frames N] [--warmup N] [--out file.json]\n";
+
+		// std::stoul also takes "-1", "10x" and values past 32 bits, those are invalid here too
+		auto parseCount = [](const char* text)
+			{
+				const std::string value = text;
+				size_t end = 0;
+				const unsigned long count = std::stoul(value, &end);
+				if (end != value.size() || value.find('-') != std::string::npos || count > UINT32_MAX)
+					throw std::invalid_argument(value);
+				return static_cast<uint32_t>(count);
+			};
+
+		BenchmarkConfig config{};
+		std::string key;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			try
+			{
+				if (arg == "--bench" && hasValue)
+					key = argv[++i];
+				else if (arg == "--frames" && hasValue)
+					config.frames = parseCount(argv[++i]);
+				else if (arg == "--warmup" && hasValue)
+					config.warmupFrames = parseCount(argv[++i]);
+				else if (arg == "--out" && hasValue)
+					config.output = argv[++i];
+				else
+				{
+					std::cerr << "Unknown argument: " << arg << "\n" << Usage;
+					return EXIT_FAILURE;
+				}
+			}
+			catch (const std::logic_error&)	// std::invalid_argument, std::out_of_range
+			{
+				std::cerr << "Invalid value for " << arg << ": \"" << argv[i] << "\"\n" << Usage;
+				return EXIT_FAILURE;
+			}
+		}
+
+		auto it = std::find_if(EugenixTests.begin(), EugenixTests.end(), [&](const TestEntry& t) { return t.key == key; });
+		if (it == EugenixTests.end())
+		{
+			std::cerr << "Unknown test: \"" << key << "\"\n";
+			return EXIT_FAILURE;
+		}
+
+		config.name = it->title;
+		if (config.output.empty())
+			config.output = "Bench-" + it->title + ".json";
+
+		auto app = it->make();
+		app->SetBenchmark(config);
+
+		try
+		{
+			return app->Run();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "App threw exception: " << e.what() << "\n";
+			return EXIT_FAILURE;
+		}
+	}
 };
 
-int main()
+int main(int argc, char** argv)
 {
+    if (argc > 1)
+        return TestRunner::RunBenchmark(argc, argv);
+
     std::string lastKey;
 
     while (true) 